@@ -16,7 +16,9 @@
 #define BOOST_GEOMETRY_ALGORITHMS_DETAIL_OVERLAY_GET_TURNS_HPP
 
 
+#include <algorithm>
 #include <cstddef>
+#include <iterator>
 #include <map>
 
 #include <boost/array.hpp>
@@ -35,6 +37,7 @@
 
 #include <boost/geometry/geometries/concepts/check.hpp>
 
+#include <boost/geometry/util/condition.hpp>
 #include <boost/geometry/util/math.hpp>
 #include <boost/geometry/views/closeable_view.hpp>
 #include <boost/geometry/views/reversible_view.hpp>
@@ -421,6 +424,24 @@ struct section_visitor
         , m_interrupt_policy(ip)
     {}
 
+    // Used by the parallel partition, the turns are stored in the buffer
+    typedef Turns buffer_type;
+
+    section_visitor(section_visitor const& other, Turns& turns)
+        : m_source_id1(other.m_source_id1), m_geometry1(other.m_geometry1)
+        , m_source_id2(other.m_source_id2), m_geometry2(other.m_geometry2)
+        , m_intersection_strategy(other.m_intersection_strategy)
+        , m_rescale_policy(other.m_rescale_policy)
+        , m_turns(turns)
+        , m_interrupt_policy(other.m_interrupt_policy)
+    {}
+
+    inline void join(Turns& turns)
+    {
+        std::copy(boost::begin(turns), boost::end(turns),
+                  std::back_inserter(m_turns));
+    }
+
     template <typename Section>
     inline bool apply(Section const& sec1, Section const& sec2)
     {
@@ -456,6 +477,10 @@ class get_turns_generic
 {
 
 public:
+    // The sections are partitioned by the given number of threads, 0 means
+    // the number of hardware threads. The turns are the same and in the same
+    // order as in the sequential version. Stateful interrupt policies are
+    // not thread-safe so they're always used in the calling thread only.
     template <typename IntersectionStrategy, typename RobustPolicy, typename Turns, typename InterruptPolicy>
     static inline void apply(
             int source_id1, Geometry1 const& geometry1,
@@ -463,7 +488,8 @@ public:
             IntersectionStrategy const& intersection_strategy,
             RobustPolicy const& robust_policy,
             Turns& turns,
-            InterruptPolicy& interrupt_policy)
+            InterruptPolicy& interrupt_policy,
+            std::size_t threads = 1)
     {
         // First create monotonic sections...
         typedef typename boost::range_value<Turns>::type ip_type;
@@ -501,12 +527,27 @@ public:
                       intersection_strategy, robust_policy,
                       turns, interrupt_policy);
 
-        geometry::partition
-            <
-                box_type
-            >::apply(sec1, sec2, visitor,
-                     detail::section::get_section_box(),
-                     detail::section::overlaps_section_box());
+        if (threads == 1 || BOOST_GEOMETRY_CONDITION(InterruptPolicy::enabled))
+        {
+            geometry::partition
+                <
+                    box_type
+                >::apply(sec1, sec2, visitor,
+                         detail::section::get_section_box(),
+                         detail::section::overlaps_section_box());
+        }
+        else
+        {
+            typedef geometry::partition<box_type> partition_type;
+            partition_type::apply(sec1, sec2, visitor,
+                                  detail::section::get_section_box(),
+                                  detail::section::overlaps_section_box(),
+                                  detail::section::get_section_box(),
+                                  detail::section::overlaps_section_box(),
+                                  partition_type::default_min_elements,
+                                  detail::partition::visit_no_policy(),
+                                  threads);
+        }
     }
 };
 
@@ -16,7 +16,9 @@
 #define BOOST_GEOMETRY_ALGORITHMS_DETAIL_OVERLAY_SELF_TURN_POINTS_HPP
 
 
+#include <algorithm>
 #include <cstddef>
+#include <iterator>
 
 #include <boost/mpl/vector_c.hpp>
 #include <boost/range.hpp>
@@ -96,6 +98,25 @@ struct self_section_visitor
         , m_skip_adjacent(skip_adjacent)
     {}
 
+    // Used by the parallel partition, the turns are stored in the buffer
+    typedef Turns buffer_type;
+
+    inline self_section_visitor(self_section_visitor const& other, Turns& turns)
+        : m_geometry(other.m_geometry)
+        , m_intersection_strategy(other.m_intersection_strategy)
+        , m_rescale_policy(other.m_rescale_policy)
+        , m_turns(turns)
+        , m_interrupt_policy(other.m_interrupt_policy)
+        , m_source_index(other.m_source_index)
+        , m_skip_adjacent(other.m_skip_adjacent)
+    {}
+
+    inline void join(Turns& turns)
+    {
+        std::copy(boost::begin(turns), boost::end(turns),
+                  std::back_inserter(m_turns));
+    }
+
     template <typename Section>
     inline bool apply(Section const& sec1, Section const& sec2)
     {
@@ -128,6 +149,9 @@ struct self_section_visitor
 template <bool Reverse, typename TurnPolicy>
 struct get_turns
 {
+    // The sections are partitioned by the given number of threads, 0 means
+    // the number of hardware threads. Stateful interrupt policies are not
+    // thread-safe so in this case the calling thread is used only.
     template <typename Geometry, typename IntersectionStrategy, typename RobustPolicy, typename Turns, typename InterruptPolicy>
     static inline bool apply(
             Geometry const& geometry,
@@ -135,7 +159,8 @@ struct get_turns
             RobustPolicy const& robust_policy,
             Turns& turns,
             InterruptPolicy& interrupt_policy,
-            int source_index, bool skip_adjacent)
+            int source_index, bool skip_adjacent,
+            std::size_t threads = 1)
     {
         typedef model::box
             <
@@ -162,13 +187,24 @@ struct get_turns
                 Turns, TurnPolicy, IntersectionStrategy, RobustPolicy, InterruptPolicy
             > visitor(geometry, intersection_strategy, robust_policy, turns, interrupt_policy, source_index, skip_adjacent);
 
+        typedef geometry::partition<box_type> partition_type;
+
         // false if interrupted
-        geometry::partition
-            <
-                box_type
-            >::apply(sec, visitor,
-                     detail::section::get_section_box(),
-                     detail::section::overlaps_section_box());
+        if (threads == 1 || BOOST_GEOMETRY_CONDITION(InterruptPolicy::enabled))
+        {
+            partition_type::apply(sec, visitor,
+                                  detail::section::get_section_box(),
+                                  detail::section::overlaps_section_box());
+        }
+        else
+        {
+            partition_type::apply(sec, visitor,
+                                  detail::section::get_section_box(),
+                                  detail::section::overlaps_section_box(),
+                                  partition_type::default_min_elements,
+                                  detail::partition::visit_no_policy(),
+                                  threads);
+        }
 
         return ! interrupt_policy.has_intersections;
     }
@@ -230,7 +266,8 @@ struct self_get_turn_points
             Turns& ,
             InterruptPolicy& ,
             int /*source_index*/,
-            bool /*skip_adjacent*/)
+            bool /*skip_adjacent*/,
+            std::size_t /*threads*/ = 1)
     {
         return true;
     }
@@ -293,7 +330,8 @@ inline void self_turns(Geometry const& geometry,
                        Turns& turns,
                        InterruptPolicy& interrupt_policy,
                        int source_index = 0,
-                       bool skip_adjacent = false)
+                       bool skip_adjacent = false,
+                       std::size_t threads = 1)
 {
     concepts::check<Geometry const>();
 
@@ -306,7 +344,7 @@ inline void self_turns(Geometry const& geometry,
                 Geometry,
                 turn_policy
             >::apply(geometry, strategy, robust_policy, turns, interrupt_policy,
-                     source_index, skip_adjacent);
+                     source_index, skip_adjacent, threads);
 }
 
 }} // namespace detail::self_get_turn_points
@@ -324,6 +362,10 @@ inline void self_turns(Geometry const& geometry,
     \param turns container which will contain intersection points
     \param interrupt_policy policy determining if process is stopped
         when intersection is found
+    \param source_index source index for generated turns
+    \param skip_adjacent indicates if adjacent turns should be skipped
+    \param threads the maximum number of threads used to find the turns,
+        if 0 the number of hardware threads is used
  */
 template
 <
@@ -340,7 +382,8 @@ inline void self_turns(Geometry const& geometry,
                        Turns& turns,
                        InterruptPolicy& interrupt_policy,
                        int source_index = 0,
-                       bool skip_adjacent = false)
+                       bool skip_adjacent = false,
+                       std::size_t threads = 1)
 {
     concepts::check<Geometry const>();
 
@@ -354,7 +397,7 @@ inline void self_turns(Geometry const& geometry,
                 reverse,
                 AssignPolicy
             >(geometry, strategy, robust_policy, turns, interrupt_policy,
-              source_index, skip_adjacent);
+              source_index, skip_adjacent, threads);
 }
 
 
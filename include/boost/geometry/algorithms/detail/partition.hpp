@@ -22,6 +22,7 @@
 #include <boost/geometry/core/access.hpp>
 #include <boost/geometry/core/coordinate_type.hpp>
 #include <boost/geometry/algorithms/assign.hpp>
+#include <boost/geometry/util/parallel.hpp>
 
 
 namespace boost { namespace geometry
@@ -209,6 +210,69 @@ inline bool recurse_ok(IteratorVector1 const& input1,
 }
 
 
+// The partitioning may be performed sequentially or by more than one thread.
+// In the parallel version, after the exceeding elements are handled, the
+// upper parts of the ranges are processed in a separate thread, concurrently
+// with the lower parts. The threads are distributed between the two halves
+// at each level so at most the requested number of threads is running at
+// the same time.
+// The visitor of the upper part is created with the constructor taking the
+// visitor and a buffer of type VisitPolicy::buffer_type where the results are
+// stored. The buffer is then passed to visitor.join(), after the lower part
+// is finished, so the results are merged in the same order as in the
+// sequential version. If the lower part is interrupted the results of the
+// upper part are dropped. The VisitBoxPolicy has to be thread-safe.
+struct sequential_execution
+{};
+
+struct parallel_execution
+{
+    explicit parallel_execution(std::size_t t)
+        : threads(t)
+    {}
+
+    std::size_t threads;
+};
+
+template <typename Task, typename VisitPolicy>
+struct bound_task
+{
+    bound_task(Task const& t, VisitPolicy& v)
+        : task(t), visitor(v), result(false)
+    {}
+
+    void operator()()
+    {
+        result = task(visitor);
+    }
+
+    Task const& task;
+    VisitPolicy& visitor;
+    bool result;
+};
+
+template <typename Task, typename VisitPolicy>
+inline bool apply_concurrently(Task const& lower_task, Task const& upper_task,
+                               VisitPolicy& visitor)
+{
+    typename VisitPolicy::buffer_type upper_buffer;
+    VisitPolicy upper_visitor(visitor, upper_buffer);
+
+    bound_task<Task, VisitPolicy> lower(lower_task, visitor);
+    bound_task<Task, VisitPolicy> upper(upper_task, upper_visitor);
+
+    geometry::detail::parallel::invoke(upper, lower, true);
+
+    if (! lower.result)
+    {
+        return false; // interrupt
+    }
+
+    visitor.join(upper_buffer);
+    return upper.result;
+}
+
+
 template <int Dimension, typename Box>
 class partition_two_ranges;
 
@@ -232,7 +296,8 @@ class partition_one_range
         typename VisitPolicy,
         typename ExpandPolicy,
         typename OverlapsPolicy,
-        typename VisitBoxPolicy
+        typename VisitBoxPolicy,
+        typename Execution
     >
     static inline bool next_level(Box const& box,
                                   IteratorVector const& input,
@@ -240,7 +305,8 @@ class partition_one_range
                                   VisitPolicy& visitor,
                                   ExpandPolicy const& expand_policy,
                                   OverlapsPolicy const& overlaps_policy,
-                                  VisitBoxPolicy& box_policy)
+                                  VisitBoxPolicy& box_policy,
+                                  Execution const& execution)
     {
         if (recurse_ok(input, min_elements, level))
         {
@@ -249,7 +315,8 @@ class partition_one_range
                     1 - Dimension,
                     Box
                 >::apply(box, input, level + 1, min_elements,
-                         visitor, expand_policy, overlaps_policy, box_policy);
+                         visitor, expand_policy, overlaps_policy, box_policy,
+                         execution);
         }
         else
         {
@@ -265,7 +332,8 @@ class partition_one_range
         typename VisitPolicy,
         typename ExpandPolicy,
         typename OverlapsPolicy,
-        typename VisitBoxPolicy
+        typename VisitBoxPolicy,
+        typename Execution
     >
     static inline bool next_level2(Box const& box,
                                    IteratorVector const& input1,
@@ -274,7 +342,8 @@ class partition_one_range
                                    VisitPolicy& visitor,
                                    ExpandPolicy const& expand_policy,
                                    OverlapsPolicy const& overlaps_policy,
-                                   VisitBoxPolicy& box_policy)
+                                   VisitBoxPolicy& box_policy,
+                                   Execution const& execution)
     {
         if (recurse_ok(input1, input2, min_elements, level))
         {
@@ -283,7 +352,8 @@ class partition_one_range
                     1 - Dimension, Box
                 >::apply(box, input1, input2, level + 1, min_elements,
                          visitor, expand_policy, overlaps_policy,
-                         expand_policy, overlaps_policy, box_policy);
+                         expand_policy, overlaps_policy, box_policy,
+                         execution);
         }
         else
         {
@@ -291,7 +361,44 @@ class partition_one_range
         }
     }
 
-public :
+    template
+    <
+        typename IteratorVector,
+        typename ExpandPolicy,
+        typename OverlapsPolicy,
+        typename VisitBoxPolicy
+    >
+    struct next_level_task
+    {
+        next_level_task(Box const& b, IteratorVector const& in,
+                        std::size_t l, std::size_t me,
+                        ExpandPolicy const& ep, OverlapsPolicy const& op,
+                        VisitBoxPolicy& bp, std::size_t th)
+            : box(b), input(in), level(l), min_elements(me)
+            , expand_policy(ep), overlaps_policy(op), box_policy(bp)
+            , threads(th)
+        {}
+
+        template <typename VisitPolicy>
+        bool operator()(VisitPolicy& visitor) const
+        {
+            return partition_one_range::next_level(box, input,
+                        level, min_elements, visitor,
+                        expand_policy, overlaps_policy, box_policy,
+                        parallel_execution(threads));
+        }
+
+        Box const& box;
+        IteratorVector const& input;
+        std::size_t level;
+        std::size_t min_elements;
+        ExpandPolicy const& expand_policy;
+        OverlapsPolicy const& overlaps_policy;
+        VisitBoxPolicy& box_policy;
+        std::size_t threads;
+    };
+
+    // Recursively call operation both parts
     template
     <
         typename IteratorVector,
@@ -300,6 +407,81 @@ public :
         typename OverlapsPolicy,
         typename VisitBoxPolicy
     >
+    static inline bool next_levels(Box const& lower_box,
+                                   IteratorVector const& lower,
+                                   Box const& upper_box,
+                                   IteratorVector const& upper,
+                                   std::size_t level, std::size_t min_elements,
+                                   VisitPolicy& visitor,
+                                   ExpandPolicy const& expand_policy,
+                                   OverlapsPolicy const& overlaps_policy,
+                                   VisitBoxPolicy& box_policy,
+                                   sequential_execution const& execution)
+    {
+        return next_level(lower_box, lower, level, min_elements,
+                          visitor, expand_policy, overlaps_policy, box_policy,
+                          execution)
+            && next_level(upper_box, upper, level, min_elements,
+                          visitor, expand_policy, overlaps_policy, box_policy,
+                          execution);
+    }
+
+    template
+    <
+        typename IteratorVector,
+        typename VisitPolicy,
+        typename ExpandPolicy,
+        typename OverlapsPolicy,
+        typename VisitBoxPolicy
+    >
+    static inline bool next_levels(Box const& lower_box,
+                                   IteratorVector const& lower,
+                                   Box const& upper_box,
+                                   IteratorVector const& upper,
+                                   std::size_t level, std::size_t min_elements,
+                                   VisitPolicy& visitor,
+                                   ExpandPolicy const& expand_policy,
+                                   OverlapsPolicy const& overlaps_policy,
+                                   VisitBoxPolicy& box_policy,
+                                   parallel_execution const& execution)
+    {
+        // A thread is started only if the upper part is going to be divided
+        if (execution.threads <= 1 || ! recurse_ok(upper, min_elements, level))
+        {
+            return next_level(lower_box, lower, level, min_elements,
+                              visitor, expand_policy, overlaps_policy, box_policy,
+                              execution)
+                && next_level(upper_box, upper, level, min_elements,
+                              visitor, expand_policy, overlaps_policy, box_policy,
+                              execution);
+        }
+
+        typedef next_level_task
+            <
+                IteratorVector, ExpandPolicy, OverlapsPolicy, VisitBoxPolicy
+            > task_type;
+
+        std::size_t const upper_threads = execution.threads / 2;
+        task_type const lower_task(lower_box, lower, level, min_elements,
+                                   expand_policy, overlaps_policy, box_policy,
+                                   execution.threads - upper_threads);
+        task_type const upper_task(upper_box, upper, level, min_elements,
+                                   expand_policy, overlaps_policy, box_policy,
+                                   upper_threads);
+
+        return apply_concurrently(lower_task, upper_task, visitor);
+    }
+
+public :
+    template
+    <
+        typename IteratorVector,
+        typename VisitPolicy,
+        typename ExpandPolicy,
+        typename OverlapsPolicy,
+        typename VisitBoxPolicy,
+        typename Execution
+    >
     static inline bool apply(Box const& box,
                              IteratorVector const& input,
                              std::size_t level,
@@ -307,7 +489,8 @@ public :
                              VisitPolicy& visitor,
                              ExpandPolicy const& expand_policy,
                              OverlapsPolicy const& overlaps_policy,
-                             VisitBoxPolicy& box_policy)
+                             VisitBoxPolicy& box_policy,
+                             Execution const& execution)
     {
         box_policy.apply(box, level);
 
@@ -327,23 +510,26 @@ public :
                    // Recursively do exceeding elements only, in next dimension they
                    // will probably be less exceeding within the new box
             if (! (next_level(exceeding_box, exceeding, level, min_elements,
-                              visitor, expand_policy, overlaps_policy, box_policy)
+                              visitor, expand_policy, overlaps_policy, box_policy,
+                              execution)
                    // Switch to two forward ranges, combine exceeding with
                    // lower resp upper, but not lower/lower, upper/upper
                 && next_level2(exceeding_box, exceeding, lower, level, min_elements,
-                               visitor, expand_policy, overlaps_policy, box_policy)
+                               visitor, expand_policy, overlaps_policy, box_policy,
+                               execution)
                 && next_level2(exceeding_box, exceeding, upper, level, min_elements,
-                               visitor, expand_policy, overlaps_policy, box_policy)) )
+                               visitor, expand_policy, overlaps_policy, box_policy,
+                               execution)) )
             {
                 return false; // interrupt
             }
         }
 
         // Recursively call operation both parts
-        return next_level(lower_box, lower, level, min_elements,
-                          visitor, expand_policy, overlaps_policy, box_policy)
-            && next_level(upper_box, upper, level, min_elements,
-                          visitor, expand_policy, overlaps_policy, box_policy);
+        return next_levels(lower_box, lower, upper_box, upper,
+                           level, min_elements,
+                           visitor, expand_policy, overlaps_policy, box_policy,
+                           execution);
     }
 };
 
@@ -363,7 +549,8 @@ class partition_two_ranges
         typename OverlapsPolicy1,
         typename ExpandPolicy2,
         typename OverlapsPolicy2,
-        typename VisitBoxPolicy
+        typename VisitBoxPolicy,
+        typename Execution
     >
     static inline bool next_level(Box const& box,
                                   IteratorVector1 const& input1,
@@ -374,14 +561,199 @@ class partition_two_ranges
                                   OverlapsPolicy1 const& overlaps_policy1,
                                   ExpandPolicy2 const& expand_policy2,
                                   OverlapsPolicy2 const& overlaps_policy2,
-                                  VisitBoxPolicy& box_policy)
+                                  VisitBoxPolicy& box_policy,
+                                  Execution const& execution)
     {
         return partition_two_ranges
             <
                 1 - Dimension, Box
             >::apply(box, input1, input2, level + 1, min_elements,
                      visitor, expand_policy1, overlaps_policy1,
-                     expand_policy2, overlaps_policy2, box_policy);
+                     expand_policy2, overlaps_policy2, box_policy,
+                     execution);
+    }
+
+    // Recursively call operation for the lower or upper parts
+    // or handle them directly if they are small
+    template
+    <
+        typename IteratorVector1,
+        typename IteratorVector2,
+        typename VisitPolicy,
+        typename ExpandPolicy1,
+        typename OverlapsPolicy1,
+        typename ExpandPolicy2,
+        typename OverlapsPolicy2,
+        typename VisitBoxPolicy,
+        typename Execution
+    >
+    static inline bool next_level_or_handle(Box const& box,
+                                            IteratorVector1 const& input1,
+                                            IteratorVector2 const& input2,
+                                            std::size_t level, std::size_t min_elements,
+                                            VisitPolicy& visitor,
+                                            ExpandPolicy1 const& expand_policy1,
+                                            OverlapsPolicy1 const& overlaps_policy1,
+                                            ExpandPolicy2 const& expand_policy2,
+                                            OverlapsPolicy2 const& overlaps_policy2,
+                                            VisitBoxPolicy& box_policy,
+                                            Execution const& execution)
+    {
+        if (recurse_ok(input1, input2, min_elements, level))
+        {
+            return next_level(box, input1, input2, level,
+                              min_elements, visitor, expand_policy1, overlaps_policy1,
+                              expand_policy2, overlaps_policy2, box_policy,
+                              execution);
+        }
+        else
+        {
+            return handle_two(input1, input2, visitor);
+        }
+    }
+
+    template
+    <
+        typename IteratorVector1,
+        typename IteratorVector2,
+        typename ExpandPolicy1,
+        typename OverlapsPolicy1,
+        typename ExpandPolicy2,
+        typename OverlapsPolicy2,
+        typename VisitBoxPolicy
+    >
+    struct next_level_task
+    {
+        next_level_task(Box const& b,
+                        IteratorVector1 const& in1, IteratorVector2 const& in2,
+                        std::size_t l, std::size_t me,
+                        ExpandPolicy1 const& ep1, OverlapsPolicy1 const& op1,
+                        ExpandPolicy2 const& ep2, OverlapsPolicy2 const& op2,
+                        VisitBoxPolicy& bp, std::size_t th)
+            : box(b), input1(in1), input2(in2), level(l), min_elements(me)
+            , expand_policy1(ep1), overlaps_policy1(op1)
+            , expand_policy2(ep2), overlaps_policy2(op2)
+            , box_policy(bp), threads(th)
+        {}
+
+        template <typename VisitPolicy>
+        bool operator()(VisitPolicy& visitor) const
+        {
+            return partition_two_ranges::next_level_or_handle(box,
+                        input1, input2, level, min_elements, visitor,
+                        expand_policy1, overlaps_policy1,
+                        expand_policy2, overlaps_policy2, box_policy,
+                        parallel_execution(threads));
+        }
+
+        Box const& box;
+        IteratorVector1 const& input1;
+        IteratorVector2 const& input2;
+        std::size_t level;
+        std::size_t min_elements;
+        ExpandPolicy1 const& expand_policy1;
+        OverlapsPolicy1 const& overlaps_policy1;
+        ExpandPolicy2 const& expand_policy2;
+        OverlapsPolicy2 const& overlaps_policy2;
+        VisitBoxPolicy& box_policy;
+        std::size_t threads;
+    };
+
+    template
+    <
+        typename IteratorVector1,
+        typename IteratorVector2,
+        typename VisitPolicy,
+        typename ExpandPolicy1,
+        typename OverlapsPolicy1,
+        typename ExpandPolicy2,
+        typename OverlapsPolicy2,
+        typename VisitBoxPolicy
+    >
+    static inline bool next_levels(Box const& lower_box,
+                                   IteratorVector1 const& lower1,
+                                   IteratorVector2 const& lower2,
+                                   Box const& upper_box,
+                                   IteratorVector1 const& upper1,
+                                   IteratorVector2 const& upper2,
+                                   std::size_t level, std::size_t min_elements,
+                                   VisitPolicy& visitor,
+                                   ExpandPolicy1 const& expand_policy1,
+                                   OverlapsPolicy1 const& overlaps_policy1,
+                                   ExpandPolicy2 const& expand_policy2,
+                                   OverlapsPolicy2 const& overlaps_policy2,
+                                   VisitBoxPolicy& box_policy,
+                                   sequential_execution const& execution)
+    {
+        return next_level_or_handle(lower_box, lower1, lower2, level,
+                                    min_elements, visitor, expand_policy1, overlaps_policy1,
+                                    expand_policy2, overlaps_policy2, box_policy,
+                                    execution)
+            && next_level_or_handle(upper_box, upper1, upper2, level,
+                                    min_elements, visitor, expand_policy1, overlaps_policy1,
+                                    expand_policy2, overlaps_policy2, box_policy,
+                                    execution);
+    }
+
+    template
+    <
+        typename IteratorVector1,
+        typename IteratorVector2,
+        typename VisitPolicy,
+        typename ExpandPolicy1,
+        typename OverlapsPolicy1,
+        typename ExpandPolicy2,
+        typename OverlapsPolicy2,
+        typename VisitBoxPolicy
+    >
+    static inline bool next_levels(Box const& lower_box,
+                                   IteratorVector1 const& lower1,
+                                   IteratorVector2 const& lower2,
+                                   Box const& upper_box,
+                                   IteratorVector1 const& upper1,
+                                   IteratorVector2 const& upper2,
+                                   std::size_t level, std::size_t min_elements,
+                                   VisitPolicy& visitor,
+                                   ExpandPolicy1 const& expand_policy1,
+                                   OverlapsPolicy1 const& overlaps_policy1,
+                                   ExpandPolicy2 const& expand_policy2,
+                                   OverlapsPolicy2 const& overlaps_policy2,
+                                   VisitBoxPolicy& box_policy,
+                                   parallel_execution const& execution)
+    {
+        // A thread is started only if the upper parts are going to be divided
+        if (execution.threads <= 1
+            || ! recurse_ok(upper1, upper2, min_elements, level))
+        {
+            return next_level_or_handle(lower_box, lower1, lower2, level,
+                                        min_elements, visitor, expand_policy1, overlaps_policy1,
+                                        expand_policy2, overlaps_policy2, box_policy,
+                                        execution)
+                && next_level_or_handle(upper_box, upper1, upper2, level,
+                                        min_elements, visitor, expand_policy1, overlaps_policy1,
+                                        expand_policy2, overlaps_policy2, box_policy,
+                                        execution);
+        }
+
+        typedef next_level_task
+            <
+                IteratorVector1, IteratorVector2,
+                ExpandPolicy1, OverlapsPolicy1,
+                ExpandPolicy2, OverlapsPolicy2,
+                VisitBoxPolicy
+            > task_type;
+
+        std::size_t const upper_threads = execution.threads / 2;
+        task_type const lower_task(lower_box, lower1, lower2, level, min_elements,
+                                   expand_policy1, overlaps_policy1,
+                                   expand_policy2, overlaps_policy2, box_policy,
+                                   execution.threads - upper_threads);
+        task_type const upper_task(upper_box, upper1, upper2, level, min_elements,
+                                   expand_policy1, overlaps_policy1,
+                                   expand_policy2, overlaps_policy2, box_policy,
+                                   upper_threads);
+
+        return apply_concurrently(lower_task, upper_task, visitor);
     }
 
     template <typename IteratorVector, typename ExpandPolicy>
@@ -419,7 +791,8 @@ public :
         typename OverlapsPolicy1,
         typename ExpandPolicy2,
         typename OverlapsPolicy2,
-        typename VisitBoxPolicy
+        typename VisitBoxPolicy,
+        typename Execution
     >
     static inline bool apply(Box const& box,
                              IteratorVector1 const& input1,
@@ -431,7 +804,8 @@ public :
                              OverlapsPolicy1 const& overlaps_policy1,
                              ExpandPolicy2 const& expand_policy2,
                              OverlapsPolicy2 const& overlaps_policy2,
-                             VisitBoxPolicy& box_policy)
+                             VisitBoxPolicy& box_policy,
+                             Execution const& execution)
     {
         box_policy.apply(box, level);
 
@@ -457,7 +831,8 @@ public :
                                                 expand_policy1, expand_policy2);
                 if (! next_level(exceeding_box, exceeding1, exceeding2, level,
                                  min_elements, visitor, expand_policy1, overlaps_policy1,
-                                 expand_policy2, overlaps_policy2, box_policy))
+                                 expand_policy2, overlaps_policy2, box_policy,
+                                 execution))
                 {
                     return false; // interrupt
                 }
@@ -479,10 +854,12 @@ public :
                 Box exceeding_box = get_new_box(exceeding1, expand_policy1);
                 if (! (next_level(exceeding_box, exceeding1, lower2, level,
                                   min_elements, visitor, expand_policy1, overlaps_policy1,
-                                  expand_policy2, overlaps_policy2, box_policy)
+                                  expand_policy2, overlaps_policy2, box_policy,
+                                  execution)
                     && next_level(exceeding_box, exceeding1, upper2, level,
                                   min_elements, visitor, expand_policy1, overlaps_policy1,
-                                  expand_policy2, overlaps_policy2, box_policy)) )
+                                  expand_policy2, overlaps_policy2, box_policy,
+                                  execution)) )
                 {
                     return false; // interrupt
                 }
@@ -505,10 +882,12 @@ public :
                 Box exceeding_box = get_new_box(exceeding2, expand_policy2);
                 if (! (next_level(exceeding_box, lower1, exceeding2, level,
                                   min_elements, visitor, expand_policy1, overlaps_policy1,
-                                  expand_policy2, overlaps_policy2, box_policy)
+                                  expand_policy2, overlaps_policy2, box_policy,
+                                  execution)
                     && next_level(exceeding_box, upper1, exceeding2, level,
                                   min_elements, visitor, expand_policy1, overlaps_policy1,
-                                  expand_policy2, overlaps_policy2, box_policy)) )
+                                  expand_policy2, overlaps_policy2, box_policy,
+                                  execution)) )
                 {
                     return false; // interrupt
                 }
@@ -523,41 +902,12 @@ public :
             }
         }
 
-        if (recurse_ok(lower1, lower2, min_elements, level))
-        {
-            if (! next_level(lower_box, lower1, lower2, level,
-                             min_elements, visitor, expand_policy1, overlaps_policy1,
-                             expand_policy2, overlaps_policy2, box_policy) )
-            {
-                return false; // interrupt
-            }
-        }
-        else
-        {
-            if (! handle_two(lower1, lower2, visitor))
-            {
-                return false; // interrupt
-            }
-        }
-
-        if (recurse_ok(upper1, upper2, min_elements, level))
-        {
-            if (! next_level(upper_box, upper1, upper2, level,
-                             min_elements, visitor, expand_policy1, overlaps_policy1,
-                             expand_policy2, overlaps_policy2, box_policy) )
-            {
-                return false; // interrupt
-            }
-        }
-        else
-        {
-            if (! handle_two(upper1, upper2, visitor))
-            {
-                return false; // interrupt
-            }
-        }
-
-        return true;
+        return next_levels(lower_box, lower1, lower2,
+                           upper_box, upper1, upper2,
+                           level, min_elements, visitor,
+                           expand_policy1, overlaps_policy1,
+                           expand_policy2, overlaps_policy2, box_policy,
+                           execution);
     }
 };
 
@@ -588,8 +938,6 @@ template
 >
 class partition
 {
-    static const std::size_t default_min_elements = 16;
-
     template
     <
         typename IncludePolicy,
@@ -615,7 +963,140 @@ class partition
         }
     }
 
+    template
+    <
+        typename ForwardRange,
+        typename VisitPolicy,
+        typename ExpandPolicy,
+        typename OverlapsPolicy,
+        typename VisitBoxPolicy,
+        typename Execution
+    >
+    static inline bool execute(ForwardRange const& forward_range,
+                               VisitPolicy& visitor,
+                               ExpandPolicy const& expand_policy,
+                               OverlapsPolicy const& overlaps_policy,
+                               std::size_t min_elements,
+                               VisitBoxPolicy& box_visitor,
+                               Execution const& execution)
+    {
+        typedef typename boost::range_iterator
+            <
+                ForwardRange const
+            >::type iterator_type;
+
+        if (std::size_t(boost::size(forward_range)) > min_elements)
+        {
+            std::vector<iterator_type> iterator_vector;
+            Box total;
+            assign_inverse(total);
+            expand_to_range<IncludePolicy1>(forward_range, total,
+                                            iterator_vector, expand_policy);
+
+            return detail::partition::partition_one_range
+                <
+                    0, Box
+                >::apply(total, iterator_vector, 0, min_elements,
+                         visitor, expand_policy, overlaps_policy, box_visitor,
+                         execution);
+        }
+        else
+        {
+            for(iterator_type it1 = boost::begin(forward_range);
+                it1 != boost::end(forward_range);
+                ++it1)
+            {
+                iterator_type it2 = it1;
+                for(++it2; it2 != boost::end(forward_range); ++it2)
+                {
+                    if (! visitor.apply(*it1, *it2))
+                    {
+                        return false; // interrupt
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+
+    template
+    <
+        typename ForwardRange1,
+        typename ForwardRange2,
+        typename VisitPolicy,
+        typename ExpandPolicy1,
+        typename OverlapsPolicy1,
+        typename ExpandPolicy2,
+        typename OverlapsPolicy2,
+        typename VisitBoxPolicy,
+        typename Execution
+    >
+    static inline bool execute(ForwardRange1 const& forward_range1,
+                               ForwardRange2 const& forward_range2,
+                               VisitPolicy& visitor,
+                               ExpandPolicy1 const& expand_policy1,
+                               OverlapsPolicy1 const& overlaps_policy1,
+                               ExpandPolicy2 const& expand_policy2,
+                               OverlapsPolicy2 const& overlaps_policy2,
+                               std::size_t min_elements,
+                               VisitBoxPolicy& box_visitor,
+                               Execution const& execution)
+    {
+        typedef typename boost::range_iterator
+            <
+                ForwardRange1 const
+            >::type iterator_type1;
+
+        typedef typename boost::range_iterator
+            <
+                ForwardRange2 const
+            >::type iterator_type2;
+
+        if (std::size_t(boost::size(forward_range1)) > min_elements
+            && std::size_t(boost::size(forward_range2)) > min_elements)
+        {
+            std::vector<iterator_type1> iterator_vector1;
+            std::vector<iterator_type2> iterator_vector2;
+            Box total;
+            assign_inverse(total);
+            expand_to_range<IncludePolicy1>(forward_range1, total,
+                                            iterator_vector1, expand_policy1);
+            expand_to_range<IncludePolicy2>(forward_range2, total,
+                                            iterator_vector2, expand_policy2);
+
+            return detail::partition::partition_two_ranges
+                <
+                    0, Box
+                >::apply(total, iterator_vector1, iterator_vector2,
+                         0, min_elements, visitor, expand_policy1,
+                         overlaps_policy1, expand_policy2, overlaps_policy2,
+                         box_visitor, execution);
+        }
+        else
+        {
+            for(iterator_type1 it1 = boost::begin(forward_range1);
+                it1 != boost::end(forward_range1);
+                ++it1)
+            {
+                for(iterator_type2 it2 = boost::begin(forward_range2);
+                    it2 != boost::end(forward_range2);
+                    ++it2)
+                {
+                    if (! visitor.apply(*it1, *it2))
+                    {
+                        return false; // interrupt
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+
 public:
+    static const std::size_t default_min_elements = 16;
+
     template
     <
         typename ForwardRange,
@@ -664,43 +1145,34 @@ public:
                              std::size_t min_elements,
                              VisitBoxPolicy box_visitor)
     {
-        typedef typename boost::range_iterator
-            <
-                ForwardRange const
-            >::type iterator_type;
-
-        if (std::size_t(boost::size(forward_range)) > min_elements)
-        {
-            std::vector<iterator_type> iterator_vector;
-            Box total;
-            assign_inverse(total);
-            expand_to_range<IncludePolicy1>(forward_range, total,
-                                            iterator_vector, expand_policy);
-
-            return detail::partition::partition_one_range
-                <
-                    0, Box
-                >::apply(total, iterator_vector, 0, min_elements,
-                         visitor, expand_policy, overlaps_policy, box_visitor);
-        }
-        else
-        {
-            for(iterator_type it1 = boost::begin(forward_range);
-                it1 != boost::end(forward_range);
-                ++it1)
-            {
-                iterator_type it2 = it1;
-                for(++it2; it2 != boost::end(forward_range); ++it2)
-                {
-                    if (! visitor.apply(*it1, *it2))
-                    {
-                        return false; // interrupt
-                    }
-                }
-            }
-        }
+        return execute(forward_range, visitor, expand_policy, overlaps_policy,
+                       min_elements, box_visitor,
+                       detail::partition::sequential_execution());
+    }
 
-        return true;
+    // The visitor has to define buffer_type, the constructor taking
+    // the visitor and the buffer and join() taking the buffer.
+    // If threads is 0 the number of hardware threads is used.
+    template
+    <
+        typename ForwardRange,
+        typename VisitPolicy,
+        typename ExpandPolicy,
+        typename OverlapsPolicy,
+        typename VisitBoxPolicy
+    >
+    static inline bool apply(ForwardRange const& forward_range,
+                             VisitPolicy& visitor,
+                             ExpandPolicy const& expand_policy,
+                             OverlapsPolicy const& overlaps_policy,
+                             std::size_t min_elements,
+                             VisitBoxPolicy box_visitor,
+                             std::size_t threads)
+    {
+        return execute(forward_range, visitor, expand_policy, overlaps_policy,
+                       min_elements, box_visitor,
+                       detail::partition::parallel_execution(
+                           geometry::detail::parallel::threads_count(threads)));
     }
 
     template
@@ -790,55 +1262,44 @@ public:
                              std::size_t min_elements,
                              VisitBoxPolicy box_visitor)
     {
-        typedef typename boost::range_iterator
-            <
-                ForwardRange1 const
-            >::type iterator_type1;
-
-        typedef typename boost::range_iterator
-            <
-                ForwardRange2 const
-            >::type iterator_type2;
-
-        if (std::size_t(boost::size(forward_range1)) > min_elements
-            && std::size_t(boost::size(forward_range2)) > min_elements)
-        {
-            std::vector<iterator_type1> iterator_vector1;
-            std::vector<iterator_type2> iterator_vector2;
-            Box total;
-            assign_inverse(total);
-            expand_to_range<IncludePolicy1>(forward_range1, total,
-                                            iterator_vector1, expand_policy1);
-            expand_to_range<IncludePolicy2>(forward_range2, total,
-                                            iterator_vector2, expand_policy2);
-
-            return detail::partition::partition_two_ranges
-                <
-                    0, Box
-                >::apply(total, iterator_vector1, iterator_vector2,
-                         0, min_elements, visitor, expand_policy1,
-                         overlaps_policy1, expand_policy2, overlaps_policy2,
-                         box_visitor);
-        }
-        else
-        {
-            for(iterator_type1 it1 = boost::begin(forward_range1);
-                it1 != boost::end(forward_range1);
-                ++it1)
-            {
-                for(iterator_type2 it2 = boost::begin(forward_range2);
-                    it2 != boost::end(forward_range2);
-                    ++it2)
-                {
-                    if (! visitor.apply(*it1, *it2))
-                    {
-                        return false; // interrupt
-                    }
-                }
-            }
-        }
+        return execute(forward_range1, forward_range2, visitor,
+                       expand_policy1, overlaps_policy1,
+                       expand_policy2, overlaps_policy2,
+                       min_elements, box_visitor,
+                       detail::partition::sequential_execution());
+    }
 
-        return true;
+    // The visitor has to define buffer_type, the constructor taking
+    // the visitor and the buffer and join() taking the buffer.
+    // If threads is 0 the number of hardware threads is used.
+    template
+    <
+        typename ForwardRange1,
+        typename ForwardRange2,
+        typename VisitPolicy,
+        typename ExpandPolicy1,
+        typename OverlapsPolicy1,
+        typename ExpandPolicy2,
+        typename OverlapsPolicy2,
+        typename VisitBoxPolicy
+    >
+    static inline bool apply(ForwardRange1 const& forward_range1,
+                             ForwardRange2 const& forward_range2,
+                             VisitPolicy& visitor,
+                             ExpandPolicy1 const& expand_policy1,
+                             OverlapsPolicy1 const& overlaps_policy1,
+                             ExpandPolicy2 const& expand_policy2,
+                             OverlapsPolicy2 const& overlaps_policy2,
+                             std::size_t min_elements,
+                             VisitBoxPolicy box_visitor,
+                             std::size_t threads)
+    {
+        return execute(forward_range1, forward_range2, visitor,
+                       expand_policy1, overlaps_policy1,
+                       expand_policy2, overlaps_policy2,
+                       min_elements, box_visitor,
+                       detail::partition::parallel_execution(
+                           geometry::detail::parallel::threads_count(threads)));
     }
 };
 
@@ -0,0 +1,185 @@
+// Boost.Geometry Index
+//
+// R-tree native binary serialization
+//
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_BINARY_HPP
+#define BOOST_GEOMETRY_INDEX_BINARY_HPP
+
+#include <istream>
+#include <ostream>
+
+#include <boost/geometry/index/rtree.hpp>
+#include <boost/geometry/index/detail/rtree/binary.hpp>
+#include <boost/geometry/index/detail/rtree/private_view.hpp>
+
+namespace boost { namespace geometry { namespace index {
+
+/*!
+\brief Writes the rtree to the stream in the native binary format.
+
+The structure of the tree is written as it is, the elements of each node are written
+at once as raw bytes. The data may be read with load_binary() into the rtree having
+the same Value and Box types and compatible parameters. The data is written in the native
+representation of the platform so it may only be read on the same platform.
+
+\ingroup rtree_functions
+
+\par Example
+\verbatim
+std::ofstream file("tree.bin", std::ios::binary);
+bgi::save_binary(tree, file);
+\endverbatim
+
+\param tree The spatial index.
+\param os   The output stream. The stream should be opened in binary mode.
+
+\par Throws
+\li If allocation throws.
+\li std::runtime_error if the data can't be written.
+
+\warning
+The Value must be trivially copyable because it is stored as raw bytes.
+*/
+template <typename Value, typename Parameters, typename IndexableGetter, typename EqualTo, typename Allocator>
+inline void save_binary(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> const& tree,
+                        std::ostream & os)
+{
+    typedef rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> rtree_type;
+    typedef detail::rtree::const_private_view<rtree_type> view_type;
+    typedef typename view_type::box_type box_type;
+    typedef detail::rtree::binary::visitors::save
+        <
+            typename view_type::value_type,
+            typename view_type::options_type,
+            box_type,
+            typename view_type::allocators_type
+        > save_type;
+
+    view_type view(tree);
+
+    detail::rtree::binary::header h;
+    detail::rtree::binary::fill_header<Value, box_type>(h);
+    h.max_elements = view.members().parameters().get_max_elements();
+    h.min_elements = view.members().parameters().get_min_elements();
+    h.values_count = view.members().values_count;
+    h.leafs_level = view.members().leafs_level;
+
+    detail::rtree::binary::write_raw(os, &h, 1);
+
+    if ( view.members().values_count != 0 )
+    {
+        save_type save_v(os, view.members().parameters().get_max_elements());
+        detail::rtree::apply_visitor(save_v, *view.members().root);
+    }
+
+    if ( ! os )
+        detail::throw_runtime_error("unable to write the rtree data");
+}
+
+/*!
+\brief Reads the rtree written by save_binary() from the stream.
+
+The structure of the tree is restored exactly, the Values aren't inserted and no
+rebalancing is done. The Value and Box types must be the same as the ones of the saved
+tree. The maximum number of elements of the saved tree can't be greater and the minimum
+can't be lower than the ones of the loaded tree. The previous content of the tree is destroyed.
+
+\ingroup rtree_functions
+
+\par Example
+\verbatim
+std::ifstream file("tree.bin", std::ios::binary);
+bgi::load_binary(tree, file);
+\endverbatim
+
+\param tree The spatial index.
+\param is   The input stream. The stream should be opened in binary mode.
+
+\par Throws
+\li If allocation throws or returns invalid value.
+\li std::runtime_error if the data can't be read, was written for different types
+    or incompatible parameters or is corrupted.
+
+\par Exception-safety
+strong
+
+\warning
+The Value must be trivially copyable because it is stored as raw bytes.
+*/
+template <typename Value, typename Parameters, typename IndexableGetter, typename EqualTo, typename Allocator>
+inline void load_binary(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> & tree,
+                        std::istream & is)
+{
+    typedef rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> rtree_type;
+    typedef detail::rtree::private_view<rtree_type> view_type;
+    typedef typename view_type::box_type box_type;
+    typedef typename view_type::size_type size_type;
+    typedef typename view_type::allocators_type allocators_type;
+    typedef detail::rtree::binary::load
+        <
+            typename view_type::value_type,
+            typename view_type::options_type,
+            typename view_type::translator_type,
+            box_type,
+            allocators_type
+        > load_type;
+    typedef detail::rtree::subtree_destroyer
+        <
+            typename view_type::value_type,
+            typename view_type::options_type,
+            typename view_type::translator_type,
+            box_type,
+            allocators_type
+        > subtree_destroyer;
+
+    view_type view(tree);
+
+    detail::rtree::binary::header expected;
+    detail::rtree::binary::fill_header<Value, box_type>(expected);
+
+    detail::rtree::binary::header h;
+    detail::rtree::binary::read_raw(is, &h, 1);                                                         // MAY THROW (F)
+
+    if ( ! detail::rtree::binary::is_magic_ok(h) || h.version != expected.version )
+        detail::throw_runtime_error("unrecognized format of the rtree data");
+    if ( h.byte_order != expected.byte_order )
+        detail::throw_runtime_error("the rtree data was written using different byte order");
+    if ( h.dimension != expected.dimension
+      || h.coordinate_size != expected.coordinate_size
+      || h.box_size != expected.box_size
+      || h.value_size != expected.value_size )
+        detail::throw_runtime_error("the rtree data was written for different Value or Box type");
+    if ( view.members().parameters().get_max_elements() < h.max_elements
+      || h.min_elements < view.members().parameters().get_min_elements() )
+        detail::throw_runtime_error("the rtree data was written for incompatible parameters");
+    // the depth of a tree can't be greater than the number of bits of the number of values
+    if ( ( h.values_count == 0 && h.leafs_level != 0 ) || 64 <= h.leafs_level )
+        detail::throw_runtime_error("the rtree data is corrupted");
+
+    if ( h.values_count == 0 )
+    {
+        tree.clear();
+        return;
+    }
+
+    size_type const leafs_level = static_cast<size_type>(h.leafs_level);
+    load_type load_v(is, leafs_level, view.members().parameters(), view.members().allocators());     // MAY THROW (A)
+    typename allocators_type::node_pointer root = load_v.apply();                                     // MAY THROW (A, C, F)
+    subtree_destroyer auto_remover(root, view.members().allocators());
+
+    if ( load_v.values_count() != h.values_count )
+        detail::throw_runtime_error("the rtree data is corrupted");
+
+    auto_remover.release();
+    detail::rtree::replace_content(tree, root, load_v.values_count(), leafs_level);
+}
+
+}}} // namespace boost::geometry::index
+
+#endif // BOOST_GEOMETRY_INDEX_BINARY_HPP
@@ -0,0 +1,189 @@
+// Boost.Geometry Index
+//
+// Geometry with cached envelope
+//
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_CACHED_ENVELOPE_HPP
+#define BOOST_GEOMETRY_INDEX_CACHED_ENVELOPE_HPP
+
+#include <utility>
+
+#include <boost/config.hpp>
+#include <boost/move/utility_core.hpp>
+
+#include <boost/geometry/algorithms/envelope.hpp>
+#include <boost/geometry/core/point_type.hpp>
+#include <boost/geometry/geometries/box.hpp>
+
+#include <boost/geometry/index/equal_to.hpp>
+#include <boost/geometry/index/indexable.hpp>
+
+namespace boost { namespace geometry { namespace index {
+
+/*!
+\brief The Value storing a Geometry together with its envelope.
+
+The envelope is calculated once when the object is created and stored next to the
+Geometry. The rtree storing objects of this type uses the cached envelope as the
+Indexable so Geometries of any kind, e.g. Polygons or Linestrings, may be stored
+directly and their envelopes are never recalculated during insertion, splitting,
+reinsertion or queries. Since the Geometry can't be modified the envelope is always
+valid. It may also be stored as the first member of std::pair<cached_envelope<...>, T>.
+
+Values are compared with geometry::equals() called for the Geometries.
+
+\par Example
+\verbatim
+typedef bgi::cached_envelope<Polygon> value_type;
+bgi::rtree<value_type, bgi::rstar<16> > rt;
+rt.insert(value_type(polygon));
+\endverbatim
+
+\tparam Geometry    The type of the stored Geometry.
+\tparam Box         The type of the envelope.
+*/
+template <typename Geometry,
+          typename Box = geometry::model::box<typename geometry::point_type<Geometry>::type> >
+class cached_envelope
+{
+public:
+    /*! \brief The type of the stored Geometry. */
+    typedef Geometry geometry_type;
+    /*! \brief The type of the envelope. */
+    typedef Box box_type;
+
+    /*!
+    \brief The constructor, creates an object storing default-constructed Geometry.
+    */
+    cached_envelope()
+    {
+        geometry::envelope(m_geometry, m_envelope);
+    }
+
+    /*!
+    \brief The constructor, copies the Geometry and calculates its envelope.
+
+    \param g    The Geometry.
+    */
+    explicit cached_envelope(Geometry const& g)
+        : m_geometry(g)
+    {
+        geometry::envelope(m_geometry, m_envelope);
+    }
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    /*!
+    \brief The constructor, moves the Geometry and calculates its envelope.
+
+    \param g    The Geometry.
+    */
+    explicit cached_envelope(Geometry && g)
+        : m_geometry(boost::move(g))
+    {
+        geometry::envelope(m_geometry, m_envelope);
+    }
+#endif
+
+    /*!
+    \brief Returns the stored Geometry.
+
+    \return     The Geometry.
+    */
+    Geometry const& geometry() const
+    {
+        return m_geometry;
+    }
+
+    /*!
+    \brief Returns the cached envelope of the stored Geometry.
+
+    \return     The envelope.
+    */
+    Box const& envelope() const
+    {
+        return m_envelope;
+    }
+
+private:
+    Box m_envelope;
+    Geometry m_geometry;
+};
+
+namespace detail {
+
+/*!
+\brief The function object extracting Indexable from Value.
+
+This specialization returns the envelope cached in cached_envelope<Geometry, Box>.
+
+\tparam Geometry    The type of the stored Geometry.
+\tparam Box         The type of the envelope.
+*/
+template <typename Geometry, typename Box>
+struct indexable<index::cached_envelope<Geometry, Box>, false>
+{
+    /*! \brief The type of result returned by function object. */
+    typedef Box const& result_type;
+
+    /*!
+    \brief Return indexable extracted from the value.
+
+    \param v The value.
+    \return The indexable.
+    */
+    inline result_type operator()(index::cached_envelope<Geometry, Box> const& v) const
+    {
+        return v.envelope();
+    }
+};
+
+/*!
+\brief The function object extracting Indexable from Value.
+
+This specialization returns the envelope cached in the first member of
+std::pair<cached_envelope<Geometry, Box>, T2>.
+
+\tparam Geometry    The type of the stored Geometry.
+\tparam Box         The type of the envelope.
+\tparam T2          The second type.
+*/
+template <typename Geometry, typename Box, typename T2>
+struct indexable<std::pair<index::cached_envelope<Geometry, Box>, T2>, false>
+{
+    /*! \brief The type of result returned by function object. */
+    typedef Box const& result_type;
+
+    /*!
+    \brief Return indexable extracted from the value.
+
+    \param v The value.
+    \return The indexable.
+    */
+    inline result_type operator()(std::pair<index::cached_envelope<Geometry, Box>, T2> const& v) const
+    {
+        return v.first.envelope();
+    }
+};
+
+template <typename Geometry, typename Box>
+struct equals<index::cached_envelope<Geometry, Box>, void>
+{
+    inline static bool apply(index::cached_envelope<Geometry, Box> const& v1,
+                             index::cached_envelope<Geometry, Box> const& v2)
+    {
+        // spatially equal Geometries have equal envelopes
+        return equals<Box>::apply(v1.envelope(), v2.envelope())
+            && equals<Geometry>::apply(v1.geometry(), v2.geometry());
+    }
+};
+
+} // namespace detail
+
+}}} // namespace boost::geometry::index
+
+#endif // BOOST_GEOMETRY_INDEX_CACHED_ENVELOPE_HPP
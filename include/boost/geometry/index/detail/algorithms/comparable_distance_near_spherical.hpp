@@ -0,0 +1,110 @@
+// Boost.Geometry Index
+//
+// comparable distance between point and nearest point of the box on a sphere
+//
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_ALGORITHMS_COMPARABLE_DISTANCE_NEAR_SPHERICAL_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_ALGORITHMS_COMPARABLE_DISTANCE_NEAR_SPHERICAL_HPP
+
+#include <cmath>
+
+#include <boost/geometry/core/access.hpp>
+#include <boost/geometry/core/radian_access.hpp>
+#include <boost/geometry/strategies/default_comparable_distance_result.hpp>
+#include <boost/geometry/util/math.hpp>
+
+namespace boost { namespace geometry { namespace index { namespace detail {
+
+// The comparable distance between a point and a meridian segment, i.e. hav()
+// of the angle. The segment lies in the distance dlon in [0, pi] from the point
+// and spans from lat_min to lat_max.
+template <typename T>
+inline T comparable_distance_meridian_segment(T const& lat, T const& dlon, T const& lat_min, T const& lat_max)
+{
+    T const cos_lat = cos(lat);
+    T const hav_dlon = math::hav(dlon);
+    // f(t) = sin(lat) * sin(t) + cos(lat) * cos(dlon) * cos(t) is the cosine of the
+    // angle between the point and the point of the meridian at latitude t,
+    // it has the maximum at atan2(sin(lat), cos(lat) * cos(dlon))
+    T const a = sin(lat);
+    T const b = cos_lat * cos(dlon);
+
+    if ( b > 0 )
+    {
+        T const sin_min = sin(lat_min);
+        T const cos_min = cos(lat_min);
+        if ( a * cos_min <= b * sin_min )
+            return math::hav(lat - lat_min) + cos_lat * cos_min * hav_dlon;
+
+        T const sin_max = sin(lat_max);
+        T const cos_max = cos(lat_max);
+        if ( a * cos_max >= b * sin_max )
+            return math::hav(lat - lat_max) + cos_lat * cos_max * hav_dlon;
+
+        // the closest point is inside the segment, the angle x to the great circle
+        // of the meridian is given by sin(x) = cos(lat) * sin(dlon),
+        // hav(x) = (1 - cos(x)) / 2 = sin(x)^2 / (2 * (1 + cos(x)))
+        T const s = cos_lat * sin(dlon);
+        T const s2 = s * s;
+        return s2 / (T(2) * (T(1) + math::sqrt(T(1) - s2)));
+    }
+
+    // f is monotonic in [-pi/2, pi/2] so the closest point is one of the endpoints
+    T const d_min = math::hav(lat - lat_min) + cos_lat * cos(lat_min) * hav_dlon;
+    T const d_max = math::hav(lat - lat_max) + cos_lat * cos(lat_max) * hav_dlon;
+    return (std::min)(d_min, d_max);
+}
+
+// Returns the comparable distance between the point and the nearest point of the box
+// in spherical equatorial coordinate system, i.e. hav() of the angle, the same as
+// the comparable distances calculated by the default haversine and cross track
+// strategies. The coordinates don't have to be normalized, the box may cross the
+// antimeridian. Contrary to the cross track strategy the courses are not calculated.
+template <typename Point, typename Box>
+inline typename geometry::default_comparable_distance_result<Point, Box>::type
+comparable_distance_near_spherical(Point const& pt, Box const& b)
+{
+    typedef typename geometry::default_comparable_distance_result<Point, Box>::type result_type;
+
+    result_type const two_pi = math::two_pi<result_type>();
+
+    result_type const lon = geometry::get_as_radian<0>(pt);
+    result_type const lat = geometry::get_as_radian<1>(pt);
+    result_type const lon_min = geometry::get_as_radian<geometry::min_corner, 0>(b);
+    result_type const lat_min = geometry::get_as_radian<geometry::min_corner, 1>(b);
+    result_type const lon_max = geometry::get_as_radian<geometry::max_corner, 0>(b);
+    result_type const lat_max = geometry::get_as_radian<geometry::max_corner, 1>(b);
+
+    // the longitude of the point east of the western meridian of the box in [0, 2pi)
+    result_type dlon = std::fmod(lon - lon_min, two_pi);
+    if ( dlon < 0 )
+        dlon += two_pi;
+
+    result_type const width = lon_max - lon_min;
+
+    // the point is in the band of longitudes of the box
+    if ( dlon <= width )
+    {
+        if ( lat > lat_max )
+            return math::hav(lat - lat_max);
+        else if ( lat < lat_min )
+            return math::hav(lat_min - lat);
+        else
+            return 0;
+    }
+
+    // the angle to the closer meridian of the box
+    result_type const dlon_east = dlon - width;
+    result_type const dlon_west = two_pi - dlon;
+
+    return comparable_distance_meridian_segment(lat, (std::min)(dlon_east, dlon_west), lat_min, lat_max);
+}
+
+}}}} // namespace boost::geometry::index::detail
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_ALGORITHMS_COMPARABLE_DISTANCE_NEAR_SPHERICAL_HPP
@@ -0,0 +1,134 @@
+// Boost.Geometry Index
+//
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_ALGORITHMS_RADIX_SORT_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_ALGORITHMS_RADIX_SORT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/is_integral.hpp>
+#include <boost/type_traits/is_unsigned.hpp>
+
+#include <boost/geometry/util/parallel.hpp>
+
+namespace boost { namespace geometry { namespace index { namespace detail {
+
+namespace radix_sort_detail {
+
+static const std::size_t radix_bits = 8;
+static const std::size_t radix_size = 1 << radix_bits;
+
+template <typename Key, typename T>
+struct histogram_task
+{
+    typedef std::vector<std::pair<Key, T> > container;
+
+    histogram_task(container const& v, std::size_t s, std::vector<std::size_t> & h)
+        : values(v), shift(s), histograms(h)
+    {}
+
+    void operator()(std::size_t first, std::size_t last, std::size_t chunk_index)
+    {
+        std::size_t * h = &histograms[chunk_index * radix_size];
+        for ( std::size_t i = first ; i < last ; ++i )
+            ++h[(values[i].first >> shift) & (radix_size - 1)];
+    }
+
+    container const& values;
+    std::size_t shift;
+    std::vector<std::size_t> & histograms;
+};
+
+template <typename Key, typename T>
+struct scatter_task
+{
+    typedef std::vector<std::pair<Key, T> > container;
+
+    scatter_task(container const& v, container & b, std::size_t s, std::vector<std::size_t> & o)
+        : values(v), buffer(b), shift(s), offsets(o)
+    {}
+
+    void operator()(std::size_t first, std::size_t last, std::size_t chunk_index)
+    {
+        std::size_t * o = &offsets[chunk_index * radix_size];
+        for ( std::size_t i = first ; i < last ; ++i )
+            buffer[o[(values[i].first >> shift) & (radix_size - 1)]++] = values[i];
+    }
+
+    container const& values;
+    container & buffer;
+    std::size_t shift;
+    std::vector<std::size_t> & offsets;
+};
+
+} // namespace radix_sort_detail
+
+// Stable LSD radix sort of pairs WRT the first member being an unsigned integer.
+// In each pass the elements are divided into contiguous chunks, one per thread.
+// The histograms of the chunks are calculated concurrently and then the elements
+// are scattered concurrently into disjoint parts of the buffer. The passes in which
+// all keys have the same digit are skipped.
+template <typename Key, typename T>
+inline void radix_sort(std::vector<std::pair<Key, T> > & values, std::size_t threads = 1)
+{
+    BOOST_STATIC_ASSERT((boost::is_integral<Key>::value && boost::is_unsigned<Key>::value));
+
+    namespace rsd = radix_sort_detail;
+    typedef std::vector<std::pair<Key, T> > container;
+
+    std::size_t const count = values.size();
+    if ( count < 2 )
+        return;
+
+    if ( threads < 1 )
+        threads = 1;
+    if ( threads > count )
+        threads = count;
+
+    container buffer(count);
+    std::vector<std::size_t> histograms(threads * rsd::radix_size);
+
+    for ( std::size_t shift = 0 ; shift < sizeof(Key) * 8 ; shift += rsd::radix_bits )
+    {
+        std::fill(histograms.begin(), histograms.end(), 0);
+        rsd::histogram_task<Key, T> histogram_t(values, shift, histograms);
+        geometry::detail::parallel::for_each_chunk(count, threads, histogram_t);
+
+        // the position of the first element of each digit in each chunk
+        bool single_digit = false;
+        std::size_t offset = 0;
+        for ( std::size_t d = 0 ; d < rsd::radix_size ; ++d )
+        {
+            std::size_t const digit_first = offset;
+            for ( std::size_t c = 0 ; c < threads ; ++c )
+            {
+                std::size_t const n = histograms[c * rsd::radix_size + d];
+                histograms[c * rsd::radix_size + d] = offset;
+                offset += n;
+            }
+            if ( offset - digit_first == count )
+                single_digit = true;
+        }
+
+        if ( single_digit )
+            continue;
+
+        rsd::scatter_task<Key, T> scatter_t(values, buffer, shift, histograms);
+        geometry::detail::parallel::for_each_chunk(count, threads, scatter_t);
+
+        values.swap(buffer);
+    }
+}
+
+}}}} // namespace boost::geometry::index::detail
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_ALGORITHMS_RADIX_SORT_HPP
@@ -13,6 +13,7 @@
 #define BOOST_GEOMETRY_INDEX_DETAIL_DISTANCE_PREDICATES_HPP
 
 #include <boost/geometry/index/detail/algorithms/comparable_distance_near.hpp>
+#include <boost/geometry/index/detail/algorithms/comparable_distance_near_spherical.hpp>
 #include <boost/geometry/index/detail/algorithms/comparable_distance_far.hpp>
 #include <boost/geometry/index/detail/algorithms/comparable_distance_centroid.hpp>
 #include <boost/geometry/index/detail/algorithms/path_intersection.hpp>
@@ -117,6 +118,47 @@ struct calculate_distance< predicates::nearest<PointRelation>, Indexable, Tag >
     }
 };
 
+// In spherical equatorial coordinate system the distance between the point and the
+// node's box is calculated directly, without the point-segment strategy.
+template <typename Point, typename Box,
+          typename PointTag = typename geometry::tag<Point>::type,
+          typename CSTag = typename geometry::cs_tag<Point>::type>
+struct comparable_distance_bounds
+{
+    typedef typename geometry::default_comparable_distance_result<Point, Box>::type result_type;
+
+    static inline result_type apply(Point const& pt, Box const& b)
+    {
+        return geometry::comparable_distance(pt, b);
+    }
+};
+
+template <typename Point, typename Box>
+struct comparable_distance_bounds<Point, Box, point_tag, spherical_equatorial_tag>
+{
+    typedef typename geometry::default_comparable_distance_result<Point, Box>::type result_type;
+
+    static inline result_type apply(Point const& pt, Box const& b)
+    {
+        return index::detail::comparable_distance_near_spherical(pt, b);
+    }
+};
+
+template <typename PointRelation, typename Box>
+struct calculate_distance< predicates::nearest<PointRelation>, Box, bounds_tag >
+{
+    typedef detail::relation<PointRelation> relation;
+    typedef typename relation::value_type point_type;
+    typedef comparable_distance_bounds<point_type, Box> comparable_distance;
+    typedef typename comparable_distance::result_type result_type;
+
+    static inline bool apply(predicates::nearest<PointRelation> const& p, Box const& b, result_type & result)
+    {
+        result = comparable_distance::apply(relation::value(p.point_or_relation), b);
+        return true;
+    }
+};
+
 template <typename Point, typename Indexable>
 struct calculate_distance< predicates::nearest< to_centroid<Point> >, Indexable, value_tag>
 {
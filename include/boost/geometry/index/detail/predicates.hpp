@@ -16,6 +16,10 @@
 #include <boost/mpl/assert.hpp>
 #include <boost/tuple/tuple.hpp>
 
+#include <boost/geometry/core/cs.hpp>
+
+#include <boost/geometry/index/detail/algorithms/comparable_distance_far.hpp>
+#include <boost/geometry/index/detail/algorithms/comparable_distance_near.hpp>
 #include <boost/geometry/index/detail/tags.hpp>
 
 namespace boost { namespace geometry { namespace index { namespace detail {
@@ -67,6 +71,8 @@ struct within_tag {};
 template <typename Geometry, typename Tag, bool Negated>
 struct spatial_predicate
 {
+    typedef Geometry geometry_type;
+
     spatial_predicate() {}
     spatial_predicate(Geometry const& g) : geometry(g) {}
     Geometry geometry;
@@ -108,6 +114,20 @@ struct path
     unsigned count;
 };
 
+// ------------------------------------------------------------------ //
+
+template <typename Point, typename Distance>
+struct within_distance
+{
+    within_distance() {}
+    within_distance(Point const& pt, Distance const& d)
+        : point(pt)
+        , distance(d)
+    {}
+    Point point;
+    Distance distance;
+};
+
 } // namespace predicates
 
 // ------------------------------------------------------------------ //
@@ -475,6 +495,217 @@ struct predicate_check<predicates::path<Linestring>, bounds_tag>
     }
 };
 
+// ------------------------------------------------------------------ //
+// predicates_check for bounds covering values
+// ------------------------------------------------------------------ //
+
+// Returns true if all values which indexables are covered by the bounds
+// meet the predicate and false if it's not known.
+
+// value_tag        covered_bounds_tag
+// ---------------------------------------------
+// covered_by(I,G)  covered_by(B,G) if G is a Box
+// disjoint(I,G)    disjoint(B,G)
+// intersects(I,G)  covered_by(B,G) if G is a Box
+// !disjoint(I,G)   covered_by(B,G) if G is a Box
+// !intersects(I,G) disjoint(B,G)
+// other            FALSE
+
+template <typename Geometry, typename GeometryTag = typename geometry::tag<Geometry>::type>
+struct bounds_covered_by_geometry
+{
+    template <typename Box>
+    static inline bool apply(Box const&, Geometry const&)
+    {
+        return false;
+    }
+};
+
+template <typename Geometry>
+struct bounds_covered_by_geometry<Geometry, geometry::box_tag>
+{
+    template <typename Box>
+    static inline bool apply(Box const& b, Geometry const& g)
+    {
+        return geometry::covered_by(b, g);
+    }
+};
+
+// default
+template <typename Predicate>
+struct predicate_check<Predicate, covered_bounds_tag>
+{
+    template <typename Value, typename Box>
+    static inline bool apply(Predicate const&, Value const&, Box const&)
+    {
+        return false;
+    }
+};
+
+template <typename Geometry>
+struct predicate_check<predicates::spatial_predicate<Geometry, predicates::covered_by_tag, false>, covered_bounds_tag>
+{
+    typedef predicates::spatial_predicate<Geometry, predicates::covered_by_tag, false> Pred;
+
+    template <typename Value, typename Box>
+    static inline bool apply(Pred const& p, Value const&, Box const& b)
+    {
+        return bounds_covered_by_geometry<Geometry>::apply(b, p.geometry);
+    }
+};
+
+template <typename Geometry>
+struct predicate_check<predicates::spatial_predicate<Geometry, predicates::disjoint_tag, false>, covered_bounds_tag>
+{
+    typedef predicates::spatial_predicate<Geometry, predicates::disjoint_tag, false> Pred;
+
+    template <typename Value, typename Box>
+    static inline bool apply(Pred const& p, Value const&, Box const& b)
+    {
+        return spatial_predicate_call<predicates::disjoint_tag>::apply(b, p.geometry);
+    }
+};
+
+template <typename Geometry>
+struct predicate_check<predicates::spatial_predicate<Geometry, predicates::intersects_tag, false>, covered_bounds_tag>
+{
+    typedef predicates::spatial_predicate<Geometry, predicates::intersects_tag, false> Pred;
+
+    template <typename Value, typename Box>
+    static inline bool apply(Pred const& p, Value const&, Box const& b)
+    {
+        return bounds_covered_by_geometry<Geometry>::apply(b, p.geometry);
+    }
+};
+
+template <typename Geometry>
+struct predicate_check<predicates::spatial_predicate<Geometry, predicates::disjoint_tag, true>, covered_bounds_tag>
+{
+    typedef predicates::spatial_predicate<Geometry, predicates::disjoint_tag, true> Pred;
+
+    template <typename Value, typename Box>
+    static inline bool apply(Pred const& p, Value const&, Box const& b)
+    {
+        return bounds_covered_by_geometry<Geometry>::apply(b, p.geometry);
+    }
+};
+
+template <typename Geometry>
+struct predicate_check<predicates::spatial_predicate<Geometry, predicates::intersects_tag, true>, covered_bounds_tag>
+{
+    typedef predicates::spatial_predicate<Geometry, predicates::intersects_tag, true> Pred;
+
+    template <typename Value, typename Box>
+    static inline bool apply(Pred const& p, Value const&, Box const& b)
+    {
+        return spatial_predicate_call<predicates::disjoint_tag>::apply(b, p.geometry);
+    }
+};
+
+// ------------------------------------------------------------------ //
+// predicate_check for within_distance
+// ------------------------------------------------------------------ //
+
+// In the cartesian coordinate system the comparable distances, i.e. squared
+// distances, are compared with the squared maximum distance. The nodes are
+// checked with the distance to the nearest point of the box and whole subtrees
+// are returned if the furthest point of the box is close enough. In other
+// coordinate systems the distances are calculated with default strategies.
+
+template <typename CSTag>
+struct within_distance_call
+{
+    template <typename Point, typename Indexable, typename Distance>
+    static inline bool value(Point const& pt, Indexable const& i, Distance const& d)
+    {
+        return geometry::distance(pt, i) <= d;
+    }
+
+    template <typename Point, typename Box, typename Distance>
+    static inline bool bounds(Point const& pt, Box const& b, Distance const& d)
+    {
+        return geometry::distance(pt, b) <= d;
+    }
+
+    template <typename Point, typename Box, typename Distance>
+    static inline bool covered_bounds(Point const&, Box const&, Distance const&)
+    {
+        return false;
+    }
+};
+
+template <>
+struct within_distance_call<geometry::cartesian_tag>
+{
+    template <typename Point, typename Indexable, typename Distance>
+    static inline bool value(Point const& pt, Indexable const& i, Distance const& d)
+    {
+        typedef typename geometry::default_comparable_distance_result<Point, Indexable>::type result_type;
+        return geometry::comparable_distance(pt, i) <= squared<result_type>(d);
+    }
+
+    template <typename Point, typename Box, typename Distance>
+    static inline bool bounds(Point const& pt, Box const& b, Distance const& d)
+    {
+        typedef typename geometry::default_comparable_distance_result<Point, Box>::type result_type;
+        return comparable_distance_near(pt, b) <= squared<result_type>(d);
+    }
+
+    template <typename Point, typename Box, typename Distance>
+    static inline bool covered_bounds(Point const& pt, Box const& b, Distance const& d)
+    {
+        typedef typename geometry::default_comparable_distance_result<Point, Box>::type result_type;
+        return comparable_distance_far(pt, b) <= squared<result_type>(d);
+    }
+
+private:
+    template <typename Result, typename Distance>
+    static inline Result squared(Distance const& d)
+    {
+        Result const r = d;
+        return r * r;
+    }
+};
+
+template <typename Point, typename Distance>
+struct predicate_check<predicates::within_distance<Point, Distance>, value_tag>
+{
+    typedef predicates::within_distance<Point, Distance> Pred;
+    typedef within_distance_call<typename geometry::cs_tag<Point>::type> call;
+
+    template <typename Value, typename Indexable>
+    static inline bool apply(Pred const& p, Value const&, Indexable const& i)
+    {
+        return call::value(p.point, i, p.distance);
+    }
+};
+
+template <typename Point, typename Distance>
+struct predicate_check<predicates::within_distance<Point, Distance>, bounds_tag>
+{
+    typedef predicates::within_distance<Point, Distance> Pred;
+    typedef within_distance_call<typename geometry::cs_tag<Point>::type> call;
+
+    template <typename Value, typename Box>
+    static inline bool apply(Pred const& p, Value const&, Box const& b)
+    {
+        return call::bounds(p.point, b, p.distance);
+    }
+};
+
+template <typename Point, typename Distance>
+struct predicate_check<predicates::within_distance<Point, Distance>, covered_bounds_tag>
+{
+    typedef predicates::within_distance<Point, Distance> Pred;
+    typedef within_distance_call<typename geometry::cs_tag<Point>::type> call;
+
+    template <typename Value, typename Box>
+    static inline bool apply(Pred const& p, Value const&, Box const& b)
+    {
+        return call::covered_bounds(p.point, b, p.distance);
+    }
+};
+
 // ------------------------------------------------------------------ //
 // predicates_length
 // ------------------------------------------------------------------ //
@@ -0,0 +1,190 @@
+// Boost.Geometry Index
+//
+// R-tree batch query
+//
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_BATCH_QUERY_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_BATCH_QUERY_HPP
+
+#include <iterator>
+#include <vector>
+
+#include <boost/mpl/bool.hpp>
+#include <boost/mpl/if.hpp>
+
+#include <boost/geometry/util/parallel.hpp>
+
+namespace boost { namespace geometry { namespace index { namespace detail { namespace rtree {
+
+// Performs a number of queries defined by a random access range of Predicates.
+// The queries are divided into contiguous chunks, one chunk per thread.
+// Spatial queries from one chunk are performed during a single traversal
+// of the tree (see visitors::spatial_query_batch) so the nodes hit by more than
+// one query are visited only once. Distance queries are performed one by one.
+// The results of each query are the same and are returned in the same order
+// as if the query was performed with rtree::query().
+template <typename Value, typename Options, typename Translator, typename Box, typename Allocators, typename PredicatesIterator>
+class batch_query
+{
+    typedef typename Options::parameters_type parameters_type;
+    typedef typename Allocators::node_pointer node_pointer;
+    typedef typename Allocators::size_type size_type;
+
+    typedef typename std::iterator_traits<PredicatesIterator>::value_type predicates_type;
+
+    static const unsigned distance_predicates_count = index::detail::predicates_count_distance<predicates_type>::value;
+    static const bool is_distance_query = 0 < distance_predicates_count;
+    BOOST_MPL_ASSERT_MSG((distance_predicates_count <= 1), PASS_ONLY_ONE_DISTANCE_PREDICATE, (predicates_type));
+
+    typedef visitors::spatial_query_batch
+        <
+            Value, Options, Translator, Box, Allocators, PredicatesIterator
+        > spatial_visitor_type;
+
+    // distance queries store copies of values, spatial queries pointers to values in the tree
+    typedef typename boost::mpl::if_c
+        <
+            is_distance_query,
+            std::vector<Value>,
+            std::vector<const Value *>
+        >::type chunk_values_type;
+
+    struct chunk_result
+    {
+        std::vector<size_type> counts;
+        chunk_values_type values;
+    };
+
+    struct chunk_query
+    {
+        chunk_query(node_pointer r, parameters_type const& p, Translator const& t,
+                    PredicatesIterator f, std::vector<chunk_result> & c)
+            : root(r), parameters(p), translator(t), first(f), chunks(c)
+        {}
+
+        void operator()(std::size_t f, std::size_t l, std::size_t chunk_index)
+        {
+            batch_query::apply_chunk(root, parameters, translator,
+                                     first + f, static_cast<size_type>(l - f),
+                                     chunks[chunk_index],
+                                     boost::mpl::bool_<is_distance_query>());
+        }
+
+        node_pointer root;
+        parameters_type const& parameters;
+        Translator const& translator;
+        PredicatesIterator first;
+        std::vector<chunk_result> & chunks;
+    };
+
+public:
+    template <typename OutIter, typename OffsetsOutIter>
+    static inline size_type apply(node_pointer root, parameters_type const& parameters, Translator const& translator,
+                                  PredicatesIterator first, size_type count,
+                                  OutIter out_it, OffsetsOutIter offsets_it,
+                                  std::size_t threads)
+    {
+        if ( threads < 1 )
+            threads = 1;
+        if ( count < threads )
+            threads = count;
+
+        std::vector<chunk_result> chunks(threads);
+        chunk_query q(root, parameters, translator, first, chunks);
+        geometry::detail::parallel::for_each_chunk(count, threads, q);
+
+        // offsets of the results of each query in the output
+        size_type offset = 0;
+        *offsets_it = offset;
+        ++offsets_it;
+        for ( typename std::vector<chunk_result>::const_iterator it = chunks.begin() ; it != chunks.end() ; ++it )
+        {
+            for ( typename std::vector<size_type>::const_iterator c_it = it->counts.begin() ; c_it != it->counts.end() ; ++c_it )
+            {
+                offset += *c_it;
+                *offsets_it = offset;
+                ++offsets_it;
+            }
+        }
+
+        // flat buffer of results
+        for ( typename std::vector<chunk_result>::const_iterator it = chunks.begin() ; it != chunks.end() ; ++it )
+        {
+            for ( typename chunk_values_type::const_iterator v_it = it->values.begin() ; v_it != it->values.end() ; ++v_it )
+            {
+                *out_it = value_ref(*v_it);
+                ++out_it;
+            }
+        }
+
+        return offset;
+    }
+
+private:
+    static inline Value const& value_ref(Value const& v) { return v; }
+    static inline Value const& value_ref(const Value * v) { return *v; }
+
+    static inline void apply_chunk(node_pointer root, parameters_type const& /*parameters*/, Translator const& translator,
+                                   PredicatesIterator first, size_type count,
+                                   chunk_result & result,
+                                   boost::mpl::bool_<false> const& /*is_distance_query*/)
+    {
+        typedef typename spatial_visitor_type::found_type visitor_found_type;
+        std::vector<visitor_found_type> found;
+
+        if ( root )
+        {
+            spatial_visitor_type find_v(translator, first, count, found);
+            rtree::apply_visitor(find_v, *root);
+        }
+
+        // stable counting sort of the results WRT the index of the query
+        result.counts.assign(count, 0);
+        for ( typename std::vector<visitor_found_type>::const_iterator it = found.begin() ; it != found.end() ; ++it )
+            ++result.counts[it->first];
+
+        std::vector<size_type> positions(count, 0);
+        for ( size_type i = 1 ; i < count ; ++i )
+            positions[i] = positions[i - 1] + result.counts[i - 1];
+
+        result.values.resize(found.size());
+        for ( typename std::vector<visitor_found_type>::const_iterator it = found.begin() ; it != found.end() ; ++it )
+            result.values[positions[it->first]++] = it->second;
+    }
+
+    static inline void apply_chunk(node_pointer root, parameters_type const& parameters, Translator const& translator,
+                                   PredicatesIterator first, size_type count,
+                                   chunk_result & result,
+                                   boost::mpl::bool_<true> const& /*is_distance_query*/)
+    {
+        static const unsigned distance_predicate_index = index::detail::predicates_find_distance<predicates_type>::value;
+        typedef typename visitors::distance_query_visitor
+            <
+                Value, Options, Translator, Box, Allocators,
+                predicates_type, distance_predicate_index,
+                std::back_insert_iterator<chunk_values_type>
+            >::type distance_visitor_type;
+
+        result.counts.reserve(count);
+        for ( size_type i = 0 ; i < count ; ++i, ++first )
+        {
+            size_type found_count = 0;
+            if ( root )
+            {
+                distance_visitor_type distance_v(parameters, translator, *first, std::back_inserter(result.values));
+                rtree::apply_visitor(distance_v, *root);
+                found_count = distance_v.finish();
+            }
+            result.counts.push_back(found_count);
+        }
+    }
+};
+
+}}}}} // namespace boost::geometry::index::detail::rtree
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_BATCH_QUERY_HPP
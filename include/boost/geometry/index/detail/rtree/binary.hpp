@@ -0,0 +1,282 @@
+// Boost.Geometry Index
+//
+// R-tree native binary serialization
+//
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_BINARY_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_BINARY_HPP
+
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#include <boost/core/addressof.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/mpl/assert.hpp>
+#include <boost/type_traits/aligned_storage.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+#include <boost/type_traits/has_trivial_copy.hpp>
+
+#include <boost/geometry/core/coordinate_dimension.hpp>
+#include <boost/geometry/core/coordinate_type.hpp>
+
+#include <boost/geometry/index/detail/exception.hpp>
+#include <boost/geometry/index/detail/rtree/visitors/aggregate.hpp>
+
+namespace boost { namespace geometry { namespace index { namespace detail { namespace rtree { namespace binary {
+
+// The layout of the data:
+//
+// header
+// nodes  - the nodes in depth-first order, each node is stored as
+//          uint32 count of elements followed by count Boxes of children
+//          for internal nodes or count Values for leafs, the subtrees of
+//          the children follow the Boxes of an internal node
+//
+// The Boxes and Values are stored in the native representation as raw bytes
+// so the data may only be read on the platform on which it was written.
+// The structure of the tree is restored as it was, no rebalancing is done.
+
+static const boost::uint32_t format_version = 1;
+static const boost::uint32_t byte_order_mark = 0x01020304;
+
+struct header
+{
+    char magic[8];
+    boost::uint32_t version;
+    boost::uint32_t byte_order;
+    boost::uint32_t dimension;
+    boost::uint32_t coordinate_size;
+    boost::uint32_t box_size;
+    boost::uint32_t value_size;
+
+    boost::uint64_t max_elements;
+    boost::uint64_t min_elements;
+    boost::uint64_t values_count;
+    boost::uint64_t leafs_level;
+};
+
+inline void set_magic(header & h)
+{
+    std::memcpy(h.magic, "BGIRTBN", 8);
+}
+
+inline bool is_magic_ok(header const& h)
+{
+    return 0 == std::memcmp(h.magic, "BGIRTBN", 8);
+}
+
+template <typename T>
+inline void write_raw(std::ostream & os, const T * ptr, std::size_t count)
+{
+    os.write(reinterpret_cast<const char *>(ptr), static_cast<std::streamsize>(count * sizeof(T)));
+}
+
+template <typename T>
+inline void read_raw(std::istream & is, T * ptr, std::size_t count)
+{
+    std::streamsize const size = static_cast<std::streamsize>(count * sizeof(T));
+    if ( ! is.read(reinterpret_cast<char *>(ptr), size) || is.gcount() != size )
+        throw_runtime_error("unable to read the rtree data");
+}
+
+template <typename Value, typename Box>
+inline void fill_header(header & h)
+{
+    std::memset(&h, 0, sizeof(header));
+    set_magic(h);
+    h.version = format_version;
+    h.byte_order = byte_order_mark;
+    h.dimension = geometry::dimension<Box>::value;
+    h.coordinate_size = sizeof(typename geometry::coordinate_type<Box>::type);
+    h.box_size = sizeof(Box);
+    h.value_size = sizeof(Value);
+}
+
+namespace visitors {
+
+// Writes the nodes in depth-first order.
+// The elements of each node are written at once.
+template <typename Value, typename Options, typename Box, typename Allocators>
+class save
+    : public rtree::visitor<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag, true>::type
+{
+    typedef typename rtree::internal_node<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag>::type internal_node;
+    typedef typename rtree::leaf<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag>::type leaf;
+
+public:
+    inline save(std::ostream & os, std::size_t max_elements)
+        : m_os(os)
+    {
+        m_boxes.reserve(max_elements + 1);
+    }
+
+    inline void operator()(internal_node const& n)
+    {
+        typedef typename rtree::elements_type<internal_node>::type elements_type;
+        elements_type const& elements = rtree::elements(n);
+
+        m_boxes.clear();
+        for ( typename elements_type::const_iterator it = elements.begin() ; it != elements.end() ; ++it )
+            m_boxes.push_back(it->first);
+
+        boost::uint32_t const count = static_cast<boost::uint32_t>(elements.size());
+        write_raw(m_os, &count, 1);
+        write_raw(m_os, &m_boxes[0], m_boxes.size());
+
+        for ( typename elements_type::const_iterator it = elements.begin() ; it != elements.end() ; ++it )
+            rtree::apply_visitor(*this, *it->second);
+    }
+
+    inline void operator()(leaf const& n)
+    {
+        typedef typename rtree::elements_type<leaf>::type elements_type;
+        elements_type const& elements = rtree::elements(n);
+
+        boost::uint32_t const count = static_cast<boost::uint32_t>(elements.size());
+        write_raw(m_os, &count, 1);
+        if ( ! elements.empty() )
+            write_raw(m_os, boost::addressof(*elements.begin()), elements.size());
+    }
+
+private:
+    std::ostream & m_os;
+    std::vector<Box> m_boxes;
+};
+
+} // namespace visitors
+
+// Reads the nodes written by the save visitor and creates the tree
+// with exactly the same structure.
+template <typename Value, typename Options, typename Translator, typename Box, typename Allocators>
+class load
+{
+    typedef typename rtree::internal_node<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag>::type internal_node;
+    typedef typename rtree::leaf<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag>::type leaf;
+
+    typedef typename Options::parameters_type parameters_type;
+    typedef typename Allocators::node_pointer node_pointer;
+    typedef typename Allocators::size_type size_type;
+    typedef rtree::subtree_destroyer<Value, Options, Translator, Box, Allocators> subtree_destroyer;
+
+    typedef typename boost::aligned_storage
+        <
+            sizeof(Value), boost::alignment_of<Value>::value
+        >::type value_storage;
+
+    BOOST_MPL_ASSERT_MSG((boost::has_trivial_copy<Value>::value),
+                         VALUE_MUST_BE_TRIVIALLY_COPYABLE,
+                         (Value));
+
+public:
+    inline load(std::istream & is, size_type leafs_level, parameters_type const& parameters, Allocators & allocators)
+        : m_is(is)
+        , m_leafs_level(leafs_level)
+        , m_parameters(parameters)
+        , m_allocators(allocators)
+        , m_values_count(0)
+        , m_values(parameters.get_max_elements() + 1)
+        , m_boxes(leafs_level)
+    {
+        for ( size_type l = 0 ; l < leafs_level ; ++l )
+            m_boxes[l].reserve(parameters.get_max_elements() + 1);
+    }
+
+    inline node_pointer apply()
+    {
+        m_values_count = 0;
+        return apply(0);
+    }
+
+    inline size_type values_count() const
+    {
+        return m_values_count;
+    }
+
+private:
+    inline std::size_t read_count(size_type level)
+    {
+        boost::uint32_t count = 0;
+        read_raw(m_is, &count, 1);
+        // the root may store less than min elements
+        if ( count == 0 || m_parameters.get_max_elements() < count
+          || ( level != 0 && count < m_parameters.get_min_elements() ) )
+            throw_runtime_error("the rtree data is corrupted");
+        return count;
+    }
+
+    node_pointer apply(size_type level)
+    {
+        std::size_t const count = read_count(level);
+
+        if ( level < m_leafs_level )
+        {
+            typedef typename rtree::elements_type<internal_node>::type elements_type;
+            typedef typename elements_type::value_type element_type;
+
+            std::vector<Box> & boxes = m_boxes[level];
+            boxes.resize(count);
+            read_raw(m_is, &boxes[0], count);                                                               // MAY THROW (F)
+
+            node_pointer n = rtree::create_node<Allocators, internal_node>::apply(m_allocators);            // MAY THROW (A)
+            subtree_destroyer auto_remover(n, m_allocators);
+            internal_node & in = rtree::get<internal_node>(*n);
+            elements_type & elements = rtree::elements(in);
+
+            elements.reserve(count);                                                                        // MAY THROW (A)
+
+            for ( std::size_t i = 0 ; i < count ; ++i )
+            {
+                node_pointer child = apply(level + 1);                                                      // MAY THROW (A, F)
+                subtree_destroyer child_remover(child, m_allocators);
+                // the memory is reserved
+                elements.push_back(element_type(boxes[i], child));
+                child_remover.release();
+            }
+
+            rtree::update_aggregate<Value, Options, Box, Allocators>::apply(in, m_parameters);
+
+            auto_remover.release();
+            return n;
+        }
+        else
+        {
+            typedef typename rtree::elements_type<leaf>::type elements_type;
+
+            Value * first = reinterpret_cast<Value *>(&m_values[0]);
+            read_raw(m_is, first, count);                                                                   // MAY THROW (F)
+
+            node_pointer n = rtree::create_node<Allocators, leaf>::apply(m_allocators);                     // MAY THROW (A)
+            subtree_destroyer auto_remover(n, m_allocators);
+            leaf & l = rtree::get<leaf>(*n);
+            elements_type & elements = rtree::elements(l);
+
+            elements.assign(first, first + count);                                                          // MAY THROW (A, C)
+            m_values_count += count;
+
+            rtree::update_aggregate<Value, Options, Box, Allocators>::apply(l, m_parameters);
+
+            auto_remover.release();
+            return n;
+        }
+    }
+
+    std::istream & m_is;
+    size_type m_leafs_level;
+    parameters_type const& m_parameters;
+    Allocators & m_allocators;
+    size_type m_values_count;
+
+    std::vector<value_storage> m_values;
+    std::vector< std::vector<Box> > m_boxes;
+};
+
+}}}}}} // namespace boost::geometry::index::detail::rtree::binary
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_BINARY_HPP
@@ -0,0 +1,63 @@
+// Boost.Geometry Index
+//
+// R-tree output iterator calling a function object until it returns false
+//
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_CALLBACK_OUTPUT_ITERATOR_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_CALLBACK_OUTPUT_ITERATOR_HPP
+
+#include <cstddef>
+#include <iterator>
+
+namespace boost { namespace geometry { namespace index { namespace detail { namespace rtree {
+
+// Passes the assigned values to the function object until it returns false,
+// the following values are ignored. The state is shared by the copies.
+template <typename Function>
+class callback_output_iterator
+{
+public:
+    typedef std::output_iterator_tag iterator_category;
+    typedef void value_type;
+    typedef void difference_type;
+    typedef void pointer;
+    typedef void reference;
+
+    struct state
+    {
+        explicit state(Function & f) : function(f), count(0), stopped(false) {}
+
+        Function & function;
+        std::size_t count;
+        bool stopped;
+    };
+
+    explicit callback_output_iterator(state & s) : m_state(&s) {}
+
+    callback_output_iterator & operator*() { return *this; }
+    callback_output_iterator & operator++() { return *this; }
+    callback_output_iterator & operator++(int) { return *this; }
+
+    template <typename Value>
+    callback_output_iterator & operator=(Value const& v)
+    {
+        if ( ! m_state->stopped )
+        {
+            ++m_state->count;
+            m_state->stopped = ! m_state->function(v);
+        }
+        return *this;
+    }
+
+private:
+    state * m_state;
+};
+
+}}}}} // namespace boost::geometry::index::detail::rtree
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_CALLBACK_OUTPUT_ITERATOR_HPP
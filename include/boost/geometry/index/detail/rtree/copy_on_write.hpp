@@ -0,0 +1,463 @@
+// Boost.Geometry Index
+//
+// R-tree copy-on-write modification
+//
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_COPY_ON_WRITE_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_COPY_ON_WRITE_HPP
+
+#include <utility>
+#include <vector>
+
+#include <boost/type_traits/is_same.hpp>
+#include <boost/unordered_set.hpp>
+
+#include <boost/geometry/algorithms/detail/covered_by/interface.hpp>
+#include <boost/geometry/algorithms/detail/expand_by_epsilon.hpp>
+#include <boost/geometry/util/condition.hpp>
+
+#include <boost/geometry/index/detail/algorithms/bounds.hpp>
+#include <boost/geometry/index/detail/rtree/visitors/insert.hpp>
+#include <boost/geometry/index/detail/rtree/visitors/is_leaf.hpp>
+
+namespace boost { namespace geometry { namespace index { namespace detail { namespace rtree {
+
+// Modifies a tree which nodes may be shared with other trees.
+//
+// Only the private nodes, i.e. the nodes created by this algorithm since the
+// set of private nodes was cleared, are modified. Before a node which isn't
+// private is modified it's copied, the copy becomes private and replaces the
+// original node in its parent which was copied before. So all nodes on the
+// path from the root to the modified node are copied once. The replaced nodes
+// are appended to the list of retired nodes because they may still be used
+// by other trees. The private nodes which are removed from the tree are
+// destroyed immediately.
+//
+// The values are inserted like by the insert visitor but the R*-tree forced
+// reinsertions are not performed, the overflowing nodes are split. The values
+// are removed like by the remove visitor.
+//
+// If an exception is thrown the tree may be invalid. The other trees are not
+// modified and the caller may restore the previous state by destroying the
+// private nodes with destroy_node() and restoring the root.
+template <typename Value, typename Options, typename Translator, typename Box, typename Allocators>
+class copy_on_write
+{
+    typedef typename Options::parameters_type parameters_type;
+
+    typedef typename rtree::node<Value, parameters_type, Box, Allocators, typename Options::node_tag>::type node;
+    typedef typename rtree::internal_node<Value, parameters_type, Box, Allocators, typename Options::node_tag>::type internal_node;
+    typedef typename rtree::leaf<Value, parameters_type, Box, Allocators, typename Options::node_tag>::type leaf;
+
+    typedef typename Allocators::node_pointer node_pointer;
+    typedef typename Allocators::size_type size_type;
+
+    typedef typename rtree::elements_type<internal_node>::type internal_elements;
+    typedef typename internal_elements::value_type internal_element;
+    typedef typename rtree::elements_type<leaf>::type leaf_elements;
+
+    typedef rtree::choose_next_node<Value, Options, Box, Allocators, typename Options::choose_next_node_tag> choose_next_node;
+    typedef rtree::split<Value, Options, Translator, Box, Allocators, typename Options::split_tag> split_algo;
+
+    // The internal nodes on the path from the root and the indexes of the children
+    typedef std::vector<std::pair<node_pointer, std::size_t> > path_type;
+
+    // The removed nodes and their levels counted from the leafs level
+    typedef std::vector<std::pair<size_type, node_pointer> > underflowed_nodes_type;
+
+public:
+    typedef boost::unordered_set<node_pointer> private_nodes_type;
+    typedef std::vector<node_pointer> retired_nodes_type;
+
+    copy_on_write(node_pointer & root, size_type & leafs_level,
+                  private_nodes_type & private_nodes, retired_nodes_type & retired_nodes,
+                  parameters_type const& parameters, Translator const& translator, Allocators & allocators)
+        : m_root(root), m_leafs_level(leafs_level)
+        , m_private_nodes(private_nodes), m_retired_nodes(retired_nodes)
+        , m_parameters(parameters), m_translator(translator), m_allocators(allocators)
+    {}
+
+    void insert(Value const& value)
+    {
+        if ( ! m_root )
+        {
+            node_pointer n = rtree::create_node<Allocators, leaf>::apply(m_allocators);              // MAY THROW (N: alloc)
+            add_private(n);                                                                           // MAY THROW (alloc)
+            m_root = n;
+            m_leafs_level = 0;
+        }
+
+        insert_element(value, element_bounds(value), m_leafs_level);                                  // MAY THROW (V, E: alloc, copy, N: alloc)
+    }
+
+    bool remove(Value const& value)
+    {
+        if ( ! m_root )
+            return false;
+
+        // find the value in the tree without modifying it
+        std::vector<std::size_t> indexes;
+        std::size_t value_index = 0;
+        if ( ! find(m_root, 0, value, indexes, value_index) )                                        // MAY THROW (alloc)
+            return false;
+
+        path_type path;
+        node_pointer n = copy_path(indexes.begin(), indexes.end(), path);                             // MAY THROW (V, E: alloc, copy, N: alloc)
+
+        leaf_elements & values = rtree::elements(rtree::get<leaf>(*n));
+        rtree::move_from_back(values, values.begin() + value_index);                                  // MAY THROW (V: copy)
+        values.pop_back();
+
+        // update the boxes and remove the underflowed nodes
+        underflowed_nodes_type underflowed_nodes;
+        update_after_remove<leaf>(n, path, path.size(), underflowed_nodes);                           // MAY THROW (E: alloc, copy)
+        for ( std::size_t depth = path.size() ; depth > 0 ; --depth )
+            update_after_remove<internal_node>(path[depth - 1].first, path, depth - 1, underflowed_nodes); // MAY THROW (E: alloc, copy)
+
+        // reinsert the elements of the removed nodes, begin with the levels closer to the root
+        for ( typename underflowed_nodes_type::reverse_iterator it = underflowed_nodes.rbegin() ;
+              it != underflowed_nodes.rend() ; ++it )
+        {
+            if ( it->first == 0 )
+            {
+                leaf_elements const& elements = rtree::elements(rtree::get<leaf>(*it->second));
+                for ( typename leaf_elements::const_iterator e = elements.begin() ; e != elements.end() ; ++e )
+                    insert_element(*e, element_bounds(*e), m_leafs_level);                           // MAY THROW (V, E: alloc, copy, N: alloc)
+            }
+            else
+            {
+                internal_elements const& elements = rtree::elements(rtree::get<internal_node>(*it->second));
+                for ( typename internal_elements::const_iterator e = elements.begin() ; e != elements.end() ; ++e )
+                    insert_element(*e, e->first, m_leafs_level - it->first);                          // MAY THROW (E: alloc, copy, N: alloc)
+            }
+
+            retire(it->second);                                                                       // MAY THROW (alloc)
+        }
+
+        // shorten the tree
+        while ( 0 < m_leafs_level && rtree::elements(rtree::get<internal_node>(*m_root)).size() <= 1 )
+        {
+            internal_elements & children = rtree::elements(rtree::get<internal_node>(*m_root));
+            node_pointer const root_to_retire = m_root;
+
+            if ( children.empty() )
+            {
+                m_root = 0;
+                m_leafs_level = 0;
+            }
+            else
+            {
+                m_root = children[0].second;
+                --m_leafs_level;
+            }
+
+            retire(root_to_retire);                                                                   // MAY THROW (alloc)
+        }
+
+        return true;
+    }
+
+    // Destroys the node without its children.
+    static void destroy_node(node_pointer n, Allocators & allocators)
+    {
+        visitors::is_leaf<Value, Options, Box, Allocators> ilv;
+        rtree::apply_visitor(ilv, *n);
+
+        if ( ilv.result )
+            rtree::destroy_node<Allocators, leaf>::apply(allocators, n);
+        else
+            rtree::destroy_node<Allocators, internal_node>::apply(allocators, n);
+    }
+
+private:
+    template <typename Element>
+    void insert_element(Element const& element, Box const& element_box, size_type level)
+    {
+        std::vector<std::size_t> indexes;
+        path_type path;
+        node_pointer n = m_root;
+
+        // choose the path before copying it
+        for ( size_type l = 0 ; l < level ; ++l )
+        {
+            internal_node & in = rtree::get<internal_node>(*n);
+            std::size_t const c = choose_next_node::apply(in, rtree::element_indexable(element, m_translator),
+                                                          m_parameters, m_leafs_level - l);
+            indexes.push_back(c);                                                                     // MAY THROW (alloc)
+            n = rtree::elements(in)[c].second;
+        }
+
+        n = copy_path(indexes.begin(), indexes.end(), path);                                          // MAY THROW (V, E: alloc, copy, N: alloc)
+
+        for ( std::size_t i = 0 ; i < path.size() ; ++i )
+        {
+            internal_elements & children = rtree::elements(rtree::get<internal_node>(*path[i].first));
+            geometry::expand(children[path[i].second].first, element_box);
+        }
+
+        add_and_split(n, element, path);                                                              // MAY THROW (V, E: alloc, copy, N: alloc)
+
+        for ( std::size_t depth = path.size() ; depth > 0 ; --depth )
+            split_if_overflow<internal_node>(path[depth - 1].first, path, depth - 1);                 // MAY THROW (E: alloc, copy, N: alloc)
+    }
+
+    void add_and_split(node_pointer n, Value const& value, path_type & path)
+    {
+        rtree::elements(rtree::get<leaf>(*n)).push_back(value);                                       // MAY THROW, STRONG (V: alloc, copy)
+        split_if_overflow<leaf>(n, path, path.size());                                                // MAY THROW (V: alloc, copy, N: alloc)
+    }
+
+    void add_and_split(node_pointer n, internal_element const& element, path_type & path)
+    {
+        rtree::elements(rtree::get<internal_node>(*n)).push_back(element);                           // MAY THROW, STRONG (E: alloc, copy)
+        split_if_overflow<internal_node>(n, path, path.size());                                       // MAY THROW (E: alloc, copy, N: alloc)
+    }
+
+    // Splits the node at depth if it overflows and adds the new node to the parent
+    // or to the new root.
+    template <typename Node>
+    void split_if_overflow(node_pointer n, path_type & path, std::size_t depth)
+    {
+        Node & nd = rtree::get<Node>(*n);
+
+        if ( rtree::elements(nd).size() <= m_parameters.get_max_elements() )
+        {
+            rtree::update_aggregate<Value, Options, Box, Allocators>::apply(nd, m_parameters);
+            return;
+        }
+
+        typename split_algo::nodes_container_type additional_nodes;
+        Box n_box;
+        split_algo::apply(additional_nodes, nd, n_box, m_parameters, m_translator, m_allocators);      // MAY THROW (V, E: alloc, copy, N: alloc)
+
+        BOOST_GEOMETRY_INDEX_ASSERT(additional_nodes.size() == 1, "unexpected number of additional nodes");
+
+        add_private(additional_nodes[0].second);                                                      // MAY THROW (alloc)
+
+#ifdef BOOST_GEOMETRY_INDEX_EXPERIMENTAL_ENLARGE_BY_EPSILON
+        // the same as in the insert visitor
+        if (BOOST_GEOMETRY_CONDITION((
+                boost::is_same<Node, leaf>::value
+             && ! index::detail::is_bounding_geometry
+                    <
+                        typename indexable_type<Translator>::type
+                    >::value )))
+        {
+            geometry::detail::expand_by_epsilon(n_box);
+            geometry::detail::expand_by_epsilon(additional_nodes[0].first);
+        }
+#endif
+
+        if ( 0 < depth )
+        {
+            internal_elements & siblings = rtree::elements(rtree::get<internal_node>(*path[depth - 1].first));
+            siblings[path[depth - 1].second].first = n_box;
+            siblings.push_back(additional_nodes[0]);                                                  // MAY THROW, STRONG (E: alloc, copy)
+        }
+        else
+        {
+            node_pointer new_root = rtree::create_node<Allocators, internal_node>::apply(m_allocators); // MAY THROW (N: alloc)
+            add_private(new_root);                                                                    // MAY THROW (alloc)
+
+            internal_elements & children = rtree::elements(rtree::get<internal_node>(*new_root));
+            children.push_back(rtree::make_ptr_pair(n_box, m_root));                                  // MAY THROW, STRONG (E: alloc, copy)
+            children.push_back(additional_nodes[0]);                                                  // MAY THROW, STRONG (E: alloc, copy)
+            rtree::update_aggregate<Value, Options, Box, Allocators>::apply(rtree::get<internal_node>(*new_root), m_parameters);
+
+            m_root = new_root;
+            ++m_leafs_level;
+        }
+    }
+
+    // Updates the box of the node at depth in its parent or removes the node
+    // from the parent if it underflows.
+    template <typename Node>
+    void update_after_remove(node_pointer n, path_type const& path, std::size_t depth,
+                             underflowed_nodes_type & underflowed_nodes)
+    {
+        Node & nd = rtree::get<Node>(*n);
+        rtree::update_aggregate<Value, Options, Box, Allocators>::apply(nd, m_parameters);
+
+        // the root may have less than min elements
+        if ( 0 == depth )
+            return;
+
+        internal_elements & siblings = rtree::elements(rtree::get<internal_node>(*path[depth - 1].first));
+        std::size_t const c = path[depth - 1].second;
+
+        if ( rtree::elements(nd).size() < m_parameters.get_min_elements() )
+        {
+            underflowed_nodes.push_back(std::make_pair(m_leafs_level - depth, n));                    // MAY THROW (E: alloc, copy)
+            rtree::move_from_back(siblings, siblings.begin() + c);                                    // MAY THROW (E: copy)
+            siblings.pop_back();
+        }
+        else
+        {
+            siblings[c].first = node_box(nd);
+        }
+    }
+
+    // Makes private the root and the children at indexes on the path from the root.
+    // Returns the last node.
+    template <typename It>
+    node_pointer copy_path(It first, It last, path_type & path)
+    {
+        make_private(m_root, 0 == m_leafs_level);                                                     // MAY THROW (V, E: alloc, copy, N: alloc)
+        node_pointer n = m_root;
+        size_type level = 0;
+
+        for ( ; first != last ; ++first, ++level )
+        {
+            internal_elements & children = rtree::elements(rtree::get<internal_node>(*n));
+            make_private(children[*first].second, level + 1 == m_leafs_level);                        // MAY THROW (V, E: alloc, copy, N: alloc)
+            path.push_back(std::make_pair(n, *first));                                                // MAY THROW (alloc)
+            n = children[*first].second;
+        }
+
+        return n;
+    }
+
+    void make_private(node_pointer & n, bool is_leaf)
+    {
+        if ( m_private_nodes.find(n) != m_private_nodes.end() )
+            return;
+
+        node_pointer const copy = is_leaf
+                                ? copy_node<leaf>(n)                                                  // MAY THROW (V: alloc, copy, N: alloc)
+                                : copy_node<internal_node>(n);                                        // MAY THROW (E: alloc, copy, N: alloc)
+
+        m_retired_nodes.push_back(n);                                                                 // MAY THROW (alloc)
+        n = copy;
+    }
+
+    template <typename Node>
+    node_pointer copy_node(node_pointer n)
+    {
+        node_pointer result = rtree::create_node<Allocators, Node>::apply(m_allocators);              // MAY THROW (N: alloc)
+
+        BOOST_TRY
+        {
+            Node & dst = rtree::get<Node>(*result);
+            rtree::elements(dst) = rtree::elements(rtree::get<Node>(*n));                             // MAY THROW (V, E: alloc, copy)
+            rtree::update_aggregate<Value, Options, Box, Allocators>::apply(dst, m_parameters);
+        }
+        BOOST_CATCH(...)
+        {
+            rtree::destroy_node<Allocators, Node>::apply(m_allocators, result);
+            BOOST_RETHROW                                                                             // RETHROW
+        }
+        BOOST_CATCH_END
+
+        add_private(result);                                                                          // MAY THROW (alloc)
+        return result;
+    }
+
+    void add_private(node_pointer n)
+    {
+        BOOST_TRY
+        {
+            m_private_nodes.insert(n);                                                                // MAY THROW (alloc)
+        }
+        BOOST_CATCH(...)
+        {
+            destroy_node(n, m_allocators);
+            BOOST_RETHROW                                                                             // RETHROW
+        }
+        BOOST_CATCH_END
+    }
+
+    // The node removed from the tree is destroyed if it's private, otherwise it's retired.
+    void retire(node_pointer n)
+    {
+        typename private_nodes_type::iterator it = m_private_nodes.find(n);
+        if ( it != m_private_nodes.end() )
+        {
+            m_private_nodes.erase(it);
+            destroy_node(n, m_allocators);
+        }
+        else
+        {
+            m_retired_nodes.push_back(n);                                                             // MAY THROW (alloc)
+        }
+    }
+
+    bool find(node_pointer n, size_type level, Value const& value,
+              std::vector<std::size_t> & indexes, std::size_t & value_index) const
+    {
+        if ( level == m_leafs_level )
+        {
+            leaf_elements const& elements = rtree::elements(rtree::get<leaf>(*n));
+            for ( std::size_t i = 0 ; i < elements.size() ; ++i )
+            {
+                if ( m_translator.equals(elements[i], value) )
+                {
+                    value_index = i;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        internal_elements const& children = rtree::elements(rtree::get<internal_node>(*n));
+        for ( std::size_t c = 0 ; c < children.size() ; ++c )
+        {
+            if ( geometry::covered_by(return_ref_or_bounds(m_translator(value)), children[c].first) )
+            {
+                indexes.push_back(c);                                                                 // MAY THROW (alloc)
+                if ( find(children[c].second, level + 1, value, indexes, value_index) )
+                    return true;
+                indexes.pop_back();
+            }
+        }
+
+        return false;
+    }
+
+    Box node_box(leaf const& n) const
+    {
+        return rtree::values_box<Box>(rtree::elements(n).begin(), rtree::elements(n).end(), m_translator);
+    }
+
+    Box node_box(internal_node const& n) const
+    {
+        return rtree::elements_box<Box>(rtree::elements(n).begin(), rtree::elements(n).end(), m_translator);
+    }
+
+    Box element_bounds(Value const& v) const
+    {
+        Box result;
+        index::detail::bounds(m_translator(v), result);
+
+#ifdef BOOST_GEOMETRY_INDEX_EXPERIMENTAL_ENLARGE_BY_EPSILON
+        // the same as in the insert visitor
+        if (BOOST_GEOMETRY_CONDITION((
+                ! index::detail::is_bounding_geometry
+                    <
+                        typename indexable_type<Translator>::type
+                    >::value )) )
+        {
+            geometry::detail::expand_by_epsilon(result);
+        }
+#endif
+
+        return result;
+    }
+
+    node_pointer & m_root;
+    size_type & m_leafs_level;
+    private_nodes_type & m_private_nodes;
+    retired_nodes_type & m_retired_nodes;
+
+    parameters_type const& m_parameters;
+    Translator const& m_translator;
+    Allocators & m_allocators;
+};
+
+}}}}} // namespace boost::geometry::index::detail::rtree
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_COPY_ON_WRITE_HPP
@@ -0,0 +1,208 @@
+// Boost.Geometry Index
+//
+// R-tree flat layout, checking the predicates for all children of a node
+//
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_FLAT_CHILDREN_FILTER_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_FLAT_CHILDREN_FILTER_HPP
+
+#include <algorithm>
+
+#include <boost/type_traits/is_same.hpp>
+
+#include <boost/geometry/core/coordinate_dimension.hpp>
+#include <boost/geometry/core/coordinate_type.hpp>
+#include <boost/geometry/core/cs.hpp>
+#include <boost/geometry/core/tags.hpp>
+#include <boost/geometry/util/select_most_precise.hpp>
+
+#include <boost/geometry/index/detail/rtree/flat/format.hpp>
+
+namespace boost { namespace geometry { namespace index { namespace detail { namespace rtree { namespace flat {
+
+template <typename Predicates, typename Box>
+struct is_cartesian_box_intersects
+{
+    static const bool value = false;
+};
+
+template <typename Geometry, typename Box>
+struct is_cartesian_box_intersects
+    <
+        index::detail::predicates::spatial_predicate<Geometry, index::detail::predicates::intersects_tag, false>,
+        Box
+    >
+{
+    static const bool value
+        = boost::is_same<typename geometry::tag<Geometry>::type, box_tag>::value
+       && boost::is_same<typename geometry::cs_tag<Geometry>::type, cartesian_tag>::value
+       && boost::is_same<typename geometry::cs_tag<Box>::type, cartesian_tag>::value
+       && geometry::dimension<Geometry>::value == geometry::dimension<Box>::value;
+};
+
+// Checks the predicates for the children [first, first + count) of a node
+// and sets mask[i] to 1 if the i-th child meets them, 0 otherwise.
+template
+<
+    typename Value,
+    typename Box,
+    typename Predicates,
+    bool IsCartesianBoxIntersects = is_cartesian_box_intersects<Predicates, Box>::value
+>
+struct children_filter
+{
+    static const unsigned predicates_len = index::detail::predicates_length<Predicates>::value;
+
+    static inline void nodes(data<Value, Box> const& d, Predicates const& predicates,
+                             Box const& parent_box,
+                             std::size_t first, std::size_t count,
+                             unsigned char * mask)
+    {
+        for ( std::size_t i = 0 ; i < count ; ++i )
+        {
+            // 0 - dummy value
+            mask[i] = index::detail::predicates_check<index::detail::bounds_tag, 0, predicates_len>(predicates, 0, d.box(first + i, parent_box))
+                    ? 1 : 0;
+        }
+    }
+
+    template <typename Translator>
+    static inline void values(data<Value, Box> const& d, Translator const& tr, Predicates const& predicates,
+                              std::size_t first, std::size_t count,
+                              unsigned char * mask)
+    {
+        for ( std::size_t i = 0 ; i < count ; ++i )
+        {
+            Value const& v = d.values[first + i];
+            mask[i] = index::detail::predicates_check<index::detail::value_tag, 0, predicates_len>(predicates, v, tr(v))
+                    ? 1 : 0;
+        }
+    }
+};
+
+// The coordinates of the children of a node are stored in contiguous arrays
+// so the overlap test is done for all of them at once, one dimension at a time.
+// The inner loop has no branches and may be vectorized by the compiler.
+template <typename Value, typename Box, typename Predicates>
+struct children_filter<Value, Box, Predicates, true>
+{
+    typedef data<Value, Box> data_type;
+    typedef typename data_type::coordinate_type coordinate_type;
+    static const std::size_t dimension = data_type::dimension;
+    static const unsigned predicates_len = index::detail::predicates_length<Predicates>::value;
+
+    static inline void nodes(data_type const& d, Predicates const& predicates,
+                             Box const& parent_box,
+                             std::size_t first, std::size_t count,
+                             unsigned char * mask)
+    {
+        if ( d.quantization_bits == 8 )
+            overlaps_quantized<boost::uint8_t>(d, predicates, parent_box, first, count, mask);
+        else if ( d.quantization_bits == 16 )
+            overlaps_quantized<boost::uint16_t>(d, predicates, parent_box, first, count, mask);
+        else
+            overlaps(d.min_coords, d.max_coords, predicates, first, count, mask);
+    }
+
+    template <typename Translator>
+    static inline void values(data_type const& d, Translator const& tr, Predicates const& predicates,
+                              std::size_t first, std::size_t count,
+                              unsigned char * mask)
+    {
+        typedef typename index::detail::indexable_type<Translator>::type indexable_type;
+        typedef typename geometry::tag<indexable_type>::type indexable_tag;
+
+        // the envelopes of the values
+        overlaps(d.value_min_coords, d.value_max_coords, predicates, first, count, mask);
+
+        // the result is exact for Boxes and Points
+        if ( ! boost::is_same<indexable_tag, box_tag>::value
+          && ! boost::is_same<indexable_tag, point_tag>::value )
+        {
+            for ( std::size_t i = 0 ; i < count ; ++i )
+            {
+                if ( mask[i] )
+                {
+                    Value const& v = d.values[first + i];
+                    mask[i] = index::detail::predicates_check<index::detail::value_tag, 0, predicates_len>(predicates, v, tr(v))
+                            ? 1 : 0;
+                }
+            }
+        }
+    }
+
+private:
+    typedef typename geometry::select_most_precise
+        <
+            coordinate_type,
+            typename geometry::coordinate_type<typename Predicates::geometry_type>::type
+        >::type calc_t;
+
+    static inline void overlaps(const coordinate_type * const * min_coords,
+                                const coordinate_type * const * max_coords,
+                                Predicates const& predicates,
+                                std::size_t first, std::size_t count,
+                                unsigned char * mask)
+    {
+        calc_t query_mins[dimension];
+        calc_t query_maxs[dimension];
+        box_coordinates<typename Predicates::geometry_type>::get(predicates.geometry, query_mins, query_maxs);
+
+        std::fill(mask, mask + count, static_cast<unsigned char>(1));
+
+        for ( std::size_t dim = 0 ; dim < dimension ; ++dim )
+        {
+            const coordinate_type * const mins = min_coords[dim] + first;
+            const coordinate_type * const maxs = max_coords[dim] + first;
+            calc_t const query_min = query_mins[dim];
+            calc_t const query_max = query_maxs[dim];
+
+            for ( std::size_t i = 0 ; i < count ; ++i )
+            {
+                mask[i] &= static_cast<unsigned char>( (mins[i] <= query_max) & (query_min <= maxs[i]) );
+            }
+        }
+    }
+
+    // The same test for the children decoded from the quantized coordinates
+    template <typename Q>
+    static inline void overlaps_quantized(data_type const& d,
+                                          Predicates const& predicates,
+                                          Box const& parent_box,
+                                          std::size_t first, std::size_t count,
+                                          unsigned char * mask)
+    {
+        calc_t query_mins[dimension];
+        calc_t query_maxs[dimension];
+        box_coordinates<typename Predicates::geometry_type>::get(predicates.geometry, query_mins, query_maxs);
+
+        coordinate_type parent_mins[dimension];
+        coordinate_type parent_maxs[dimension];
+        box_coordinates<Box>::get(parent_box, parent_mins, parent_maxs);
+
+        std::fill(mask, mask + count, static_cast<unsigned char>(1));
+
+        for ( std::size_t dim = 0 ; dim < dimension ; ++dim )
+        {
+            const Q * const mins = d.template quantized_mins<Q>(dim) + first;
+            const Q * const maxs = d.template quantized_maxs<Q>(dim) + first;
+            dequantizer<coordinate_type> const deq(parent_mins[dim], parent_maxs[dim], max_quantized(d.quantization_bits));
+            calc_t const query_min = query_mins[dim];
+            calc_t const query_max = query_maxs[dim];
+
+            for ( std::size_t i = 0 ; i < count ; ++i )
+            {
+                mask[i] &= static_cast<unsigned char>( (deq(mins[i]) <= query_max) & (query_min <= deq(maxs[i])) );
+            }
+        }
+    }
+};
+
+}}}}}} // namespace boost::geometry::index::detail::rtree::flat
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_FLAT_CHILDREN_FILTER_HPP
@@ -0,0 +1,286 @@
+// Boost.Geometry Index
+//
+// R-tree flat layout read-only view
+//
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_FLAT_FLAT_VIEW_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_FLAT_FLAT_VIEW_HPP
+
+#include <utility>
+
+#include <boost/container/small_vector.hpp>
+#include <boost/mpl/if.hpp>
+
+#include <boost/geometry/index/rtree.hpp>
+
+#include <boost/geometry/index/detail/rtree/flat/children_filter.hpp>
+#include <boost/geometry/index/detail/rtree/flat/format.hpp>
+#include <boost/geometry/index/detail/rtree/flat/query_iterators.hpp>
+#include <boost/geometry/index/detail/rtree/flat/write.hpp>
+
+namespace boost { namespace geometry { namespace index { namespace detail { namespace rtree { namespace flat {
+
+/*!
+\brief The read-only view of the rtree stored in the flat layout.
+
+The view doesn't own nor copy the data. It may be created for the data written
+by write_flat() and e.g. mapped into memory from a file, so opening the index
+takes constant time and the same pages may be shared by many processes.
+The data must be aligned to 16 bytes and must be valid as long as the view
+and the query iterators are used.
+
+\tparam Value            The type of objects stored in the view.
+\tparam IndexableGetter  Function object translating Value to Indexable.
+\tparam EqualTo          Function object comparing Values.
+*/
+template
+<
+    typename Value,
+    typename IndexableGetter = index::indexable<Value>,
+    typename EqualTo = index::equal_to<Value>
+>
+class flat_view
+{
+public:
+    typedef Value value_type;
+    typedef IndexableGetter indexable_getter;
+    typedef EqualTo value_equal;
+    typedef std::size_t size_type;
+
+    typedef typename index::detail::indexable_type<
+        detail::translator<IndexableGetter, EqualTo>
+    >::type indexable_type;
+
+    typedef geometry::model::box<
+                geometry::model::point<
+                    typename coordinate_type<indexable_type>::type,
+                    dimension<indexable_type>::value,
+                    typename coordinate_system<indexable_type>::type
+                >
+            >
+    bounds_type;
+
+private:
+    typedef detail::translator<IndexableGetter, EqualTo> translator_type;
+    typedef flat::data<Value, bounds_type> data_type;
+
+public:
+    /*! \brief The type of query iterator returned by qbegin() for Predicates. */
+    template <typename Predicates>
+    struct query_iterator_type
+    {
+        typedef typename boost::mpl::if_c
+            <
+                (0 < index::detail::predicates_count_distance<Predicates>::value),
+                distance_query_iterator
+                    <
+                        Value, bounds_type, translator_type, Predicates,
+                        index::detail::predicates_find_distance<Predicates>::value
+                    >,
+                spatial_query_iterator<Value, bounds_type, translator_type, Predicates>
+            >::type type;
+    };
+
+    /*!
+    \brief The constructor.
+
+    \param ptr      The pointer to the data written by write_flat().
+    \param size     The size of the data in bytes.
+    \param getter   The function object extracting Indexable from Value.
+    \param equal    The function object comparing Values.
+
+    \par Throws
+    std::invalid_argument if the data is not aligned, was written for different types,
+    on different platform or is corrupted.
+    */
+    inline flat_view(const void * ptr, std::size_t size,
+                     IndexableGetter const& getter = IndexableGetter(),
+                     EqualTo const& equal = EqualTo())
+        : m_data(ptr, size)
+        , m_translator(getter, equal)
+    {}
+
+    /*!
+    \brief Finds values meeting passed predicates e.g. nearest to some Point and/or intersecting some Box.
+
+    The same predicates as in the case of rtree::query() may be passed. In case of k-nearest
+    neighbors query the values are returned in order of increasing distance.
+
+    \param predicates   Predicates.
+    \param out_it       The output iterator, e.g. generated by std::back_inserter().
+
+    \return             The number of values found.
+    */
+    template <typename Predicates, typename OutIter>
+    size_type query(Predicates const& predicates, OutIter out_it) const
+    {
+        static const unsigned distance_predicates_count = index::detail::predicates_count_distance<Predicates>::value;
+        static const bool is_distance_predicate = 0 < distance_predicates_count;
+        BOOST_MPL_ASSERT_MSG((distance_predicates_count <= 1), PASS_ONLY_ONE_DISTANCE_PREDICATE, (Predicates));
+
+        if ( 0 == m_data.nodes_count )
+            return 0;
+
+        return query_dispatch(predicates, out_it, boost::mpl::bool_<is_distance_predicate>());
+    }
+
+    /*!
+    \brief Returns the query iterator pointing at the begin of the query range.
+
+    \param predicates   Predicates.
+
+    \return             The iterator pointing at the begin of the query range.
+    */
+    template <typename Predicates>
+    typename query_iterator_type<Predicates>::type
+    qbegin(Predicates const& predicates) const
+    {
+        static const unsigned distance_predicates_count = index::detail::predicates_count_distance<Predicates>::value;
+        BOOST_MPL_ASSERT_MSG((distance_predicates_count <= 1), PASS_ONLY_ONE_DISTANCE_PREDICATE, (Predicates));
+
+        return typename query_iterator_type<Predicates>::type(m_data, m_translator, predicates);
+    }
+
+    /*!
+    \brief Returns the query iterator pointing at the end of the query range.
+
+    \return             The iterator pointing at the end of the query range.
+    */
+    end_query_iterator<Value> qend() const
+    {
+        return end_query_iterator<Value>();
+    }
+
+    /*!
+    \brief Returns the number of stored values.
+    */
+    inline size_type size() const
+    {
+        return m_data.values_count;
+    }
+
+    /*!
+    \brief Query if the view is empty.
+    */
+    inline bool empty() const
+    {
+        return 0 == m_data.values_count;
+    }
+
+    /*!
+    \brief Returns the box able to contain all values stored in the view.
+
+    If the view is empty the result of \c geometry::assign_inverse() is returned.
+    */
+    inline bounds_type bounds() const
+    {
+        bounds_type result;
+        if ( 0 < m_data.nodes_count )
+            result = m_data.box(0);
+        else
+            geometry::assign_inverse(result);
+        return result;
+    }
+
+    /*!
+    \brief Returns the level of the leafs, 0 if the root is a leaf.
+    */
+    inline size_type depth() const
+    {
+        return m_data.leafs_level;
+    }
+
+    inline indexable_getter indexable_get() const
+    {
+        return m_translator;
+    }
+
+    inline value_equal value_eq() const
+    {
+        return m_translator;
+    }
+
+private:
+    template <typename Predicates, typename OutIter>
+    size_type query_dispatch(Predicates const& predicates, OutIter out_it, boost::mpl::bool_<false> const& /*is_distance_predicate*/) const
+    {
+        typedef children_filter<Value, bounds_type, Predicates> filter_type;
+
+        size_type found_count = 0;
+
+        // small buffers are allocated on the stack
+        boost::container::small_vector<unsigned char, 64> mask(m_data.max_children);
+        // the nodes to visit with their boxes, the next one at the back
+        // the boxes of the children are decoded relative to the box of the parent
+        boost::container::small_vector<std::pair<size_type, bounds_type>, 64> stack;
+        // the root is always visited
+        stack.push_back(std::make_pair(size_type(0), m_data.box(0)));
+
+        while ( ! stack.empty() )
+        {
+            size_type const node_index = stack.back().first;
+            bounds_type const node_box = stack.back().second;
+            stack.pop_back();
+
+            flat::node const& n = m_data.nodes[node_index];
+            size_type const first = static_cast<size_type>(n.first);
+            size_type const count = static_cast<size_type>(n.count);
+
+            if ( m_data.is_leaf(node_index) )
+            {
+                filter_type::values(m_data, m_translator, predicates, first, count, &mask[0]);
+
+                for ( size_type i = 0 ; i < count ; ++i )
+                {
+                    if ( mask[i] )
+                    {
+                        *out_it = m_data.values[first + i];
+                        ++out_it;
+                        ++found_count;
+                    }
+                }
+            }
+            else
+            {
+                filter_type::nodes(m_data, predicates, node_box, first, count, &mask[0]);
+
+                // pushed in reversed order to traverse the children in the original order
+                for ( size_type i = count ; i > 0 ; --i )
+                {
+                    if ( mask[i - 1] )
+                        stack.push_back(std::make_pair(first + i - 1, m_data.box(first + i - 1, node_box)));
+                }
+            }
+        }
+
+        return found_count;
+    }
+
+    template <typename Predicates, typename OutIter>
+    size_type query_dispatch(Predicates const& predicates, OutIter out_it, boost::mpl::bool_<true> const& /*is_distance_predicate*/) const
+    {
+        typedef typename query_iterator_type<Predicates>::type iterator_type;
+
+        // the iterator returns at most k values
+        size_type found_count = 0;
+        for ( iterator_type it(m_data, m_translator, predicates) ; ! it.is_end() ; ++it )
+        {
+            *out_it = *it;
+            ++out_it;
+            ++found_count;
+        }
+        return found_count;
+    }
+
+    data_type m_data;
+    translator_type m_translator;
+};
+
+}}}}}} // namespace boost::geometry::index::detail::rtree::flat
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_FLAT_FLAT_VIEW_HPP
@@ -0,0 +1,359 @@
+// Boost.Geometry Index
+//
+// R-tree flat, pointer-free memory layout
+//
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_FLAT_FORMAT_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_FLAT_FORMAT_HPP
+
+#include <cstddef>
+#include <cstring>
+
+#include <boost/cstdint.hpp>
+
+#include <boost/geometry/core/access.hpp>
+#include <boost/geometry/core/coordinate_dimension.hpp>
+#include <boost/geometry/core/coordinate_type.hpp>
+
+#include <boost/geometry/index/detail/assert.hpp>
+#include <boost/geometry/index/detail/exception.hpp>
+
+namespace boost { namespace geometry { namespace index { namespace detail { namespace rtree { namespace flat {
+
+// The layout of the data:
+//
+// header
+// coordinates       - the bounding boxes of the nodes, the box of the root first,
+//                     stored as structure of arrays: for each dimension an array
+//                     of min coordinates and an array of max coordinates, each of
+//                     nodes_count elements, or only the box of the root if
+//                     the boxes are quantized
+// value coordinates - the bounding boxes of the indexables of values stored
+//                     the same way, each array of values_count elements
+// quantized coords  - if quantization_bits is not 0, the bounding boxes of the nodes
+//                     stored the same way as unsigned integers of quantization_bits
+//                     relative to the box of the parent node, each array of
+//                     nodes_count elements
+// nodes             - node[nodes_count], the nodes in breadth-first order
+// values            - Value[values_count], the values in the order of leafs
+//
+// Each section and each array of coordinates starts at the offset aligned
+// to section_alignment bytes. The children of an internal node are the nodes
+// [first, first + count) so the coordinates of the children of a node are
+// stored contiguously and may be processed at once. The nodes stored at
+// indexes greater or equal to first_leaf are leafs and their elements are
+// the values [first, first + count). The coordinates, values and numbers are
+// stored in the native representation so the data may only be read on the
+// platform on which it was written. Values must be trivially copyable.
+//
+// The quantized box of a node contains the original box. The coordinates are
+// rounded outward to the grid of 2^quantization_bits - 1 cells spanning the
+// decoded box of the parent node, so the box of a node can only be decoded
+// when the box of its parent is known. The boxes of the values are always
+// stored exactly.
+
+static const std::size_t section_alignment = 16;
+static const boost::uint32_t format_version = 2;
+static const boost::uint32_t byte_order_mark = 0x01020304;
+
+struct header
+{
+    char magic[8];
+    boost::uint32_t version;
+    boost::uint32_t byte_order;
+    boost::uint32_t dimension;
+    boost::uint32_t coordinate_size;
+    boost::uint32_t value_size;
+    boost::uint32_t max_children;
+    boost::uint32_t quantization_bits;
+
+    boost::uint64_t values_count;
+    boost::uint64_t nodes_count;
+    boost::uint64_t first_leaf;
+    boost::uint64_t leafs_level;
+
+    boost::uint64_t coordinates_offset;
+    boost::uint64_t coordinates_stride;
+    boost::uint64_t value_coordinates_offset;
+    boost::uint64_t value_coordinates_stride;
+    boost::uint64_t quantized_coordinates_offset;
+    boost::uint64_t quantized_coordinates_stride;
+    boost::uint64_t nodes_offset;
+    boost::uint64_t values_offset;
+    boost::uint64_t size;
+};
+
+struct node
+{
+    boost::uint64_t first;
+    boost::uint64_t count;
+};
+
+inline void set_magic(header & h)
+{
+    std::memcpy(h.magic, "BGIRTFL", 8);
+}
+
+inline bool is_magic_ok(header const& h)
+{
+    return 0 == std::memcmp(h.magic, "BGIRTFL", 8);
+}
+
+inline boost::uint64_t aligned_offset(boost::uint64_t offset)
+{
+    return (offset + section_alignment - 1) / section_alignment * section_alignment;
+}
+
+inline bool is_quantization_supported(boost::uint32_t bits)
+{
+    return bits == 0 || bits == 8 || bits == 16;
+}
+
+// The number of boxes of nodes stored exactly
+inline boost::uint64_t exact_boxes_count(boost::uint64_t nodes_count, boost::uint32_t quantization_bits)
+{
+    return quantization_bits == 0 || nodes_count == 0 ? nodes_count : 1;
+}
+
+// Converts quantized coordinates to the coordinates within [lo, hi].
+// It's used both when the data is written and read so the decoded values are
+// the same. The greatest quantized value is decoded as hi exactly.
+template <typename T>
+struct dequantizer
+{
+    dequantizer(T const& lo_, T const& hi_, boost::uint32_t max_quantized_)
+        : lo(lo_), hi(hi_)
+        , scale((hi_ - lo_) / static_cast<T>(max_quantized_))
+        , max_quantized(max_quantized_)
+    {}
+
+    template <typename Q>
+    T operator()(Q const& q) const
+    {
+        return q == max_quantized ? hi : lo + static_cast<T>(q) * scale;
+    }
+
+    T lo;
+    T hi;
+    T scale;
+    boost::uint32_t max_quantized;
+};
+
+inline boost::uint32_t max_quantized(boost::uint32_t quantization_bits)
+{
+    return (boost::uint32_t(1) << quantization_bits) - 1;
+}
+
+// Gets and sets the coordinates of a Box from/to the arrays of coordinates.
+template <typename Box,
+          std::size_t I = 0,
+          std::size_t N = geometry::dimension<Box>::value>
+struct box_coordinates
+{
+    template <typename T>
+    static inline void get(Box const& b, T * mins, T * maxs)
+    {
+        mins[I] = geometry::get<min_corner, I>(b);
+        maxs[I] = geometry::get<max_corner, I>(b);
+        box_coordinates<Box, I + 1, N>::get(b, mins, maxs);
+    }
+
+    template <typename T>
+    static inline void set(Box & b, T const* const* mins, T const* const* maxs, std::size_t index)
+    {
+        geometry::set<min_corner, I>(b, mins[I][index]);
+        geometry::set<max_corner, I>(b, maxs[I][index]);
+        box_coordinates<Box, I + 1, N>::set(b, mins, maxs, index);
+    }
+
+    template <typename T>
+    static inline void assign(Box & b, T const* mins, T const* maxs)
+    {
+        geometry::set<min_corner, I>(b, mins[I]);
+        geometry::set<max_corner, I>(b, maxs[I]);
+        box_coordinates<Box, I + 1, N>::assign(b, mins, maxs);
+    }
+};
+
+template <typename Box, std::size_t N>
+struct box_coordinates<Box, N, N>
+{
+    template <typename T>
+    static inline void get(Box const& , T * , T * ) {}
+
+    template <typename T>
+    static inline void set(Box & , T const* const* , T const* const* , std::size_t ) {}
+
+    template <typename T>
+    static inline void assign(Box & , T const* , T const* ) {}
+};
+
+// The pointers to the sections of the data.
+template <typename Value, typename Box>
+struct data
+{
+    typedef typename geometry::coordinate_type<Box>::type coordinate_type;
+    static const std::size_t dimension = geometry::dimension<Box>::value;
+
+    data()
+        : nodes(0), values(0)
+        , nodes_count(0), values_count(0), first_leaf(0), leafs_level(0), max_children(0)
+        , quantization_bits(0)
+    {
+        for ( std::size_t d = 0 ; d < dimension ; ++d )
+        {
+            min_coords[d] = max_coords[d] = 0;
+            value_min_coords[d] = value_max_coords[d] = 0;
+            quantized_min_coords[d] = quantized_max_coords[d] = 0;
+        }
+    }
+
+    // The data must be kept alive as long as the view is used
+    data(const void * ptr, std::size_t size)
+    {
+        if ( size < sizeof(header) )
+            throw_invalid_argument("the size of the data is too small");
+
+        if ( reinterpret_cast<std::size_t>(ptr) % section_alignment != 0 )
+            throw_invalid_argument("the data is not aligned");
+
+        const char * bytes = static_cast<const char *>(ptr);
+        header const& h = *reinterpret_cast<header const*>(bytes);
+
+        if ( ! is_magic_ok(h) || h.version != format_version )
+            throw_invalid_argument("unrecognized format of the data");
+        if ( h.byte_order != byte_order_mark )
+            throw_invalid_argument("the data was written using different byte order");
+        if ( h.dimension != dimension
+          || h.coordinate_size != sizeof(coordinate_type)
+          || h.value_size != sizeof(Value) )
+            throw_invalid_argument("the data was written for different Value or Box type");
+        if ( ! is_quantization_supported(h.quantization_bits) )
+            throw_invalid_argument("the data is corrupted");
+
+        if ( h.size > size
+          || h.coordinates_stride < exact_boxes_count(h.nodes_count, h.quantization_bits) * sizeof(coordinate_type)
+          || h.coordinates_offset + 2 * dimension * h.coordinates_stride > h.size
+          || h.value_coordinates_stride < h.values_count * sizeof(coordinate_type)
+          || h.value_coordinates_offset + 2 * dimension * h.value_coordinates_stride > h.size
+          || ( h.quantization_bits != 0
+            && ( h.quantized_coordinates_stride < h.nodes_count * h.quantization_bits / 8
+              || h.quantized_coordinates_offset + 2 * dimension * h.quantized_coordinates_stride > h.size ) )
+          || h.nodes_offset + h.nodes_count * sizeof(node) > h.size
+          || h.values_offset + h.values_count * sizeof(Value) > h.size
+          || h.first_leaf > h.nodes_count )
+            throw_invalid_argument("the data is corrupted");
+
+        for ( std::size_t d = 0 ; d < dimension ; ++d )
+        {
+            boost::uint64_t const offset = h.coordinates_offset + 2 * d * h.coordinates_stride;
+            min_coords[d] = reinterpret_cast<const coordinate_type *>(bytes + offset);
+            max_coords[d] = reinterpret_cast<const coordinate_type *>(bytes + offset + h.coordinates_stride);
+
+            boost::uint64_t const value_offset = h.value_coordinates_offset + 2 * d * h.value_coordinates_stride;
+            value_min_coords[d] = reinterpret_cast<const coordinate_type *>(bytes + value_offset);
+            value_max_coords[d] = reinterpret_cast<const coordinate_type *>(bytes + value_offset + h.value_coordinates_stride);
+
+            boost::uint64_t const quantized_offset = h.quantized_coordinates_offset + 2 * d * h.quantized_coordinates_stride;
+            quantized_min_coords[d] = h.quantization_bits == 0 ? 0 : bytes + quantized_offset;
+            quantized_max_coords[d] = h.quantization_bits == 0 ? 0 : bytes + quantized_offset + h.quantized_coordinates_stride;
+        }
+        nodes = reinterpret_cast<const node *>(bytes + h.nodes_offset);
+        values = reinterpret_cast<const Value *>(bytes + h.values_offset);
+        nodes_count = static_cast<std::size_t>(h.nodes_count);
+        values_count = static_cast<std::size_t>(h.values_count);
+        first_leaf = static_cast<std::size_t>(h.first_leaf);
+        leafs_level = static_cast<std::size_t>(h.leafs_level);
+        max_children = static_cast<std::size_t>(h.max_children);
+        quantization_bits = h.quantization_bits;
+    }
+
+    bool is_leaf(std::size_t node_index) const
+    {
+        return first_leaf <= node_index;
+    }
+
+    bool is_quantized() const
+    {
+        return quantization_bits != 0;
+    }
+
+    // The box of the root or of any node if the boxes are not quantized
+    Box box(std::size_t node_index) const
+    {
+        BOOST_GEOMETRY_INDEX_ASSERT(node_index == 0 || ! is_quantized(), "the box of the parent is required");
+
+        Box result;
+        box_coordinates<Box>::set(result, min_coords, max_coords, node_index);
+        return result;
+    }
+
+    // The box of a child of the node having parent_box
+    Box box(std::size_t node_index, Box const& parent_box) const
+    {
+        if ( quantization_bits == 8 )
+            return quantized_box<boost::uint8_t>(node_index, parent_box);
+        else if ( quantization_bits == 16 )
+            return quantized_box<boost::uint16_t>(node_index, parent_box);
+        else
+            return box(node_index);
+    }
+
+    template <typename Q>
+    const Q * quantized_mins(std::size_t dim) const
+    {
+        return static_cast<const Q *>(quantized_min_coords[dim]);
+    }
+
+    template <typename Q>
+    const Q * quantized_maxs(std::size_t dim) const
+    {
+        return static_cast<const Q *>(quantized_max_coords[dim]);
+    }
+
+    const coordinate_type * min_coords[dimension];
+    const coordinate_type * max_coords[dimension];
+    const coordinate_type * value_min_coords[dimension];
+    const coordinate_type * value_max_coords[dimension];
+    const node * nodes;
+    const Value * values;
+    std::size_t nodes_count;
+    std::size_t values_count;
+    std::size_t first_leaf;
+    std::size_t leafs_level;
+    std::size_t max_children;
+    boost::uint32_t quantization_bits;
+    const void * quantized_min_coords[dimension];
+    const void * quantized_max_coords[dimension];
+
+private:
+    template <typename Q>
+    Box quantized_box(std::size_t node_index, Box const& parent_box) const
+    {
+        coordinate_type parent_mins[dimension];
+        coordinate_type parent_maxs[dimension];
+        box_coordinates<Box>::get(parent_box, parent_mins, parent_maxs);
+
+        coordinate_type mins[dimension];
+        coordinate_type maxs[dimension];
+        for ( std::size_t d = 0 ; d < dimension ; ++d )
+        {
+            dequantizer<coordinate_type> const deq(parent_mins[d], parent_maxs[d], max_quantized(quantization_bits));
+            mins[d] = deq(quantized_mins<Q>(d)[node_index]);
+            maxs[d] = deq(quantized_maxs<Q>(d)[node_index]);
+        }
+
+        Box result;
+        box_coordinates<Box>::assign(result, mins, maxs);
+        return result;
+    }
+};
+
+}}}}}} // namespace boost::geometry::index::detail::rtree::flat
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_FLAT_FORMAT_HPP
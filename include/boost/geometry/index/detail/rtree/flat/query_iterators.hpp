@@ -0,0 +1,416 @@
+// Boost.Geometry Index
+//
+// R-tree flat layout query iterators
+//
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_FLAT_QUERY_ITERATORS_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_FLAT_QUERY_ITERATORS_HPP
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <boost/geometry/util/select_most_precise.hpp>
+
+#include <boost/geometry/index/detail/rtree/flat/format.hpp>
+
+namespace boost { namespace geometry { namespace index { namespace detail { namespace rtree { namespace flat {
+
+template <typename Value>
+struct end_query_iterator
+{
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Value value_type;
+    typedef Value const& reference;
+    typedef std::ptrdiff_t difference_type;
+    typedef Value const* pointer;
+
+    reference operator*() const
+    {
+        BOOST_GEOMETRY_INDEX_ASSERT(false, "iterator not dereferencable");
+        pointer p(0);
+        return *p;
+    }
+
+    const value_type * operator->() const
+    {
+        BOOST_GEOMETRY_INDEX_ASSERT(false, "iterator not dereferencable");
+        const value_type * p = 0;
+        return p;
+    }
+
+    end_query_iterator & operator++()
+    {
+        BOOST_GEOMETRY_INDEX_ASSERT(false, "iterator not incrementable");
+        return *this;
+    }
+
+    end_query_iterator operator++(int)
+    {
+        BOOST_GEOMETRY_INDEX_ASSERT(false, "iterator not incrementable");
+        return *this;
+    }
+
+    friend bool operator==(end_query_iterator const& /*l*/, end_query_iterator const& /*r*/)
+    {
+        return true;
+    }
+};
+
+// Visits the nodes depth-first, like visitors::spatial_query_incremental.
+template <typename Value, typename Box, typename Translator, typename Predicates>
+class spatial_query_iterator
+{
+    typedef flat::data<Value, Box> data_type;
+
+    static const unsigned predicates_len = index::detail::predicates_length<Predicates>::value;
+
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Value value_type;
+    typedef Value const& reference;
+    typedef std::ptrdiff_t difference_type;
+    typedef Value const* pointer;
+
+    inline spatial_query_iterator()
+        : m_data(0), m_translator(0)
+        , m_current(0), m_last(0)
+    {}
+
+    inline spatial_query_iterator(data_type const& d, Translator const& t, Predicates const& p)
+        : m_data(boost::addressof(d)), m_translator(boost::addressof(t)), m_pred(p)
+        , m_current(0), m_last(0)
+    {
+        if ( 0 < m_data->nodes_count )
+        {
+            visit(0, m_data->box(0));
+            search_value();
+        }
+    }
+
+    reference operator*() const
+    {
+        BOOST_GEOMETRY_INDEX_ASSERT(m_current < m_last, "not dereferencable");
+        return m_data->values[m_current];
+    }
+
+    const value_type * operator->() const
+    {
+        return boost::addressof(operator*());
+    }
+
+    spatial_query_iterator & operator++()
+    {
+        ++m_current;
+        search_value();
+        return *this;
+    }
+
+    spatial_query_iterator operator++(int)
+    {
+        spatial_query_iterator temp = *this;
+        this->operator++();
+        return temp;
+    }
+
+    bool is_end() const
+    {
+        return m_current == m_last;
+    }
+
+    friend bool operator==(spatial_query_iterator const& l, spatial_query_iterator const& r)
+    {
+        return l.is_end() ? r.is_end() : ( ! r.is_end() && l.m_current == r.m_current );
+    }
+
+    friend bool operator==(spatial_query_iterator const& l, end_query_iterator<Value> const& /*r*/)
+    {
+        return l.is_end();
+    }
+
+    friend bool operator==(end_query_iterator<Value> const& /*l*/, spatial_query_iterator const& r)
+    {
+        return r.is_end();
+    }
+
+private:
+    // The children of the node on the stack, the first one not visited yet
+    // and the box of the node required to decode the boxes of the children.
+    struct internal_stack_element
+    {
+        internal_stack_element(std::size_t f, std::size_t l, Box const& b)
+            : first(f), last(l), box(b)
+        {}
+
+        std::size_t first;
+        std::size_t last;
+        Box box;
+    };
+
+    void visit(std::size_t node_index, Box const& node_box)
+    {
+        flat::node const& n = m_data->nodes[node_index];
+        std::size_t const first = static_cast<std::size_t>(n.first);
+        std::size_t const last = first + static_cast<std::size_t>(n.count);
+
+        if ( m_data->is_leaf(node_index) )
+        {
+            m_current = first;
+            m_last = last;
+        }
+        else
+        {
+            m_stack.push_back(internal_stack_element(first, last, node_box));
+        }
+    }
+
+    void search_value()
+    {
+        for (;;)
+        {
+            // move to the next value in the current leaf
+            if ( m_current < m_last )
+            {
+                Value const& v = m_data->values[m_current];
+                if ( index::detail::predicates_check<index::detail::value_tag, 0, predicates_len>(m_pred, v, (*m_translator)(v)) )
+                    return;
+
+                ++m_current;
+            }
+            // move to the next leaf
+            else
+            {
+                // no more nodes to traverse, m_current == m_last
+                if ( m_stack.empty() )
+                    return;
+
+                if ( m_stack.back().first == m_stack.back().last )
+                {
+                    m_stack.pop_back();
+                    continue;
+                }
+
+                std::size_t const child = m_stack.back().first;
+                ++m_stack.back().first;
+
+                Box const child_box = m_data->box(child, m_stack.back().box);
+                if ( index::detail::predicates_check<index::detail::bounds_tag, 0, predicates_len>(m_pred, 0, child_box) )
+                    visit(child, child_box);
+            }
+        }
+    }
+
+    const data_type * m_data;
+    const Translator * m_translator;
+    Predicates m_pred;
+
+    std::vector<internal_stack_element> m_stack;
+    std::size_t m_current;
+    std::size_t m_last;
+};
+
+// Incremental best-first k-nearest neighbors search (Hjaltason, Samet).
+// Both nodes and values are kept in one priority queue so the values
+// are returned in order of increasing distance.
+template <typename Value, typename Box, typename Translator, typename Predicates, unsigned DistancePredicateIndex>
+class distance_query_iterator
+{
+    typedef flat::data<Value, Box> data_type;
+
+    typedef index::detail::predicates_element<DistancePredicateIndex, Predicates> nearest_predicate_access;
+    typedef typename nearest_predicate_access::type nearest_predicate_type;
+    typedef typename index::detail::indexable_type<Translator>::type indexable_type;
+
+    typedef index::detail::calculate_distance<nearest_predicate_type, indexable_type, value_tag> calculate_value_distance;
+    typedef index::detail::calculate_distance<nearest_predicate_type, Box, bounds_tag> calculate_node_distance;
+    typedef typename geometry::select_most_precise
+        <
+            typename calculate_value_distance::result_type,
+            typename calculate_node_distance::result_type
+        >::type distance_type;
+
+    static const unsigned predicates_len = index::detail::predicates_length<Predicates>::value;
+
+    // The box of a node is required to decode the boxes of its children
+    struct entry
+    {
+        entry(distance_type const& d, std::size_t i, bool v, Box const& b = Box())
+            : distance(d), index(i), is_value(v), box(b)
+        {}
+
+        distance_type distance;
+        std::size_t index;
+        bool is_value;
+        Box box;
+    };
+
+    static inline bool entry_greater(entry const& l, entry const& r)
+    {
+        return l.distance > r.distance;
+    }
+
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Value value_type;
+    typedef Value const& reference;
+    typedef std::ptrdiff_t difference_type;
+    typedef Value const* pointer;
+
+    inline distance_query_iterator()
+        : m_data(0), m_translator(0)
+        , m_found(0)
+        , m_current(0), m_is_end(true)
+    {}
+
+    inline distance_query_iterator(data_type const& d, Translator const& t, Predicates const& p)
+        : m_data(boost::addressof(d)), m_translator(boost::addressof(t)), m_pred(p)
+        , m_found(0)
+        , m_current(0), m_is_end(false)
+    {
+        BOOST_GEOMETRY_INDEX_ASSERT(0 < max_count(), "k must be greather than 0");
+
+        if ( 0 < m_data->nodes_count )
+            m_queue.push_back(entry(distance_type(0), 0, false, m_data->box(0)));
+
+        increment();
+    }
+
+    reference operator*() const
+    {
+        BOOST_GEOMETRY_INDEX_ASSERT(! m_is_end, "not dereferencable");
+        return m_data->values[m_current];
+    }
+
+    const value_type * operator->() const
+    {
+        return boost::addressof(operator*());
+    }
+
+    distance_query_iterator & operator++()
+    {
+        increment();
+        return *this;
+    }
+
+    distance_query_iterator operator++(int)
+    {
+        distance_query_iterator temp = *this;
+        this->operator++();
+        return temp;
+    }
+
+    bool is_end() const
+    {
+        return m_is_end;
+    }
+
+    friend bool operator==(distance_query_iterator const& l, distance_query_iterator const& r)
+    {
+        return l.is_end() ? r.is_end() : ( ! r.is_end() && l.m_found == r.m_found && l.m_current == r.m_current );
+    }
+
+    friend bool operator==(distance_query_iterator const& l, end_query_iterator<Value> const& /*r*/)
+    {
+        return l.is_end();
+    }
+
+    friend bool operator==(end_query_iterator<Value> const& /*l*/, distance_query_iterator const& r)
+    {
+        return r.is_end();
+    }
+
+private:
+    void increment()
+    {
+        while ( m_found < max_count() && ! m_queue.empty() )
+        {
+            entry const e = m_queue.front();
+            std::pop_heap(m_queue.begin(), m_queue.end(), entry_greater);
+            m_queue.pop_back();
+
+            // the closest element in the queue is a value
+            if ( e.is_value )
+            {
+                m_current = e.index;
+                ++m_found;
+                return;
+            }
+
+            flat::node const& n = m_data->nodes[e.index];
+            std::size_t const first = static_cast<std::size_t>(n.first);
+            std::size_t const last = first + static_cast<std::size_t>(n.count);
+
+            if ( m_data->is_leaf(e.index) )
+            {
+                for ( std::size_t i = first ; i < last ; ++i )
+                {
+                    Value const& v = m_data->values[i];
+                    if ( index::detail::predicates_check<index::detail::value_tag, 0, predicates_len>(m_pred, v, (*m_translator)(v)) )
+                    {
+                        typename calculate_value_distance::result_type d;
+                        if ( calculate_value_distance::apply(predicate(), (*m_translator)(v), d) )
+                            push(entry(d, i, true));
+                    }
+                }
+            }
+            else
+            {
+                for ( std::size_t i = first ; i < last ; ++i )
+                {
+                    Box const box = m_data->box(i, e.box);
+                    if ( index::detail::predicates_check<index::detail::bounds_tag, 0, predicates_len>(m_pred, 0, box) )
+                    {
+                        typename calculate_node_distance::result_type d;
+                        if ( calculate_node_distance::apply(predicate(), box, d) )
+                            push(entry(d, i, false, box));
+                    }
+                }
+            }
+        }
+
+        m_is_end = true;
+        m_queue.clear();
+    }
+
+    void push(entry const& e)
+    {
+        m_queue.push_back(e);
+        std::push_heap(m_queue.begin(), m_queue.end(), entry_greater);
+    }
+
+    std::size_t max_count() const
+    {
+        return nearest_predicate_access::get(m_pred).count;
+    }
+
+    nearest_predicate_type const& predicate() const
+    {
+        return nearest_predicate_access::get(m_pred);
+    }
+
+    const data_type * m_data;
+    const Translator * m_translator;
+    Predicates m_pred;
+
+    std::vector<entry> m_queue;
+    std::size_t m_found;
+    std::size_t m_current;
+    bool m_is_end;
+};
+
+template <typename L, typename R>
+inline bool operator!=(L const& l, R const& r)
+{
+    return !(l == r);
+}
+
+}}}}}} // namespace boost::geometry::index::detail::rtree::flat
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_FLAT_QUERY_ITERATORS_HPP
@@ -0,0 +1,377 @@
+// Boost.Geometry Index
+//
+// R-tree flat layout writer
+//
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_FLAT_WRITE_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_FLAT_WRITE_HPP
+
+#include <cmath>
+#include <ostream>
+#include <vector>
+
+#include <boost/type_traits/is_floating_point.hpp>
+
+#include <boost/geometry/index/detail/algorithms/bounds.hpp>
+#include <boost/geometry/index/detail/rtree/flat/format.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/view.hpp>
+
+namespace boost { namespace geometry { namespace index { namespace detail { namespace rtree { namespace flat {
+
+namespace visitors {
+
+// Gathers the nodes of the tree in breadth-first order.
+// The visitor is applied to the root and the rest of the nodes
+// are visited in the loop started in the root.
+template <typename Value, typename Options, typename Box, typename Allocators>
+class gather_nodes
+    : public rtree::visitor<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag, true>::type
+{
+    typedef typename rtree::internal_node<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag>::type internal_node;
+    typedef typename rtree::leaf<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag>::type leaf;
+    typedef typename Allocators::node_pointer node_pointer;
+
+public:
+    inline explicit gather_nodes(Box const& root_box)
+        : first_leaf(0), leafs_level(0), max_children(0)
+        , m_current(0), m_traversing(false)
+    {
+        boxes.push_back(root_box);
+    }
+
+    inline void operator()(internal_node const& n)
+    {
+        typedef typename rtree::elements_type<internal_node>::type elements_type;
+        elements_type const& elements = rtree::elements(n);
+
+        // the children are placed at the end of the queue
+        flat::node fn;
+        fn.first = 1 + m_queue.size();
+        fn.count = elements.size();
+        nodes.push_back(fn);
+
+        if ( max_children < elements.size() )
+            max_children = elements.size();
+
+        for (typename elements_type::const_iterator it = elements.begin();
+            it != elements.end(); ++it)
+        {
+            boxes.push_back(it->first);
+            m_queue.push_back(it->second);
+        }
+
+        if ( m_traversing )
+            return;
+
+        m_traversing = true;
+        // the index of a node in the queue is equal to its index - 1
+        // the nodes are gathered level by level so first_leaf is known
+        // when the first leaf is visited
+        for ( m_current = 0 ; m_current < m_queue.size() ; ++m_current )
+            rtree::apply_visitor(*this, *m_queue[m_current]);
+        m_traversing = false;
+    }
+
+    inline void operator()(leaf const& n)
+    {
+        typedef typename rtree::elements_type<leaf>::type elements_type;
+        elements_type const& elements = rtree::elements(n);
+
+        if ( values.empty() )
+        {
+            first_leaf = nodes.size();
+            // the first child of the first node of a level is
+            // the first node of the next level
+            for ( std::size_t level_first = 0 ; level_first < first_leaf ; ++leafs_level )
+                level_first = static_cast<std::size_t>(nodes[level_first].first);
+        }
+
+        flat::node fn;
+        fn.first = values.size();
+        fn.count = elements.size();
+        nodes.push_back(fn);
+
+        if ( max_children < elements.size() )
+            max_children = elements.size();
+
+        for (typename elements_type::const_iterator it = elements.begin();
+            it != elements.end(); ++it)
+        {
+            values.push_back(boost::addressof(*it));
+        }
+    }
+
+    std::vector<Box> boxes;
+    std::vector<flat::node> nodes;
+    std::vector<const Value *> values;
+    std::size_t first_leaf;
+    std::size_t leafs_level;
+    std::size_t max_children;
+
+private:
+    std::vector<node_pointer> m_queue;
+    std::size_t m_current;
+    bool m_traversing;
+};
+
+} // namespace visitors
+
+inline void write_padding(std::ostream & os, boost::uint64_t & offset, boost::uint64_t new_offset)
+{
+    for ( ; offset < new_offset ; ++offset )
+        os.put(0);
+}
+
+template <typename T>
+inline void write_raw(std::ostream & os, boost::uint64_t & offset, T const& v)
+{
+    os.write(reinterpret_cast<const char *>(boost::addressof(v)), sizeof(T));
+    offset += sizeof(T);
+}
+
+// Writes the coordinates of first count boxes as structure of arrays
+template <typename Box>
+inline void write_coordinates(std::ostream & os, boost::uint64_t & offset,
+                              std::vector<Box> const& boxes,
+                              std::size_t count,
+                              boost::uint64_t coordinates_offset,
+                              boost::uint64_t coordinates_stride)
+{
+    typedef typename geometry::coordinate_type<Box>::type coordinate_type;
+    static const std::size_t dimension = geometry::dimension<Box>::value;
+
+    std::vector<coordinate_type> coordinates(2 * dimension * count);
+    for ( std::size_t i = 0 ; i < count ; ++i )
+    {
+        coordinate_type mins[dimension];
+        coordinate_type maxs[dimension];
+        box_coordinates<Box>::get(boxes[i], mins, maxs);
+        for ( std::size_t d = 0 ; d < dimension ; ++d )
+        {
+            coordinates[2 * d * count + i] = mins[d];
+            coordinates[(2 * d + 1) * count + i] = maxs[d];
+        }
+    }
+
+    for ( std::size_t a = 0 ; a < 2 * dimension ; ++a )
+    {
+        write_padding(os, offset, coordinates_offset + a * coordinates_stride);
+        for ( std::size_t i = 0 ; i < count ; ++i )
+            write_raw(os, offset, coordinates[a * count + i]);
+    }
+}
+
+// Rounds the coordinate outward to the grid of the parent box.
+// The initial estimate is corrected so the decoded coordinate
+// is not greater than the min coordinate or not less than the max one.
+template <typename T>
+inline boost::uint32_t quantize_min(dequantizer<T> const& deq, T const& v)
+{
+    boost::uint32_t q = 0;
+    if ( deq.lo < deq.hi )
+    {
+        double const t = static_cast<double>(v - deq.lo) / static_cast<double>(deq.hi - deq.lo) * deq.max_quantized;
+        q = t <= 0 ? 0 : t >= deq.max_quantized ? deq.max_quantized : static_cast<boost::uint32_t>(t);
+    }
+    while ( 0 < q && v < deq(q) )
+        --q;
+    return q;
+}
+
+template <typename T>
+inline boost::uint32_t quantize_max(dequantizer<T> const& deq, T const& v)
+{
+    boost::uint32_t q = deq.max_quantized;
+    if ( deq.lo < deq.hi )
+    {
+        double const t = std::ceil(static_cast<double>(v - deq.lo) / static_cast<double>(deq.hi - deq.lo) * deq.max_quantized);
+        q = t <= 0 ? 0 : t >= deq.max_quantized ? deq.max_quantized : static_cast<boost::uint32_t>(t);
+    }
+    while ( q < deq.max_quantized && deq(q) < v )
+        ++q;
+    return q;
+}
+
+// Writes the coordinates of boxes of nodes quantized relative to the boxes of parents,
+// as structure of arrays. The boxes are decoded while traversing the nodes so
+// the children of a node are encoded relative to the same box the reader gets.
+template <typename Q, typename Box>
+inline void write_quantized_coordinates(std::ostream & os, boost::uint64_t & offset,
+                                        std::vector<Box> const& boxes,
+                                        std::vector<flat::node> const& nodes,
+                                        std::size_t first_leaf,
+                                        boost::uint32_t quantization_bits,
+                                        boost::uint64_t coordinates_offset,
+                                        boost::uint64_t coordinates_stride)
+{
+    typedef typename geometry::coordinate_type<Box>::type coordinate_type;
+    static const std::size_t dimension = geometry::dimension<Box>::value;
+
+    std::size_t const count = boxes.size();
+    if ( count == 0 )
+        return;
+
+    boost::uint32_t const max_q = max_quantized(quantization_bits);
+    std::vector<Q> coordinates(2 * dimension * count);
+    std::vector<coordinate_type> decoded(2 * dimension * count);
+
+    // the root is stored exactly, the whole range of its own box
+    box_coordinates<Box>::get(boxes[0], &decoded[0], &decoded[dimension]);
+    for ( std::size_t d = 0 ; d < dimension ; ++d )
+    {
+        coordinates[2 * d * count] = 0;
+        coordinates[(2 * d + 1) * count] = static_cast<Q>(max_q);
+    }
+
+    for ( std::size_t p = 0 ; p < first_leaf ; ++p )
+    {
+        std::size_t const first = static_cast<std::size_t>(nodes[p].first);
+        std::size_t const last = first + static_cast<std::size_t>(nodes[p].count);
+        coordinate_type const* const parent_mins = &decoded[2 * dimension * p];
+        coordinate_type const* const parent_maxs = parent_mins + dimension;
+
+        for ( std::size_t i = first ; i < last ; ++i )
+        {
+            coordinate_type mins[dimension];
+            coordinate_type maxs[dimension];
+            box_coordinates<Box>::get(boxes[i], mins, maxs);
+
+            coordinate_type * const decoded_mins = &decoded[2 * dimension * i];
+            coordinate_type * const decoded_maxs = decoded_mins + dimension;
+
+            for ( std::size_t d = 0 ; d < dimension ; ++d )
+            {
+                dequantizer<coordinate_type> const deq(parent_mins[d], parent_maxs[d], max_q);
+                boost::uint32_t const qmin = quantize_min(deq, mins[d]);
+                boost::uint32_t const qmax = quantize_max(deq, maxs[d]);
+                coordinates[2 * d * count + i] = static_cast<Q>(qmin);
+                coordinates[(2 * d + 1) * count + i] = static_cast<Q>(qmax);
+                decoded_mins[d] = deq(qmin);
+                decoded_maxs[d] = deq(qmax);
+            }
+        }
+    }
+
+    for ( std::size_t a = 0 ; a < 2 * dimension ; ++a )
+    {
+        write_padding(os, offset, coordinates_offset + a * coordinates_stride);
+        for ( std::size_t i = 0 ; i < count ; ++i )
+            write_raw(os, offset, coordinates[a * count + i]);
+    }
+}
+
+/*!
+\brief Writes the rtree in the flat, pointer-free layout.
+
+The data written by this function may be read by flat_view, e.g. directly
+from the memory mapped file. The layout of the data reflects the structure
+of the tree so the best query performance is achieved for the trees created
+with the packing algorithm.
+
+Value and Box types must be trivially copyable. The data is written
+in the native representation of the platform.
+
+The boxes of the nodes may be quantized, i.e. stored as 8- or 16-bit integers
+relative to the box of the parent node. The quantized boxes are rounded outward
+so the queries return the same values but more nodes may be visited. The values
+and their boxes are stored exactly. For 2d boxes of doubles the 16-bit
+quantization reduces the size of the boxes of the nodes 4 times.
+
+\param tree                 The rtree.
+\param os                   The output stream. The stream should be opened in binary mode.
+\param quantization_bits    0 (exact boxes), 8 or 16. Quantization requires
+                            floating point coordinates.
+
+\par Throws
+std::invalid_argument if the quantization is not supported.
+*/
+template <typename Rtree>
+inline void write_flat(Rtree const& tree, std::ostream & os, unsigned quantization_bits = 0)
+{
+    typedef utilities::view<Rtree> RTV;
+    RTV rtv(tree);
+
+    typedef typename RTV::value_type value_type;
+    typedef typename RTV::box_type box_type;
+
+    visitors::gather_nodes
+        <
+            value_type,
+            typename RTV::options_type,
+            box_type,
+            typename RTV::allocators_type
+        > gather_v(tree.bounds());
+
+    rtv.apply_visitor(gather_v);
+
+    // the root wasn't visited
+    if ( tree.empty() )
+        gather_v.boxes.clear();
+
+    typedef typename geometry::coordinate_type<box_type>::type coordinate_type;
+    static const std::size_t dimension = geometry::dimension<box_type>::value;
+
+    if ( ! is_quantization_supported(quantization_bits)
+      || ( quantization_bits != 0 && ! boost::is_floating_point<coordinate_type>::value ) )
+        throw_invalid_argument("unsupported quantization");
+
+    header h;
+    std::memset(&h, 0, sizeof(header));
+    set_magic(h);
+    h.version = format_version;
+    h.byte_order = byte_order_mark;
+    h.dimension = dimension;
+    h.coordinate_size = sizeof(coordinate_type);
+    h.value_size = sizeof(value_type);
+    h.max_children = static_cast<boost::uint32_t>(gather_v.max_children);
+    h.values_count = gather_v.values.size();
+    h.nodes_count = gather_v.nodes.size();
+    h.first_leaf = gather_v.first_leaf;
+    h.leafs_level = gather_v.leafs_level;
+    h.quantization_bits = quantization_bits;
+    h.coordinates_offset = aligned_offset(sizeof(header));
+    h.coordinates_stride = aligned_offset(exact_boxes_count(h.nodes_count, h.quantization_bits) * sizeof(coordinate_type));
+    h.value_coordinates_offset = h.coordinates_offset + 2 * dimension * h.coordinates_stride;
+    h.value_coordinates_stride = aligned_offset(h.values_count * sizeof(coordinate_type));
+    h.quantized_coordinates_offset = h.value_coordinates_offset + 2 * dimension * h.value_coordinates_stride;
+    h.quantized_coordinates_stride = aligned_offset(h.nodes_count * h.quantization_bits / 8);
+    h.nodes_offset = h.quantized_coordinates_offset + 2 * dimension * h.quantized_coordinates_stride;
+    h.values_offset = aligned_offset(h.nodes_offset + h.nodes_count * sizeof(flat::node));
+    h.size = h.values_offset + h.values_count * sizeof(value_type);
+
+    boost::uint64_t offset = 0;
+    write_raw(os, offset, h);
+
+    std::vector<box_type> value_boxes(gather_v.values.size());
+    for ( std::size_t i = 0 ; i < gather_v.values.size() ; ++i )
+        index::detail::bounds(rtv.translator()(*gather_v.values[i]), value_boxes[i]);
+
+    // only the box of the root is stored exactly if the boxes are quantized
+    write_coordinates(os, offset, gather_v.boxes, static_cast<std::size_t>(exact_boxes_count(h.nodes_count, h.quantization_bits)),
+                      h.coordinates_offset, h.coordinates_stride);
+    write_coordinates(os, offset, value_boxes, value_boxes.size(), h.value_coordinates_offset, h.value_coordinates_stride);
+
+    if ( quantization_bits == 8 )
+        write_quantized_coordinates<boost::uint8_t>(os, offset, gather_v.boxes, gather_v.nodes, gather_v.first_leaf,
+                                                    quantization_bits, h.quantized_coordinates_offset, h.quantized_coordinates_stride);
+    else if ( quantization_bits == 16 )
+        write_quantized_coordinates<boost::uint16_t>(os, offset, gather_v.boxes, gather_v.nodes, gather_v.first_leaf,
+                                                     quantization_bits, h.quantized_coordinates_offset, h.quantized_coordinates_stride);
+
+    write_padding(os, offset, h.nodes_offset);
+    for ( std::size_t i = 0 ; i < gather_v.nodes.size() ; ++i )
+        write_raw(os, offset, gather_v.nodes[i]);
+
+    write_padding(os, offset, h.values_offset);
+    for ( std::size_t i = 0 ; i < gather_v.values.size() ; ++i )
+        write_raw(os, offset, *gather_v.values[i]);
+}
+
+}}}}}} // namespace boost::geometry::index::detail::rtree::flat
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_FLAT_WRITE_HPP
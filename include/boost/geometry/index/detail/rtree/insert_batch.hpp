@@ -0,0 +1,391 @@
+// Boost.Geometry Index
+//
+// R-tree batch insert
+//
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_INSERT_BATCH_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_INSERT_BATCH_HPP
+
+#include <iterator>
+#include <limits>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/type_traits/is_same.hpp>
+
+#include <boost/geometry/algorithms/centroid.hpp>
+#include <boost/geometry/algorithms/detail/expand_by_epsilon.hpp>
+#include <boost/geometry/util/condition.hpp>
+
+#include <boost/geometry/index/detail/algorithms/bounds.hpp>
+#include <boost/geometry/index/detail/algorithms/content.hpp>
+#include <boost/geometry/index/detail/algorithms/radix_sort.hpp>
+#include <boost/geometry/index/detail/rtree/pack_create.hpp>
+#include <boost/geometry/index/detail/rtree/visitors/insert.hpp>
+
+namespace boost { namespace geometry { namespace index { namespace detail { namespace rtree {
+
+// Inserts a range of values into an existing tree.
+//
+// The values are sorted by the Hilbert curve index of their centroids. Then
+// the tree is traversed once. In each internal node the next node is chosen
+// for every value with the choose_next_node algorithm of the tree, the values
+// are grouped by the chosen children, preserving the order, and each group is
+// passed to its child. So a node is visited once for all values inserted into
+// its subtree. In a leaf the values are added one by one. When a node overflows
+// it's split with the split algorithm of the tree and the next values or nodes
+// are added to the node which box needs the smallest enlargement. The nodes
+// created by splits are added to the parent after all groups are processed
+// and the parent is split in the same way. If the root is split new levels
+// are added on top of it.
+//
+// The R*-tree forced reinsertions are not performed.
+template <typename Value, typename Options, typename Translator, typename Box, typename Allocators>
+class insert_batch
+{
+    typedef typename Options::parameters_type parameters_type;
+
+    typedef typename rtree::node<Value, parameters_type, Box, Allocators, typename Options::node_tag>::type node;
+    typedef typename rtree::internal_node<Value, parameters_type, Box, Allocators, typename Options::node_tag>::type internal_node;
+    typedef typename rtree::leaf<Value, parameters_type, Box, Allocators, typename Options::node_tag>::type leaf;
+
+    typedef typename Allocators::node_pointer node_pointer;
+    typedef typename Allocators::size_type size_type;
+    typedef rtree::subtree_destroyer<Value, Options, Translator, Box, Allocators> subtree_destroyer;
+
+    typedef typename rtree::elements_type<internal_node>::type internal_elements;
+    typedef typename internal_elements::value_type internal_element;
+
+    typedef rtree::choose_next_node<Value, Options, Box, Allocators, typename Options::choose_next_node_tag> choose_next_node;
+    typedef rtree::split<Value, Options, Translator, Box, Allocators, typename Options::split_tag> split_algo;
+
+    typedef typename geometry::point_type<Box>::type point_type;
+    typedef typename index::detail::default_content_result<Box>::type content_type;
+    static const std::size_t dimension = geometry::dimension<Box>::value;
+
+    // The nodes of one level: the node into which the elements are inserted
+    // first and the nodes created by the splits after it.
+    typedef std::vector<internal_element> nodes_type;
+
+    // Destroys the subtrees of nodes [first, nodes.size()) unless released.
+    struct nodes_guard
+    {
+        nodes_guard(nodes_type & n, std::size_t f, Allocators & a)
+            : nodes(n), first(f), allocators(a), released(false)
+        {}
+
+        ~nodes_guard()
+        {
+            if ( released )
+                return;
+
+            for ( std::size_t i = first ; i < nodes.size() ; ++i )
+                subtree_destroyer dummy(nodes[i].second, allocators);
+        }
+
+        void release()
+        {
+            released = true;
+        }
+
+        nodes_type & nodes;
+        std::size_t first;
+        Allocators & allocators;
+        bool released;
+    };
+
+public:
+    template <typename FwdIt> inline static
+    void apply(node_pointer & root, size_type & leafs_level,
+               FwdIt first, FwdIt last,
+               parameters_type const& parameters, Translator const& translator, Allocators & allocators)
+    {
+        BOOST_GEOMETRY_INDEX_ASSERT(root, "The root must exist");
+
+        std::vector<FwdIt> entries;
+        sort_by_curve(first, last, translator, entries);
+        if ( entries.empty() )
+            return;
+
+        insert_batch ib(parameters, translator, allocators);
+
+        nodes_type nodes;
+        nodes.push_back(rtree::make_ptr_pair(ib.root_box(root, leafs_level), root));                 // MAY THROW (E: alloc, copy)
+        nodes_guard guard(nodes, 1, allocators);
+
+        ib.insert_into(nodes, 0, leafs_level, entries.begin(), entries.end());                        // MAY THROW (V, E: alloc, copy, N: alloc)
+
+        // the root was split - add levels
+        while ( 1 < nodes.size() )
+        {
+            nodes_type upper;
+            upper.reserve(2);                                                                          // MAY THROW (E: alloc)
+            nodes_guard upper_guard(upper, 1, allocators);
+
+            // the old root is the first child of the new root
+            node_pointer new_root = rtree::create_node<Allocators, internal_node>::apply(allocators); // MAY THROW (N: alloc)
+            {
+                subtree_destroyer new_root_guard(new_root, allocators);
+                rtree::elements(rtree::get<internal_node>(*new_root)).push_back(nodes[0]);            // MAY THROW, STRONG (E: alloc, copy)
+                new_root_guard.release();
+            }
+            upper.push_back(rtree::make_ptr_pair(nodes[0].first, new_root));
+            root = new_root;
+            ++leafs_level;
+
+            for ( std::size_t i = 1 ; i < nodes.size() ; ++i )
+            {
+                ib.template add_element<internal_node>(upper, nodes[i], nodes[i].first);              // MAY THROW (E: alloc, copy, N: alloc)
+                guard.first = i + 1;
+            }
+
+            ib.template update_nodes<internal_node>(upper);
+
+            // the nodes created by the splits of the new root are guarded now
+            upper_guard.release();
+            nodes.swap(upper);
+            guard.first = 1;
+        }
+
+        guard.release();
+    }
+
+private:
+    insert_batch(parameters_type const& parameters, Translator const& translator, Allocators & allocators)
+        : m_parameters(parameters), m_translator(translator), m_allocators(allocators)
+    {}
+
+    template <typename FwdIt> inline static
+    void sort_by_curve(FwdIt first, FwdIt last, Translator const& translator, std::vector<FwdIt> & result)
+    {
+        std::vector<std::pair<point_type, FwdIt> > entries;
+        Box hint_box;
+        geometry::assign_inverse(hint_box);
+
+        for ( ; first != last ; ++first )
+        {
+            typename std::iterator_traits<FwdIt>::reference in_ref = *first;
+            typename Translator::result_type indexable = translator(in_ref);
+
+            // CONSIDER: alternative - ignore invalid indexable or throw an exception
+            BOOST_GEOMETRY_INDEX_ASSERT(detail::is_valid(indexable), "Indexable is invalid");
+
+            geometry::expand(hint_box, indexable);
+
+            point_type pt;
+            geometry::centroid(indexable, pt);
+            entries.push_back(std::make_pair(pt, first));
+        }
+
+        std::vector<std::pair<boost::uint64_t, std::size_t> > keys(entries.size());
+        for ( std::size_t i = 0 ; i < entries.size() ; ++i )
+        {
+            keys[i].first = pack_utils::curve_key<dimension>::apply(entries[i].first, hint_box, index::packing::hilbert);
+            keys[i].second = i;
+        }
+
+        index::detail::radix_sort(keys, 1);
+
+        result.reserve(entries.size());
+        for ( std::size_t i = 0 ; i < keys.size() ; ++i )
+            result.push_back(entries[keys[i].second].second);
+    }
+
+    // Inserts the values [first, last) into the subtree of nodes[0] at level.
+    // The nodes created by the splits are appended to nodes.
+    template <typename EIt>
+    void insert_into(nodes_type & nodes, size_type level, size_type leafs_level, EIt first, EIt last)
+    {
+        if ( level == leafs_level )
+        {
+            for ( ; first != last ; ++first )
+            {
+                Value const& v = **first;
+                add_element<leaf>(nodes, v, element_bounds(v));                                       // MAY THROW (V: alloc, copy, N: alloc)
+            }
+
+            update_nodes<leaf>(nodes);
+            return;
+        }
+
+        internal_node & n = rtree::get<internal_node>(*nodes[0].second);
+        internal_elements & children = rtree::elements(n);
+        std::size_t const children_count = children.size();
+        std::size_t const count = static_cast<std::size_t>(std::distance(first, last));
+
+        // choose the child for each value and group the values by children, preserving the order
+        std::vector<std::size_t> chosen(count);
+        std::vector<std::size_t> offsets(children_count + 1, 0);
+        std::size_t i = 0;
+        for ( EIt it = first ; it != last ; ++it, ++i )
+        {
+            Value const& v = **it;
+            std::size_t const c = choose_next_node::apply(n, m_translator(v), m_parameters, leafs_level - level);
+            geometry::expand(children[c].first, element_bounds(v));
+            chosen[i] = c;
+            ++offsets[c + 1];
+        }
+        for ( std::size_t c = 0 ; c < children_count ; ++c )
+            offsets[c + 1] += offsets[c];
+
+        typedef typename std::iterator_traits<EIt>::value_type entry_type;
+        std::vector<entry_type> grouped(count);
+        {
+            std::vector<std::size_t> positions(offsets.begin(), offsets.end() - 1);
+            i = 0;
+            for ( EIt it = first ; it != last ; ++it, ++i )
+                grouped[positions[chosen[i]]++] = *it;
+        }
+
+        // the nodes created by the splits of the children
+        nodes_type pending;
+        nodes_guard pending_guard(pending, 0, m_allocators);
+
+        for ( std::size_t c = 0 ; c < children_count ; ++c )
+        {
+            if ( offsets[c] == offsets[c + 1] )
+                continue;
+
+            nodes_type child_nodes;
+            child_nodes.push_back(children[c]);                                                       // MAY THROW (E: alloc, copy)
+            nodes_guard child_guard(child_nodes, 1, m_allocators);
+
+            insert_into(child_nodes, level + 1, leafs_level,
+                        grouped.begin() + offsets[c], grouped.begin() + offsets[c + 1]);              // MAY THROW (V, E: alloc, copy, N: alloc)
+
+            children[c] = child_nodes[0];
+            pending.reserve(pending.size() + child_nodes.size() - 1);                                 // MAY THROW (E: alloc)
+            pending.insert(pending.end(), child_nodes.begin() + 1, child_nodes.end());
+            child_guard.release();
+        }
+
+        nodes[0].first = rtree::elements_box<Box>(children.begin(), children.end(), m_translator);
+
+        for ( std::size_t p = 0 ; p < pending.size() ; ++p )
+        {
+            add_element<internal_node>(nodes, pending[p], pending[p].first);                          // MAY THROW (E: alloc, copy, N: alloc)
+            pending_guard.first = p + 1;
+        }
+
+        pending_guard.release();
+
+        update_nodes<internal_node>(nodes);
+    }
+
+    // Adds the element to the node which box needs the smallest enlargement
+    // and splits this node if it overflows.
+    template <typename Node, typename Element>
+    void add_element(nodes_type & nodes, Element const& element, Box const& element_box)
+    {
+        std::size_t const chosen = choose_node(nodes, element_box);
+        Node & n = rtree::get<Node>(*nodes[chosen].second);
+
+        rtree::elements(n).push_back(element);                                                        // MAY THROW, STRONG (V, E: alloc, copy)
+        geometry::expand(nodes[chosen].first, element_box);
+
+        if ( m_parameters.get_max_elements() < rtree::elements(n).size() )
+        {
+            nodes.reserve(nodes.size() + 1);                                                          // MAY THROW (E: alloc)
+
+            typename split_algo::nodes_container_type additional_nodes;
+            Box n_box;
+            split_algo::apply(additional_nodes, n, n_box, m_parameters, m_translator, m_allocators);  // MAY THROW (V, E: alloc, copy, N: alloc)
+
+            BOOST_GEOMETRY_INDEX_ASSERT(additional_nodes.size() == 1, "unexpected number of additional nodes");
+
+            nodes[chosen].first = n_box;
+            nodes.push_back(additional_nodes[0]);
+        }
+    }
+
+    std::size_t choose_node(nodes_type const& nodes, Box const& element_box) const
+    {
+        std::size_t result = 0;
+        if ( nodes.size() == 1 )
+            return result;
+
+        content_type smallest_content_diff = (std::numeric_limits<content_type>::max)();
+        content_type smallest_content = (std::numeric_limits<content_type>::max)();
+
+        for ( std::size_t i = 0 ; i < nodes.size() ; ++i )
+        {
+            Box box_exp(nodes[i].first);
+            geometry::expand(box_exp, element_box);
+
+            content_type const content = index::detail::content(box_exp);
+            content_type const content_diff = content - index::detail::content(nodes[i].first);
+
+            if ( content_diff < smallest_content_diff ||
+                ( content_diff == smallest_content_diff && content < smallest_content ) )
+            {
+                smallest_content_diff = content_diff;
+                smallest_content = content;
+                result = i;
+            }
+        }
+
+        return result;
+    }
+
+    // Calculates the exact boxes and the aggregates of the nodes after all elements were added.
+    template <typename Node>
+    void update_nodes(nodes_type & nodes) const
+    {
+        for ( std::size_t i = 0 ; i < nodes.size() ; ++i )
+        {
+            Node & n = rtree::get<Node>(*nodes[i].second);
+            nodes[i].first = node_box(n);
+            rtree::update_aggregate<Value, Options, Box, Allocators>::apply(n, m_parameters);
+        }
+    }
+
+    Box node_box(leaf const& n) const
+    {
+        return rtree::values_box<Box>(rtree::elements(n).begin(), rtree::elements(n).end(), m_translator);
+    }
+
+    Box node_box(internal_node const& n) const
+    {
+        return rtree::elements_box<Box>(rtree::elements(n).begin(), rtree::elements(n).end(), m_translator);
+    }
+
+    Box root_box(node_pointer root, size_type leafs_level) const
+    {
+        return 0 == leafs_level
+             ? node_box(rtree::get<leaf>(*root))
+             : node_box(rtree::get<internal_node>(*root));
+    }
+
+    Box element_bounds(Value const& v) const
+    {
+        Box result;
+        index::detail::bounds(m_translator(v), result);
+
+#ifdef BOOST_GEOMETRY_INDEX_EXPERIMENTAL_ENLARGE_BY_EPSILON
+        // the same as in the insert visitor
+        if (BOOST_GEOMETRY_CONDITION((
+                ! index::detail::is_bounding_geometry
+                    <
+                        typename indexable_type<Translator>::type
+                    >::value )) )
+        {
+            geometry::detail::expand_by_epsilon(result);
+        }
+#endif
+
+        return result;
+    }
+
+    parameters_type const& m_parameters;
+    Translator const& m_translator;
+    Allocators & m_allocators;
+};
+
+}}}}} // namespace boost::geometry::index::detail::rtree
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_INSERT_BATCH_HPP
@@ -0,0 +1,314 @@
+// Boost.Geometry Index
+//
+// R-tree all k-nearest neighbors and k-nearest neighbors join
+//
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_KNN_JOIN_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_KNN_JOIN_HPP
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <boost/core/addressof.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/mpl/assert.hpp>
+#include <boost/type_traits/is_same.hpp>
+
+#include <boost/geometry/algorithms/assign.hpp>
+#include <boost/geometry/algorithms/expand.hpp>
+
+#include <boost/geometry/index/detail/algorithms/radix_sort.hpp>
+#include <boost/geometry/index/detail/rtree/pack_create.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/view.hpp>
+#include <boost/geometry/index/detail/rtree/visitors/distance_query.hpp>
+
+#include <boost/geometry/util/parallel.hpp>
+
+namespace boost { namespace geometry { namespace index { namespace detail { namespace rtree {
+
+// Finds k nearest values stored in the rtree for each of many query points.
+// Instead of performing a separate k-NN query for each point the points close
+// to each other are grouped and the queries of a group are performed during one
+// traversal of the tree (see visitors::distance_query_group). The points passed
+// as a range are sorted along the Hilbert curve and divided into groups of at most
+// max elements of the rtree. The points stored in the other rtree are grouped by
+// the leafs of this rtree.
+//
+// The groups are divided into contiguous chunks, one chunk per thread. The neighbors
+// are stored and then written in the order of the queries, the range of points
+// or the leafs of the other rtree in the order of their traversal. The neighbors
+// of a query are written in the same order as by the k-NN query.
+template <typename Rtree, typename QueryValue, typename QueryPoint>
+class knn_join
+{
+    typedef utilities::view<Rtree> view_type;
+
+    typedef typename view_type::value_type value_type;
+    typedef typename view_type::options_type options_type;
+    typedef typename view_type::box_type box_type;
+    typedef typename view_type::allocators_type allocators_type;
+    typedef typename view_type::translator_type translator_type;
+    typedef typename view_type::size_type size_type;
+
+    BOOST_MPL_ASSERT_MSG((boost::is_same<typename geometry::tag<QueryPoint>::type, geometry::point_tag>::value),
+                         QUERY_GEOMETRY_MUST_BE_A_POINT,
+                         (QueryPoint));
+
+    typedef visitors::distance_query_group
+        <
+            value_type, options_type, translator_type, box_type, allocators_type, QueryPoint
+        > group_visitor_type;
+
+    typedef typename group_visitor_type::nearest_predicate_type nearest_predicate_type;
+    typedef typename group_visitor_type::found_type found_type;
+
+    struct chunk_result
+    {
+        found_type found;
+        std::vector<size_type> counts;
+    };
+
+    struct chunk_query
+    {
+        chunk_query(Rtree const& r, std::vector<QueryPoint> const& p, unsigned k_,
+                    std::vector<std::size_t> const& o, std::vector<std::size_t> const& g,
+                    std::vector<chunk_result> & c)
+            : rt(r), points(p), k(k_), order(o), groups(g), chunks(c)
+        {}
+
+        void operator()(std::size_t first, std::size_t last, std::size_t chunk_index)
+        {
+            view_type rtv(rt);
+            translator_type const tr = rtv.translator();
+            chunk_result & result = chunks[chunk_index];
+
+            std::size_t const max_count = (std::min)(std::size_t(k), std::size_t(rt.size()));
+            result.counts.reserve(groups[last] - groups[first]);
+            result.found.reserve((groups[last] - groups[first]) * max_count);
+
+            // the visitor and the predicates are reused by all groups of the chunk
+            group_visitor_type group_v(tr, k);
+            std::vector<nearest_predicate_type> predicates;
+            for ( std::size_t g = first ; g < last ; ++g )
+            {
+                predicates.clear();
+                for ( std::size_t i = groups[g] ; i < groups[g + 1] ; ++i )
+                    predicates.push_back(nearest_predicate_type(points[order[i]], k));
+
+                group_v.reset(predicates);
+                rtv.apply_visitor(group_v);
+                group_v.finish(result.found, result.counts);
+            }
+        }
+
+        Rtree const& rt;
+        std::vector<QueryPoint> const& points;
+        unsigned k;
+        std::vector<std::size_t> const& order;
+        std::vector<std::size_t> const& groups;
+        std::vector<chunk_result> & chunks;
+    };
+
+    // Gathers the values of the leafs, one group per leaf
+    template <typename QueryRtree>
+    class gather_leafs
+        : public rtree::visitor
+            <
+                QueryValue,
+                typename utilities::view<QueryRtree>::options_type::parameters_type,
+                typename utilities::view<QueryRtree>::box_type,
+                typename utilities::view<QueryRtree>::allocators_type,
+                typename utilities::view<QueryRtree>::options_type::node_tag,
+                true
+            >::type
+    {
+        typedef utilities::view<QueryRtree> query_view_type;
+        typedef typename query_view_type::options_type query_options_type;
+        typedef typename query_view_type::box_type query_box_type;
+        typedef typename query_view_type::allocators_type query_allocators_type;
+        typedef typename query_view_type::translator_type query_translator_type;
+
+        typedef typename rtree::internal_node
+            <
+                QueryValue, typename query_options_type::parameters_type, query_box_type,
+                query_allocators_type, typename query_options_type::node_tag
+            >::type internal_node;
+        typedef typename rtree::leaf
+            <
+                QueryValue, typename query_options_type::parameters_type, query_box_type,
+                query_allocators_type, typename query_options_type::node_tag
+            >::type leaf;
+
+    public:
+        gather_leafs(query_translator_type const& t,
+                     std::vector<const QueryValue *> & q, std::vector<QueryPoint> & p,
+                     std::vector<std::size_t> & g)
+            : tr(t), queries(q), points(p), groups(g)
+        {}
+
+        void operator()(internal_node const& n)
+        {
+            typedef typename rtree::elements_type<internal_node>::type elements_type;
+            elements_type const& elements = rtree::elements(n);
+            for ( typename elements_type::const_iterator it = elements.begin() ; it != elements.end() ; ++it )
+                rtree::apply_visitor(*this, *it->second);
+        }
+
+        void operator()(leaf const& n)
+        {
+            typedef typename rtree::elements_type<leaf>::type elements_type;
+            elements_type const& elements = rtree::elements(n);
+            if ( elements.empty() )
+                return;
+
+            for ( typename elements_type::const_iterator it = elements.begin() ; it != elements.end() ; ++it )
+            {
+                queries.push_back(boost::addressof(*it));
+                points.push_back(tr(*it));
+            }
+            groups.push_back(queries.size());
+        }
+
+    private:
+        query_translator_type const& tr;
+        std::vector<const QueryValue *> & queries;
+        std::vector<QueryPoint> & points;
+        std::vector<std::size_t> & groups;
+    };
+
+public:
+    template <typename FwdIt, typename OutIter>
+    static inline std::size_t apply(Rtree const& rt, FwdIt first, FwdIt last, unsigned k,
+                                    OutIter out_it, std::size_t threads)
+    {
+        if ( rt.empty() || k == 0 || first == last )
+            return 0;
+
+        std::vector<const QueryValue *> queries;
+        std::vector<QueryPoint> points;
+        for ( ; first != last ; ++first )
+        {
+            queries.push_back(boost::addressof(*first));
+            points.push_back(*first);
+        }
+
+        // group the points close to each other
+        std::vector<std::size_t> order;
+        sort_by_curve(points, order);
+
+        std::size_t const group_size = rt.parameters().get_max_elements();
+        std::vector<std::size_t> groups;
+        for ( std::size_t i = 0 ; i < points.size() ; i += group_size )
+            groups.push_back(i);
+        groups.push_back(points.size());
+
+        return apply_groups(rt, queries, points, k, order, groups, out_it, threads);
+    }
+
+    template <typename QueryRtree, typename OutIter>
+    static inline std::size_t apply(Rtree const& rt, QueryRtree const& query_rt, unsigned k,
+                                    OutIter out_it, std::size_t threads)
+    {
+        if ( rt.empty() || k == 0 || query_rt.empty() )
+            return 0;
+
+        std::vector<const QueryValue *> queries;
+        std::vector<QueryPoint> points;
+        std::vector<std::size_t> groups(1, 0);
+        queries.reserve(query_rt.size());
+        points.reserve(query_rt.size());
+
+        utilities::view<QueryRtree> query_rtv(query_rt);
+        typename utilities::view<QueryRtree>::translator_type const query_tr = query_rtv.translator();
+        gather_leafs<QueryRtree> gather_v(query_tr, queries, points, groups);
+        query_rtv.apply_visitor(gather_v);
+
+        std::vector<std::size_t> order(points.size());
+        for ( std::size_t i = 0 ; i < order.size() ; ++i )
+            order[i] = i;
+
+        return apply_groups(rt, queries, points, k, order, groups, out_it, threads);
+    }
+
+private:
+    template <typename OutIter>
+    static inline std::size_t apply_groups(Rtree const& rt,
+                                           std::vector<const QueryValue *> const& queries,
+                                           std::vector<QueryPoint> const& points,
+                                           unsigned k,
+                                           std::vector<std::size_t> const& order,
+                                           std::vector<std::size_t> const& groups,
+                                           OutIter out_it, std::size_t threads)
+    {
+        std::size_t const groups_count = groups.size() - 1;
+        if ( threads < 1 )
+            threads = 1;
+        if ( groups_count < threads )
+            threads = groups_count;
+
+        std::vector<chunk_result> chunks(threads);
+        chunk_query q(rt, points, k, order, groups, chunks);
+        geometry::detail::parallel::for_each_chunk(groups_count, threads, q);
+
+        // the neighbors of queries in the order of the traversal
+        std::vector<std::pair<std::size_t, std::size_t> > ranges(points.size());
+        std::vector<const found_type *> founds(points.size());
+        std::size_t i = 0;
+        for ( typename std::vector<chunk_result>::const_iterator it = chunks.begin() ; it != chunks.end() ; ++it )
+        {
+            std::size_t offset = 0;
+            for ( typename std::vector<size_type>::const_iterator c_it = it->counts.begin() ; c_it != it->counts.end() ; ++c_it, ++i )
+            {
+                ranges[order[i]] = std::make_pair(offset, offset + *c_it);
+                founds[order[i]] = boost::addressof(it->found);
+                offset += *c_it;
+            }
+        }
+
+        std::size_t found_count = 0;
+        for ( std::size_t q = 0 ; q < queries.size() ; ++q )
+        {
+            for ( std::size_t j = ranges[q].first ; j < ranges[q].second ; ++j )
+            {
+                *out_it = std::make_pair(*queries[q], *(*founds[q])[j]);
+                ++out_it;
+                ++found_count;
+            }
+        }
+
+        return found_count;
+    }
+
+    static inline void sort_by_curve(std::vector<QueryPoint> const& points, std::vector<std::size_t> & order)
+    {
+        static const std::size_t dimension = geometry::dimension<QueryPoint>::value;
+
+        geometry::model::box<QueryPoint> hint_box;
+        geometry::assign_inverse(hint_box);
+        for ( std::size_t i = 0 ; i < points.size() ; ++i )
+            geometry::expand(hint_box, points[i]);
+
+        std::vector<std::pair<boost::uint64_t, std::size_t> > keys(points.size());
+        for ( std::size_t i = 0 ; i < points.size() ; ++i )
+        {
+            keys[i].first = pack_utils::curve_key<dimension>::apply(points[i], hint_box, index::packing::hilbert);
+            keys[i].second = i;
+        }
+
+        index::detail::radix_sort(keys, 1);
+
+        order.resize(keys.size());
+        for ( std::size_t i = 0 ; i < keys.size() ; ++i )
+            order[i] = keys[i].second;
+    }
+};
+
+}}}}} // namespace boost::geometry::index::detail::rtree
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_KNN_JOIN_HPP
@@ -0,0 +1,165 @@
+// Boost.Geometry Index
+//
+// R-tree nodes aggregates of subtrees
+//
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_NODE_AGGREGATE_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_NODE_AGGREGATE_HPP
+
+#include <boost/type_traits/integral_constant.hpp>
+
+#include <boost/geometry/index/parameters.hpp>
+
+namespace boost { namespace geometry { namespace index {
+
+namespace detail { namespace rtree {
+
+template <typename Parameters>
+struct is_augmented
+    : boost::false_type
+{};
+
+template <typename Parameters, typename Aggregator>
+struct is_augmented< index::augmented<Parameters, Aggregator> >
+    : boost::true_type
+{};
+
+template <typename Parameters>
+struct parameters_aggregator
+{
+    typedef index::detail::no_aggregator type;
+    typedef void result_type;
+
+    static inline type get(Parameters const& )
+    {
+        return type();
+    }
+};
+
+template <typename Parameters, typename Aggregator>
+struct parameters_aggregator< index::augmented<Parameters, Aggregator> >
+{
+    typedef Aggregator type;
+    typedef typename Aggregator::result_type result_type;
+
+    static inline type const& get(index::augmented<Parameters, Aggregator> const& parameters)
+    {
+        return parameters.aggregator();
+    }
+};
+
+template <typename Parameters>
+struct parameters_aggregator< index::augmented<Parameters, index::detail::no_aggregator> >
+{
+    typedef index::detail::no_aggregator type;
+    typedef void result_type;
+
+    static inline type const& get(index::augmented<Parameters, type> const& parameters)
+    {
+        return parameters.aggregator();
+    }
+};
+
+// Base of nodes of not augmented rtrees
+struct node_no_aggregate {};
+
+// The number of values and the aggregate of values stored in a subtree
+template <typename SizeType, typename Aggregator>
+struct node_aggregate_data
+{
+    typedef typename Aggregator::result_type value_type;
+
+    node_aggregate_data() : aggregate_count(0), aggregate_value() {}
+
+    inline void reset(Aggregator const& a)
+    {
+        aggregate_count = 0;
+        aggregate_value = a.identity();
+    }
+
+    template <typename Value>
+    inline void add_value(Aggregator const& a, Value const& v)
+    {
+        ++aggregate_count;
+        aggregate_value = a.combine(aggregate_value, a.value(v));
+    }
+
+    inline void add(Aggregator const& a, node_aggregate_data const& other)
+    {
+        aggregate_count += other.aggregate_count;
+        aggregate_value = a.combine(aggregate_value, other.aggregate_value);
+    }
+
+    SizeType aggregate_count;
+    value_type aggregate_value;
+};
+
+template <typename SizeType>
+struct node_aggregate_data<SizeType, index::detail::no_aggregator>
+{
+    typedef index::detail::no_aggregator aggregator_type;
+
+    node_aggregate_data() : aggregate_count(0) {}
+
+    inline void reset(aggregator_type const& )
+    {
+        aggregate_count = 0;
+    }
+
+    template <typename Value>
+    inline void add_value(aggregator_type const& , Value const& )
+    {
+        ++aggregate_count;
+    }
+
+    inline void add(aggregator_type const& , node_aggregate_data const& other)
+    {
+        aggregate_count += other.aggregate_count;
+    }
+
+    SizeType aggregate_count;
+};
+
+template <typename Parameters, typename SizeType>
+struct node_aggregate
+{
+    typedef node_no_aggregate type;
+};
+
+template <typename Parameters, typename Aggregator, typename SizeType>
+struct node_aggregate<index::augmented<Parameters, Aggregator>, SizeType>
+{
+    typedef node_aggregate_data<SizeType, Aggregator> type;
+};
+
+// Copies the aggregate of a node of an augmented rtree, does nothing otherwise
+template <typename Parameters, typename SizeType, bool IsAugmented = is_augmented<Parameters>::value>
+struct copy_aggregate
+{
+    template <typename Node>
+    static inline void apply(Node const& , Node & )
+    {}
+};
+
+template <typename Parameters, typename SizeType>
+struct copy_aggregate<Parameters, SizeType, true>
+{
+    typedef typename node_aggregate<Parameters, SizeType>::type aggregate_type;
+
+    template <typename Node>
+    static inline void apply(Node const& src, Node & dst)
+    {
+        static_cast<aggregate_type &>(dst) = static_cast<aggregate_type const&>(src);
+    }
+};
+
+}} // namespace detail::rtree
+
+}}} // namespace boost::geometry::index
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_NODE_AGGREGATE_HPP
@@ -18,6 +18,7 @@
 #include <boost/geometry/index/detail/rtree/node/pairs.hpp>
 #include <boost/geometry/index/detail/rtree/node/node_elements.hpp>
 #include <boost/geometry/index/detail/rtree/node/scoped_deallocator.hpp>
+#include <boost/geometry/index/detail/rtree/node/aggregate.hpp>
 
 //#include <boost/geometry/index/detail/rtree/node/weak_visitor.hpp>
 //#include <boost/geometry/index/detail/rtree/node/weak_dynamic.hpp>
@@ -32,6 +33,7 @@
 #include <boost/geometry/algorithms/expand.hpp>
 
 #include <boost/geometry/index/detail/rtree/visitors/is_leaf.hpp>
+#include <boost/geometry/index/detail/rtree/visitors/aggregate.hpp>
 
 #include <boost/geometry/index/detail/algorithms/bounds.hpp>
 #include <boost/geometry/index/detail/is_bounding_geometry.hpp>
@@ -21,6 +21,7 @@ namespace detail { namespace rtree {
 
 template <typename Value, typename Parameters, typename Box, typename Allocators, typename Tag>
 struct variant_internal_node
+    : public node_aggregate<Parameters, typename Allocators::size_type>::type
 {
     typedef rtree::ptr_pair<Box, typename Allocators::node_pointer> element_type;
     typedef typename boost::container::allocator_traits
@@ -40,6 +41,7 @@ struct variant_internal_node
 
 template <typename Value, typename Parameters, typename Box, typename Allocators, typename Tag>
 struct variant_leaf
+    : public node_aggregate<Parameters, typename Allocators::size_type>::type
 {
     typedef typename boost::container::allocator_traits
         <
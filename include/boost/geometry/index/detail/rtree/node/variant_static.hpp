@@ -19,6 +19,7 @@ namespace detail { namespace rtree {
 
 template <typename Value, typename Parameters, typename Box, typename Allocators>
 struct variant_internal_node<Value, Parameters, Box, Allocators, node_variant_static_tag>
+    : public node_aggregate<Parameters, typename Allocators::size_type>::type
 {
     typedef detail::varray<
         rtree::ptr_pair<Box, typename Allocators::node_pointer>,
@@ -33,6 +34,7 @@ struct variant_internal_node<Value, Parameters, Box, Allocators, node_variant_st
 
 template <typename Value, typename Parameters, typename Box, typename Allocators>
 struct variant_leaf<Value, Parameters, Box, Allocators, node_variant_static_tag>
+    : public node_aggregate<Parameters, typename Allocators::size_type>::type
 {
     typedef detail::varray<
         Value,
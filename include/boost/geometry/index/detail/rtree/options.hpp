@@ -148,6 +148,21 @@ struct options_type< index::dynamic_rstar >
     > type;
 };
 
+template <typename Parameters, typename Aggregator>
+struct options_type< index::augmented<Parameters, Aggregator> >
+{
+    typedef typename options_type<Parameters>::type underlying_options;
+
+    typedef options<
+        index::augmented<Parameters, Aggregator>,
+        typename underlying_options::insert_tag,
+        typename underlying_options::choose_next_node_tag,
+        typename underlying_options::split_tag,
+        typename underlying_options::redistribute_tag,
+        typename underlying_options::node_tag
+    > type;
+};
+
 }} // namespace detail::rtree
 
 }}} // namespace boost::geometry::index
@@ -14,9 +14,16 @@
 #include <boost/geometry/algorithms/expand.hpp>
 #include <boost/geometry/index/detail/algorithms/bounds.hpp>
 #include <boost/geometry/index/detail/algorithms/nth_element.hpp>
+#include <boost/geometry/index/detail/algorithms/radix_sort.hpp>
+#include <boost/geometry/index/detail/rtree/reorder_nodes.hpp>
+#include <boost/geometry/index/packing.hpp>
 
 #include <boost/geometry/algorithms/detail/expand_by_epsilon.hpp>
 
+#include <boost/geometry/util/parallel.hpp>
+
+#include <boost/cstdint.hpp>
+
 namespace boost { namespace geometry { namespace index { namespace detail { namespace rtree {
 
 namespace pack_utils {
@@ -91,6 +98,219 @@ struct nth_element_and_half_boxes<Dimension, Dimension>
     static inline void apply(EIt , EIt , EIt , Box const& , Box & , Box & , std::size_t ) {}
 };
 
+// Splits the range of entries at the median along the longest edge of the hint box
+struct median_partitioner
+{
+    template <typename EIt, typename Box>
+    static inline void apply(EIt first, EIt median, EIt last, Box const& box, Box & left, Box & right)
+    {
+        static const std::size_t dimension = geometry::dimension<Box>::value;
+
+        typename coordinate_type<Box>::type greatest_length;
+        std::size_t greatest_dim_index = 0;
+        biggest_edge<dimension>::apply(box, greatest_length, greatest_dim_index);
+        nth_element_and_half_boxes<0, dimension>
+            ::apply(first, median, last, box, left, right, greatest_dim_index);
+    }
+};
+
+// Keeps the order of already sorted entries, the hint box is not used
+struct order_partitioner
+{
+    template <typename EIt, typename Box>
+    static inline void apply(EIt , EIt , EIt , Box const& box, Box & left, Box & right)
+    {
+        geometry::convert(box, left);
+        geometry::convert(box, right);
+    }
+};
+
+template <std::size_t I, std::size_t Dimension>
+struct quantize_coordinates
+{
+    template <typename Point, typename Box>
+    static inline void apply(Point const& pt, Box const& box, boost::uint32_t max_value, boost::uint32_t * result)
+    {
+        double const min_c = static_cast<double>(geometry::get<min_corner, I>(box));
+        double const max_c = static_cast<double>(geometry::get<max_corner, I>(box));
+        double const c = static_cast<double>(geometry::get<I>(pt));
+
+        double q = 0;
+        if ( min_c < max_c )
+            q = (c - min_c) / (max_c - min_c) * max_value;
+
+        result[I] = q <= 0 ? 0
+                  : q >= max_value ? max_value
+                  : static_cast<boost::uint32_t>(q);
+
+        quantize_coordinates<I + 1, Dimension>::apply(pt, box, max_value, result);
+    }
+};
+
+template <std::size_t Dimension>
+struct quantize_coordinates<Dimension, Dimension>
+{
+    template <typename Point, typename Box>
+    static inline void apply(Point const& , Box const& , boost::uint32_t , boost::uint32_t * ) {}
+};
+
+// Calculates the index of a point on the Hilbert or Morton curve filling the hint box.
+// Each coordinate is quantized to 64/Dimension bits (at most 32).
+// The Hilbert index is calculated with the algorithm described in:
+// J. Skilling, Programming the Hilbert curve, AIP Conf. Proc. 707, 381 (2004)
+template <std::size_t Dimension>
+struct curve_key
+{
+    static const std::size_t bits = 64 / Dimension > 32 ? 32
+                                  : 64 / Dimension < 1 ? 1
+                                  : 64 / Dimension;
+
+    template <typename Point, typename Box>
+    static inline boost::uint64_t apply(Point const& pt, Box const& box, index::packing::algorithm_type algorithm)
+    {
+        boost::uint32_t const max_value = static_cast<boost::uint32_t>((boost::uint64_t(1) << bits) - 1);
+
+        boost::uint32_t x[Dimension];
+        quantize_coordinates<0, Dimension>::apply(pt, box, max_value, x);
+
+        if ( algorithm == index::packing::hilbert )
+            axes_to_transpose(x);
+
+        // interleave the bits, the most significant first
+        boost::uint64_t result = 0;
+        for ( std::size_t b = bits ; b > 0 ; --b )
+        {
+            for ( std::size_t i = 0 ; i < Dimension ; ++i )
+            {
+                result = (result << 1) | ((x[i] >> (b - 1)) & 1);
+            }
+        }
+        return result;
+    }
+
+private:
+    static inline void axes_to_transpose(boost::uint32_t * x)
+    {
+        boost::uint32_t const m = boost::uint32_t(1) << (bits - 1);
+
+        // inverse undo
+        for ( boost::uint32_t q = m ; q > 1 ; q >>= 1 )
+        {
+            boost::uint32_t const p = q - 1;
+            for ( std::size_t i = 0 ; i < Dimension ; ++i )
+            {
+                if ( x[i] & q )
+                {
+                    x[0] ^= p; // invert
+                }
+                else
+                {
+                    boost::uint32_t const t = (x[0] ^ x[i]) & p; // exchange
+                    x[0] ^= t;
+                    x[i] ^= t;
+                }
+            }
+        }
+
+        // gray encode
+        for ( std::size_t i = 1 ; i < Dimension ; ++i )
+            x[i] ^= x[i - 1];
+        boost::uint32_t t = 0;
+        for ( boost::uint32_t q = m ; q > 1 ; q >>= 1 )
+        {
+            if ( x[Dimension - 1] & q )
+                t ^= q - 1;
+        }
+        for ( std::size_t i = 0 ; i < Dimension ; ++i )
+            x[i] ^= t;
+    }
+};
+
+// The maximum and minimum numbers of values stored in the subtrees of the current level.
+struct subtree_elements_counts
+{
+    subtree_elements_counts(std::size_t ma, std::size_t mi) : maxc(ma), minc(mi) {}
+    std::size_t maxc;
+    std::size_t minc;
+};
+
+template <typename Parameters, typename SizeType>
+inline subtree_elements_counts calculate_subtree_elements_counts(std::size_t elements_count, Parameters const& parameters, SizeType & leafs_level)
+{
+    boost::ignore_unused_variable_warning(parameters);
+
+    subtree_elements_counts res(1, 1);
+    leafs_level = 0;
+
+    std::size_t smax = parameters.get_max_elements();
+    for ( ; smax < elements_count ; smax *= parameters.get_max_elements(), ++leafs_level )
+        res.maxc = smax;
+
+    res.minc = parameters.get_min_elements() * (res.maxc / parameters.get_max_elements());
+
+    return res;
+}
+
+inline std::size_t calculate_nodes_count(std::size_t count,
+                                         subtree_elements_counts const& subtree_counts)
+{
+    std::size_t n = count / subtree_counts.maxc;
+    std::size_t r = count % subtree_counts.maxc;
+
+    if ( 0 < r && r < subtree_counts.minc )
+    {
+        std::size_t count_minus_min = count - subtree_counts.minc;
+        n = count_minus_min / subtree_counts.maxc;
+        r = count_minus_min % subtree_counts.maxc;
+        ++n;
+    }
+
+    if ( 0 < r )
+        ++n;
+
+    return n;
+}
+
+inline std::size_t calculate_median_count(std::size_t count,
+                                          subtree_elements_counts const& subtree_counts)
+{
+    // e.g. for max = 5, min = 2, count = 52, subtree_max = 25, subtree_min = 10
+
+    std::size_t n = count / subtree_counts.maxc; // e.g. 52 / 25 = 2
+    std::size_t r = count % subtree_counts.maxc; // e.g. 52 % 25 = 2
+    std::size_t median_count = (n / 2) * subtree_counts.maxc; // e.g. 2 / 2 * 25 = 25
+
+    if ( 0 != r ) // e.g. 0 != 2
+    {
+        if ( subtree_counts.minc <= r ) // e.g. 10 <= 2 == false
+        {
+            //BOOST_GEOMETRY_INDEX_ASSERT(0 < n, "unexpected value");
+            median_count = ((n+1)/2) * subtree_counts.maxc; // if calculated ((2+1)/2) * 25 which would be ok, but not in all cases
+        }
+        else // r < subtree_counts.second  // e.g. 2 < 10 == true
+        {
+            std::size_t count_minus_min = count - subtree_counts.minc; // e.g. 52 - 10 = 42
+            n = count_minus_min / subtree_counts.maxc; // e.g. 42 / 25 = 1
+            r = count_minus_min % subtree_counts.maxc; // e.g. 42 % 25 = 17
+            if ( r == 0 )                               // e.g. false
+            {
+                // n can't be equal to 0 because then there wouldn't be any element in the other node
+                //BOOST_GEOMETRY_INDEX_ASSERT(0 < n, "unexpected value");
+                median_count = ((n+1)/2) * subtree_counts.maxc;     // if calculated ((1+1)/2) * 25 which would be ok, but not in all cases
+            }
+            else
+            {
+                if ( n == 0 )                                        // e.g. false
+                    median_count = r;                                // if calculated -> 17 which is wrong!
+                else
+                    median_count = ((n+2)/2) * subtree_counts.maxc; // e.g. ((1+2)/2) * 25 = 25
+            }
+        }
+    }
+
+    return median_count;
+}
+
 } // namespace pack_utils
 
 // STR leafs number are calculated as rcount/max
@@ -119,6 +339,21 @@ struct nth_element_and_half_boxes<Dimension, Dimension>
 // L1          125               52
 // L2  25  25  25  25  25   25  17    10
 // L3  5x5 5x5 5x5 5x5 5x5  5x5 3x5+2 2x5
+//
+// The packing may be performed by more than one thread. In this case the packets
+// created by splitting the range of elements (both the nth_element partitioning
+// and the construction of subtrees) are processed concurrently. The threads are
+// distributed between the two halves at each split so at most the requested number
+// of threads is running at the same time. The order of the elements in nodes is
+// preserved so the resulting tree is identical to the one created sequentially.
+// The Allocator must be safe to use from many threads at the same time.
+//
+// Alternatively the elements may be sorted by the index of their centroids on
+// a space-filling curve (Hilbert or Morton) before the tree is created. In this
+// case the range is split into packets in the same way, with the same numbers of
+// elements, but the order of the elements is kept. So the elements of each node
+// are a contiguous part of the curve. The sort is performed with a radix sort
+// which may also use many threads.
 
 template <typename Value, typename Options, typename Translator, typename Box, typename Allocators>
 class pack
@@ -145,11 +380,25 @@ class pack
     typedef typename rtree::elements_type<internal_node>::type internal_elements;
     typedef typename internal_elements::value_type internal_element;
 
+    typedef typename rtree::container_from_elements_type<
+        internal_elements, internal_element
+    >::type internal_elements_buffer;
+
 public:
     // Arbitrary iterators
     template <typename InIt> inline static
     node_pointer apply(InIt first, InIt last, size_type & values_count, size_type & leafs_level,
-                       parameters_type const& parameters, Translator const& translator, Allocators & allocators)
+                       parameters_type const& parameters, Translator const& translator, Allocators & allocators,
+                       std::size_t threads = 1)
+    {
+        return apply(first, last, values_count, leafs_level, parameters, translator, allocators,
+                     index::packing(index::packing::top_down, index::parallel(threads)));
+    }
+
+    template <typename InIt> inline static
+    node_pointer apply(InIt first, InIt last, size_type & values_count, size_type & leafs_level,
+                       parameters_type const& parameters, Translator const& translator, Allocators & allocators,
+                       index::packing const& packing)
     {
         typedef typename std::iterator_traits<InIt>::difference_type diff_type;
             
@@ -184,14 +433,72 @@ public:
             entries.push_back(std::make_pair(pt, first));
         }
 
-        subtree_elements_counts subtree_counts = calculate_subtree_elements_counts(values_count, parameters, leafs_level);
-        internal_element el = per_level(entries.begin(), entries.end(), hint_box.get(), values_count, subtree_counts,
-                                        parameters, translator, allocators);
+        pack_utils::subtree_elements_counts subtree_counts = pack_utils::calculate_subtree_elements_counts(values_count, parameters, leafs_level);
 
-        return el.second;
+        node_pointer root = 0;
+        if ( packing.algorithm() == index::packing::top_down )
+        {
+            internal_element el = per_level<pack_utils::median_partitioner>(
+                                        entries.begin(), entries.end(), hint_box.get(), values_count, subtree_counts,
+                                        parameters, translator, allocators, packing.threads());
+            root = el.second;
+        }
+        else
+        {
+            sort_by_curve(entries, hint_box.get(), packing);
+            internal_element el = per_level<pack_utils::order_partitioner>(
+                                        entries.begin(), entries.end(), hint_box.get(), values_count, subtree_counts,
+                                        parameters, translator, allocators, packing.threads());
+            root = el.second;
+        }
+
+        return reorder_nodes<Value, Options, Translator, Box, Allocators>
+                    ::apply(root, leafs_level, packing.node_order(), allocators);                  // MAY THROW (A, V: move)
     }
 
 private:
+    template <typename Entries>
+    struct curve_keys_task
+    {
+        typedef std::vector<std::pair<boost::uint64_t, std::size_t> > keys_type;
+
+        curve_keys_task(Entries const& e, Box const& b, index::packing::algorithm_type a, keys_type & k)
+            : entries(e), box(b), algorithm(a), keys(k)
+        {}
+
+        void operator()(std::size_t first, std::size_t last, std::size_t /*chunk_index*/)
+        {
+            for ( std::size_t i = first ; i < last ; ++i )
+            {
+                keys[i].first = pack_utils::curve_key<dimension>::apply(entries[i].first, box, algorithm);
+                keys[i].second = i;
+            }
+        }
+
+        Entries const& entries;
+        Box const& box;
+        index::packing::algorithm_type algorithm;
+        keys_type & keys;
+    };
+
+    template <typename Entries> inline static
+    void sort_by_curve(Entries & entries, Box const& hint_box, index::packing const& packing)
+    {
+        typedef typename curve_keys_task<Entries>::keys_type keys_type;
+
+        keys_type keys(entries.size());
+        curve_keys_task<Entries> keys_task(entries, hint_box, packing.algorithm(), keys);
+        geometry::detail::parallel::for_each_chunk(entries.size(), packing.threads(), keys_task);
+
+        index::detail::radix_sort(keys, packing.threads());
+
+        Entries sorted;
+        sorted.reserve(entries.size());
+        for ( typename keys_type::const_iterator it = keys.begin() ; it != keys.end() ; ++it )
+            sorted.push_back(entries[it->second]);
+        entries.swap(sorted);
+    }
+
     template <typename BoxType>
     class expandable_box
     {
@@ -240,16 +547,10 @@ private:
         BoxType m_box;
     };
 
-    struct subtree_elements_counts
-    {
-        subtree_elements_counts(std::size_t ma, std::size_t mi) : maxc(ma), minc(mi) {}
-        std::size_t maxc;
-        std::size_t minc;
-    };
-
-    template <typename EIt> inline static
-    internal_element per_level(EIt first, EIt last, Box const& hint_box, std::size_t values_count, subtree_elements_counts const& subtree_counts,
-                               parameters_type const& parameters, Translator const& translator, Allocators & allocators)
+    template <typename Partitioner, typename EIt> inline static
+    internal_element per_level(EIt first, EIt last, Box const& hint_box, std::size_t values_count, pack_utils::subtree_elements_counts const& subtree_counts,
+                               parameters_type const& parameters, Translator const& translator, Allocators & allocators,
+                               std::size_t threads)
     {
         BOOST_GEOMETRY_INDEX_ASSERT(0 < std::distance(first, last) && static_cast<std::size_t>(std::distance(first, last)) == values_count,
                                     "unexpected parameters");
@@ -299,12 +600,14 @@ private:
             }
 #endif
 
+            rtree::update_aggregate<Value, Options, Box, Allocators>::apply(l, parameters);
+
             auto_remover.release();
             return internal_element(elements_box.get(), n);
         }
 
         // calculate next max and min subtree counts
-        subtree_elements_counts next_subtree_counts = subtree_counts;
+        pack_utils::subtree_elements_counts next_subtree_counts = subtree_counts;
         next_subtree_counts.maxc /= parameters.get_max_elements();
         next_subtree_counts.minc /= parameters.get_max_elements();
 
@@ -314,26 +617,29 @@ private:
         internal_node & in = rtree::get<internal_node>(*n);
 
         // reserve space for values
-        std::size_t nodes_count = calculate_nodes_count(values_count, subtree_counts);
+        std::size_t nodes_count = pack_utils::calculate_nodes_count(values_count, subtree_counts);
         rtree::elements(in).reserve(nodes_count);                                                           // MAY THROW (A)
         // calculate values box and copy values
         expandable_box<Box> elements_box;
         
-        per_level_packets(first, last, hint_box, values_count, subtree_counts, next_subtree_counts,
-                          rtree::elements(in), elements_box,
-                          parameters, translator, allocators);
+        per_level_packets<Partitioner>(first, last, hint_box, values_count, subtree_counts, next_subtree_counts,
+                                       rtree::elements(in), elements_box,
+                                       parameters, translator, allocators, threads);
+
+        rtree::update_aggregate<Value, Options, Box, Allocators>::apply(in, parameters);
 
         auto_remover.release();
         return internal_element(elements_box.get(), n);
     }
 
-    template <typename EIt, typename ExpandableBox> inline static
+    template <typename Partitioner, typename EIt, typename Elements, typename ExpandableBox> inline static
     void per_level_packets(EIt first, EIt last, Box const& hint_box,
                            std::size_t values_count,
-                           subtree_elements_counts const& subtree_counts,
-                           subtree_elements_counts const& next_subtree_counts,
-                           internal_elements & elements, ExpandableBox & elements_box,
-                           parameters_type const& parameters, Translator const& translator, Allocators & allocators)
+                           pack_utils::subtree_elements_counts const& subtree_counts,
+                           pack_utils::subtree_elements_counts const& next_subtree_counts,
+                           Elements & elements, ExpandableBox & elements_box,
+                           parameters_type const& parameters, Translator const& translator, Allocators & allocators,
+                           std::size_t threads)
     {
         BOOST_GEOMETRY_INDEX_ASSERT(0 < std::distance(first, last) && static_cast<std::size_t>(std::distance(first, last)) == values_count,
                                     "unexpected parameters");
@@ -345,8 +651,8 @@ private:
         if ( values_count <= subtree_counts.maxc )
         {
             // the end, move to the next level
-            internal_element el = per_level(first, last, hint_box, values_count, next_subtree_counts,
-                                            parameters, translator, allocators);
+            internal_element el = per_level<Partitioner>(first, last, hint_box, values_count, next_subtree_counts,
+                                                         parameters, translator, allocators, threads);
 
             // in case if push_back() do throw here
             // and even if this is not probable (previously reserved memory, nonthrowing pairs copy)
@@ -360,104 +666,103 @@ private:
             return;
         }
         
-        std::size_t median_count = calculate_median_count(values_count, subtree_counts);
+        std::size_t median_count = pack_utils::calculate_median_count(values_count, subtree_counts);
         EIt median = first + median_count;
 
-        coordinate_type greatest_length;
-        std::size_t greatest_dim_index = 0;
-        pack_utils::biggest_edge<dimension>::apply(hint_box, greatest_length, greatest_dim_index);
         Box left, right;
-        pack_utils::nth_element_and_half_boxes<0, dimension>
-            ::apply(first, median, last, hint_box, left, right, greatest_dim_index);
+        Partitioner::apply(first, median, last, hint_box, left, right);
         
-        per_level_packets(first, median, left,
-                          median_count, subtree_counts, next_subtree_counts,
-                          elements, elements_box,
-                          parameters, translator, allocators);
-        per_level_packets(median, last, right,
-                          values_count - median_count, subtree_counts, next_subtree_counts,
-                          elements, elements_box,
-                          parameters, translator, allocators);
-    }
-
-    inline static
-    subtree_elements_counts calculate_subtree_elements_counts(std::size_t elements_count, parameters_type const& parameters, size_type & leafs_level)
-    {
-        boost::ignore_unused_variable_warning(parameters);
-
-        subtree_elements_counts res(1, 1);
-        leafs_level = 0;
-
-        std::size_t smax = parameters.get_max_elements();
-        for ( ; smax < elements_count ; smax *= parameters.get_max_elements(), ++leafs_level )
-            res.maxc = smax;
-
-        res.minc = parameters.get_min_elements() * (res.maxc / parameters.get_max_elements());
-
-        return res;
-    }
+        if ( threads <= 1 )
+        {
+            per_level_packets<Partitioner>(first, median, left,
+                                           median_count, subtree_counts, next_subtree_counts,
+                                           elements, elements_box,
+                                           parameters, translator, allocators, 1);
+            per_level_packets<Partitioner>(median, last, right,
+                                           values_count - median_count, subtree_counts, next_subtree_counts,
+                                           elements, elements_box,
+                                           parameters, translator, allocators, 1);
+            return;
+        }
 
-    inline static
-    std::size_t calculate_nodes_count(std::size_t count,
-                                      subtree_elements_counts const& subtree_counts)
-    {
-        std::size_t n = count / subtree_counts.maxc;
-        std::size_t r = count % subtree_counts.maxc;
+        // The right packets are created in a separate thread and stored in a temporary
+        // container. They're appended after the left ones in order to keep the same
+        // order of elements as in the sequential version.
+        internal_elements_buffer right_elements;
+        expandable_box<Box> right_elements_box;
+
+        std::size_t const right_threads = threads / 2;
+        packets_task<Partitioner, EIt, Elements, ExpandableBox>
+            left_task(first, median, left,
+                      median_count, subtree_counts, next_subtree_counts,
+                      elements, elements_box,
+                      parameters, translator, allocators, threads - right_threads);
+        packets_task<Partitioner, EIt, internal_elements_buffer, expandable_box<Box> >
+            right_task(median, last, right,
+                       values_count - median_count, subtree_counts, next_subtree_counts,
+                       right_elements, right_elements_box,
+                       parameters, translator, allocators, right_threads);
+
+        std::size_t moved_count = 0;
+        BOOST_TRY
+        {
+            geometry::detail::parallel::invoke(right_task, left_task, true);
 
-        if ( 0 < r && r < subtree_counts.minc )
+            for ( ; moved_count < right_elements.size() ; ++moved_count )
+            {
+                // this container should have memory allocated, reserve() called outside
+                elements.push_back(right_elements[moved_count]);                    // MAY THROW (A?,C) - however in normal conditions shouldn't
+            }
+        }
+        BOOST_CATCH(...)
         {
-            std::size_t count_minus_min = count - subtree_counts.minc;
-            n = count_minus_min / subtree_counts.maxc;
-            r = count_minus_min % subtree_counts.maxc;
-            ++n;
+            // destroy the subtrees which weren't moved to the destination container
+            rtree::destroy_elements<Value, Options, Translator, Box, Allocators>
+                ::apply(right_elements.begin() + moved_count, right_elements.end(), allocators);
+            BOOST_RETHROW                                                           // RETHROW
         }
+        BOOST_CATCH_END
 
-        if ( 0 < r )
-            ++n;
-
-        return n;
+        elements_box.expand(right_elements_box.get());
     }
 
-    inline static
-    std::size_t calculate_median_count(std::size_t count,
-                                       subtree_elements_counts const& subtree_counts)
+    template <typename Partitioner, typename EIt, typename Elements, typename ExpandableBox>
+    struct packets_task
     {
-        // e.g. for max = 5, min = 2, count = 52, subtree_max = 25, subtree_min = 10
-
-        std::size_t n = count / subtree_counts.maxc; // e.g. 52 / 25 = 2
-        std::size_t r = count % subtree_counts.maxc; // e.g. 52 % 25 = 2
-        std::size_t median_count = (n / 2) * subtree_counts.maxc; // e.g. 2 / 2 * 25 = 25
+        packets_task(EIt f, EIt l, Box const& hb,
+                     std::size_t vc,
+                     pack_utils::subtree_elements_counts const& sc,
+                     pack_utils::subtree_elements_counts const& nsc,
+                     Elements & els, ExpandableBox & els_box,
+                     parameters_type const& p, Translator const& t, Allocators & a,
+                     std::size_t th)
+            : first(f), last(l), hint_box(hb)
+            , values_count(vc), subtree_counts(sc), next_subtree_counts(nsc)
+            , elements(els), elements_box(els_box)
+            , parameters(p), translator(t), allocators(a)
+            , threads(th)
+        {}
 
-        if ( 0 != r ) // e.g. 0 != 2
+        void operator()()
         {
-            if ( subtree_counts.minc <= r ) // e.g. 10 <= 2 == false
-            {
-                //BOOST_GEOMETRY_INDEX_ASSERT(0 < n, "unexpected value");
-                median_count = ((n+1)/2) * subtree_counts.maxc; // if calculated ((2+1)/2) * 25 which would be ok, but not in all cases
-            }
-            else // r < subtree_counts.second  // e.g. 2 < 10 == true
-            {
-                std::size_t count_minus_min = count - subtree_counts.minc; // e.g. 52 - 10 = 42
-                n = count_minus_min / subtree_counts.maxc; // e.g. 42 / 25 = 1
-                r = count_minus_min % subtree_counts.maxc; // e.g. 42 % 25 = 17
-                if ( r == 0 )                               // e.g. false
-                {
-                    // n can't be equal to 0 because then there wouldn't be any element in the other node
-                    //BOOST_GEOMETRY_INDEX_ASSERT(0 < n, "unexpected value");
-                    median_count = ((n+1)/2) * subtree_counts.maxc;     // if calculated ((1+1)/2) * 25 which would be ok, but not in all cases
-                }
-                else
-                {
-                    if ( n == 0 )                                        // e.g. false
-                        median_count = r;                                // if calculated -> 17 which is wrong!
-                    else
-                        median_count = ((n+2)/2) * subtree_counts.maxc; // e.g. ((1+2)/2) * 25 = 25
-                }
-            }
+            pack::per_level_packets<Partitioner>(first, last, hint_box,
+                                                 values_count, subtree_counts, next_subtree_counts,
+                                                 elements, elements_box,
+                                                 parameters, translator, allocators, threads);
         }
 
-        return median_count;
-    }
+        EIt first, last;
+        Box const& hint_box;
+        std::size_t values_count;
+        pack_utils::subtree_elements_counts const& subtree_counts;
+        pack_utils::subtree_elements_counts const& next_subtree_counts;
+        Elements & elements;
+        ExpandableBox & elements_box;
+        parameters_type const& parameters;
+        Translator const& translator;
+        Allocators & allocators;
+        std::size_t threads;
+    };
 };
 
 }}}}} // namespace boost::geometry::index::detail::rtree
@@ -0,0 +1,497 @@
+// Boost.Geometry Index
+//
+// R-tree packing with bounded memory
+//
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_PACK_EXTERNAL_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_PACK_EXTERNAL_HPP
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include <boost/core/noncopyable.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/move/iterator.hpp>
+#include <boost/mpl/assert.hpp>
+#include <boost/type_traits/has_trivial_copy.hpp>
+
+#include <boost/geometry/algorithms/centroid.hpp>
+#include <boost/geometry/algorithms/detail/expand_by_epsilon.hpp>
+#include <boost/geometry/algorithms/expand.hpp>
+#include <boost/geometry/util/condition.hpp>
+#include <boost/geometry/util/parallel.hpp>
+
+#include <boost/geometry/index/detail/algorithms/bounds.hpp>
+#include <boost/geometry/index/detail/algorithms/radix_sort.hpp>
+#include <boost/geometry/index/detail/exception.hpp>
+#include <boost/geometry/index/detail/rtree/pack_create.hpp>
+#include <boost/geometry/index/packing.hpp>
+
+namespace boost { namespace geometry { namespace index { namespace detail { namespace rtree {
+
+namespace pack_utils {
+
+// Temporary binary file storing trivially copyable objects.
+// The file is removed automatically when it's closed.
+template <typename T>
+class temporary_file
+    : boost::noncopyable
+{
+public:
+    typedef std::fpos_t position_type;
+
+    temporary_file()
+        : m_file(std::tmpfile())
+    {
+        if ( !m_file )
+            detail::throw_runtime_error("unable to create temporary file");
+    }
+
+    ~temporary_file()
+    {
+        std::fclose(m_file);
+    }
+
+    position_type position()
+    {
+        position_type result;
+        if ( 0 != std::fgetpos(m_file, &result) )
+            detail::throw_runtime_error("unable to get the position in temporary file");
+        return result;
+    }
+
+    void set_position(position_type const& pos)
+    {
+        if ( 0 != std::fsetpos(m_file, &pos) )
+            detail::throw_runtime_error("unable to set the position in temporary file");
+    }
+
+    void write(T const* data, std::size_t count)
+    {
+        if ( 0 < count && std::fwrite(data, sizeof(T), count, m_file) != count )
+            detail::throw_runtime_error("unable to write temporary file");
+    }
+
+    void read(T * data, std::size_t count)
+    {
+        if ( 0 < count && std::fread(data, sizeof(T), count, m_file) != count )
+            detail::throw_runtime_error("unable to read temporary file");
+    }
+
+private:
+    std::FILE * m_file;
+};
+
+} // namespace pack_utils
+
+// The values are read from the input range in chunks of at most max_values_in_memory
+// values. If all of them fit in one chunk the tree is created with pack. Otherwise
+// the chunks are stored in a temporary file and the bounding box of all values is
+// calculated (unless it's passed by the user). Then each chunk is sorted by the
+// space-filling curve index of the centroids and stored as a sorted run in another
+// temporary file. Finally the runs are merged and the tree is created bottom-up
+// from the stream of sorted values. The sorts are stable and the ties are resolved
+// in favor of the earlier runs so the order of values, the numbers of elements in
+// nodes and the resulting tree are the same as the ones created by pack with the
+// same curve. Only the runs buffers, max_values_in_memory values in total, and the
+// nodes on the path from the root to the currently created leaf are stored in memory
+// besides the tree. The Values must be trivially copyable.
+template <typename Value, typename Options, typename Translator, typename Box, typename Allocators>
+class pack_external
+{
+    typedef typename rtree::internal_node<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag>::type internal_node;
+    typedef typename rtree::leaf<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag>::type leaf;
+
+    typedef typename Allocators::node_pointer node_pointer;
+    typedef rtree::subtree_destroyer<Value, Options, Translator, Box, Allocators> subtree_destroyer;
+    typedef typename Allocators::size_type size_type;
+
+    typedef typename geometry::point_type<Box>::type point_type;
+    typedef typename Options::parameters_type parameters_type;
+    static const std::size_t dimension = geometry::dimension<point_type>::value;
+
+    typedef typename rtree::elements_type<internal_node>::type internal_elements;
+    typedef typename internal_elements::value_type internal_element;
+
+    typedef std::pair<boost::uint64_t, Value> record_type;
+    typedef pack_utils::temporary_file<Value> values_file;
+    typedef pack_utils::temporary_file<record_type> records_file;
+
+    typedef rtree::pack<Value, Options, Translator, Box, Allocators> pack;
+
+    BOOST_MPL_ASSERT_MSG((boost::has_trivial_copy<Value>::value),
+                         VALUE_MUST_BE_TRIVIALLY_COPYABLE,
+                         (Value));
+
+    struct run
+    {
+        typename records_file::position_type position;
+        std::size_t count;
+    };
+
+public:
+    template <typename InIt> inline static
+    node_pointer apply(InIt first, InIt last, size_type & values_count, size_type & leafs_level,
+                       parameters_type const& parameters, Translator const& translator, Allocators & allocators,
+                       index::packing const& packing, std::size_t max_values_in_memory)
+    {
+        index::packing const curve_packing = curve_packing_policy(packing);
+        std::size_t const chunk_size = (std::max)(max_values_in_memory, std::size_t(1));
+
+        std::vector<Value> chunk;
+        chunk.reserve(chunk_size);                                                                      // MAY THROW (A)
+        read_chunk(first, last, chunk, chunk_size, translator);                                         // MAY THROW (A, C)
+
+        // all values fit in memory
+        if ( first == last )
+        {
+            return pack::apply(boost::make_move_iterator(chunk.begin()), boost::make_move_iterator(chunk.end()),
+                               values_count, leafs_level,
+                               parameters, translator, allocators, curve_packing);                      // MAY THROW (A, C)
+        }
+
+        // store the values and calculate the bounding box
+        values_file spill;
+        typename values_file::position_type const spill_begin = spill.position();
+
+        Box bounds;
+        detail::bounds(translator(chunk.front()), bounds);
+        std::size_t count = 0;
+        while ( ! chunk.empty() )
+        {
+            for ( typename std::vector<Value>::const_iterator it = chunk.begin() ; it != chunk.end() ; ++it )
+                geometry::expand(bounds, translator(*it));
+            spill.write(&chunk[0], chunk.size());                                                       // MAY THROW (F)
+            count += chunk.size();
+
+            chunk.clear();
+            read_chunk(first, last, chunk, chunk_size, translator);                                     // MAY THROW (A, C)
+        }
+
+        // create the sorted runs
+        records_file runs_file;
+        std::vector<run> runs;
+        spill.set_position(spill_begin);
+        for ( std::size_t i = 0 ; i < count ; i += chunk.size() )
+        {
+            chunk.resize((std::min)(chunk_size, count - i));                                            // MAY THROW (A, C)
+            spill.read(&chunk[0], chunk.size());                                                        // MAY THROW (F)
+            write_run(chunk, bounds, translator, curve_packing, runs_file, runs);                       // MAY THROW (A, F)
+        }
+
+        return apply_runs(runs_file, runs, count, chunk_size, values_count, leafs_level,
+                          parameters, translator, allocators, packing.node_order());                    // MAY THROW (A, F)
+    }
+
+    template <typename InIt> inline static
+    node_pointer apply(InIt first, InIt last, Box const& bounds, size_type & values_count, size_type & leafs_level,
+                       parameters_type const& parameters, Translator const& translator, Allocators & allocators,
+                       index::packing const& packing, std::size_t max_values_in_memory)
+    {
+        index::packing const curve_packing = curve_packing_policy(packing);
+        std::size_t const chunk_size = (std::max)(max_values_in_memory, std::size_t(1));
+
+        records_file runs_file;
+        std::vector<run> runs;
+        std::size_t count = 0;
+
+        // create the sorted runs directly from the input
+        std::vector<Value> chunk;
+        chunk.reserve(chunk_size);                                                                      // MAY THROW (A)
+        read_chunk(first, last, chunk, chunk_size, translator);                                         // MAY THROW (A, C)
+        while ( ! chunk.empty() )
+        {
+            write_run(chunk, bounds, translator, curve_packing, runs_file, runs);                       // MAY THROW (A, F)
+            count += chunk.size();
+
+            chunk.clear();
+            read_chunk(first, last, chunk, chunk_size, translator);                                     // MAY THROW (A, C)
+        }
+
+        return apply_runs(runs_file, runs, count, chunk_size, values_count, leafs_level,
+                          parameters, translator, allocators, packing.node_order());                    // MAY THROW (A, F)
+    }
+
+private:
+    // The merged stream of values stored in the sorted runs.
+    class merged_runs
+    {
+        typedef std::pair<boost::uint64_t, std::size_t> heap_element;
+        typedef std::greater<heap_element> heap_compare;
+
+        struct run_buffer
+        {
+            typename records_file::position_type position;
+            std::size_t remaining;
+            std::vector<record_type> records;
+            std::size_t current;
+        };
+
+    public:
+        merged_runs(records_file & file, std::vector<run> const& runs, std::size_t buffer_size)
+            : m_file(file)
+            , m_buffers(runs.size())
+        {
+            m_heap.reserve(runs.size());
+            for ( std::size_t i = 0 ; i < runs.size() ; ++i )
+            {
+                m_buffers[i].position = runs[i].position;
+                m_buffers[i].remaining = runs[i].count;
+                m_buffers[i].records.reserve((std::min)(buffer_size, runs[i].count));                  // MAY THROW (A)
+                fill(m_buffers[i]);                                                                     // MAY THROW (F)
+                m_heap.push_back(heap_element(m_buffers[i].records.front().first, i));
+            }
+            std::make_heap(m_heap.begin(), m_heap.end(), heap_compare());
+        }
+
+        // The ties are resolved in favor of the run with lower index.
+        Value next()
+        {
+            BOOST_GEOMETRY_INDEX_ASSERT(! m_heap.empty(), "no more values");
+
+            std::pop_heap(m_heap.begin(), m_heap.end(), heap_compare());
+            std::size_t const i = m_heap.back().second;
+            run_buffer & buffer = m_buffers[i];
+
+            Value result = buffer.records[buffer.current].second;
+            ++buffer.current;
+
+            if ( buffer.current == buffer.records.size() && 0 < buffer.remaining )
+                fill(buffer);                                                                           // MAY THROW (F)
+
+            if ( buffer.current < buffer.records.size() )
+            {
+                m_heap.back().first = buffer.records[buffer.current].first;
+                std::push_heap(m_heap.begin(), m_heap.end(), heap_compare());
+            }
+            else
+            {
+                m_heap.pop_back();
+            }
+
+            return result;
+        }
+
+    private:
+        void fill(run_buffer & buffer)
+        {
+            std::size_t const n = (std::min)(buffer.records.capacity(), buffer.remaining);
+            buffer.records.resize(n);
+            m_file.set_position(buffer.position);
+            m_file.read(&buffer.records[0], n);                                                         // MAY THROW (F)
+            buffer.position = m_file.position();
+            buffer.remaining -= n;
+            buffer.current = 0;
+        }
+
+        records_file & m_file;
+        std::vector<run_buffer> m_buffers;
+        std::vector<heap_element> m_heap;
+    };
+
+    inline static index::packing curve_packing_policy(index::packing const& packing)
+    {
+        // top-down packing requires random access to all values
+        return index::packing(packing.algorithm() == index::packing::morton ? index::packing::morton
+                                                                            : index::packing::hilbert,
+                              index::parallel(packing.threads()),
+                              packing.node_order());
+    }
+
+    template <typename InIt> inline static
+    void read_chunk(InIt & first, InIt const& last, std::vector<Value> & chunk, std::size_t chunk_size,
+                    Translator const& translator)
+    {
+        for ( ; first != last && chunk.size() < chunk_size ; ++first )
+        {
+            chunk.push_back(*first);                                                                    // MAY THROW (A?, C)
+
+            // NOTE: added for consistency with insert()
+            BOOST_GEOMETRY_INDEX_ASSERT(detail::is_valid(translator(chunk.back())), "Indexable is invalid");
+        }
+    }
+
+    template <typename Chunk>
+    struct curve_keys_task
+    {
+        typedef std::vector<std::pair<boost::uint64_t, std::size_t> > keys_type;
+
+        curve_keys_task(Chunk const& c, Box const& b, Translator const& t, index::packing::algorithm_type a, keys_type & k)
+            : chunk(c), box(b), translator(t), algorithm(a), keys(k)
+        {}
+
+        void operator()(std::size_t first, std::size_t last, std::size_t /*chunk_index*/)
+        {
+            for ( std::size_t i = first ; i < last ; ++i )
+            {
+                point_type pt;
+                geometry::centroid(translator(chunk[i]), pt);
+                keys[i].first = pack_utils::curve_key<dimension>::apply(pt, box, algorithm);
+                keys[i].second = i;
+            }
+        }
+
+        Chunk const& chunk;
+        Box const& box;
+        Translator const& translator;
+        index::packing::algorithm_type algorithm;
+        keys_type & keys;
+    };
+
+    inline static
+    void write_run(std::vector<Value> const& chunk, Box const& bounds, Translator const& translator,
+                   index::packing const& packing, records_file & file, std::vector<run> & runs)
+    {
+        typedef typename curve_keys_task< std::vector<Value> >::keys_type keys_type;
+
+        keys_type keys(chunk.size());                                                                   // MAY THROW (A)
+        curve_keys_task< std::vector<Value> > keys_task(chunk, bounds, translator, packing.algorithm(), keys);
+        geometry::detail::parallel::for_each_chunk(chunk.size(), packing.threads(), keys_task);
+
+        index::detail::radix_sort(keys, packing.threads());                                            // MAY THROW (A)
+
+        std::vector<record_type> records;
+        records.reserve(chunk.size());                                                                  // MAY THROW (A)
+        for ( typename keys_type::const_iterator it = keys.begin() ; it != keys.end() ; ++it )
+            records.push_back(record_type(it->first, chunk[it->second]));
+
+        run r;
+        r.position = file.position();
+        r.count = records.size();
+        file.write(&records[0], records.size());                                                        // MAY THROW (F)
+        runs.push_back(r);                                                                              // MAY THROW (A)
+    }
+
+    inline static
+    node_pointer apply_runs(records_file & file, std::vector<run> const& runs, std::size_t count, std::size_t chunk_size,
+                            size_type & values_count, size_type & leafs_level,
+                            parameters_type const& parameters, Translator const& translator, Allocators & allocators,
+                            index::packing::node_order_type node_order)
+    {
+        if ( count == 0 )
+            return node_pointer(0);
+
+        // the memory is divided between the buffers of the runs
+        merged_runs source(file, runs, (std::max)(chunk_size / runs.size(), std::size_t(1)));          // MAY THROW (A, F)
+
+        values_count = static_cast<size_type>(count);
+        pack_utils::subtree_elements_counts subtree_counts = pack_utils::calculate_subtree_elements_counts(count, parameters, leafs_level);
+
+        internal_element el = per_level(source, count, subtree_counts, parameters, translator, allocators);  // MAY THROW (A, C, F)
+        return reorder_nodes<Value, Options, Translator, Box, Allocators>
+                    ::apply(el.second, leafs_level, node_order, allocators);                        // MAY THROW (A, V: move)
+    }
+
+    // The same recursion as in pack with order_partitioner, the values are taken from the stream.
+    inline static
+    internal_element per_level(merged_runs & source, std::size_t values_count, pack_utils::subtree_elements_counts const& subtree_counts,
+                               parameters_type const& parameters, Translator const& translator, Allocators & allocators)
+    {
+        if ( subtree_counts.maxc <= 1 )
+        {
+            // ROOT or LEAF
+            BOOST_GEOMETRY_INDEX_ASSERT(values_count <= parameters.get_max_elements(),
+                                        "too big number of elements");
+
+            node_pointer n = rtree::create_node<Allocators, leaf>::apply(allocators);                       // MAY THROW (A)
+            subtree_destroyer auto_remover(n, allocators);
+            leaf & l = rtree::get<leaf>(*n);
+
+            rtree::elements(l).reserve(values_count);                                                       // MAY THROW (A)
+
+            rtree::elements(l).push_back(source.next());                                                    // MAY THROW (A?, C, F)
+            Box elements_box;
+            detail::bounds(translator(rtree::elements(l).back()), elements_box);
+            for ( std::size_t i = 1 ; i < values_count ; ++i )
+            {
+                rtree::elements(l).push_back(source.next());                                                // MAY THROW (A?, C, F)
+                geometry::expand(elements_box, translator(rtree::elements(l).back()));
+            }
+
+#ifdef BOOST_GEOMETRY_INDEX_EXPERIMENTAL_ENLARGE_BY_EPSILON
+            // Enlarge bounds of a leaf node the same way as in pack.
+            if ( BOOST_GEOMETRY_CONDITION((
+                    ! index::detail::is_bounding_geometry
+                        <
+                            typename indexable_type<Translator>::type
+                        >::value )) )
+            {
+                geometry::detail::expand_by_epsilon(elements_box);
+            }
+#endif
+
+            rtree::update_aggregate<Value, Options, Box, Allocators>::apply(l, parameters);
+
+            auto_remover.release();
+            return internal_element(elements_box, n);
+        }
+
+        pack_utils::subtree_elements_counts next_subtree_counts = subtree_counts;
+        next_subtree_counts.maxc /= parameters.get_max_elements();
+        next_subtree_counts.minc /= parameters.get_max_elements();
+
+        node_pointer n = rtree::create_node<Allocators, internal_node>::apply(allocators);                  // MAY THROW (A)
+        subtree_destroyer auto_remover(n, allocators);
+        internal_node & in = rtree::get<internal_node>(*n);
+
+        rtree::elements(in).reserve(pack_utils::calculate_nodes_count(values_count, subtree_counts));      // MAY THROW (A)
+
+        per_level_packets(source, values_count, subtree_counts, next_subtree_counts,
+                          rtree::elements(in), parameters, translator, allocators);                         // MAY THROW (A, C, F)
+
+        Box elements_box = rtree::elements(in).front().first;
+        for ( typename internal_elements::const_iterator it = rtree::elements(in).begin() + 1 ;
+              it != rtree::elements(in).end() ; ++it )
+        {
+            geometry::expand(elements_box, it->first);
+        }
+
+        rtree::update_aggregate<Value, Options, Box, Allocators>::apply(in, parameters);
+
+        auto_remover.release();
+        return internal_element(elements_box, n);
+    }
+
+    inline static
+    void per_level_packets(merged_runs & source, std::size_t values_count,
+                           pack_utils::subtree_elements_counts const& subtree_counts,
+                           pack_utils::subtree_elements_counts const& next_subtree_counts,
+                           internal_elements & elements,
+                           parameters_type const& parameters, Translator const& translator, Allocators & allocators)
+    {
+        BOOST_GEOMETRY_INDEX_ASSERT(subtree_counts.minc <= values_count,
+                                    "too small number of elements");
+
+        // only one packet
+        if ( values_count <= subtree_counts.maxc )
+        {
+            internal_element el = per_level(source, values_count, next_subtree_counts,
+                                            parameters, translator, allocators);                            // MAY THROW (A, C, F)
+
+            subtree_destroyer auto_remover(el.second, allocators);
+            // this container should have memory allocated, reserve() called outside
+            elements.push_back(el);                                                                         // MAY THROW (A?, C) - however in normal conditions shouldn't
+            auto_remover.release();
+            return;
+        }
+
+        std::size_t median_count = pack_utils::calculate_median_count(values_count, subtree_counts);
+
+        per_level_packets(source, median_count, subtree_counts, next_subtree_counts,
+                          elements, parameters, translator, allocators);                                    // MAY THROW (A, C, F)
+        per_level_packets(source, values_count - median_count, subtree_counts, next_subtree_counts,
+                          elements, parameters, translator, allocators);                                    // MAY THROW (A, C, F)
+    }
+};
+
+}}}}} // namespace boost::geometry::index::detail::rtree
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_PACK_EXTERNAL_HPP
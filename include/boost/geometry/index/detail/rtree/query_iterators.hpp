@@ -63,6 +63,7 @@ class spatial_query_iterator
 {
     typedef visitors::spatial_query_incremental<Value, Options, Translator, Box, Allocators, Predicates> visitor_type;
     typedef typename visitor_type::node_pointer node_pointer;
+    typedef typename visitor_type::size_type size_type;
 
 public:
     typedef std::forward_iterator_tag iterator_category;
@@ -84,6 +85,13 @@ public:
         m_visitor.initialize(root);
     }
 
+    inline spatial_query_iterator(node_pointer root, size_type leafs_level, size_type max_elements, size_type values_count,
+                                  Translator const& t, Predicates const& p)
+        : m_visitor(t, p)
+    {
+        m_visitor.initialize(root, leafs_level, max_elements, values_count);
+    }
+
     reference operator*() const
     {
         return m_visitor.dereference();
@@ -131,6 +139,7 @@ class distance_query_iterator
 {
     typedef visitors::distance_query_incremental<Value, Options, Translator, Box, Allocators, Predicates, NearestPredicateIndex> visitor_type;
     typedef typename visitor_type::node_pointer node_pointer;
+    typedef typename visitor_type::size_type size_type;
 
 public:
     typedef std::forward_iterator_tag iterator_category;
@@ -152,6 +161,13 @@ public:
         m_visitor.initialize(root);
     }
 
+    inline distance_query_iterator(node_pointer root, size_type leafs_level, size_type max_elements, size_type values_count,
+                                   Translator const& t, Predicates const& p)
+        : m_visitor(t, p)
+    {
+        m_visitor.initialize(root, leafs_level, max_elements, values_count);
+    }
+
     reference operator*() const
     {
         return m_visitor.dereference();
@@ -195,6 +211,45 @@ private:
 };
 
 
+// The statically-typed iterator performing the query for Predicates
+template <typename Value, typename Options, typename Translator, typename Box, typename Allocators, typename Predicates>
+struct query_iterator_type
+{
+    typedef typename boost::mpl::if_c<
+        index::detail::predicates_count_distance<Predicates>::value == 0,
+        spatial_query_iterator<Value, Options, Translator, Box, Allocators, Predicates>,
+        distance_query_iterator<
+            Value, Options, Translator, Box, Allocators, Predicates,
+            index::detail::predicates_find_distance<Predicates>::value
+        >
+    >::type type;
+};
+
+// The range of values returned by the query, both iterators have the same type
+template <typename Iterator>
+class query_range
+{
+public:
+    typedef Iterator iterator;
+    typedef Iterator const_iterator;
+    typedef typename Iterator::value_type value_type;
+    typedef typename Iterator::reference reference;
+    typedef typename Iterator::reference const_reference;
+    typedef typename Iterator::difference_type difference_type;
+
+    query_range(Iterator const& first, Iterator const& last)
+        : m_first(first), m_last(last)
+    {}
+
+    const_iterator begin() const { return m_first; }
+    const_iterator end() const { return m_last; }
+    bool empty() const { return m_first == m_last; }
+
+private:
+    Iterator m_first;
+    Iterator m_last;
+};
+
 template <typename L, typename R>
 inline bool operator!=(L const& l, R const& r)
 {
@@ -0,0 +1,36 @@
+// Boost.Geometry Index
+//
+// R-tree query visitors statistics policy
+//
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_QUERY_STATISTICS_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_QUERY_STATISTICS_HPP
+
+#include <cstddef>
+
+namespace boost { namespace geometry { namespace index { namespace detail { namespace rtree {
+
+// The default statistics policy of query visitors, nothing is recorded.
+// See utilities::query_statistics for the policy recording the traversal.
+struct no_query_statistics
+{
+    // internal node visited
+    inline void visit_internal_node() {}
+    // leaf visited, its values are scanned
+    inline void visit_leaf() {}
+    // predicates checked for the box of a child node
+    inline void check_bounds() {}
+    // predicates checked for a value
+    inline void check_value() {}
+    // values returned by the query
+    inline void return_values(std::size_t ) {}
+};
+
+}}}}} // namespace boost::geometry::index::detail::rtree
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_QUERY_STATISTICS_HPP
@@ -0,0 +1,477 @@
+// Boost.Geometry Index
+//
+// R-tree batch remove
+//
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_REMOVE_BATCH_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_REMOVE_BATCH_HPP
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include <boost/geometry/algorithms/detail/covered_by/interface.hpp>
+#include <boost/geometry/util/parallel.hpp>
+
+#include <boost/geometry/index/detail/algorithms/bounds.hpp>
+#include <boost/geometry/index/detail/rtree/visitors/insert.hpp>
+
+namespace boost { namespace geometry { namespace index { namespace detail { namespace rtree {
+
+// Removes a range of values from the tree.
+//
+// The tree is traversed once. Each internal node is visited for all values which
+// boxes are covered by its box, like in the remove visitor, and a value is removed
+// only once. After the children of a node are processed the boxes of the modified
+// children are recalculated and the children having less than min elements are
+// removed from the node. At the end the elements of the removed internal nodes are
+// reinserted at their levels and the values of the removed leafs are returned so
+// they may be inserted with insert_batch. The tree is shortened if the root has
+// one child.
+//
+// apply_if() removes all values meeting the predicate in the same way. All nodes
+// are visited once. The subtrees of the children of the root may be processed
+// by many threads, then the predicate is called concurrently.
+template <typename Value, typename Options, typename Translator, typename Box, typename Allocators>
+class remove_batch
+{
+    typedef typename Options::parameters_type parameters_type;
+
+    typedef typename rtree::node<Value, parameters_type, Box, Allocators, typename Options::node_tag>::type node;
+    typedef typename rtree::internal_node<Value, parameters_type, Box, Allocators, typename Options::node_tag>::type internal_node;
+    typedef typename rtree::leaf<Value, parameters_type, Box, Allocators, typename Options::node_tag>::type leaf;
+
+    typedef typename Allocators::node_pointer node_pointer;
+    typedef typename Allocators::size_type size_type;
+    typedef rtree::subtree_destroyer<Value, Options, Translator, Box, Allocators> subtree_destroyer;
+
+    typedef typename rtree::elements_type<internal_node>::type internal_elements;
+    typedef typename rtree::elements_type<leaf>::type leaf_elements;
+
+    // The removed nodes and the levels of their parents counted from the leafs level
+    typedef std::vector<std::pair<size_type, node_pointer> > underflowed_nodes_type;
+
+public:
+    // Returns the number of removed values. The values of the removed leafs are
+    // moved to orphaned_values and are no longer stored in the tree.
+    template <typename FwdIt> inline static
+    size_type apply(node_pointer & root, size_type & leafs_level,
+                    FwdIt first, FwdIt last,
+                    std::vector<Value> & orphaned_values,
+                    parameters_type const& parameters, Translator const& translator, Allocators & allocators)
+    {
+        BOOST_GEOMETRY_INDEX_ASSERT(root, "The root must exist");
+
+        remove_batch rb(parameters, translator, allocators);
+
+        std::vector<FwdIt> values;
+        std::vector<Box> boxes;
+        for ( ; first != last ; ++first )
+        {
+            Box b;
+            index::detail::bounds(translator(*first), b);
+            values.push_back(first);
+            boxes.push_back(b);
+        }
+
+        std::vector<char> removed(values.size(), 0);
+        std::vector<std::size_t> indexes(values.size());
+        for ( std::size_t i = 0 ; i < indexes.size() ; ++i )
+            indexes[i] = i;
+
+        underflowed_nodes_type underflowed_nodes;
+        size_type const removed_count = rb.remove_from(root, 0, leafs_level, values, boxes, removed, indexes, underflowed_nodes);
+
+        BOOST_TRY
+        {
+            rb.reinsert(root, leafs_level, underflowed_nodes, orphaned_values);                       // MAY THROW (V, E: alloc, copy, N: alloc)
+        }
+        BOOST_CATCH(...)
+        {
+            for ( std::size_t i = 0 ; i < underflowed_nodes.size() ; ++i )
+                subtree_destroyer dummy(underflowed_nodes[i].second, allocators);
+            BOOST_RETHROW                                                                             // RETHROW
+        }
+        BOOST_CATCH_END
+
+        if ( root )
+            rtree::update_aggregate<Value, Options, Box, Allocators>::apply(*root, parameters);
+
+        return removed_count;
+    }
+
+    // Returns the number of removed values meeting the predicate. The values of
+    // the removed leafs are moved to orphaned_values and are no longer stored in the tree.
+    template <typename UnaryPredicate> inline static
+    size_type apply_if(node_pointer & root, size_type & leafs_level,
+                       UnaryPredicate const& pred, std::size_t threads,
+                       std::vector<Value> & orphaned_values,
+                       parameters_type const& parameters, Translator const& translator, Allocators & allocators)
+    {
+        BOOST_GEOMETRY_INDEX_ASSERT(root, "The root must exist");
+
+        remove_batch rb(parameters, translator, allocators);
+
+        size_type removed_count = 0;
+        underflowed_nodes_type underflowed_nodes;
+
+        BOOST_TRY
+        {
+            if ( 0 < leafs_level && 1 < threads )
+                removed_count = rb.remove_if_parallel(root, leafs_level, pred, threads, underflowed_nodes);  // MAY THROW
+            else
+                removed_count = rb.remove_if_from(root, 0, leafs_level, pred, underflowed_nodes);            // MAY THROW
+
+            rb.reinsert(root, leafs_level, underflowed_nodes, orphaned_values);                       // MAY THROW (V, E: alloc, copy, N: alloc)
+        }
+        BOOST_CATCH(...)
+        {
+            for ( std::size_t i = 0 ; i < underflowed_nodes.size() ; ++i )
+                subtree_destroyer dummy(underflowed_nodes[i].second, allocators);
+            BOOST_RETHROW                                                                             // RETHROW
+        }
+        BOOST_CATCH_END
+
+        if ( root )
+            rtree::update_aggregate<Value, Options, Box, Allocators>::apply(*root, parameters);
+
+        return removed_count;
+    }
+
+private:
+    template <typename UnaryPredicate>
+    struct remove_if_chunk
+    {
+        remove_if_chunk(remove_batch & r, internal_elements & c, size_type ll, UnaryPredicate const& p,
+                        std::vector<size_type> & rc, std::vector<underflowed_nodes_type> & un)
+            : rb(r), children(c), leafs_level(ll), pred(p), removed_counts(rc), underflowed_nodes(un)
+        {}
+
+        // the removed count of each child of the root is stored
+        void operator()(std::size_t f, std::size_t l, std::size_t chunk_index)
+        {
+            for ( std::size_t c = f ; c < l ; ++c )
+                removed_counts[c] = rb.remove_if_from(children[c].second, 1, leafs_level, pred,
+                                                      underflowed_nodes[chunk_index]);                // MAY THROW
+        }
+
+        remove_batch & rb;
+        internal_elements & children;
+        size_type leafs_level;
+        UnaryPredicate const& pred;
+        std::vector<size_type> & removed_counts;
+        std::vector<underflowed_nodes_type> & underflowed_nodes;
+    };
+
+    remove_batch(parameters_type const& parameters, Translator const& translator, Allocators & allocators)
+        : m_parameters(parameters), m_translator(translator), m_allocators(allocators)
+    {}
+
+    template <typename FwdIt>
+    size_type remove_from(node_pointer n, size_type level, size_type leafs_level,
+                          std::vector<FwdIt> const& values,
+                          std::vector<Box> const& boxes,
+                          std::vector<char> & removed,
+                          std::vector<std::size_t> const& indexes,
+                          underflowed_nodes_type & underflowed_nodes)
+    {
+        size_type result = 0;
+
+        if ( level == leafs_level )
+        {
+            leaf_elements & elements = rtree::elements(rtree::get<leaf>(*n));
+
+            for ( std::size_t i = 0 ; i < indexes.size() ; ++i )
+            {
+                std::size_t const v = indexes[i];
+                if ( removed[v] )
+                    continue;
+
+                for ( typename leaf_elements::iterator it = elements.begin() ; it != elements.end() ; ++it )
+                {
+                    if ( m_translator.equals(*it, *values[v]) )
+                    {
+                        rtree::move_from_back(elements, it);                                          // MAY THROW (V: copy)
+                        elements.pop_back();
+                        removed[v] = 1;
+                        ++result;
+                        break;
+                    }
+                }
+            }
+
+            return result;
+        }
+
+        internal_elements & children = rtree::elements(rtree::get<internal_node>(*n));
+
+        // traverse the children which boxes cover the boxes of values
+        std::vector<std::size_t> modified;
+        std::vector<std::size_t> child_indexes;
+        for ( std::size_t c = 0 ; c < children.size() ; ++c )
+        {
+            child_indexes.clear();
+            for ( std::size_t i = 0 ; i < indexes.size() ; ++i )
+            {
+                std::size_t const v = indexes[i];
+                if ( ! removed[v] && geometry::covered_by(boxes[v], children[c].first) )
+                    child_indexes.push_back(v);
+            }
+
+            if ( child_indexes.empty() )
+                continue;
+
+            size_type const count = remove_from(children[c].second, level + 1, leafs_level,
+                                                values, boxes, removed, child_indexes, underflowed_nodes);    // MAY THROW
+            if ( 0 < count )
+            {
+                modified.push_back(c);
+                result += count;
+            }
+        }
+
+        condense(children, modified, level, leafs_level, underflowed_nodes);                         // MAY THROW (E: alloc, copy)
+
+        return result;
+    }
+
+    template <typename UnaryPredicate>
+    size_type remove_if_from(node_pointer n, size_type level, size_type leafs_level,
+                             UnaryPredicate const& pred,
+                             underflowed_nodes_type & underflowed_nodes)
+    {
+        size_type result = 0;
+
+        if ( level == leafs_level )
+        {
+            leaf_elements & elements = rtree::elements(rtree::get<leaf>(*n));
+
+            for ( typename leaf_elements::iterator it = elements.begin() ; it != elements.end() ; )
+            {
+                if ( pred(*it) )
+                {
+                    rtree::move_from_back(elements, it);                                              // MAY THROW (V: copy)
+                    elements.pop_back();
+                    ++result;
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+
+            return result;
+        }
+
+        internal_elements & children = rtree::elements(rtree::get<internal_node>(*n));
+
+        std::vector<std::size_t> modified;
+        for ( std::size_t c = 0 ; c < children.size() ; ++c )
+        {
+            size_type const count = remove_if_from(children[c].second, level + 1, leafs_level,
+                                                   pred, underflowed_nodes);                          // MAY THROW
+            if ( 0 < count )
+            {
+                modified.push_back(c);
+                result += count;
+            }
+        }
+
+        condense(children, modified, level, leafs_level, underflowed_nodes);                         // MAY THROW (E: alloc, copy)
+
+        return result;
+    }
+
+    // The subtrees of the children of the root are divided into contiguous chunks,
+    // one chunk per thread. The root is updated after all threads have finished.
+    template <typename UnaryPredicate>
+    size_type remove_if_parallel(node_pointer root, size_type leafs_level,
+                                 UnaryPredicate const& pred, std::size_t threads,
+                                 underflowed_nodes_type & underflowed_nodes)
+    {
+        internal_elements & children = rtree::elements(rtree::get<internal_node>(*root));
+        if ( children.size() < threads )
+            threads = children.size();
+
+        std::vector<size_type> removed_counts(children.size(), 0);
+        std::vector<underflowed_nodes_type> chunks_underflowed_nodes(threads);
+        remove_if_chunk<UnaryPredicate> f(*this, children, leafs_level, pred, removed_counts, chunks_underflowed_nodes);
+
+        BOOST_TRY
+        {
+            geometry::detail::parallel::for_each_chunk(children.size(), threads, f);                  // MAY THROW
+        }
+        BOOST_CATCH(...)
+        {
+            for ( std::size_t i = 0 ; i < chunks_underflowed_nodes.size() ; ++i )
+                for ( std::size_t j = 0 ; j < chunks_underflowed_nodes[i].size() ; ++j )
+                    subtree_destroyer dummy(chunks_underflowed_nodes[i][j].second, m_allocators);
+            BOOST_RETHROW                                                                             // RETHROW
+        }
+        BOOST_CATCH_END
+
+        // the nodes are moved before anything may throw so they're destroyed by the caller
+        for ( std::size_t i = 0 ; i < chunks_underflowed_nodes.size() ; ++i )
+        {
+            underflowed_nodes_type & un = chunks_underflowed_nodes[i];
+            while ( ! un.empty() )
+            {
+                underflowed_nodes.push_back(un.back());                                               // MAY THROW (E: alloc)
+                un.pop_back();
+            }
+        }
+
+        size_type result = 0;
+        std::vector<std::size_t> modified;
+        for ( std::size_t c = 0 ; c < children.size() ; ++c )
+        {
+            if ( 0 < removed_counts[c] )
+            {
+                modified.push_back(c);
+                result += removed_counts[c];
+            }
+        }
+
+        condense(children, modified, 0, leafs_level, underflowed_nodes);                             // MAY THROW (E: alloc, copy)
+
+        return result;
+    }
+
+    // Updates the modified children, from the back because the underflowed
+    // children are replaced with the last ones.
+    void condense(internal_elements & children, std::vector<std::size_t> const& modified,
+                  size_type level, size_type leafs_level,
+                  underflowed_nodes_type & underflowed_nodes) const
+    {
+        for ( std::size_t m = modified.size() ; m > 0 ; --m )
+        {
+            std::size_t const c = modified[m - 1];
+            bool const child_is_leaf = level + 1 == leafs_level;
+            std::size_t const count = child_is_leaf
+                                    ? update_child(children[c], rtree::get<leaf>(*children[c].second))
+                                    : update_child(children[c], rtree::get<internal_node>(*children[c].second));
+
+            if ( count < m_parameters.get_min_elements() )
+            {
+                underflowed_nodes.push_back(std::make_pair(leafs_level - level, children[c].second));    // MAY THROW (E: alloc, copy)
+                rtree::move_from_back(children, children.begin() + c);                                // MAY THROW (E: copy)
+                children.pop_back();
+            }
+        }
+    }
+
+    template <typename Element>
+    std::size_t update_child(Element & el, leaf & l) const
+    {
+        el.first = rtree::values_box<Box>(rtree::elements(l).begin(), rtree::elements(l).end(), m_translator);
+        rtree::update_aggregate<Value, Options, Box, Allocators>::apply(l, m_parameters);
+        return rtree::elements(l).size();
+    }
+
+    template <typename Element>
+    std::size_t update_child(Element & el, internal_node & n) const
+    {
+        el.first = rtree::elements_box<Box>(rtree::elements(n).begin(), rtree::elements(n).end(), m_translator);
+        rtree::update_aggregate<Value, Options, Box, Allocators>::apply(n, m_parameters);
+        return rtree::elements(n).size();
+    }
+
+    void reinsert(node_pointer & root, size_type & leafs_level,
+                  underflowed_nodes_type & underflowed_nodes,
+                  std::vector<Value> & orphaned_values)
+    {
+        // the nodes are taken from the back, the nodes closer to the root first
+        std::stable_sort(underflowed_nodes.begin(), underflowed_nodes.end(), level_less);
+
+        bool const root_is_empty = 0 < leafs_level
+                                && rtree::elements(rtree::get<internal_node>(*root)).empty();
+
+        while ( ! underflowed_nodes.empty() )
+        {
+            std::pair<size_type, node_pointer> const un = underflowed_nodes.back();
+            underflowed_nodes.pop_back();
+            subtree_destroyer un_guard(un.second, m_allocators);
+
+            // the elements may be reinserted if the root still has children
+            if ( un.first == 1 || root_is_empty )
+                collect_values(un.second, un.first - 1, orphaned_values);                            // MAY THROW (V: alloc, copy)
+            else
+                reinsert_elements(root, leafs_level, un);                                             // MAY THROW (V, E: alloc, copy, N: alloc)
+        }
+
+        if ( root_is_empty )
+        {
+            rtree::destroy_node<Allocators, internal_node>::apply(m_allocators, root);
+            root = 0;
+            leafs_level = 0;
+            return;
+        }
+
+        // shorten the tree
+        while ( 0 < leafs_level && rtree::elements(rtree::get<internal_node>(*root)).size() == 1 )
+        {
+            node_pointer const root_to_destroy = root;
+            root = rtree::elements(rtree::get<internal_node>(*root))[0].second;
+            --leafs_level;
+
+            rtree::destroy_node<Allocators, internal_node>::apply(m_allocators, root_to_destroy);
+        }
+    }
+
+    // Reinserts the children of an underflowed internal node and destroys the node.
+    void reinsert_elements(node_pointer & root, size_type & leafs_level,
+                           std::pair<size_type, node_pointer> const& un)
+    {
+        internal_elements & elements = rtree::elements(rtree::get<internal_node>(*un.second));
+
+        while ( ! elements.empty() )
+        {
+            typename internal_elements::value_type const el = elements.back();
+            elements.pop_back();
+
+            visitors::insert<
+                typename internal_elements::value_type,
+                Value, Options, Translator, Box, Allocators,
+                typename Options::insert_tag
+            > insert_v(root, leafs_level, el, m_parameters, m_translator, m_allocators, un.first - 1);
+
+            rtree::apply_visitor(insert_v, *root);                                                    // MAY THROW (V, E: alloc, copy, N: alloc)
+        }
+    }
+
+    // Copies the values stored in the subtree, the subtree is destroyed by the caller.
+    void collect_values(node_pointer n, size_type relative_level, std::vector<Value> & result) const
+    {
+        if ( 0 == relative_level )
+        {
+            leaf_elements const& elements = rtree::elements(rtree::get<leaf>(*n));
+            result.insert(result.end(), elements.begin(), elements.end());                           // MAY THROW (V: alloc, copy)
+        }
+        else
+        {
+            internal_elements const& elements = rtree::elements(rtree::get<internal_node>(*n));
+            for ( typename internal_elements::const_iterator it = elements.begin() ; it != elements.end() ; ++it )
+                collect_values(it->second, relative_level - 1, result);                              // MAY THROW (V: alloc, copy)
+        }
+    }
+
+    static inline bool level_less(std::pair<size_type, node_pointer> const& l,
+                                  std::pair<size_type, node_pointer> const& r)
+    {
+        return l.first < r.first;
+    }
+
+    parameters_type const& m_parameters;
+    Translator const& m_translator;
+    Allocators & m_allocators;
+};
+
+}}}}} // namespace boost::geometry::index::detail::rtree
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_REMOVE_BATCH_HPP
@@ -0,0 +1,213 @@
+// Boost.Geometry Index
+//
+// R-tree nodes reordering in memory
+//
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_REORDER_NODES_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_REORDER_NODES_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/move/utility_core.hpp>
+
+#include <boost/geometry/index/packing.hpp>
+
+namespace boost { namespace geometry { namespace index { namespace detail { namespace rtree {
+
+// Allocates the nodes of the tree again, one after another in the given order
+// and moves the elements into them. The structure of the tree isn't changed.
+// The allocators usually place the blocks allocated one after another next to
+// each other, e.g. node_pool_allocator in the same slab, so the nodes visited
+// together by the queries are close in memory. In both orders each node is
+// placed before its descendants.
+//
+// The old nodes are released after all new nodes are created so their memory
+// isn't reused. If an exception is thrown the tree is destroyed.
+template <typename Value, typename Options, typename Translator, typename Box, typename Allocators>
+class reorder_nodes
+{
+    typedef typename rtree::internal_node<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag>::type internal_node;
+    typedef typename rtree::leaf<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag>::type leaf;
+
+    typedef typename rtree::elements_type<internal_node>::type internal_elements;
+    typedef typename rtree::elements_type<leaf>::type leaf_elements;
+
+    typedef typename Allocators::node_pointer node_pointer;
+    typedef typename Allocators::size_type size_type;
+    typedef typename node_aggregate<typename Options::parameters_type, size_type>::type aggregate_type;
+    typedef rtree::subtree_destroyer<Value, Options, Translator, Box, Allocators> subtree_destroyer;
+
+    struct entry
+    {
+        entry(node_pointer n, std::size_t p, std::size_t s, size_type l)
+            : node(n), parent(p), slot(s), level(l)
+        {}
+
+        node_pointer node;
+        std::size_t parent;     // the index of the parent in the new order
+        std::size_t slot;       // the index of the node in the elements of the parent
+        size_type level;
+    };
+
+    typedef std::vector<entry> entries_type;
+
+    static const std::size_t no_parent = std::size_t(-1);
+
+public:
+    static inline node_pointer apply(node_pointer root, size_type leafs_level,
+                                     index::packing::node_order_type order,
+                                     Allocators & allocators)
+    {
+        if ( ! root || order == index::packing::creation_order )
+            return root;
+
+        entries_type entries;
+
+        BOOST_TRY
+        {
+            if ( order == index::packing::breadth_first )
+                gather_breadth_first(root, leafs_level, entries);                                   // MAY THROW (A)
+            else
+            {
+                entries_type children;
+                gather_van_emde_boas(entry(root, no_parent, 0, 0), leafs_level + 1,
+                                     leafs_level, entries, children);                               // MAY THROW (A)
+            }
+        }
+        BOOST_CATCH(...)
+        {
+            subtree_destroyer auto_remover(root, allocators);
+            BOOST_RETHROW                                                                           // RETHROW
+        }
+        BOOST_CATCH_END
+
+        return move_nodes(root, leafs_level, entries, allocators);                                  // MAY THROW (A, V: move)
+    }
+
+private:
+    static inline void push_children(entry const& e, std::size_t index, entries_type & children)
+    {
+        internal_elements const& elements = rtree::elements(rtree::get<internal_node>(*e.node));
+        for ( std::size_t i = 0 ; i < elements.size() ; ++i )
+            children.push_back(entry(elements[i].second, index, i, e.level + 1));
+    }
+
+    static inline void gather_breadth_first(node_pointer root, size_type leafs_level, entries_type & entries)
+    {
+        entries.push_back(entry(root, no_parent, 0, 0));
+        for ( std::size_t i = 0 ; i < entries.size() ; ++i )
+        {
+            if ( entries[i].level < leafs_level )
+            {
+                entry const e = entries[i];
+                push_children(e, i, entries);
+            }
+        }
+    }
+
+    // Lays out the part of the subtree of height levels. The top half of the levels
+    // is laid out recursively first and then the subtrees of the bottom half, each
+    // recursively. The children of the nodes of the lowest level of the part
+    // are stored in children.
+    static inline void gather_van_emde_boas(entry const& e, size_type height, size_type leafs_level,
+                                            entries_type & entries, entries_type & children)
+    {
+        if ( height == 1 )
+        {
+            entries.push_back(e);
+            if ( e.level < leafs_level )
+                push_children(e, entries.size() - 1, children);
+            return;
+        }
+
+        size_type const top_height = height / 2;
+        size_type const bottom_height = height - top_height;
+
+        entries_type top_children;
+        gather_van_emde_boas(e, top_height, leafs_level, entries, top_children);
+        for ( std::size_t i = 0 ; i < top_children.size() ; ++i )
+            gather_van_emde_boas(top_children[i], bottom_height, leafs_level, entries, children);
+    }
+
+    static inline node_pointer move_nodes(node_pointer root, size_type leafs_level,
+                                          entries_type const& entries, Allocators & allocators)
+    {
+        std::vector<node_pointer> new_nodes;
+
+        BOOST_TRY
+        {
+            new_nodes.reserve(entries.size());                                                      // MAY THROW (A)
+
+            for ( std::size_t i = 0 ; i < entries.size() ; ++i )
+            {
+                entry const& e = entries[i];
+                node_pointer n = 0;
+
+                if ( e.level < leafs_level )
+                {
+                    n = rtree::create_node<Allocators, internal_node>::apply(allocators);           // MAY THROW (A)
+                    new_nodes.push_back(n);
+
+                    internal_elements & src = rtree::elements(rtree::get<internal_node>(*e.node));
+                    internal_elements & dst = rtree::elements(rtree::get<internal_node>(*n));
+                    // the children are updated when they're created
+                    dst.reserve(src.size());                                                        // MAY THROW (A)
+                    for ( std::size_t j = 0 ; j < src.size() ; ++j )
+                        dst.push_back(src[j]);
+
+                    static_cast<aggregate_type &>(rtree::get<internal_node>(*n))
+                        = static_cast<aggregate_type const&>(rtree::get<internal_node>(*e.node));
+                }
+                else
+                {
+                    n = rtree::create_node<Allocators, leaf>::apply(allocators);                    // MAY THROW (A)
+                    new_nodes.push_back(n);
+
+                    leaf_elements & src = rtree::elements(rtree::get<leaf>(*e.node));
+                    leaf_elements & dst = rtree::elements(rtree::get<leaf>(*n));
+                    dst.reserve(src.size());                                                        // MAY THROW (A)
+                    for ( std::size_t j = 0 ; j < src.size() ; ++j )
+                        dst.push_back(boost::move(src[j]));                                         // MAY THROW (V: move)
+
+                    static_cast<aggregate_type &>(rtree::get<leaf>(*n))
+                        = static_cast<aggregate_type const&>(rtree::get<leaf>(*e.node));
+                }
+
+                if ( e.parent != no_parent )
+                    rtree::elements(rtree::get<internal_node>(*new_nodes[e.parent]))[e.slot].second = n;
+            }
+        }
+        BOOST_CATCH(...)
+        {
+            // the children of the new nodes may be the old nodes so only the nodes are destroyed
+            for ( std::size_t i = 0 ; i < new_nodes.size() ; ++i )
+                destroy_node(new_nodes[i], entries[i].level, leafs_level, allocators);
+            subtree_destroyer auto_remover(root, allocators);
+            BOOST_RETHROW                                                                           // RETHROW
+        }
+        BOOST_CATCH_END
+
+        for ( std::size_t i = 0 ; i < entries.size() ; ++i )
+            destroy_node(entries[i].node, entries[i].level, leafs_level, allocators);
+
+        return new_nodes.front();
+    }
+
+    static inline void destroy_node(node_pointer n, size_type level, size_type leafs_level, Allocators & allocators)
+    {
+        if ( level < leafs_level )
+            rtree::destroy_node<Allocators, internal_node>::apply(allocators, n);
+        else
+            rtree::destroy_node<Allocators, leaf>::apply(allocators, n);
+    }
+};
+
+}}}}} // namespace boost::geometry::index::detail::rtree
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_REORDER_NODES_HPP
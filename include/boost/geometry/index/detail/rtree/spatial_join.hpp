@@ -0,0 +1,345 @@
+// Boost.Geometry Index
+//
+// R-tree spatial join
+//
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_SPATIAL_JOIN_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_SPATIAL_JOIN_HPP
+
+#include <utility>
+#include <vector>
+
+#include <boost/core/addressof.hpp>
+
+#include <boost/geometry/algorithms/intersects.hpp>
+
+#include <boost/geometry/index/detail/rtree/utilities/view.hpp>
+
+#include <boost/geometry/util/parallel.hpp>
+
+namespace boost { namespace geometry { namespace index { namespace detail { namespace rtree {
+
+// Finds all pairs of values of two rtrees for which the indexables intersect.
+// Both trees are traversed simultaneously. A pair of nodes is visited only if
+// their boxes intersect and the children of a node not intersecting the box of
+// the other node are skipped. If the trees have different heights the nodes of
+// the higher tree are traversed alone when the leafs of the other one are reached.
+// The pairs are found in the order defined by the structures of both trees.
+//
+// In the parallel version the pairs of the children of the roots meeting the above
+// conditions are gathered and divided into contiguous chunks, one chunk per thread.
+// The results of chunks are stored and returned in the same order as in the
+// sequential version.
+template <typename Rtree1, typename Rtree2>
+class spatial_join
+{
+    typedef utilities::view<Rtree1> view1_type;
+    typedef utilities::view<Rtree2> view2_type;
+
+    typedef typename view1_type::value_type value1_type;
+    typedef typename view1_type::options_type options1_type;
+    typedef typename view1_type::box_type box1_type;
+    typedef typename view1_type::allocators_type allocators1_type;
+    typedef typename view1_type::translator_type translator1_type;
+
+    typedef typename view2_type::value_type value2_type;
+    typedef typename view2_type::options_type options2_type;
+    typedef typename view2_type::box_type box2_type;
+    typedef typename view2_type::allocators_type allocators2_type;
+    typedef typename view2_type::translator_type translator2_type;
+
+    typedef typename rtree::internal_node<value1_type, typename options1_type::parameters_type, box1_type, allocators1_type, typename options1_type::node_tag>::type internal1_type;
+    typedef typename rtree::leaf<value1_type, typename options1_type::parameters_type, box1_type, allocators1_type, typename options1_type::node_tag>::type leaf1_type;
+    typedef typename rtree::internal_node<value2_type, typename options2_type::parameters_type, box2_type, allocators2_type, typename options2_type::node_tag>::type internal2_type;
+    typedef typename rtree::leaf<value2_type, typename options2_type::parameters_type, box2_type, allocators2_type, typename options2_type::node_tag>::type leaf2_type;
+
+    typedef typename allocators1_type::node_pointer node1_pointer;
+    typedef typename allocators2_type::node_pointer node2_pointer;
+
+    typedef typename rtree::elements_type<internal1_type>::type internal1_elements;
+    typedef typename rtree::elements_type<internal2_type>::type internal2_elements;
+    typedef typename rtree::elements_type<leaf1_type>::type leaf1_elements;
+    typedef typename rtree::elements_type<leaf2_type>::type leaf2_elements;
+
+    typedef std::pair<const value1_type *, const value2_type *> found_type;
+
+    template <typename Value, typename Options, typename Box, typename Allocators>
+    struct root_visitor
+        : public rtree::visitor<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag, true>::type
+    {
+        typedef typename rtree::internal_node<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag>::type internal_node;
+        typedef typename rtree::leaf<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag>::type leaf;
+
+        root_visitor() : internal(0), leaf_node(0) {}
+
+        void operator()(internal_node const& n) { internal = boost::addressof(n); }
+        void operator()(leaf const& n) { leaf_node = boost::addressof(n); }
+
+        const internal_node * internal;
+        const leaf * leaf_node;
+    };
+
+    typedef root_visitor<value1_type, options1_type, box1_type, allocators1_type> root1_visitor;
+    typedef root_visitor<value2_type, options2_type, box2_type, allocators2_type> root2_visitor;
+
+    struct task
+    {
+        task(node1_pointer p1, box1_type const& b1, node2_pointer p2, box2_type const& b2)
+            : ptr1(p1), box1(b1), ptr2(p2), box2(b2)
+        {}
+
+        node1_pointer ptr1;
+        box1_type box1;
+        node2_pointer ptr2;
+        box2_type box2;
+    };
+
+    template <typename OutIter>
+    struct out_iter_emitter
+    {
+        explicit out_iter_emitter(OutIter it) : out_it(it), found_count(0) {}
+
+        void operator()(value1_type const& v1, value2_type const& v2)
+        {
+            *out_it = std::make_pair(v1, v2);
+            ++out_it;
+            ++found_count;
+        }
+
+        OutIter out_it;
+        std::size_t found_count;
+    };
+
+    struct pointers_emitter
+    {
+        void operator()(value1_type const& v1, value2_type const& v2)
+        {
+            found.push_back(found_type(boost::addressof(v1), boost::addressof(v2)));
+        }
+
+        std::vector<found_type> found;
+    };
+
+    template <typename Emitter>
+    class traversal
+    {
+    public:
+        traversal(translator1_type const& t1, std::size_t ll1,
+                  translator2_type const& t2, std::size_t ll2,
+                  Emitter & e)
+            : m_tr1(t1), m_tr2(t2)
+            , m_leafs_level1(ll1), m_leafs_level2(ll2)
+            , m_emitter(e)
+        {}
+
+        void apply(internal1_type const& n1, std::size_t l1, box1_type const& ,
+                   internal2_type const& n2, std::size_t l2, box2_type const& b2)
+        {
+            internal1_elements const& elements1 = rtree::elements(n1);
+            internal2_elements const& elements2 = rtree::elements(n2);
+
+            for ( typename internal1_elements::const_iterator it1 = elements1.begin() ; it1 != elements1.end() ; ++it1 )
+            {
+                // if the child doesn't intersect the other node it can't intersect its children
+                if ( ! geometry::intersects(it1->first, b2) )
+                    continue;
+
+                for ( typename internal2_elements::const_iterator it2 = elements2.begin() ; it2 != elements2.end() ; ++it2 )
+                {
+                    if ( geometry::intersects(it1->first, it2->first) )
+                        descend_both(it1->second, l1 + 1, it1->first, it2->second, l2 + 1, it2->first);
+                }
+            }
+        }
+
+        void apply(internal1_type const& n1, std::size_t l1, box1_type const& ,
+                   leaf2_type const& n2, std::size_t l2, box2_type const& b2)
+        {
+            internal1_elements const& elements1 = rtree::elements(n1);
+            for ( typename internal1_elements::const_iterator it1 = elements1.begin() ; it1 != elements1.end() ; ++it1 )
+            {
+                if ( geometry::intersects(it1->first, b2) )
+                    descend_first(it1->second, l1 + 1, it1->first, n2, l2, b2);
+            }
+        }
+
+        void apply(leaf1_type const& n1, std::size_t l1, box1_type const& b1,
+                   internal2_type const& n2, std::size_t l2, box2_type const& )
+        {
+            internal2_elements const& elements2 = rtree::elements(n2);
+            for ( typename internal2_elements::const_iterator it2 = elements2.begin() ; it2 != elements2.end() ; ++it2 )
+            {
+                if ( geometry::intersects(b1, it2->first) )
+                    descend_second(n1, l1, b1, it2->second, l2 + 1, it2->first);
+            }
+        }
+
+        void apply(leaf1_type const& n1, std::size_t , box1_type const& ,
+                   leaf2_type const& n2, std::size_t , box2_type const& b2)
+        {
+            leaf1_elements const& elements1 = rtree::elements(n1);
+            leaf2_elements const& elements2 = rtree::elements(n2);
+
+            for ( typename leaf1_elements::const_iterator it1 = elements1.begin() ; it1 != elements1.end() ; ++it1 )
+            {
+                typename translator1_type::result_type indexable1 = m_tr1(*it1);
+                if ( ! geometry::intersects(indexable1, b2) )
+                    continue;
+
+                for ( typename leaf2_elements::const_iterator it2 = elements2.begin() ; it2 != elements2.end() ; ++it2 )
+                {
+                    if ( geometry::intersects(indexable1, m_tr2(*it2)) )
+                        m_emitter(*it1, *it2);
+                }
+            }
+        }
+
+        void descend_both(node1_pointer p1, std::size_t l1, box1_type const& b1,
+                          node2_pointer p2, std::size_t l2, box2_type const& b2)
+        {
+            if ( l1 == m_leafs_level1 )
+                descend_second(rtree::get<leaf1_type>(*p1), l1, b1, p2, l2, b2);
+            else
+                descend_second(rtree::get<internal1_type>(*p1), l1, b1, p2, l2, b2);
+        }
+
+    private:
+        template <typename Node2>
+        void descend_first(node1_pointer p1, std::size_t l1, box1_type const& b1,
+                           Node2 const& n2, std::size_t l2, box2_type const& b2)
+        {
+            if ( l1 == m_leafs_level1 )
+                apply(rtree::get<leaf1_type>(*p1), l1, b1, n2, l2, b2);
+            else
+                apply(rtree::get<internal1_type>(*p1), l1, b1, n2, l2, b2);
+        }
+
+        template <typename Node1>
+        void descend_second(Node1 const& n1, std::size_t l1, box1_type const& b1,
+                            node2_pointer p2, std::size_t l2, box2_type const& b2)
+        {
+            if ( l2 == m_leafs_level2 )
+                apply(n1, l1, b1, rtree::get<leaf2_type>(*p2), l2, b2);
+            else
+                apply(n1, l1, b1, rtree::get<internal2_type>(*p2), l2, b2);
+        }
+
+        translator1_type const& m_tr1;
+        translator2_type const& m_tr2;
+        std::size_t m_leafs_level1;
+        std::size_t m_leafs_level2;
+        Emitter & m_emitter;
+    };
+
+    struct chunk_join
+    {
+        chunk_join(std::vector<task> const& ts,
+                   translator1_type const& t1, std::size_t ll1,
+                   translator2_type const& t2, std::size_t ll2,
+                   std::vector<pointers_emitter> & r)
+            : tasks(ts), tr1(t1), tr2(t2), leafs_level1(ll1), leafs_level2(ll2), results(r)
+        {}
+
+        void operator()(std::size_t first, std::size_t last, std::size_t chunk_index)
+        {
+            traversal<pointers_emitter> t(tr1, leafs_level1, tr2, leafs_level2, results[chunk_index]);
+            for ( std::size_t i = first ; i < last ; ++i )
+                t.descend_both(tasks[i].ptr1, 1, tasks[i].box1, tasks[i].ptr2, 1, tasks[i].box2);
+        }
+
+        std::vector<task> const& tasks;
+        translator1_type const& tr1;
+        translator2_type const& tr2;
+        std::size_t leafs_level1;
+        std::size_t leafs_level2;
+        std::vector<pointers_emitter> & results;
+    };
+
+public:
+    template <typename OutIter>
+    static inline std::size_t apply(Rtree1 const& rt1, Rtree2 const& rt2, OutIter out_it, std::size_t threads)
+    {
+        if ( rt1.empty() || rt2.empty() )
+            return 0;
+
+        view1_type rtv1(rt1);
+        view2_type rtv2(rt2);
+
+        translator1_type const tr1 = rtv1.translator();
+        translator2_type const tr2 = rtv2.translator();
+        std::size_t const leafs_level1 = rtv1.depth();
+        std::size_t const leafs_level2 = rtv2.depth();
+        box1_type const box1 = rt1.bounds();
+        box2_type const box2 = rt2.bounds();
+
+        if ( ! geometry::intersects(box1, box2) )
+            return 0;
+
+        root1_visitor root1_v;
+        rtv1.apply_visitor(root1_v);
+        root2_visitor root2_v;
+        rtv2.apply_visitor(root2_v);
+
+        if ( threads <= 1 || ! root1_v.internal || ! root2_v.internal )
+        {
+            out_iter_emitter<OutIter> emitter(out_it);
+            traversal< out_iter_emitter<OutIter> > t(tr1, leafs_level1, tr2, leafs_level2, emitter);
+
+            if ( root1_v.internal && root2_v.internal )
+                t.apply(*root1_v.internal, 0, box1, *root2_v.internal, 0, box2);
+            else if ( root1_v.internal )
+                t.apply(*root1_v.internal, 0, box1, *root2_v.leaf_node, 0, box2);
+            else if ( root2_v.internal )
+                t.apply(*root1_v.leaf_node, 0, box1, *root2_v.internal, 0, box2);
+            else
+                t.apply(*root1_v.leaf_node, 0, box1, *root2_v.leaf_node, 0, box2);
+
+            return emitter.found_count;
+        }
+
+        // the same pairs as the ones visited by traversal::apply(internal1, internal2)
+        std::vector<task> tasks;
+        internal1_elements const& elements1 = rtree::elements(*root1_v.internal);
+        internal2_elements const& elements2 = rtree::elements(*root2_v.internal);
+        for ( typename internal1_elements::const_iterator it1 = elements1.begin() ; it1 != elements1.end() ; ++it1 )
+        {
+            if ( ! geometry::intersects(it1->first, box2) )
+                continue;
+
+            for ( typename internal2_elements::const_iterator it2 = elements2.begin() ; it2 != elements2.end() ; ++it2 )
+            {
+                if ( geometry::intersects(it1->first, it2->first) )
+                    tasks.push_back(task(it1->second, it1->first, it2->second, it2->first));
+            }
+        }
+
+        if ( threads > tasks.size() )
+            threads = tasks.size();
+
+        std::vector<pointers_emitter> results(threads);
+        chunk_join join(tasks, tr1, leafs_level1, tr2, leafs_level2, results);
+        geometry::detail::parallel::for_each_chunk(tasks.size(), threads, join);
+
+        std::size_t found_count = 0;
+        for ( typename std::vector<pointers_emitter>::const_iterator it = results.begin() ; it != results.end() ; ++it )
+        {
+            for ( typename std::vector<found_type>::const_iterator f_it = it->found.begin() ; f_it != it->found.end() ; ++f_it )
+            {
+                *out_it = std::make_pair(*f_it->first, *f_it->second);
+                ++out_it;
+                ++found_count;
+            }
+        }
+
+        return found_count;
+    }
+};
+
+}}}}} // namespace boost::geometry::index::detail::rtree
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_SPATIAL_JOIN_HPP
@@ -0,0 +1,80 @@
+// Boost.Geometry Index
+//
+// R-tree traversal stack capacity
+//
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_TRAVERSAL_STACK_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_TRAVERSAL_STACK_HPP
+
+#include <cstddef>
+
+#include <boost/geometry/index/parameters.hpp>
+
+namespace boost { namespace geometry { namespace index { namespace detail { namespace rtree {
+
+template <std::size_t N>
+struct floor_log2
+{
+    static const std::size_t value = 1 + floor_log2<N / 2>::value;
+};
+
+template <>
+struct floor_log2<1>
+{
+    static const std::size_t value = 0;
+};
+
+// The number of levels stored in place by the stacks used during the traversal
+// of the tree, deeper trees use dynamically allocated memory.
+// The root has at least 2 children and other nodes at least min_elements so the
+// tree of depth D stores at least 2 * min_elements^(D-1) values. So for the static
+// parameters the size of the stack is sufficient for any tree storing less than
+// 2^32 values. Otherwise the default is sufficient for any tree of 2^32 values
+// with nodes storing at least 4 elements.
+template <typename Parameters>
+struct traversal_stack_capacity
+{
+    static const std::size_t value = 16;
+};
+
+template <std::size_t MinElements>
+struct traversal_stack_capacity_s
+{
+    static const std::size_t log2_min = floor_log2<MinElements>::value;
+    static const std::size_t bound = 1 + (32 - 1) / log2_min;
+    static const std::size_t value = bound < 32 ? bound : 32;
+};
+
+template <>
+struct traversal_stack_capacity_s<1>
+    : traversal_stack_capacity<void>
+{};
+
+template <std::size_t MaxElements, std::size_t MinElements>
+struct traversal_stack_capacity< index::linear<MaxElements, MinElements> >
+    : traversal_stack_capacity_s<MinElements>
+{};
+
+template <std::size_t MaxElements, std::size_t MinElements>
+struct traversal_stack_capacity< index::quadratic<MaxElements, MinElements> >
+    : traversal_stack_capacity_s<MinElements>
+{};
+
+template <std::size_t MaxElements, std::size_t MinElements, std::size_t ReinsertedElements, std::size_t OverlapCostThreshold>
+struct traversal_stack_capacity< index::rstar<MaxElements, MinElements, ReinsertedElements, OverlapCostThreshold> >
+    : traversal_stack_capacity_s<MinElements>
+{};
+
+template <typename Parameters, typename Aggregator>
+struct traversal_stack_capacity< index::augmented<Parameters, Aggregator> >
+    : traversal_stack_capacity<Parameters>
+{};
+
+}}}}} // namespace boost::geometry::index::detail::rtree
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_TRAVERSAL_STACK_HPP
@@ -93,12 +93,15 @@ bool are_counts_ok(Rtree const& tree)
     typedef utilities::view<Rtree> RTV;
     RTV rtv(tree);
 
+    // the visitor stores a reference, the parameters are returned by value
+    typename Rtree::parameters_type const parameters = tree.parameters();
+
     visitors::are_counts_ok<
         typename RTV::value_type,
         typename RTV::options_type,
         typename RTV::box_type,
         typename RTV::allocators_type
-    > v(tree.parameters());
+    > v(parameters);
     
     rtv.apply_visitor(v);
 
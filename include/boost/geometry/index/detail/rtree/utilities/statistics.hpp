@@ -13,8 +13,17 @@
 #define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_UTILITIES_STATISTICS_HPP
 
 #include <algorithm>
+#include <vector>
+
+#include <boost/mpl/bool.hpp>
 #include <boost/tuple/tuple.hpp>
 
+#include <boost/geometry/index/detail/algorithms/bounds.hpp>
+#include <boost/geometry/index/detail/algorithms/content.hpp>
+#include <boost/geometry/index/detail/algorithms/intersection_content.hpp>
+#include <boost/geometry/index/detail/predicates.hpp>
+#include <boost/geometry/index/detail/rtree/query_statistics.hpp>
+
 namespace boost { namespace geometry { namespace index { namespace detail { namespace rtree { namespace utilities {
 
 namespace visitors {
@@ -79,6 +88,150 @@ struct statistics : public rtree::visitor<Value, typename Options::parameters_ty
     std::size_t values_max;
 };
 
+// Calculates the sums of the following properties of all nodes:
+// - content: the content (e.g. area) of the bounding box of a node,
+// - overlap: the content of the intersections of the bounding boxes
+//   (or envelopes of values) of each pair of children of a node,
+// - dead space: the content of the bounding box of a node not covered by its children,
+//   estimated as the content of the node - the sum of the contents of the children
+//   + the overlap of the children, at least 0.
+// The root is not included in the content sum since it's the same for all trees
+// containing the same values.
+template <typename Value, typename Options, typename Translator, typename Box, typename Allocators>
+struct quality_statistics : public rtree::visitor<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag, true>::type
+{
+    typedef typename rtree::internal_node<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag>::type internal_node;
+    typedef typename rtree::leaf<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag>::type leaf;
+
+    typedef typename index::detail::default_content_result<Box>::type content_type;
+
+    inline quality_statistics(Translator const& t, Box const& root_box)
+        : tr(t)
+        , content(0)
+        , overlap(0)
+        , dead_space(0)
+        , node_box(root_box)
+    {}
+
+    inline void operator()(internal_node const& n)
+    {
+        typedef typename rtree::elements_type<internal_node>::type elements_type;
+        elements_type const& elements = rtree::elements(n);
+
+        boxes.clear();
+        for (typename elements_type::const_iterator it = elements.begin();
+            it != elements.end(); ++it)
+        {
+            boxes.push_back(it->first);
+        }
+        apply_node();
+
+        for (typename elements_type::const_iterator it = elements.begin();
+            it != elements.end(); ++it)
+        {
+            content += index::detail::content(it->first);
+
+            node_box = it->first;
+            rtree::apply_visitor(*this, *it->second);
+        }
+    }
+
+    inline void operator()(leaf const& n)
+    {
+        typedef typename rtree::elements_type<leaf>::type elements_type;
+        elements_type const& elements = rtree::elements(n);
+
+        boxes.clear();
+        for (typename elements_type::const_iterator it = elements.begin();
+            it != elements.end(); ++it)
+        {
+            Box b;
+            index::detail::bounds(tr(*it), b);
+            boxes.push_back(b);
+        }
+        apply_node();
+    }
+
+    Translator const& tr;
+
+    content_type content;
+    content_type overlap;
+    content_type dead_space;
+
+private:
+    inline void apply_node()
+    {
+        content_type children_content = 0;
+        content_type children_overlap = 0;
+        for ( std::size_t i = 0 ; i < boxes.size() ; ++i )
+        {
+            children_content += index::detail::content(boxes[i]);
+            for ( std::size_t j = i + 1 ; j < boxes.size() ; ++j )
+                children_overlap += index::detail::intersection_content(boxes[i], boxes[j]);
+        }
+
+        overlap += children_overlap;
+
+        content_type const dead = index::detail::content(node_box) - children_content + children_overlap;
+        if ( 0 < dead )
+            dead_space += dead;
+    }
+
+    Box node_box;
+    std::vector<Box> boxes;
+};
+
+// Calculates the sum of the contents of the boxes of the children of all internal
+// nodes and the sum of the contents of the intersections of each pair of these boxes.
+// The leafs are not visited.
+template <typename Value, typename Options, typename Box, typename Allocators>
+struct overlap_ratio : public rtree::visitor<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag, true>::type
+{
+    typedef typename rtree::internal_node<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag>::type internal_node;
+    typedef typename rtree::leaf<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag>::type leaf;
+
+    typedef typename index::detail::default_content_result<Box>::type content_type;
+
+    inline explicit overlap_ratio(std::size_t leafs_level)
+        : content(0)
+        , overlap(0)
+        , m_leafs_level(leafs_level)
+        , m_level(0)
+    {}
+
+    inline void operator()(internal_node const& n)
+    {
+        typedef typename rtree::elements_type<internal_node>::type elements_type;
+        elements_type const& elements = rtree::elements(n);
+
+        for ( std::size_t i = 0 ; i < elements.size() ; ++i )
+        {
+            content += index::detail::content(elements[i].first);
+            for ( std::size_t j = i + 1 ; j < elements.size() ; ++j )
+                overlap += index::detail::intersection_content(elements[i].first, elements[j].first);
+        }
+
+        // the children of the nodes at the last internal level are leafs
+        if ( m_level + 1 < m_leafs_level )
+        {
+            ++m_level;
+            for ( std::size_t i = 0 ; i < elements.size() ; ++i )
+                rtree::apply_visitor(*this, *elements[i].second);
+            --m_level;
+        }
+    }
+
+    inline void operator()(leaf const&)
+    {}
+
+    content_type content;
+    content_type overlap;
+
+private:
+    std::size_t m_leafs_level;
+    std::size_t m_level;
+};
+
 } // namespace visitors
 
 template <typename Rtree> inline
@@ -100,6 +253,246 @@ statistics(Rtree const& tree)
     return boost::make_tuple(stats_v.levels, stats_v.nodes, stats_v.leaves, stats_v.values, stats_v.values_min, stats_v.values_max);
 }
 
+// Returns the tuple (content, overlap, dead space) describing the quality of the tree,
+// see visitors::quality_statistics. Smaller values mean better tree. May be used to
+// compare the trees created with different algorithms and parameters.
+template <typename Rtree> inline
+boost::tuple
+    <
+        typename index::detail::default_content_result<typename Rtree::bounds_type>::type,
+        typename index::detail::default_content_result<typename Rtree::bounds_type>::type,
+        typename index::detail::default_content_result<typename Rtree::bounds_type>::type
+    >
+quality_statistics(Rtree const& tree)
+{
+    typedef utilities::view<Rtree> RTV;
+    RTV rtv(tree);
+
+    typedef visitors::quality_statistics<
+        typename RTV::value_type,
+        typename RTV::options_type,
+        typename RTV::translator_type,
+        typename RTV::box_type,
+        typename RTV::allocators_type
+    > visitor_type;
+    typedef typename visitor_type::content_type content_type;
+
+    if ( tree.empty() )
+        return boost::make_tuple(content_type(0), content_type(0), content_type(0));
+
+    typename RTV::translator_type const tr = rtv.translator();
+    visitor_type quality_v(tr, tree.bounds());
+    rtv.apply_visitor(quality_v);
+
+    return boost::make_tuple(quality_v.content, quality_v.overlap, quality_v.dead_space);
+}
+
+// Returns the ratio of the overlap of nodes to their content, i.e. the sum of the contents
+// of the intersections of the boxes of each pair of children of internal nodes divided by
+// the sum of the contents of these boxes, see visitors::overlap_ratio. It's close to 0 for
+// the trees created with the packing algorithm and grows when the quality of the tree
+// degrades after many insertions and removals so it may be used to decide when the tree
+// should be repacked. Only the internal nodes are visited so it's cheaper than
+// quality_statistics(). 0 is returned if the tree has no internal nodes or if the boxes
+// of nodes have no content.
+template <typename Rtree> inline
+double overlap_ratio(Rtree const& tree)
+{
+    typedef utilities::view<Rtree> RTV;
+    RTV rtv(tree);
+
+    if ( rtv.depth() == 0 )
+        return 0;
+
+    visitors::overlap_ratio<
+        typename RTV::value_type,
+        typename RTV::options_type,
+        typename RTV::box_type,
+        typename RTV::allocators_type
+    > overlap_v(rtv.depth());
+
+    rtv.apply_visitor(overlap_v);
+
+    if ( ! (0 < overlap_v.content) )
+        return 0;
+
+    return static_cast<double>(overlap_v.overlap) / static_cast<double>(overlap_v.content);
+}
+
+// The counters of the traversal of one query
+struct query_counters
+{
+    query_counters()
+        : nodes(0), leaves(0), predicates(0), values(0)
+    {}
+
+    std::size_t nodes;      // nodes visited, including leaves
+    std::size_t leaves;     // leaves which values were scanned
+    std::size_t predicates; // evaluations of predicates for boxes of nodes and values
+    std::size_t values;     // values returned
+};
+
+// Collects the counters of queries performed by utilities::query() and the histograms
+// of the counters. The 0-th bucket of a histogram is the number of queries for which
+// the counter was 0 and the i-th bucket for which it was in the range [2^(i-1), 2^i).
+class query_statistics
+{
+public:
+    // The statistics policy of query visitors recording the counters,
+    // see rtree::no_query_statistics
+    class recorder
+    {
+    public:
+        explicit recorder(query_counters & counters) : m_counters(&counters) {}
+
+        inline void visit_internal_node() { ++m_counters->nodes; }
+        inline void visit_leaf() { ++m_counters->nodes; ++m_counters->leaves; }
+        inline void check_bounds() { ++m_counters->predicates; }
+        inline void check_value() { ++m_counters->predicates; }
+        inline void return_values(std::size_t count) { m_counters->values += count; }
+
+    private:
+        query_counters * m_counters;
+    };
+
+    query_statistics()
+        : m_queries(0)
+    {}
+
+    // Starts recording the counters of the next query
+    recorder begin_query()
+    {
+        m_last = query_counters();
+        return recorder(m_last);
+    }
+
+    // Adds the counters of the last query to the totals and histograms
+    void end_query()
+    {
+        ++m_queries;
+
+        m_total.nodes += m_last.nodes;
+        m_total.leaves += m_last.leaves;
+        m_total.predicates += m_last.predicates;
+        m_total.values += m_last.values;
+
+        add_to_histogram(m_nodes_histogram, m_last.nodes);
+        add_to_histogram(m_leaves_histogram, m_last.leaves);
+        add_to_histogram(m_predicates_histogram, m_last.predicates);
+        add_to_histogram(m_values_histogram, m_last.values);
+    }
+
+    void clear()
+    {
+        *this = query_statistics();
+    }
+
+    std::size_t queries() const { return m_queries; }
+    query_counters const& last() const { return m_last; }
+    query_counters const& total() const { return m_total; }
+
+    std::vector<std::size_t> const& nodes_histogram() const { return m_nodes_histogram; }
+    std::vector<std::size_t> const& leaves_histogram() const { return m_leaves_histogram; }
+    std::vector<std::size_t> const& predicates_histogram() const { return m_predicates_histogram; }
+    std::vector<std::size_t> const& values_histogram() const { return m_values_histogram; }
+
+private:
+    static inline void add_to_histogram(std::vector<std::size_t> & histogram, std::size_t value)
+    {
+        std::size_t bucket = 0;
+        for ( ; value != 0 ; value >>= 1 )
+            ++bucket;
+
+        if ( histogram.size() <= bucket )
+            histogram.resize(bucket + 1, 0);
+
+        ++histogram[bucket];
+    }
+
+    std::size_t m_queries;
+    query_counters m_last;
+    query_counters m_total;
+
+    std::vector<std::size_t> m_nodes_histogram;
+    std::vector<std::size_t> m_leaves_histogram;
+    std::vector<std::size_t> m_predicates_histogram;
+    std::vector<std::size_t> m_values_histogram;
+};
+
+namespace detail {
+
+template <typename Rtree, typename Predicates, typename OutIter> inline
+std::size_t query_dispatch(Rtree const& tree, Predicates const& predicates, OutIter out_it,
+                           query_statistics::recorder const& rec,
+                           boost::mpl::bool_<false> const& /*is_distance_predicate*/)
+{
+    typedef utilities::view<Rtree> RTV;
+    RTV rtv(tree);
+
+    typename RTV::translator_type const tr = rtv.translator();
+    rtree::visitors::spatial_query
+        <
+            typename RTV::value_type,
+            typename RTV::options_type,
+            typename RTV::translator_type,
+            typename RTV::box_type,
+            typename RTV::allocators_type,
+            Predicates, OutIter,
+            query_statistics::recorder
+        > find_v(tr, predicates, out_it, rec);
+
+    rtv.apply_visitor(find_v);
+
+    return find_v.found_count;
+}
+
+template <typename Rtree, typename Predicates, typename OutIter> inline
+std::size_t query_dispatch(Rtree const& tree, Predicates const& predicates, OutIter out_it,
+                           query_statistics::recorder const& rec,
+                           boost::mpl::bool_<true> const& /*is_distance_predicate*/)
+{
+    typedef utilities::view<Rtree> RTV;
+    RTV rtv(tree);
+
+    static const unsigned distance_predicate_index = index::detail::predicates_find_distance<Predicates>::value;
+
+    typename RTV::translator_type const tr = rtv.translator();
+    typename rtree::visitors::distance_query_visitor
+        <
+            typename RTV::value_type,
+            typename RTV::options_type,
+            typename RTV::translator_type,
+            typename RTV::box_type,
+            typename RTV::allocators_type,
+            Predicates, distance_predicate_index, OutIter,
+            rtree::visitors::distance_query_default_tag,
+            query_statistics::recorder
+        >::type distance_v(tree.parameters(), tr, predicates, out_it, rec);
+
+    rtv.apply_visitor(distance_v);
+
+    return distance_v.finish();
+}
+
+} // namespace detail
+
+// Performs the query the same way as rtree::query() and records the counters
+// of the traversal in the statistics. For the spatial and k-nearest neighbors
+// queries the same visitors are used as in rtree::query() so the counters
+// show the actual cost of the query.
+template <typename Rtree, typename Predicates, typename OutIter> inline
+std::size_t query(Rtree const& tree, Predicates const& predicates, OutIter out_it, query_statistics & stats)
+{
+    static const unsigned distance_predicates_count = index::detail::predicates_count_distance<Predicates>::value;
+    BOOST_MPL_ASSERT_MSG((distance_predicates_count <= 1), PASS_ONLY_ONE_DISTANCE_PREDICATE, (Predicates));
+
+    std::size_t const result
+        = detail::query_dispatch(tree, predicates, out_it, stats.begin_query(),
+                                 boost::mpl::bool_<(0 < distance_predicates_count)>());
+    stats.end_query();
+    return result;
+}
+
 }}}}}} // namespace boost::geometry::index::detail::rtree::utilities
 
 #endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_UTILITIES_STATISTICS_HPP
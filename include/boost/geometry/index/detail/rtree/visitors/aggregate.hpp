@@ -0,0 +1,151 @@
+// Boost.Geometry Index
+//
+// R-tree visitors calculating aggregates of subtrees of augmented nodes
+//
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_AGGREGATE_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_AGGREGATE_HPP
+
+#include <boost/geometry/index/detail/rtree/node/aggregate.hpp>
+
+namespace boost { namespace geometry { namespace index {
+
+namespace detail { namespace rtree {
+
+namespace visitors {
+
+template <typename Value, typename Options, typename Box, typename Allocators>
+struct get_aggregate
+    : public rtree::visitor<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag, true>::type
+{
+    typedef typename rtree::internal_node<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag>::type internal_node;
+    typedef typename rtree::leaf<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag>::type leaf;
+
+    typedef typename rtree::node_aggregate
+        <
+            typename Options::parameters_type,
+            typename Allocators::size_type
+        >::type aggregate_type;
+
+    get_aggregate()
+        : result(0)
+    {}
+
+    inline void operator()(internal_node const& n)
+    {
+        result = &n;
+    }
+
+    inline void operator()(leaf const& n)
+    {
+        result = &n;
+    }
+
+    aggregate_type const* result;
+};
+
+// Calculates the aggregate of a node from the aggregates of its children
+// or from its values. The children must be up to date.
+template <typename Value, typename Options, typename Box, typename Allocators>
+class calculate_aggregate
+    : public rtree::visitor<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag, false>::type
+{
+    typedef typename Options::parameters_type parameters_type;
+
+    typedef typename rtree::internal_node<Value, parameters_type, Box, Allocators, typename Options::node_tag>::type internal_node;
+    typedef typename rtree::leaf<Value, parameters_type, Box, Allocators, typename Options::node_tag>::type leaf;
+
+    typedef get_aggregate<Value, Options, Box, Allocators> get_aggregate_type;
+    typedef typename get_aggregate_type::aggregate_type aggregate_type;
+
+public:
+    explicit calculate_aggregate(parameters_type const& parameters)
+        : m_parameters(parameters)
+    {}
+
+    inline void operator()(internal_node & n)
+    {
+        typedef typename rtree::elements_type<internal_node>::type elements_type;
+        elements_type const& elements = rtree::elements(n);
+
+        aggregate_type & data = n;
+        data.reset(m_parameters.aggregator());
+
+        for ( typename elements_type::const_iterator it = elements.begin() ; it != elements.end() ; ++it )
+        {
+            get_aggregate_type v;
+            rtree::apply_visitor(v, *it->second);
+            data.add(m_parameters.aggregator(), *v.result);
+        }
+    }
+
+    inline void operator()(leaf & n)
+    {
+        typedef typename rtree::elements_type<leaf>::type elements_type;
+        elements_type const& elements = rtree::elements(n);
+
+        aggregate_type & data = n;
+        data.reset(m_parameters.aggregator());
+
+        for ( typename elements_type::const_iterator it = elements.begin() ; it != elements.end() ; ++it )
+        {
+            data.add_value(m_parameters.aggregator(), *it);
+        }
+    }
+
+private:
+    parameters_type const& m_parameters;
+};
+
+} // namespace visitors
+
+// Updates the aggregate of a node of an augmented rtree, does nothing otherwise
+template <typename Value, typename Options, typename Box, typename Allocators,
+          bool IsAugmented = is_augmented<typename Options::parameters_type>::value>
+struct update_aggregate
+{
+    template <typename Node>
+    static inline void apply(Node &, typename Options::parameters_type const&)
+    {}
+};
+
+template <typename Value, typename Options, typename Box, typename Allocators>
+struct update_aggregate<Value, Options, Box, Allocators, true>
+{
+    typedef typename Options::parameters_type parameters_type;
+
+    typedef typename rtree::node<Value, parameters_type, Box, Allocators, typename Options::node_tag>::type node;
+    typedef typename rtree::internal_node<Value, parameters_type, Box, Allocators, typename Options::node_tag>::type internal_node;
+    typedef typename rtree::leaf<Value, parameters_type, Box, Allocators, typename Options::node_tag>::type leaf;
+
+    typedef visitors::calculate_aggregate<Value, Options, Box, Allocators> calculate_aggregate_type;
+
+    static inline void apply(node & n, parameters_type const& parameters)
+    {
+        calculate_aggregate_type v(parameters);
+        rtree::apply_visitor(v, n);
+    }
+
+    static inline void apply(internal_node & n, parameters_type const& parameters)
+    {
+        calculate_aggregate_type v(parameters);
+        v(n);
+    }
+
+    static inline void apply(leaf & n, parameters_type const& parameters)
+    {
+        calculate_aggregate_type v(parameters);
+        v(n);
+    }
+};
+
+}} // namespace detail::rtree
+
+}}} // namespace boost::geometry::index
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_AGGREGATE_HPP
@@ -27,6 +27,12 @@ public:
     typedef rtree::subtree_destroyer<Value, Options, Translator, Box, Allocators> subtree_destroyer;
     typedef typename Allocators::node_pointer node_pointer;
 
+    typedef rtree::copy_aggregate
+        <
+            typename Options::parameters_type,
+            typename Allocators::size_type
+        > copy_aggregate;
+
     explicit inline copy(Allocators & allocators)
         : result(0)
         , m_allocators(allocators)
@@ -55,6 +61,9 @@ public:
             auto_result.release();
         }
 
+        // copy the aggregate if the nodes are augmented
+        copy_aggregate::apply(n, rtree::get<internal_node>(*new_node));
+
         result = new_node.get();
         new_node.release();
     }
@@ -75,6 +84,9 @@ public:
             elements_dst.push_back(*it);                                                                // MAY THROW, STRONG (V: alloc, copy)
         }
 
+        // copy the aggregate if the nodes are augmented
+        copy_aggregate::apply(l, rtree::get<leaf>(*new_node));
+
         result = new_node.get();
         new_node.release();
     }
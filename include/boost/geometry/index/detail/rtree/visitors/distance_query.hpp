@@ -11,6 +11,8 @@
 #ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_DISTANCE_QUERY_HPP
 #define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_DISTANCE_QUERY_HPP
 
+#include <boost/geometry/index/detail/rtree/query_statistics.hpp>
+
 namespace boost { namespace geometry { namespace index {
 
 namespace detail { namespace rtree { namespace visitors {
@@ -97,7 +99,8 @@ template <
     typename Allocators,
     typename Predicates,
     unsigned DistancePredicateIndex,
-    typename OutIter
+    typename OutIter,
+    typename Statistics = rtree::no_query_statistics
 >
 class distance_query
     : public rtree::visitor<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag, true>::type
@@ -120,14 +123,18 @@ public:
 
     static const unsigned predicates_len = index::detail::predicates_length<Predicates>::value;
 
-    inline distance_query(parameters_type const& parameters, Translator const& translator, Predicates const& pred, OutIter out_it)
+    inline distance_query(parameters_type const& parameters, Translator const& translator, Predicates const& pred, OutIter out_it,
+                          Statistics const& statistics = Statistics())
         : m_parameters(parameters), m_translator(translator)
         , m_pred(pred)
         , m_result(nearest_predicate_access::get(m_pred).count, out_it)
+        , m_statistics(statistics)
     {}
 
     inline void operator()(internal_node const& n)
     {
+        m_statistics.visit_internal_node();
+
         typedef typename rtree::elements_type<internal_node>::type elements_type;
 
         // array of active nodes
@@ -147,6 +154,7 @@ public:
         {
             // if current node meets predicates
             // 0 - dummy value
+            m_statistics.check_bounds();
             if ( index::detail::predicates_check<index::detail::bounds_tag, 0, predicates_len>(m_pred, 0, it->first) )
             {
                 // calculate node's distance(s) for distance predicate
@@ -190,10 +198,8 @@ public:
 
         // ALTERNATIVE VERSION - use heap instead of sorted container
         // It seems to be faster for greater MaxElements and slower otherwise
-        // CONSIDER: using one global container/heap for active branches
-        //           instead of a sorted container per level
-        //           This would also change the way how branches are traversed!
-        //           The same may be applied to the iterative version which btw suffers
+        // NOTE: one global heap for active branches is used in distance_query_best_first
+        //       The same may be applied to the iterative version which btw suffers
         //           from the copying of the whole containers on resize of the ABLs container
 
         //// make a heap
@@ -218,6 +224,8 @@ public:
 
     inline void operator()(leaf const& n)
     {
+        m_statistics.visit_leaf();
+
         typedef typename rtree::elements_type<leaf>::type elements_type;
         elements_type const& elements = rtree::elements(n);
         
@@ -226,6 +234,7 @@ public:
             it != elements.end(); ++it)
         {
             // if value meets predicates
+            m_statistics.check_value();
             if ( index::detail::predicates_check<index::detail::value_tag, 0, predicates_len>(m_pred, *it, m_translator(*it)) )
             {
                 // calculate values distance for distance predicate
@@ -242,7 +251,9 @@ public:
 
     inline size_t finish()
     {
-        return m_result.finish();
+        size_t const count = m_result.finish();
+        m_statistics.return_values(count);
+        return count;
     }
 
 private:
@@ -276,6 +287,459 @@ private:
 
     Predicates m_pred;
     distance_query_result<Value, Translator, value_distance_type, OutIter> m_result;
+    Statistics m_statistics;
+};
+
+// Best-first k-nearest neighbors search (Hjaltason, Samet).
+// Instead of traversing the tree depth-first and sorting the branches
+// of each node separately, one global priority queue of branches is used.
+// The closest branch is always visited first, so the traversal can stop
+// as soon as the closest remaining branch is further than the furthest
+// of k neighbors found so far. The branches are stored in one container
+// reused during the whole traversal.
+template <
+    typename Value,
+    typename Options,
+    typename Translator,
+    typename Box,
+    typename Allocators,
+    typename Predicates,
+    unsigned DistancePredicateIndex,
+    typename OutIter,
+    typename Statistics = rtree::no_query_statistics
+>
+class distance_query_best_first
+    : public rtree::visitor<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag, true>::type
+{
+public:
+    typedef typename Options::parameters_type parameters_type;
+
+    typedef typename rtree::node<Value, parameters_type, Box, Allocators, typename Options::node_tag>::type node;
+    typedef typename rtree::internal_node<Value, parameters_type, Box, Allocators, typename Options::node_tag>::type internal_node;
+    typedef typename rtree::leaf<Value, parameters_type, Box, Allocators, typename Options::node_tag>::type leaf;
+
+    typedef index::detail::predicates_element<DistancePredicateIndex, Predicates> nearest_predicate_access;
+    typedef typename nearest_predicate_access::type nearest_predicate_type;
+    typedef typename indexable_type<Translator>::type indexable_type;
+
+    typedef index::detail::calculate_distance<nearest_predicate_type, indexable_type, value_tag> calculate_value_distance;
+    typedef index::detail::calculate_distance<nearest_predicate_type, Box, bounds_tag> calculate_node_distance;
+    typedef typename calculate_value_distance::result_type value_distance_type;
+    typedef typename calculate_node_distance::result_type node_distance_type;
+
+    typedef typename Allocators::node_pointer node_pointer;
+    typedef std::pair<node_distance_type, node_pointer> branch_data;
+
+    static const unsigned predicates_len = index::detail::predicates_length<Predicates>::value;
+
+    inline distance_query_best_first(parameters_type const& parameters, Translator const& translator, Predicates const& pred, OutIter out_it,
+                                     Statistics const& statistics = Statistics())
+        : m_parameters(parameters), m_translator(translator)
+        , m_pred(pred)
+        , m_result(nearest_predicate_access::get(m_pred).count, out_it)
+        , m_statistics(statistics)
+        , m_traversing(false)
+    {}
+
+    inline void operator()(internal_node const& n)
+    {
+        m_statistics.visit_internal_node();
+
+        typedef typename rtree::elements_type<internal_node>::type elements_type;
+        elements_type const& elements = rtree::elements(n);
+
+        // push the branches meeting predicates into the queue
+        for (typename elements_type::const_iterator it = elements.begin();
+            it != elements.end(); ++it)
+        {
+            // 0 - dummy value
+            m_statistics.check_bounds();
+            if ( index::detail::predicates_check<index::detail::bounds_tag, 0, predicates_len>(m_pred, 0, it->first) )
+            {
+                node_distance_type node_distance;
+                // if distance isn't ok - move to the next node
+                if ( !calculate_node_distance::apply(predicate(), it->first, node_distance) )
+                {
+                    continue;
+                }
+
+                // if current node is further than found neighbors - don't analyze it
+                if ( m_result.has_enough_neighbors() &&
+                     is_node_prunable(m_result.greatest_comparable_distance(), node_distance) )
+                {
+                    continue;
+                }
+
+                m_branches.push_back(std::make_pair(node_distance, it->second));
+                std::push_heap(m_branches.begin(), m_branches.end(), branch_greater);
+            }
+        }
+
+        // the nodes are visited in the loop started in the root
+        if ( m_traversing )
+            return;
+
+        m_traversing = true;
+        m_branches.reserve(m_parameters.get_max_elements());
+
+        while ( !m_branches.empty() )
+        {
+            // if the closest node is further than furthest neighbor, all of the rest are also further
+            if ( m_result.has_enough_neighbors() &&
+                 is_node_prunable(m_result.greatest_comparable_distance(), m_branches.front().first) )
+            {
+                break;
+            }
+
+            node_pointer const next = m_branches.front().second;
+            std::pop_heap(m_branches.begin(), m_branches.end(), branch_greater);
+            m_branches.pop_back();
+
+            rtree::apply_visitor(*this, *next);
+        }
+
+        m_branches.clear();
+        m_traversing = false;
+    }
+
+    inline void operator()(leaf const& n)
+    {
+        m_statistics.visit_leaf();
+
+        typedef typename rtree::elements_type<leaf>::type elements_type;
+        elements_type const& elements = rtree::elements(n);
+
+        // search leaf for closest value meeting predicates
+        for (typename elements_type::const_iterator it = elements.begin();
+            it != elements.end(); ++it)
+        {
+            // if value meets predicates
+            m_statistics.check_value();
+            if ( index::detail::predicates_check<index::detail::value_tag, 0, predicates_len>(m_pred, *it, m_translator(*it)) )
+            {
+                // calculate values distance for distance predicate
+                value_distance_type value_distance;
+                // if distance is ok
+                if ( calculate_value_distance::apply(predicate(), m_translator(*it), value_distance) )
+                {
+                    // store value
+                    m_result.store(*it, value_distance);
+                }
+            }
+        }
+    }
+
+    inline size_t finish()
+    {
+        size_t const count = m_result.finish();
+        m_statistics.return_values(count);
+        return count;
+    }
+
+private:
+    static inline bool branch_greater(branch_data const& p1, branch_data const& p2)
+    {
+        return p1.first > p2.first;
+    }
+
+    template <typename Distance>
+    static inline bool is_node_prunable(Distance const& greatest_dist, node_distance_type const& d)
+    {
+        return greatest_dist <= d;
+    }
+
+    nearest_predicate_type const& predicate() const
+    {
+        return nearest_predicate_access::get(m_pred);
+    }
+
+    parameters_type const& m_parameters;
+    Translator const& m_translator;
+
+    Predicates m_pred;
+    distance_query_result<Value, Translator, value_distance_type, OutIter> m_result;
+    Statistics m_statistics;
+
+    std::vector<branch_data> m_branches;
+    bool m_traversing;
+};
+
+// K-nearest neighbors search of many query points during one traversal of the tree.
+// The points should be close to each other, e.g. the points of one leaf of other tree.
+// Each node is visited once for all queries for which it may contain closer values
+// than the k-th neighbor found so far. The children are visited in the order of the
+// smallest distance to any of the active queries and the queries for which the child
+// became too far, because their neighbors were found in previous children, are
+// skipped. Since the closest leaf is visited first all of the queries get their
+// initial neighbors and upper bounds of distances at once and the nodes are loaded
+// once for the whole group.
+// The visitor may be reused for many groups, the buffers are not released.
+template <typename Value, typename Options, typename Translator, typename Box, typename Allocators, typename QueryPoint>
+class distance_query_group
+    : public rtree::visitor<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag, true>::type
+{
+public:
+    typedef typename Options::parameters_type parameters_type;
+
+    typedef typename rtree::node<Value, parameters_type, Box, Allocators, typename Options::node_tag>::type node;
+    typedef typename rtree::internal_node<Value, parameters_type, Box, Allocators, typename Options::node_tag>::type internal_node;
+    typedef typename rtree::leaf<Value, parameters_type, Box, Allocators, typename Options::node_tag>::type leaf;
+
+    typedef index::detail::predicates::nearest<QueryPoint> nearest_predicate_type;
+    typedef typename indexable_type<Translator>::type indexable_type;
+
+    typedef index::detail::calculate_distance<nearest_predicate_type, indexable_type, value_tag> calculate_value_distance;
+    typedef index::detail::calculate_distance<nearest_predicate_type, Box, bounds_tag> calculate_node_distance;
+    typedef typename calculate_value_distance::result_type value_distance_type;
+    typedef typename calculate_node_distance::result_type node_distance_type;
+
+    typedef typename Allocators::node_pointer node_pointer;
+    typedef typename Allocators::size_type size_type;
+
+    typedef std::vector<const Value *> found_type;
+
+    // The query and its distance to the node
+    typedef std::pair<size_type, node_distance_type> active_query;
+    typedef std::pair<value_distance_type, const Value *> neighbor_type;
+
+    struct branch
+    {
+        branch(node_distance_type const& d, node_pointer p, size_type f, size_type l)
+            : distance(d), ptr(p), first(f), last(l)
+        {}
+
+        node_distance_type distance;
+        node_pointer ptr;
+        size_type first, last;  // the range of active queries
+    };
+
+    inline distance_query_group(Translator const& translator, size_type k)
+        : m_translator(translator)
+        , m_predicates(0)
+        , m_k(k)
+        , m_active_first(0), m_active_last(0)
+    {
+        BOOST_GEOMETRY_INDEX_ASSERT(0 < m_k, "Number of neighbors should be greater than 0");
+    }
+
+    // Prepares the visitor for the queries of the next group
+    inline void reset(std::vector<nearest_predicate_type> const& predicates)
+    {
+        m_predicates = boost::addressof(predicates);
+
+        // the k neighbors of the query q are stored in a heap starting at q * k
+        m_neighbors.resize(predicates.size() * m_k);
+        m_counts.assign(predicates.size(), 0);
+
+        m_active.clear();
+        for ( size_type i = 0 ; i < predicates.size() ; ++i )
+            m_active.push_back(active_query(i, node_distance_type()));
+        m_active_first = 0;
+        m_active_last = predicates.size();
+
+        m_branches.clear();
+    }
+
+    inline void operator()(internal_node const& n)
+    {
+        typedef typename rtree::elements_type<internal_node>::type elements_type;
+        elements_type const& elements = rtree::elements(n);
+
+        size_type const active_first = m_active_first;
+        size_type const active_last = m_active_last;
+        size_type const branches_first = m_branches.size();
+
+        // gather the queries for which the children may contain closer values
+        // NOTE: m_active and m_branches may be reallocated so indexes are used
+        for (typename elements_type::const_iterator it = elements.begin();
+            it != elements.end(); ++it)
+        {
+            size_type const child_first = m_active.size();
+            node_distance_type smallest_distance = node_distance_type();
+            for ( size_type i = active_first ; i < active_last ; ++i )
+            {
+                size_type const q = m_active[i].first;
+                node_distance_type node_distance;
+                if ( !calculate_node_distance::apply((*m_predicates)[q], it->first, node_distance)
+                  || is_node_prunable(q, node_distance) )
+                {
+                    continue;
+                }
+
+                if ( child_first == m_active.size() || node_distance < smallest_distance )
+                    smallest_distance = node_distance;
+                m_active.push_back(active_query(q, node_distance));
+            }
+
+            if ( child_first < m_active.size() )
+                m_branches.push_back(branch(smallest_distance, it->second, child_first, m_active.size()));
+        }
+
+        size_type const branches_last = m_branches.size();
+        std::sort(m_branches.begin() + branches_first, m_branches.end(), branch_less);
+
+        size_type const children_last = m_active.size();
+        for ( size_type b = branches_first ; b < branches_last ; ++b )
+        {
+            // skip the queries for which closer neighbors were found in the previous children
+            size_type const child_first = m_active.size();
+            for ( size_type i = m_branches[b].first ; i < m_branches[b].last ; ++i )
+            {
+                active_query const aq = m_active[i];
+                if ( ! is_node_prunable(aq.first, aq.second) )
+                    m_active.push_back(aq);
+            }
+
+            if ( child_first < m_active.size() )
+            {
+                m_active_first = child_first;
+                m_active_last = m_active.size();
+
+                rtree::apply_visitor(*this, *m_branches[b].ptr);
+            }
+
+            m_active.resize(children_last);
+        }
+
+        m_branches.erase(m_branches.begin() + branches_first, m_branches.end());
+        m_active.resize(active_last);
+        m_active_first = active_first;
+        m_active_last = active_last;
+    }
+
+    inline void operator()(leaf const& n)
+    {
+        typedef typename rtree::elements_type<leaf>::type elements_type;
+        elements_type const& elements = rtree::elements(n);
+
+        for (typename elements_type::const_iterator it = elements.begin();
+            it != elements.end(); ++it)
+        {
+            indexable_type const& indexable = m_translator(*it);
+
+            for ( size_type i = m_active_first ; i < m_active_last ; ++i )
+            {
+                size_type const q = m_active[i].first;
+                value_distance_type value_distance;
+                if ( calculate_value_distance::apply((*m_predicates)[q], indexable, value_distance) )
+                    store(q, boost::addressof(*it), value_distance);
+            }
+        }
+    }
+
+    // Writes the neighbors of the queries to found, in the order of the queries
+    // and the same order as distance_query_result, and returns the number
+    // of neighbors of each query in counts.
+    inline void finish(found_type & found, std::vector<size_type> & counts) const
+    {
+        for ( size_type q = 0 ; q < m_counts.size() ; ++q )
+        {
+            typename std::vector<neighbor_type>::const_iterator it = m_neighbors.begin() + q * m_k;
+            for ( size_type i = 0 ; i < m_counts[q] ; ++i, ++it )
+                found.push_back(it->second);
+            counts.push_back(m_counts[q]);
+        }
+    }
+
+private:
+    inline void store(size_type q, const Value * val, value_distance_type const& d)
+    {
+        typename std::vector<neighbor_type>::iterator first = m_neighbors.begin() + q * m_k;
+        size_type & count = m_counts[q];
+
+        if ( count < m_k )
+        {
+            first[count] = neighbor_type(d, val);
+            ++count;
+
+            if ( count == m_k )
+                std::make_heap(first, first + m_k, neighbor_less);
+        }
+        else if ( d < first->first )
+        {
+            std::pop_heap(first, first + m_k, neighbor_less);
+            first[m_k - 1] = neighbor_type(d, val);
+            std::push_heap(first, first + m_k, neighbor_less);
+        }
+    }
+
+    static inline bool neighbor_less(neighbor_type const& n1, neighbor_type const& n2)
+    {
+        return n1.first < n2.first;
+    }
+
+    static inline bool branch_less(branch const& b1, branch const& b2)
+    {
+        return b1.distance < b2.distance;
+    }
+
+    inline bool is_node_prunable(size_type q, node_distance_type const& d) const
+    {
+        return m_counts[q] == m_k
+            && m_neighbors[q * m_k].first <= d;
+    }
+
+    Translator const& m_translator;
+    std::vector<nearest_predicate_type> const* m_predicates;
+    size_type m_k;
+
+    std::vector<neighbor_type> m_neighbors;
+    std::vector<size_type> m_counts;
+    std::vector<active_query> m_active;
+    std::vector<branch> m_branches;
+    size_type m_active_first;
+    size_type m_active_last;
+};
+
+struct distance_query_depth_first_tag {};
+struct distance_query_best_first_tag {};
+
+// The traversal used by default by the k-nearest neighbors queries.
+// By default the depth-first traversal is used. The best-first traversal
+// may be enabled by defining BOOST_GEOMETRY_INDEX_RTREE_BEST_FIRST_DISTANCE_QUERY.
+#ifdef BOOST_GEOMETRY_INDEX_RTREE_BEST_FIRST_DISTANCE_QUERY
+typedef distance_query_best_first_tag distance_query_default_tag;
+#else
+typedef distance_query_depth_first_tag distance_query_default_tag;
+#endif
+
+template <
+    typename Value,
+    typename Options,
+    typename Translator,
+    typename Box,
+    typename Allocators,
+    typename Predicates,
+    unsigned DistancePredicateIndex,
+    typename OutIter,
+    typename TraversalTag = distance_query_default_tag,
+    typename Statistics = rtree::no_query_statistics
+>
+struct distance_query_visitor
+{
+    typedef distance_query
+        <
+            Value, Options, Translator, Box, Allocators, Predicates, DistancePredicateIndex, OutIter, Statistics
+        > type;
+};
+
+template <
+    typename Value,
+    typename Options,
+    typename Translator,
+    typename Box,
+    typename Allocators,
+    typename Predicates,
+    unsigned DistancePredicateIndex,
+    typename OutIter,
+    typename Statistics
+>
+struct distance_query_visitor<Value, Options, Translator, Box, Allocators, Predicates, DistancePredicateIndex, OutIter, distance_query_best_first_tag, Statistics>
+{
+    typedef distance_query_best_first
+        <
+            Value, Options, Translator, Box, Allocators, Predicates, DistancePredicateIndex, OutIter, Statistics
+        > type;
 };
 
 template <
@@ -323,15 +787,20 @@ public:
     struct internal_stack_element
     {
         internal_stack_element() : current_branch(0) {}
-#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
-        // Required in c++03 for containers using Boost.Move
+        // The capacity is preserved so the copy doesn't allocate during the traversal
+        internal_stack_element(internal_stack_element const& o)
+            : current_branch(o.current_branch)
+        {
+            branches.reserve(o.branches.capacity());
+            branches.assign(o.branches.begin(), o.branches.end());
+        }
         internal_stack_element & operator=(internal_stack_element const& o)
         {
-            branches = o.branches;
+            branches.reserve(o.branches.capacity());
+            branches.assign(o.branches.begin(), o.branches.end());
             current_branch = o.current_branch;
             return *this;
         }
-#endif
         active_branch_list_type branches;
         typename active_branch_list_type::size_type current_branch;
     };
@@ -340,6 +809,7 @@ public:
     inline distance_query_incremental()
         : m_translator(NULL)
 //        , m_pred()
+        , internal_stack_size(0)
         , current_neighbor((std::numeric_limits<size_type>::max)())
 //        , next_closest_node_distance((std::numeric_limits<node_distance_type>::max)())
     {}
@@ -347,6 +817,7 @@ public:
     inline distance_query_incremental(Translator const& translator, Predicates const& pred)
         : m_translator(::boost::addressof(translator))
         , m_pred(pred)
+        , internal_stack_size(0)
         , current_neighbor((std::numeric_limits<size_type>::max)())
 
         , next_closest_node_distance((std::numeric_limits<node_distance_type>::max)())
@@ -354,6 +825,32 @@ public:
         BOOST_GEOMETRY_INDEX_ASSERT(0 < max_count(), "k must be greather than 0");
     }
 
+    // The capacity of the containers is preserved so the copy doesn't allocate during the traversal
+    inline distance_query_incremental(distance_query_incremental const& o)
+        : m_translator(o.m_translator)
+        , m_pred(o.m_pred)
+        , internal_stack(o.internal_stack)
+        , internal_stack_size(o.internal_stack_size)
+        , current_neighbor(o.current_neighbor)
+        , next_closest_node_distance(o.next_closest_node_distance)
+    {
+        neighbors.reserve(o.neighbors.capacity());
+        neighbors.assign(o.neighbors.begin(), o.neighbors.end());
+    }
+
+    inline distance_query_incremental & operator=(distance_query_incremental const& o)
+    {
+        m_translator = o.m_translator;
+        m_pred = o.m_pred;
+        internal_stack = o.internal_stack;
+        internal_stack_size = o.internal_stack_size;
+        neighbors.reserve(o.neighbors.capacity());
+        neighbors.assign(o.neighbors.begin(), o.neighbors.end());
+        current_neighbor = o.current_neighbor;
+        next_closest_node_distance = o.next_closest_node_distance;
+        return *this;
+    }
+
     const_reference dereference() const
     {
         return *(neighbors[current_neighbor].second);
@@ -365,13 +862,25 @@ public:
         increment();
     }
 
+    // The memory for all levels of the tree and all neighbours is allocated
+    // up front so no allocations are performed during the traversal.
+    void initialize(node_pointer root, size_type leafs_level, size_type max_elements, size_type values_count)
+    {
+        internal_stack.resize(leafs_level);
+        for ( typename internal_stack_type::iterator it = internal_stack.begin() ; it != internal_stack.end() ; ++it )
+            it->branches.reserve(max_elements);
+        neighbors.reserve((std::min)(size_type(max_count()), values_count) + max_elements);
+
+        initialize(root);
+    }
+
     void increment()
     {
         for (;;)
         {
             size_type new_neighbor = current_neighbor == (std::numeric_limits<size_type>::max)() ? 0 : current_neighbor + 1;
 
-            if ( internal_stack.empty() )
+            if ( 0 == internal_stack_size )
             {
                 if ( new_neighbor < neighbors.size() )
                     current_neighbor = new_neighbor;
@@ -386,12 +895,12 @@ public:
             }
             else
             {
-                active_branch_list_type & branches = internal_stack.back().branches;
-                typename active_branch_list_type::size_type & current_branch = internal_stack.back().current_branch;
+                active_branch_list_type & branches = internal_stack[internal_stack_size - 1].branches;
+                typename active_branch_list_type::size_type & current_branch = internal_stack[internal_stack_size - 1].current_branch;
 
                 if ( branches.size() <= current_branch )
                 {
-                    internal_stack.pop_back();
+                    --internal_stack_size;
                     continue;
                 }
 
@@ -411,7 +920,7 @@ public:
                      is_node_prunable(neighbors.back().first, branches[current_branch].first) )
                 {
                     // stop traversing current level
-                    internal_stack.pop_back();
+                    --internal_stack_size;
                     continue;
                 }
                 else
@@ -420,7 +929,7 @@ public:
                     ++current_branch;
                     rtree::apply_visitor(*this, *(branches[current_branch - 1].second));
 
-                    next_closest_node_distance = calc_closest_node_distance(internal_stack.begin(), internal_stack.end());
+                    next_closest_node_distance = calc_closest_node_distance(internal_stack.begin(), internal_stack.begin() + internal_stack_size);
                 }
             }
         }
@@ -449,8 +958,14 @@ public:
         typedef typename rtree::elements_type<internal_node>::type elements_type;
         elements_type const& elements = rtree::elements(n);
 
-        // add new element
-        internal_stack.resize(internal_stack.size()+1);
+        // add new element, the elements above the top of the stack are kept
+        // in order to reuse the memory of their lists of branches
+        if ( internal_stack.size() <= internal_stack_size )
+            internal_stack.resize(internal_stack_size + 1);
+        internal_stack_element & top = internal_stack[internal_stack_size];
+        top.branches.clear();
+        top.current_branch = 0;
+        ++internal_stack_size;
 
         // fill active branch list array of nodes meeting predicates
         for ( typename elements_type::const_iterator it = elements.begin() ; it != elements.end() ; ++it )
@@ -475,15 +990,15 @@ public:
                 }
 
                 // add current node's data into the list
-                internal_stack.back().branches.push_back( std::make_pair(node_distance, it->second) );
+                top.branches.push_back( std::make_pair(node_distance, it->second) );
             }
         }
 
-        if ( internal_stack.back().branches.empty() )
-            internal_stack.pop_back();
+        if ( top.branches.empty() )
+            --internal_stack_size;
         else
             // sort array
-            std::sort(internal_stack.back().branches.begin(), internal_stack.back().branches.end(), abl_less);
+            std::sort(top.branches.begin(), top.branches.end(), abl_less);
     }
 
     // Put values into the list of neighbours if those values meets predicates
@@ -576,6 +1091,7 @@ private:
     Predicates m_pred;
 
     internal_stack_type internal_stack;
+    size_type internal_stack_size;
     std::vector< std::pair<value_distance_type, const Value *> > neighbors;
     size_type current_neighbor;
     node_distance_type next_closest_node_distance;
@@ -171,6 +171,10 @@ public:
             rtree::elements(n2).size() <= parameters.get_max_elements(),
             "unexpected number of elements");
 
+        // update aggregates of both nodes if the nodes are augmented
+        rtree::update_aggregate<Value, Options, Box, Allocators>::apply(n, parameters);
+        rtree::update_aggregate<Value, Options, Box, Allocators>::apply(n2, parameters);
+
         // return the list of newly created nodes (this algorithm returns one)
         additional_nodes.push_back(rtree::make_ptr_pair(box2, second_node.get()));                           // MAY THROW, STRONG (alloc, copy)
 
@@ -340,6 +344,10 @@ protected:
         // next traversing step
         rtree::apply_visitor(visitor, *rtree::elements(n)[choosen_node_index].second);                          // MAY THROW (V, E: alloc, copy, N:alloc)
 
+        // the child node was modified, update its aggregate if the nodes are augmented
+        rtree::update_aggregate<Value, Options, Box, Allocators>
+            ::apply(*rtree::elements(n)[choosen_node_index].second, m_parameters);
+
         // restore previous traverse inputs
         m_traverse_data = backup_traverse_data;
     }
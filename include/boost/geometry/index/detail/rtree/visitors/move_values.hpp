@@ -0,0 +1,87 @@
+// Boost.Geometry Index
+//
+// R-tree visitor moving values out of the tree and destroying nodes
+//
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_MOVE_VALUES_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_MOVE_VALUES_HPP
+
+#include <boost/move/utility_core.hpp>
+
+namespace boost { namespace geometry { namespace index {
+
+namespace detail { namespace rtree { namespace visitors {
+
+// Moves the values to the container and destroys the nodes. Each node is
+// destroyed right after its values or children are processed so at most one
+// copy of each value exists at a time. After an exception is thrown the nodes
+// which weren't destroyed are still valid and may be destroyed with the
+// destroy visitor.
+template <typename Value, typename Options, typename Translator, typename Box, typename Allocators, typename Container>
+class move_values
+    : public rtree::visitor<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag, false>::type
+{
+public:
+    typedef typename rtree::internal_node<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag>::type internal_node;
+    typedef typename rtree::leaf<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag>::type leaf;
+
+    typedef typename Allocators::node_pointer node_pointer;
+
+    inline move_values(node_pointer root_node, Container & values, Allocators & allocators)
+        : m_current_node(root_node)
+        , m_values(values)
+        , m_allocators(allocators)
+    {}
+
+    inline void operator()(internal_node & n)
+    {
+        BOOST_GEOMETRY_INDEX_ASSERT(&n == &rtree::get<internal_node>(*m_current_node), "invalid pointers");
+
+        node_pointer node_to_destroy = m_current_node;
+
+        typedef typename rtree::elements_type<internal_node>::type elements_type;
+        elements_type & elements = rtree::elements(n);
+
+        // the children are removed from the back so the node is valid if an exception is thrown
+        while ( ! elements.empty() )
+        {
+            m_current_node = elements.back().second;
+            rtree::apply_visitor(*this, *m_current_node);                                   // MAY THROW (V: alloc, move)
+            elements.pop_back();
+        }
+
+        rtree::destroy_node<Allocators, internal_node>::apply(m_allocators, node_to_destroy);
+    }
+
+    inline void operator()(leaf & l)
+    {
+        BOOST_GEOMETRY_INDEX_ASSERT(&l == &rtree::get<leaf>(*m_current_node), "invalid pointers");
+
+        typedef typename rtree::elements_type<leaf>::type elements_type;
+        elements_type & elements = rtree::elements(l);
+
+        while ( ! elements.empty() )
+        {
+            m_values.push_back(boost::move(elements.back()));                               // MAY THROW (V: alloc, move)
+            elements.pop_back();
+        }
+
+        rtree::destroy_node<Allocators, leaf>::apply(m_allocators, m_current_node);
+    }
+
+private:
+    node_pointer m_current_node;
+    Container & m_values;
+    Allocators & m_allocators;
+};
+
+}}} // namespace detail::rtree::visitors
+
+}}} // namespace boost::geometry::index
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_MOVE_VALUES_HPP
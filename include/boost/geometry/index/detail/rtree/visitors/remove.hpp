@@ -198,6 +198,13 @@ private:
         // next traversing step
         rtree::apply_visitor(*this, *rtree::elements(n)[choosen_node_index].second);                    // MAY THROW (V, E: alloc, copy, N: alloc)
 
+        // update the aggregate of the child node if the nodes are augmented
+        if ( m_is_value_removed )
+        {
+            rtree::update_aggregate<Value, Options, Box, Allocators>
+                ::apply(*rtree::elements(n)[choosen_node_index].second, m_parameters);
+        }
+
         // restore previous traverse inputs
         m_parent = parent_bckup;
         m_current_child_index = current_child_index_bckup;
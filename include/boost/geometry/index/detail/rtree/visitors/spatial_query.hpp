@@ -11,11 +11,17 @@
 #ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_SPATIAL_QUERY_HPP
 #define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_SPATIAL_QUERY_HPP
 
+#include <boost/container/small_vector.hpp>
+
+#include <boost/geometry/index/detail/rtree/query_statistics.hpp>
+#include <boost/geometry/index/detail/rtree/traversal_stack.hpp>
+
 namespace boost { namespace geometry { namespace index {
 
 namespace detail { namespace rtree { namespace visitors {
 
-template <typename Value, typename Options, typename Translator, typename Box, typename Allocators, typename Predicates, typename OutIter>
+template <typename Value, typename Options, typename Translator, typename Box, typename Allocators, typename Predicates, typename OutIter,
+          typename Statistics = rtree::no_query_statistics>
 struct spatial_query
     : public rtree::visitor<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag, true>::type
 {
@@ -27,12 +33,15 @@ struct spatial_query
 
     static const unsigned predicates_len = index::detail::predicates_length<Predicates>::value;
 
-    inline spatial_query(Translator const& t, Predicates const& p, OutIter out_it)
-        : tr(t), pred(p), out_iter(out_it), found_count(0)
+    inline spatial_query(Translator const& t, Predicates const& p, OutIter out_it,
+                         Statistics const& s = Statistics())
+        : tr(t), pred(p), out_iter(out_it), found_count(0), statistics(s)
     {}
 
     inline void operator()(internal_node const& n)
     {
+        statistics.visit_internal_node();
+
         typedef typename rtree::elements_type<internal_node>::type elements_type;
         elements_type const& elements = rtree::elements(n);
 
@@ -40,6 +49,8 @@ struct spatial_query
         for (typename elements_type::const_iterator it = elements.begin();
             it != elements.end(); ++it)
         {
+            statistics.check_bounds();
+
             // if node meets predicates
             // 0 - dummy value
             if ( index::detail::predicates_check<index::detail::bounds_tag, 0, predicates_len>(pred, 0, it->first) )
@@ -49,6 +60,8 @@ struct spatial_query
 
     inline void operator()(leaf const& n)
     {
+        statistics.visit_leaf();
+
         typedef typename rtree::elements_type<leaf>::type elements_type;
         elements_type const& elements = rtree::elements(n);
 
@@ -56,6 +69,8 @@ struct spatial_query
         for (typename elements_type::const_iterator it = elements.begin();
             it != elements.end(); ++it)
         {
+            statistics.check_value();
+
             // if value meets predicates
             if ( index::detail::predicates_check<index::detail::value_tag, 0, predicates_len>(pred, *it, tr(*it)) )
             {
@@ -63,6 +78,7 @@ struct spatial_query
                 ++out_iter;
 
                 ++found_count;
+                statistics.return_values(1);
             }
         }
     }
@@ -73,6 +89,266 @@ struct spatial_query
 
     OutIter out_iter;
     size_type found_count;
+
+    Statistics statistics;
+};
+
+// Calls the function object for each value meeting predicates, in the same order
+// as spatial_query writes them to the output iterator. The traversal is stopped
+// as soon as the function object returns false. Nothing is copied or allocated.
+template <typename Value, typename Options, typename Translator, typename Box, typename Allocators, typename Predicates, typename Function>
+struct spatial_query_callback
+    : public rtree::visitor<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag, true>::type
+{
+    typedef typename rtree::node<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag>::type node;
+    typedef typename rtree::internal_node<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag>::type internal_node;
+    typedef typename rtree::leaf<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag>::type leaf;
+
+    typedef typename Allocators::size_type size_type;
+
+    static const unsigned predicates_len = index::detail::predicates_length<Predicates>::value;
+
+    inline spatial_query_callback(Translator const& t, Predicates const& p, Function & f)
+        : tr(t), pred(p), function(f), found_count(0), stopped(false)
+    {}
+
+    inline void operator()(internal_node const& n)
+    {
+        typedef typename rtree::elements_type<internal_node>::type elements_type;
+        elements_type const& elements = rtree::elements(n);
+
+        // traverse nodes meeting predicates until stopped
+        for (typename elements_type::const_iterator it = elements.begin();
+            it != elements.end(); ++it)
+        {
+            // 0 - dummy value
+            if ( index::detail::predicates_check<index::detail::bounds_tag, 0, predicates_len>(pred, 0, it->first) )
+            {
+                rtree::apply_visitor(*this, *it->second);
+
+                if ( stopped )
+                    return;
+            }
+        }
+    }
+
+    inline void operator()(leaf const& n)
+    {
+        typedef typename rtree::elements_type<leaf>::type elements_type;
+        elements_type const& elements = rtree::elements(n);
+
+        for (typename elements_type::const_iterator it = elements.begin();
+            it != elements.end(); ++it)
+        {
+            if ( index::detail::predicates_check<index::detail::value_tag, 0, predicates_len>(pred, *it, tr(*it)) )
+            {
+                ++found_count;
+
+                if ( ! function(*it) )
+                {
+                    stopped = true;
+                    return;
+                }
+            }
+        }
+    }
+
+    Translator const& tr;
+
+    Predicates const& pred;
+
+    Function & function;
+    size_type found_count;
+    bool stopped;
+};
+
+// Counts values meeting predicates and calculates their aggregate. If the nodes
+// are augmented the subtrees which bounds are covered by the predicates aren't
+// traversed, their aggregates are used instead.
+template <typename Value, typename Options, typename Translator, typename Box, typename Allocators, typename Predicates>
+struct spatial_query_aggregate
+    : public rtree::visitor<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag, true>::type
+{
+    typedef typename Options::parameters_type parameters_type;
+
+    typedef typename rtree::node<Value, parameters_type, Box, Allocators, typename Options::node_tag>::type node;
+    typedef typename rtree::internal_node<Value, parameters_type, Box, Allocators, typename Options::node_tag>::type internal_node;
+    typedef typename rtree::leaf<Value, parameters_type, Box, Allocators, typename Options::node_tag>::type leaf;
+
+    typedef typename Allocators::size_type size_type;
+
+    typedef rtree::parameters_aggregator<parameters_type> aggregator_traits;
+    typedef typename aggregator_traits::type aggregator_type;
+    typedef rtree::node_aggregate_data<size_type, aggregator_type> aggregate_type;
+
+    static const unsigned predicates_len = index::detail::predicates_length<Predicates>::value;
+    static const bool is_augmented = rtree::is_augmented<parameters_type>::value;
+
+    inline spatial_query_aggregate(Translator const& t, parameters_type const& parameters, Predicates const& p)
+        : tr(t), aggregator(aggregator_traits::get(parameters)), pred(p)
+    {
+        result.reset(aggregator);
+    }
+
+    inline void operator()(internal_node const& n)
+    {
+        typedef typename rtree::elements_type<internal_node>::type elements_type;
+        elements_type const& elements = rtree::elements(n);
+
+        for (typename elements_type::const_iterator it = elements.begin();
+            it != elements.end(); ++it)
+        {
+            // 0 - dummy value
+            if ( index::detail::predicates_check<index::detail::bounds_tag, 0, predicates_len>(pred, 0, it->first)
+              && ! add_if_covered(*it, boost::mpl::bool_<is_augmented>()) )
+            {
+                rtree::apply_visitor(*this, *it->second);
+            }
+        }
+    }
+
+    inline void operator()(leaf const& n)
+    {
+        typedef typename rtree::elements_type<leaf>::type elements_type;
+        elements_type const& elements = rtree::elements(n);
+
+        for (typename elements_type::const_iterator it = elements.begin();
+            it != elements.end(); ++it)
+        {
+            if ( index::detail::predicates_check<index::detail::value_tag, 0, predicates_len>(pred, *it, tr(*it)) )
+            {
+                result.add_value(aggregator, *it);
+            }
+        }
+    }
+
+    Translator const& tr;
+    aggregator_type aggregator;
+
+    Predicates const& pred;
+
+    aggregate_type result;
+
+private:
+    template <typename Element>
+    inline bool add_if_covered(Element const& el, boost::mpl::bool_<true> const& /*is_augmented*/)
+    {
+        // all values stored in the subtree meet predicates
+        // 0 - dummy value
+        if ( ! index::detail::predicates_check<index::detail::covered_bounds_tag, 0, predicates_len>(pred, 0, el.first) )
+            return false;
+
+        visitors::get_aggregate<Value, Options, Box, Allocators> get_v;
+        rtree::apply_visitor(get_v, *el.second);
+        result.add(aggregator, *get_v.result);
+
+        return true;
+    }
+
+    template <typename Element>
+    inline bool add_if_covered(Element const& , boost::mpl::bool_<false> const& /*is_augmented*/)
+    {
+        return false;
+    }
+};
+
+// Performs many spatial queries during one traversal of the tree.
+// The predicates of all queries are checked for a node before it's visited
+// and the node is visited only once if more than one query hits it.
+// The results are stored as pairs (query index, pointer to value),
+// for each query in the order of the traversal.
+template <typename Value, typename Options, typename Translator, typename Box, typename Allocators, typename PredicatesIterator>
+class spatial_query_batch
+    : public rtree::visitor<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag, true>::type
+{
+public:
+    typedef typename rtree::node<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag>::type node;
+    typedef typename rtree::internal_node<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag>::type internal_node;
+    typedef typename rtree::leaf<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag>::type leaf;
+
+    typedef typename Allocators::size_type size_type;
+    typedef std::pair<size_type, const Value *> found_type;
+
+    typedef typename std::iterator_traits<PredicatesIterator>::value_type predicates_type;
+    static const unsigned predicates_len = index::detail::predicates_length<predicates_type>::value;
+
+    inline spatial_query_batch(Translator const& t, PredicatesIterator first, size_type count,
+                               std::vector<found_type> & results)
+        : m_translator(t), m_predicates(first)
+        , m_active_first(0), m_active_last(count)
+        , m_results(results)
+    {
+        // all queries are active in the root
+        m_active.reserve(count);
+        for ( size_type i = 0 ; i < count ; ++i )
+            m_active.push_back(i);
+    }
+
+    inline void operator()(internal_node const& n)
+    {
+        typedef typename rtree::elements_type<internal_node>::type elements_type;
+        elements_type const& elements = rtree::elements(n);
+
+        size_type const active_first = m_active_first;
+        size_type const active_last = m_active_last;
+
+        for (typename elements_type::const_iterator it = elements.begin();
+            it != elements.end(); ++it)
+        {
+            // gather queries for which the node meets predicates
+            // NOTE: m_active may be reallocated so indexes are used
+            size_type const child_first = m_active.size();
+            for ( size_type i = active_first ; i < active_last ; ++i )
+            {
+                size_type const q = m_active[i];
+                // 0 - dummy value
+                if ( index::detail::predicates_check<index::detail::bounds_tag, 0, predicates_len>(m_predicates[q], 0, it->first) )
+                    m_active.push_back(q);
+            }
+
+            if ( child_first < m_active.size() )
+            {
+                m_active_first = child_first;
+                m_active_last = m_active.size();
+
+                rtree::apply_visitor(*this, *it->second);
+
+                m_active.resize(child_first);
+            }
+        }
+
+        m_active_first = active_first;
+        m_active_last = active_last;
+    }
+
+    inline void operator()(leaf const& n)
+    {
+        typedef typename rtree::elements_type<leaf>::type elements_type;
+        elements_type const& elements = rtree::elements(n);
+
+        for (typename elements_type::const_iterator it = elements.begin();
+            it != elements.end(); ++it)
+        {
+            typename Translator::result_type indexable = m_translator(*it);
+
+            for ( size_type i = m_active_first ; i < m_active_last ; ++i )
+            {
+                size_type const q = m_active[i];
+                if ( index::detail::predicates_check<index::detail::value_tag, 0, predicates_len>(m_predicates[q], *it, indexable) )
+                    m_results.push_back(found_type(q, boost::addressof(*it)));
+            }
+        }
+    }
+
+private:
+    Translator const& m_translator;
+    PredicatesIterator m_predicates;
+
+    std::vector<size_type> m_active;
+    size_type m_active_first;
+    size_type m_active_last;
+
+    std::vector<found_type> & m_results;
 };
 
 template <typename Value, typename Options, typename Translator, typename Box, typename Allocators, typename Predicates>
@@ -134,6 +410,13 @@ public:
         search_value();
     }
 
+    void initialize(node_pointer root, size_type leafs_level, size_type /*max_elements*/, size_type /*values_count*/)
+    {
+        // the internal nodes of deeper trees don't fit in the stack's internal buffer
+        m_internal_stack.reserve(leafs_level);
+        initialize(root);
+    }
+
     void increment()
     {
         ++m_current;
@@ -202,7 +485,11 @@ private:
 
     Predicates m_pred;
 
-    std::vector< std::pair<internal_iterator, internal_iterator> > m_internal_stack;
+    boost::container::small_vector
+        <
+            std::pair<internal_iterator, internal_iterator>,
+            traversal_stack_capacity<typename Options::parameters_type>::value
+        > m_internal_stack;
     const leaf_elements * m_values;
     leaf_iterator m_current;
 };
@@ -14,6 +14,8 @@
 #include <boost/serialization/version.hpp>
 //#include <boost/serialization/nvp.hpp>
 
+#include <boost/geometry/index/detail/rtree/private_view.hpp>
+
 // TODO
 // how about using the unsigned type capable of storing Max in compile-time versions?
 
@@ -400,6 +402,8 @@ private:
                 elements.push_back(element_type(b, n));
             }
 
+            rtree::update_aggregate<Value, Options, Box, Allocators>::apply(in, parameters);
+
             auto_remover.release();
             return n;
         }
@@ -425,6 +429,8 @@ private:
                 elements.push_back(el);                                                                     // MAY THROW (C)
             }
 
+            rtree::update_aggregate<Value, Options, Box, Allocators>::apply(l, parameters);
+
             auto_remover.release();
             return n;
         }
@@ -433,62 +439,6 @@ private:
 
 }}}}} // boost::geometry::index::detail::rtree
 
-// TODO - move to index/detail/rtree/private_view.hpp
-namespace boost { namespace geometry { namespace index { namespace detail { namespace rtree {
-
-template <typename Rtree>
-class const_private_view
-{
-public:
-    typedef typename Rtree::size_type size_type;
-
-    typedef typename Rtree::translator_type translator_type;
-    typedef typename Rtree::value_type value_type;
-    typedef typename Rtree::options_type options_type;
-    typedef typename Rtree::box_type box_type;
-    typedef typename Rtree::allocators_type allocators_type;    
-
-    const_private_view(Rtree const& rt) : m_rtree(rt) {}
-
-    typedef typename Rtree::members_holder members_holder;
-
-    members_holder const& members() const { return m_rtree.m_members; }
-
-private:
-    const_private_view(const_private_view const&);
-    const_private_view & operator=(const_private_view const&);
-
-    Rtree const& m_rtree;
-};
-
-template <typename Rtree>
-class private_view
-{
-public:
-    typedef typename Rtree::size_type size_type;
-
-    typedef typename Rtree::translator_type translator_type;
-    typedef typename Rtree::value_type value_type;
-    typedef typename Rtree::options_type options_type;
-    typedef typename Rtree::box_type box_type;
-    typedef typename Rtree::allocators_type allocators_type;    
-
-    private_view(Rtree & rt) : m_rtree(rt) {}
-
-    typedef typename Rtree::members_holder members_holder;
-
-    members_holder & members() { return m_rtree.m_members; }
-    members_holder const& members() const { return m_rtree.m_members; }
-
-private:
-    private_view(private_view const&);
-    private_view & operator=(private_view const&);
-
-    Rtree & m_rtree;
-};
-
-}}}}} // namespace boost::geometry::index::detail::rtree
-
 // TODO - move to index/serialization/rtree.hpp
 namespace boost { namespace serialization {
 
@@ -17,6 +17,7 @@ namespace detail {
 
 struct value_tag {};
 struct bounds_tag {};
+struct covered_bounds_tag {};
 
 } // namespace detail
 
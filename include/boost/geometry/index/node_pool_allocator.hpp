@@ -0,0 +1,343 @@
+// Boost.Geometry Index
+//
+// Pool allocator of the rtree nodes
+//
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_NODE_POOL_ALLOCATOR_HPP
+#define BOOST_GEOMETRY_INDEX_NODE_POOL_ALLOCATOR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <vector>
+
+#include <boost/core/addressof.hpp>
+#include <boost/core/noncopyable.hpp>
+#include <boost/smart_ptr/detail/atomic_count.hpp>
+#include <boost/smart_ptr/intrusive_ptr.hpp>
+#include <boost/type_traits/integral_constant.hpp>
+#include <boost/type_traits/type_with_alignment.hpp>
+
+#include <boost/geometry/util/parallel.hpp>
+
+#ifdef BOOST_GEOMETRY_DETAIL_PARALLEL_USE_THREADS
+#include <mutex>
+#endif
+
+namespace boost { namespace geometry { namespace index {
+
+namespace detail {
+
+// The memory of blocks is allocated from slabs of memory. Freed blocks are stored
+// in free lists, one for each size class, and reused by the subsequent allocations
+// of blocks of the same size class. The slabs are released all at once when the
+// pool is destroyed or when release() is called and there are no allocated blocks.
+// Blocks greater than max_block_size are allocated with the global operator new.
+class node_pool
+    : boost::noncopyable
+{
+    struct free_block
+    {
+        free_block * next;
+    };
+
+public:
+    static const std::size_t alignment
+        = boost::alignment_of<boost::detail::max_align>::value < sizeof(free_block)
+        ? sizeof(free_block)
+        : boost::alignment_of<boost::detail::max_align>::value;
+    static const std::size_t max_block_size = 4096;
+    static const std::size_t slab_size = 64 * 1024;
+
+    node_pool()
+        : m_current(0)
+        , m_current_end(0)
+        , m_free_lists(max_block_size / alignment + 1, static_cast<free_block*>(0))
+        , m_blocks_count(0)
+        , m_references(0)
+    {}
+
+    ~node_pool()
+    {
+        release_slabs();
+    }
+
+    void * allocate(std::size_t size)
+    {
+        if ( max_block_size < size )
+            return ::operator new(size);                                                        // MAY THROW (A)
+
+        std::size_t const size_class = (size + alignment - 1) / alignment;
+
+        lock_guard lock(m_mutex);
+
+        free_block *& head = m_free_lists[size_class];
+        if ( head != 0 )
+        {
+            free_block * const b = head;
+            head = b->next;
+            ++m_blocks_count;
+            return b;
+        }
+
+        std::size_t const block_size = size_class * alignment;
+        if ( static_cast<std::size_t>(m_current_end - m_current) < block_size )
+        {
+            // the rest of the current slab is not used
+            m_slabs.reserve(m_slabs.size() + 1);                                                // MAY THROW (A)
+            m_current = static_cast<char*>(::operator new(slab_size));                          // MAY THROW (A)
+            m_current_end = m_current + slab_size;
+            m_slabs.push_back(m_current);
+        }
+
+        void * const result = m_current;
+        m_current += block_size;
+        ++m_blocks_count;
+        return result;
+    }
+
+    void deallocate(void * p, std::size_t size)
+    {
+        if ( max_block_size < size )
+        {
+            ::operator delete(p);
+            return;
+        }
+
+        std::size_t const size_class = (size + alignment - 1) / alignment;
+
+        lock_guard lock(m_mutex);
+
+        free_block * const b = static_cast<free_block*>(p);
+        b->next = m_free_lists[size_class];
+        m_free_lists[size_class] = b;
+        --m_blocks_count;
+    }
+
+    // Releases the memory of all slabs if all blocks were deallocated.
+    bool release()
+    {
+        lock_guard lock(m_mutex);
+
+        if ( m_blocks_count != 0 )
+            return false;
+
+        release_slabs();
+        return true;
+    }
+
+    std::size_t blocks_count() const
+    {
+        lock_guard lock(m_mutex);
+        return m_blocks_count;
+    }
+
+    std::size_t slabs_count() const
+    {
+        lock_guard lock(m_mutex);
+        return m_slabs.size();
+    }
+
+    friend inline void intrusive_ptr_add_ref(node_pool * p)
+    {
+        ++p->m_references;
+    }
+
+    friend inline void intrusive_ptr_release(node_pool * p)
+    {
+        if ( --p->m_references == 0 )
+            delete p;
+    }
+
+private:
+    void release_slabs()
+    {
+        for ( std::size_t i = 0 ; i < m_slabs.size() ; ++i )
+            ::operator delete(m_slabs[i]);
+
+        m_slabs.clear();
+        std::fill(m_free_lists.begin(), m_free_lists.end(), static_cast<free_block*>(0));
+        m_current = 0;
+        m_current_end = 0;
+    }
+
+#ifdef BOOST_GEOMETRY_DETAIL_PARALLEL_USE_THREADS
+    typedef std::mutex mutex_type;
+    typedef std::lock_guard<std::mutex> lock_guard;
+#else
+    struct mutex_type {};
+    struct lock_guard
+    {
+        explicit lock_guard(mutex_type &) {}
+    };
+#endif
+
+    std::vector<char*> m_slabs;
+    char * m_current;
+    char * m_current_end;
+    std::vector<free_block*> m_free_lists;
+    std::size_t m_blocks_count;
+    mutable mutex_type m_mutex;
+    boost::detail::atomic_count m_references;
+};
+
+} // namespace detail
+
+/*!
+\brief The allocator storing the nodes of the rtree in a pool of memory.
+
+The nodes of the rtree, and the containers of elements of nodes of the rtree
+using run-time parameters, are allocated from slabs of memory owned by a pool.
+The deallocated nodes are stored in free lists and reused by the subsequent
+allocations of nodes of the same size. The memory of the slabs is released at once
+when the pool is destroyed, i.e. when the last allocator using it is destroyed,
+or when release() is called and the rtree is empty.
+
+Copies of the allocator and the allocators of different value types created from it
+use the same pool, so a copy of the rtree created with the copy constructor shares
+the pool with the source rtree. Default-constructed allocator creates new pool so by
+default each rtree has its own pool. The pool may be used by many threads at the same
+time, e.g. during the parallel packing.
+
+\par Example
+\verbatim
+bgi::rtree< Value, bgi::rstar<16>, bgi::indexable<Value>, bgi::equal_to<Value>,
+            bgi::node_pool_allocator<Value> > rt;
+\endverbatim
+
+\tparam T   The type of allocated objects.
+*/
+template <typename T>
+class node_pool_allocator
+{
+    template <typename U> friend class node_pool_allocator;
+
+public:
+    typedef T value_type;
+    typedef T * pointer;
+    typedef T const* const_pointer;
+    typedef T & reference;
+    typedef T const& const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    typedef boost::false_type propagate_on_container_copy_assignment;
+    typedef boost::true_type propagate_on_container_move_assignment;
+    typedef boost::true_type propagate_on_container_swap;
+
+    template <typename U>
+    struct rebind
+    {
+        typedef node_pool_allocator<U> other;
+    };
+
+    /*!
+    \brief The constructor creating new pool.
+    */
+    node_pool_allocator()
+        : m_pool(new detail::node_pool())
+    {}
+
+    /*!
+    \brief The copy constructor. The pool is shared.
+    */
+    node_pool_allocator(node_pool_allocator const& other)
+        : m_pool(other.m_pool)
+    {}
+
+    /*!
+    \brief The converting constructor. The pool is shared.
+    */
+    template <typename U>
+    node_pool_allocator(node_pool_allocator<U> const& other)
+        : m_pool(other.m_pool)
+    {}
+
+    node_pool_allocator & operator=(node_pool_allocator const& other)
+    {
+        m_pool = other.m_pool;
+        return *this;
+    }
+
+    pointer allocate(size_type n, const void * = 0)
+    {
+        if ( max_size() < n )
+            throw std::bad_alloc();
+
+        return static_cast<pointer>(m_pool->allocate(n * sizeof(T)));                           // MAY THROW (A)
+    }
+
+    void deallocate(pointer p, size_type n)
+    {
+        m_pool->deallocate(p, n * sizeof(T));
+    }
+
+    size_type max_size() const
+    {
+        return (std::numeric_limits<size_type>::max)() / sizeof(T);
+    }
+
+    void construct(pointer p, const_reference v)
+    {
+        ::new (static_cast<void*>(p)) T(v);
+    }
+
+    void destroy(pointer p)
+    {
+        p->~T();
+    }
+
+    pointer address(reference r) const { return boost::addressof(r); }
+    const_pointer address(const_reference r) const { return boost::addressof(r); }
+
+    /*!
+    \brief Releases the memory of the pool if no objects are allocated from it.
+
+    \return \c true if the memory was released.
+    */
+    bool release()
+    {
+        return m_pool->release();
+    }
+
+    /*!
+    \brief Returns the number of objects and arrays allocated from the slabs of the pool.
+    */
+    size_type blocks_count() const
+    {
+        return m_pool->blocks_count();
+    }
+
+    /*!
+    \brief Returns the number of slabs of memory owned by the pool.
+    */
+    size_type slabs_count() const
+    {
+        return m_pool->slabs_count();
+    }
+
+    template <typename U>
+    bool operator==(node_pool_allocator<U> const& other) const
+    {
+        return m_pool == other.m_pool;
+    }
+
+    template <typename U>
+    bool operator!=(node_pool_allocator<U> const& other) const
+    {
+        return m_pool != other.m_pool;
+    }
+
+private:
+    boost::intrusive_ptr<detail::node_pool> m_pool;
+};
+
+}}} // namespace boost::geometry::index
+
+#endif // BOOST_GEOMETRY_INDEX_NODE_POOL_ALLOCATOR_HPP
@@ -0,0 +1,152 @@
+// Boost.Geometry Index
+//
+// R-tree packing with bounded memory
+//
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_PACK_EXTERNAL_HPP
+#define BOOST_GEOMETRY_INDEX_PACK_EXTERNAL_HPP
+
+#include <cstddef>
+
+#include <boost/geometry/index/rtree.hpp>
+#include <boost/geometry/index/packing.hpp>
+#include <boost/geometry/index/detail/rtree/pack_external.hpp>
+#include <boost/geometry/index/detail/rtree/private_view.hpp>
+
+namespace boost { namespace geometry { namespace index {
+
+/*!
+\brief Creates the rtree from a range of Values which may not fit in memory.
+
+The Values are read from the range once, in chunks of at most \c max_values_in_memory
+Values. Then they are stored in temporary files, sorted by the space-filling curve
+index of the centroids of their Indexables in sorted runs and the tree is created
+bottom-up from the merged runs. Besides the created tree at most a few times
+\c max_values_in_memory Values are stored in memory at the same time. The resulting
+tree is the same as the one created by the packing constructor with the same curve.
+If all Values fit in one chunk no temporary files are created.
+
+The top-down packing algorithm needs random access to all Values so if it is passed
+the Hilbert curve is used instead. The previous content of the tree is destroyed.
+
+\ingroup rtree_functions
+
+\par Example
+\verbatim
+bgi::rtree< Point, bgi::quadratic<16> > tree;
+std::ifstream file("points.bin", std::ios::binary);
+bgi::pack_external(tree, point_file_iterator(file), point_file_iterator(),
+                   10000000, bgi::packing(bgi::packing::hilbert, bgi::parallel(4)));
+\endverbatim
+
+\param tree                 The spatial index.
+\param first                The beginning of the range of Values, input iterator.
+\param last                 The end of the range of Values.
+\param max_values_in_memory The maximum number of Values read into memory at once.
+\param packing              The packing policy defining the curve and the maximum number of threads.
+
+\par Throws
+\li If Value copy constructor or copy assignment throws.
+\li If allocation throws or returns invalid value.
+\li std::runtime_error if the temporary files can't be created, written or read.
+
+\par Exception-safety
+strong
+
+\warning
+The Value must be trivially copyable because it is stored in temporary files as raw bytes.
+*/
+template <typename Value, typename Parameters, typename IndexableGetter, typename EqualTo, typename Allocator,
+          typename InIt>
+inline void pack_external(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> & tree,
+                          InIt first, InIt last,
+                          std::size_t max_values_in_memory,
+                          index::packing const& packing = index::packing(index::packing::hilbert))
+{
+    typedef rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> rtree_type;
+    typedef detail::rtree::private_view<rtree_type> view_type;
+    typedef detail::rtree::pack_external
+        <
+            typename view_type::value_type,
+            typename view_type::options_type,
+            typename view_type::translator_type,
+            typename view_type::box_type,
+            typename view_type::allocators_type
+        > pack_external_type;
+
+    view_type view(tree);
+    typename view_type::size_type vc = 0, ll = 0;
+    typename view_type::allocators_type::node_pointer root
+        = pack_external_type::apply(first, last, vc, ll,
+                                    view.members().parameters(), view.members().translator(), view.members().allocators(),
+                                    packing, max_values_in_memory);                                 // MAY THROW
+
+    detail::rtree::replace_content(tree, root, vc, ll);
+}
+
+/*!
+\brief Creates the rtree from a range of Values which may not fit in memory, using known bounds.
+
+The same as the other overload of pack_external() but the space-filling curve is
+defined by the passed bounding box instead of the bounding box of all Values. So
+the Values are sorted as they're read and no additional pass over the temporary
+data is performed. The resulting tree is the same as the one created by the packing
+constructor only if the passed box is the bounding box of all Values.
+
+\ingroup rtree_functions
+
+\param tree                 The spatial index.
+\param first                The beginning of the range of Values, input iterator.
+\param last                 The end of the range of Values.
+\param bounds               The box defining the area filled by the space-filling curve.
+\param max_values_in_memory The maximum number of Values read into memory at once.
+\param packing              The packing policy defining the curve and the maximum number of threads.
+
+\par Throws
+\li If Value copy constructor or copy assignment throws.
+\li If allocation throws or returns invalid value.
+\li std::runtime_error if the temporary files can't be created, written or read.
+
+\par Exception-safety
+strong
+
+\warning
+The Value must be trivially copyable because it is stored in temporary files as raw bytes.
+*/
+template <typename Value, typename Parameters, typename IndexableGetter, typename EqualTo, typename Allocator,
+          typename InIt>
+inline void pack_external(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> & tree,
+                          InIt first, InIt last,
+                          typename rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator>::bounds_type const& bounds,
+                          std::size_t max_values_in_memory,
+                          index::packing const& packing = index::packing(index::packing::hilbert))
+{
+    typedef rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> rtree_type;
+    typedef detail::rtree::private_view<rtree_type> view_type;
+    typedef detail::rtree::pack_external
+        <
+            typename view_type::value_type,
+            typename view_type::options_type,
+            typename view_type::translator_type,
+            typename view_type::box_type,
+            typename view_type::allocators_type
+        > pack_external_type;
+
+    view_type view(tree);
+    typename view_type::size_type vc = 0, ll = 0;
+    typename view_type::allocators_type::node_pointer root
+        = pack_external_type::apply(first, last, bounds, vc, ll,
+                                    view.members().parameters(), view.members().translator(), view.members().allocators(),
+                                    packing, max_values_in_memory);                                 // MAY THROW
+
+    detail::rtree::replace_content(tree, root, vc, ll);
+}
+
+}}} // namespace boost::geometry::index
+
+#endif // BOOST_GEOMETRY_INDEX_PACK_EXTERNAL_HPP
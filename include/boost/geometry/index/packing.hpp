@@ -0,0 +1,142 @@
+// Boost.Geometry Index
+//
+// Packing policy
+//
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_PACKING_HPP
+#define BOOST_GEOMETRY_INDEX_PACKING_HPP
+
+#include <cstddef>
+
+#include <boost/geometry/index/parallel.hpp>
+
+namespace boost { namespace geometry { namespace index {
+
+/*!
+\brief The packing policy.
+
+The object of this type may be passed to the packing constructors of the rtree.
+It defines the algorithm used to group the Values into nodes and the maximum
+number of threads used during the construction.
+
+The following algorithms are available:
+\li \c packing::top_down - the default. The range of Values is recursively split
+    at the median along the longest edge of the bounding box (similar to STR).
+\li \c packing::hilbert - Values are sorted by the Hilbert curve index of their
+    centroids and then grouped into nodes in that order. The Hilbert curve
+    preserves the spatial locality very well so this algorithm is suitable e.g.
+    for clustered, not uniformly distributed data.
+\li \c packing::morton - Values are sorted by the Morton curve (Z-order) index of
+    their centroids. The keys are cheaper to calculate than Hilbert keys but the
+    locality is worse.
+
+In all cases the number of elements in nodes is between Min and Max and the nodes
+are packed as tightly as possible. The space-filling curve sort is performed with
+radix sort which may be executed by many threads.
+
+After the tree is created its nodes may be allocated again in the order in which
+they're visited by the queries:
+\li \c packing::creation_order - the default. The nodes are left where they were
+    allocated during the construction, in the order in which they were created.
+\li \c packing::breadth_first - the nodes are allocated level by level, the root
+    first, so the nodes of upper levels are stored close to each other.
+\li \c packing::van_emde_boas - the tree is recursively divided into the top half
+    of the levels and the subtrees of the bottom half and each of them is allocated
+    contiguously, so the nodes of a path from the root to a leaf are stored close to
+    each other for any height of the tree.
+
+The nodes are allocated with the allocator of the rtree one after another, so
+they're stored in one contiguous block of memory if the allocator places the
+subsequent allocations next to each other, e.g. bgi::node_pool_allocator.
+
+\par Example
+\verbatim
+// create the rtree using Hilbert curve packing and 4 threads
+bgi::rtree< Value, bgi::quadratic<16> > rt(values, bgi::packing(bgi::packing::hilbert, bgi::parallel(4)));
+// store the nodes in van Emde Boas order
+bgi::rtree< Value, bgi::quadratic<16> > rt2(values, bgi::packing(bgi::packing::hilbert, bgi::parallel(1),
+                                                                 bgi::packing::van_emde_boas));
+\endverbatim
+*/
+class packing
+{
+public:
+    /*!
+    \brief The packing algorithm.
+    */
+    enum algorithm_type
+    {
+        top_down,   /*!< Recursive median split along the longest edge. */
+        hilbert,    /*!< Hilbert curve sort. */
+        morton      /*!< Morton curve (Z-order) sort. */
+    };
+
+    /*!
+    \brief The order of nodes in memory.
+    */
+    enum node_order_type
+    {
+        creation_order, /*!< The order of creation. */
+        breadth_first,  /*!< Breadth-first order. */
+        van_emde_boas   /*!< Van Emde Boas order. */
+    };
+
+    /*!
+    \brief The constructor.
+
+    \param algorithm    The packing algorithm.
+    \param par          The parallel execution policy defining the maximum number of threads.
+    \param node_order   The order of nodes in memory.
+    */
+    inline explicit packing(algorithm_type algorithm = top_down,
+                            index::parallel const& par = index::parallel(1),
+                            node_order_type node_order = creation_order)
+        : m_algorithm(algorithm)
+        , m_threads(par.threads())
+        , m_node_order(node_order)
+    {}
+
+    /*!
+    \brief Returns the packing algorithm.
+
+    \return     The packing algorithm.
+    */
+    inline algorithm_type algorithm() const
+    {
+        return m_algorithm;
+    }
+
+    /*!
+    \brief Returns the maximum number of threads.
+
+    \return     The maximum number of threads, always greater than 0.
+    */
+    inline std::size_t threads() const
+    {
+        return m_threads;
+    }
+
+    /*!
+    \brief Returns the order of nodes in memory.
+
+    \return     The order of nodes.
+    */
+    inline node_order_type node_order() const
+    {
+        return m_node_order;
+    }
+
+private:
+    algorithm_type m_algorithm;
+    std::size_t m_threads;
+    node_order_type m_node_order;
+};
+
+}}} // namespace boost::geometry::index
+
+#endif // BOOST_GEOMETRY_INDEX_PACKING_HPP
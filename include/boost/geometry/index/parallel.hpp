@@ -0,0 +1,66 @@
+// Boost.Geometry Index
+//
+// Parallel execution policy
+//
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_PARALLEL_HPP
+#define BOOST_GEOMETRY_INDEX_PARALLEL_HPP
+
+#include <cstddef>
+
+#include <boost/geometry/util/parallel.hpp>
+
+namespace boost { namespace geometry { namespace index {
+
+/*!
+\brief The parallel execution policy.
+
+The object of this type may be passed to the operations which are able to
+use multiple threads, e.g. the packing constructors of the rtree. It defines
+the maximum number of threads used by the operation.
+
+If threads are not supported by the compiler or the standard library
+or if \c BOOST_GEOMETRY_DISABLE_THREADS is defined the operations are
+performed sequentially in the calling thread.
+
+\par Example
+\verbatim
+// create the rtree using packing algorithm and 8 threads
+bgi::rtree< Value, bgi::quadratic<16> > rt(values, bgi::parallel(8));
+\endverbatim
+*/
+class parallel
+{
+public:
+    /*!
+    \brief The constructor.
+
+    \param threads  The maximum number of threads. If 0 the number
+                    of hardware threads is used.
+    */
+    inline explicit parallel(std::size_t threads = 0)
+        : m_threads(geometry::detail::parallel::threads_count(threads))
+    {}
+
+    /*!
+    \brief Returns the maximum number of threads.
+
+    \return     The maximum number of threads, always greater than 0.
+    */
+    inline std::size_t threads() const
+    {
+        return m_threads;
+    }
+
+private:
+    std::size_t m_threads;
+};
+
+}}} // namespace boost::geometry::index
+
+#endif // BOOST_GEOMETRY_INDEX_PARALLEL_HPP
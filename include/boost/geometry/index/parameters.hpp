@@ -67,6 +67,9 @@ inline size_t default_rstar_reinserted_elements_d_calc(size_t max_elements, size
     return reinserted_elements;
 }
 
+// The default aggregator of augmented parameters, only the number of values is stored
+struct no_aggregator {};
+
 } // namespace detail
 
 /*!
@@ -253,6 +256,48 @@ private:
     size_t m_overlap_cost_threshold;
 };
 
+/*!
+\brief R-tree creation algorithm parameters augmenting nodes with aggregates of subtrees.
+
+Each node stores the number of values stored in its subtree and optionally the value
+of a user-defined aggregate. The aggregates are maintained during insertion and removal
+and allow to count or aggregate the values meeting spatial predicates without visiting
+subtrees whose bounds are covered by the query region.
+
+The Aggregator must define the type of the aggregate as result_type and member functions:
+identity() returning the neutral element, value(Value const&) returning the aggregate
+of a single value and combine(result_type const&, result_type const&) returning
+the aggregate of two aggregates. The combining operation must be associative and commutative.
+
+\tparam Parameters     Parameters of the underlying creation algorithm, e.g. index::quadratic<16>.
+\tparam Aggregator     The aggregator of values. By default only the counts are stored.
+*/
+template <typename Parameters, typename Aggregator = detail::no_aggregator>
+class augmented
+    : public Parameters
+{
+public:
+    typedef Parameters underlying_parameters_type;
+    typedef Aggregator aggregator_type;
+
+    /*!
+    \brief The constructor.
+
+    \param parameters     Parameters of the underlying creation algorithm.
+    \param aggregator     The aggregator of values.
+    */
+    explicit augmented(Parameters const& parameters = Parameters(),
+                       Aggregator const& aggregator = Aggregator())
+        : Parameters(parameters)
+        , m_aggregator(aggregator)
+    {}
+
+    Aggregator const& aggregator() const { return m_aggregator; }
+
+private:
+    Aggregator m_aggregator;
+};
+
 }}} // namespace boost::geometry::index
 
 #endif // BOOST_GEOMETRY_INDEX_PARAMETERS_HPP
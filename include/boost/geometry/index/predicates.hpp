@@ -339,6 +339,44 @@ nearest(Geometry const& geometry, unsigned k)
     return detail::predicates::nearest<Geometry>(geometry, k);
 }
 
+/*!
+\brief Generate within_distance() predicate.
+
+Generate a predicate defining Value and Point relationship. With this
+predicate query returns indexed Values which distance to the passed Point
+is lesser than or equal to the passed distance. Value is returned by the query
+if <tt>bg::distance(Point, Indexable) <= distance</tt> returns <tt>true</tt>.
+
+In the cartesian coordinate system the squared distances are compared so
+square roots are never calculated, nodes farther than the distance are skipped
+and subtrees fully contained in the sphere are returned without checking the
+Values. In other coordinate systems the default distance strategies are used.
+
+If this predicate is passed together with \c nearest() predicate for the same
+Point the search is bounded by the distance, i.e. at most k nearest Values
+closer than the distance are returned.
+
+\par Example
+\verbatim
+bgi::query(spatial_index, bgi::within_distance(pt, 10.0), std::back_inserter(result));
+bgi::query(spatial_index, bgi::nearest(pt, 5) && bgi::within_distance(pt, 10.0), std::back_inserter(result));
+\endverbatim
+
+\ingroup predicates
+
+\tparam Point      The Point type.
+\tparam Distance   The type of the distance.
+
+\param pt          The Point from which distance is calculated.
+\param distance    The maximum distance.
+*/
+template <typename Point, typename Distance> inline
+detail::predicates::within_distance<Point, Distance>
+within_distance(Point const& pt, Distance const& distance)
+{
+    return detail::predicates::within_distance<Point, Distance>(pt, distance);
+}
+
 #ifdef BOOST_GEOMETRY_INDEX_DETAIL_EXPERIMENTAL
 
 /*!
@@ -19,11 +19,13 @@
 #include <boost/container/new_allocator.hpp>
 #include <boost/move/move.hpp>
 #include <boost/tuple/tuple.hpp>
+#include <boost/type_traits/is_void.hpp>
 
 // Boost.Geometry
 #include <boost/geometry/algorithms/detail/comparable_distance/interface.hpp>
 #include <boost/geometry/algorithms/detail/covered_by/interface.hpp>
 #include <boost/geometry/algorithms/detail/disjoint/interface.hpp>
+#include <boost/geometry/algorithms/detail/distance/interface.hpp>
 #include <boost/geometry/algorithms/detail/equals/interface.hpp>
 #include <boost/geometry/algorithms/detail/intersects/interface.hpp>
 #include <boost/geometry/algorithms/detail/overlaps/interface.hpp>
@@ -62,6 +64,7 @@
 #include <boost/geometry/index/detail/rtree/visitors/remove.hpp>
 #include <boost/geometry/index/detail/rtree/visitors/copy.hpp>
 #include <boost/geometry/index/detail/rtree/visitors/destroy.hpp>
+#include <boost/geometry/index/detail/rtree/visitors/move_values.hpp>
 #include <boost/geometry/index/detail/rtree/visitors/spatial_query.hpp>
 #include <boost/geometry/index/detail/rtree/visitors/distance_query.hpp>
 #include <boost/geometry/index/detail/rtree/visitors/count.hpp>
@@ -73,10 +76,19 @@
 //#include <boost/geometry/extensions/index/detail/rtree/kmeans/kmeans.hpp>
 
 #include <boost/geometry/index/detail/rtree/pack_create.hpp>
+#include <boost/geometry/index/detail/rtree/batch_query.hpp>
+#include <boost/geometry/index/detail/rtree/insert_batch.hpp>
+#include <boost/geometry/index/detail/rtree/remove_batch.hpp>
+#include <boost/geometry/index/detail/rtree/callback_output_iterator.hpp>
 
 #include <boost/geometry/index/inserter.hpp>
+#include <boost/geometry/index/packing.hpp>
+#include <boost/geometry/index/parallel.hpp>
 
 #include <boost/geometry/index/detail/rtree/utilities/view.hpp>
+#include <boost/geometry/index/detail/rtree/private_view.hpp>
+#include <boost/geometry/index/detail/rtree/spatial_join.hpp>
+#include <boost/geometry/index/detail/rtree/knn_join.hpp>
 
 #include <boost/geometry/index/detail/rtree/iterators.hpp>
 #include <boost/geometry/index/detail/rtree/query_iterators.hpp>
@@ -202,10 +214,8 @@ private:
     typedef detail::rtree::subtree_destroyer<value_type, options_type, translator_type, box_type, allocators_type> subtree_destroyer;
 
     friend class detail::rtree::utilities::view<rtree>;
-#ifdef BOOST_GEOMETRY_INDEX_DETAIL_EXPERIMENTAL
     friend class detail::rtree::private_view<rtree>;
     friend class detail::rtree::const_private_view<rtree>;
-#endif
 
 public:
 
@@ -234,6 +244,19 @@ public:
             value_type, allocators_type
         > const_query_iterator;
 
+    /*! \brief Type of the range returned by qrange() for Predicates, its iterators are of category ForwardIterator. */
+    template <typename Predicates>
+    struct query_range_type
+    {
+        typedef index::detail::rtree::iterators::query_range
+            <
+                typename index::detail::rtree::iterators::query_iterator_type
+                    <
+                        value_type, options_type, translator_type, box_type, allocators_type, Predicates
+                    >::type
+            > type;
+    };
+
 public:
 
     /*!
@@ -335,6 +358,166 @@ public:
         m_members.leafs_level = ll;
     }
 
+    /*!
+    \brief The constructor.
+
+    The tree is created using packing algorithm executed by many threads.
+    The resulting tree is the same as the one created by the sequential version.
+
+    \param first        The beginning of the range of Values.
+    \param last         The end of the range of Values.
+    \param par          The parallel execution policy defining the number of threads.
+    \param parameters   The parameters object.
+    \param getter       The function object extracting Indexable from Value.
+    \param equal        The function object comparing Values.
+    \param allocator    The allocator object.
+
+    \par Throws
+    \li If allocator copy constructor throws.
+    \li If Value copy constructor or copy assignment throws.
+    \li If allocation throws or returns invalid value.
+
+    \warning
+    The allocator is used by many threads at the same time.
+    */
+    template<typename Iterator>
+    inline rtree(Iterator first, Iterator last,
+                 index::parallel const& par,
+                 parameters_type const& parameters = parameters_type(),
+                 indexable_getter const& getter = indexable_getter(),
+                 value_equal const& equal = value_equal(),
+                 allocator_type const& allocator = allocator_type())
+        : m_members(getter, equal, parameters, allocator)
+    {
+        typedef detail::rtree::pack<value_type, options_type, translator_type, box_type, allocators_type> pack;
+        size_type vc = 0, ll = 0;
+        m_members.root = pack::apply(first, last, vc, ll,
+                                     m_members.parameters(), m_members.translator(), m_members.allocators(),
+                                     par.threads());
+        m_members.values_count = vc;
+        m_members.leafs_level = ll;
+    }
+
+    /*!
+    \brief The constructor.
+
+    The tree is created using packing algorithm executed by many threads.
+    The resulting tree is the same as the one created by the sequential version.
+
+    \param rng          The range of Values.
+    \param par          The parallel execution policy defining the number of threads.
+    \param parameters   The parameters object.
+    \param getter       The function object extracting Indexable from Value.
+    \param equal        The function object comparing Values.
+    \param allocator    The allocator object.
+
+    \par Throws
+    \li If allocator copy constructor throws.
+    \li If Value copy constructor or copy assignment throws.
+    \li If allocation throws or returns invalid value.
+
+    \warning
+    The allocator is used by many threads at the same time.
+    */
+    template<typename Range>
+    inline rtree(Range const& rng,
+                 index::parallel const& par,
+                 parameters_type const& parameters = parameters_type(),
+                 indexable_getter const& getter = indexable_getter(),
+                 value_equal const& equal = value_equal(),
+                 allocator_type const& allocator = allocator_type())
+        : m_members(getter, equal, parameters, allocator)
+    {
+        typedef detail::rtree::pack<value_type, options_type, translator_type, box_type, allocators_type> pack;
+        size_type vc = 0, ll = 0;
+        m_members.root = pack::apply(::boost::begin(rng), ::boost::end(rng), vc, ll,
+                                     m_members.parameters(), m_members.translator(), m_members.allocators(),
+                                     par.threads());
+        m_members.values_count = vc;
+        m_members.leafs_level = ll;
+    }
+
+    /*!
+    \brief The constructor.
+
+    The tree is created using the packing algorithm defined by the packing policy,
+    e.g. a space-filling curve sort, executed by at most the number of threads
+    defined by the packing policy.
+
+    \param first        The beginning of the range of Values.
+    \param last         The end of the range of Values.
+    \param pack         The packing policy.
+    \param parameters   The parameters object.
+    \param getter       The function object extracting Indexable from Value.
+    \param equal        The function object comparing Values.
+    \param allocator    The allocator object.
+
+    \par Throws
+    \li If allocator copy constructor throws.
+    \li If Value copy constructor or copy assignment throws.
+    \li If allocation throws or returns invalid value.
+
+    \warning
+    If more than one thread is used the allocator is used by many threads at the same time.
+    */
+    template<typename Iterator>
+    inline rtree(Iterator first, Iterator last,
+                 index::packing const& pack,
+                 parameters_type const& parameters = parameters_type(),
+                 indexable_getter const& getter = indexable_getter(),
+                 value_equal const& equal = value_equal(),
+                 allocator_type const& allocator = allocator_type())
+        : m_members(getter, equal, parameters, allocator)
+    {
+        typedef detail::rtree::pack<value_type, options_type, translator_type, box_type, allocators_type> pack_type;
+        size_type vc = 0, ll = 0;
+        m_members.root = pack_type::apply(first, last, vc, ll,
+                                          m_members.parameters(), m_members.translator(), m_members.allocators(),
+                                          pack);
+        m_members.values_count = vc;
+        m_members.leafs_level = ll;
+    }
+
+    /*!
+    \brief The constructor.
+
+    The tree is created using the packing algorithm defined by the packing policy,
+    e.g. a space-filling curve sort, executed by at most the number of threads
+    defined by the packing policy.
+
+    \param rng          The range of Values.
+    \param pack         The packing policy.
+    \param parameters   The parameters object.
+    \param getter       The function object extracting Indexable from Value.
+    \param equal        The function object comparing Values.
+    \param allocator    The allocator object.
+
+    \par Throws
+    \li If allocator copy constructor throws.
+    \li If Value copy constructor or copy assignment throws.
+    \li If allocation throws or returns invalid value.
+
+    \warning
+    If more than one thread is used the allocator is used by many threads at the same time.
+    */
+    template<typename Range>
+    inline rtree(Range const& rng,
+                 index::packing const& pack,
+                 parameters_type const& parameters = parameters_type(),
+                 indexable_getter const& getter = indexable_getter(),
+                 value_equal const& equal = value_equal(),
+                 allocator_type const& allocator = allocator_type())
+        : m_members(getter, equal, parameters, allocator)
+    {
+        typedef detail::rtree::pack<value_type, options_type, translator_type, box_type, allocators_type> pack_type;
+        size_type vc = 0, ll = 0;
+        m_members.root = pack_type::apply(::boost::begin(rng), ::boost::end(rng), vc, ll,
+                                          m_members.parameters(), m_members.translator(), m_members.allocators(),
+                                          pack);
+        m_members.values_count = vc;
+        m_members.leafs_level = ll;
+    }
+
     /*!
     \brief The destructor.
 
@@ -738,123 +921,585 @@ public:
     }
 
     /*!
-    \brief Finds values meeting passed predicates e.g. nearest to some Point and/or intersecting some Box.
-
-    This query function performs spatial and k-nearest neighbor searches. It allows to pass a set of predicates.
-    Values will be returned only if all predicates are met.
-
-    <b>Spatial predicates</b>
-    
-    Spatial predicates may be generated by one of the functions listed below:
-    \li \c boost::geometry::index::contains(),
-    \li \c boost::geometry::index::covered_by(),
-    \li \c boost::geometry::index::covers(),
-    \li \c boost::geometry::index::disjoint(),
-    \li \c boost::geometry::index::intersects(),
-    \li \c boost::geometry::index::overlaps(),
-    \li \c boost::geometry::index::within(),
-
-    It is possible to negate spatial predicates:
-    \li <tt>! boost::geometry::index::contains()</tt>,
-    \li <tt>! boost::geometry::index::covered_by()</tt>,
-    \li <tt>! boost::geometry::index::covers()</tt>,
-    \li <tt>! boost::geometry::index::disjoint()</tt>,
-    \li <tt>! boost::geometry::index::intersects()</tt>,
-    \li <tt>! boost::geometry::index::overlaps()</tt>,
-    \li <tt>! boost::geometry::index::within()</tt>
-
-    <b>Satisfies predicate</b>
-    
-    This is a special kind of predicate which allows to pass a user-defined function or function object which checks
-    if Value should be returned by the query. It's generated by:
-    \li \c boost::geometry::index::satisfies().
-
-    <b>Nearest predicate</b>
-
-    If the nearest predicate is passed a k-nearest neighbor search will be performed. This query will result
-    in returning k values to the output iterator. Only one nearest predicate may be passed to the query.
-    It may be generated by:
-    \li \c boost::geometry::index::nearest().
-        
-    <b>Connecting predicates</b>
+    \brief Insert a range of values to the index at once.
 
-    Predicates may be passed together connected with \c operator&&().
+    The values are sorted along the Hilbert curve and the tree is traversed once. Each node is
+    visited once for all values inserted into its subtree and the overflowing nodes are split
+    with the split algorithm of the rtree. The R*-tree forced reinsertions are not performed.
+    This is significantly faster than inserting the values one by one if the range is big.
+    If the rtree is empty it is created with the packing algorithm.
 
     \par Example
     \verbatim
-    // return elements intersecting box
-    tree.query(bgi::intersects(box), std::back_inserter(result));
-    // return elements intersecting poly but not within box
-    tree.query(bgi::intersects(poly) && !bgi::within(box), std::back_inserter(result));
-    // return elements overlapping box and meeting my_fun unary predicate
-    tree.query(bgi::overlaps(box) && bgi::satisfies(my_fun), std::back_inserter(result));
-    // return 5 elements nearest to pt and elements are intersecting box
-    tree.query(bgi::nearest(pt, 5) && bgi::intersects(box), std::back_inserter(result));
+    tree.batch_insert(values.begin(), values.end());
+    \endverbatim
 
-    // For each found value do_something (it is a type of function object)
-    tree.query(bgi::intersects(box),
-               boost::make_function_output_iterator(do_something()));
+    \param first    The beginning of the range of values.
+    \param last     The end of the range of values.
 
-    // For each value stored in the rtree do_something
-    // always_true is a type of function object always returning true
-    tree.query(bgi::satisfies(always_true()),
-               boost::make_function_output_iterator(do_something()));
+    \par Throws
+    \li If Value copy constructor or copy assignment throws.
+    \li If allocation throws or returns invalid value.
 
-    // C++11 (lambda expression)
-    tree.query(bgi::intersects(box),
-               boost::make_function_output_iterator([](value_type const& val){
-                   // do something
-               }));
+    \warning
+    This operation only guarantees that there will be no memory leaks.
+    After an exception is thrown the R-tree may be left in an inconsistent state,
+    elements must not be inserted or removed. Other operations are allowed however
+    some of them may return invalid data.
+    */
+    template <typename Iterator>
+    inline void batch_insert(Iterator first, Iterator last)
+    {
+        this->raw_batch_insert(first, last);
+    }
 
-    // C++14 (generic lambda expression)
-    tree.query(bgi::intersects(box),
-               boost::make_function_output_iterator([](auto const& val){
-                   // do something
-               }));
-    \endverbatim
+    /*!
+    \brief Insert a range of values to the index at once.
 
-    \par Throws
-    If Value copy constructor or copy assignment throws.
-    If predicates copy throws.
+    It works like batch_insert(Iterator, Iterator).
 
-    \warning
-    Only one \c nearest() predicate may be passed to the query. Passing more of them results in compile-time error.
+    \param rng      The range of values.
 
-    \param predicates   Predicates.
-    \param out_it       The output iterator, e.g. generated by std::back_inserter().
+    \par Throws
+    \li If Value copy constructor or copy assignment throws.
+    \li If allocation throws or returns invalid value.
 
-    \return             The number of values found.
+    \warning
+    This operation only guarantees that there will be no memory leaks.
+    After an exception is thrown the R-tree may be left in an inconsistent state,
+    elements must not be inserted or removed. Other operations are allowed however
+    some of them may return invalid data.
     */
-    template <typename Predicates, typename OutIter>
-    size_type query(Predicates const& predicates, OutIter out_it) const
+    template <typename Range>
+    inline void batch_insert(Range const& rng)
     {
-        if ( !m_members.root )
-            return 0;
-
-        static const unsigned distance_predicates_count = detail::predicates_count_distance<Predicates>::value;
-        static const bool is_distance_predicate = 0 < distance_predicates_count;
-        BOOST_MPL_ASSERT_MSG((distance_predicates_count <= 1), PASS_ONLY_ONE_DISTANCE_PREDICATE, (Predicates));
+        BOOST_MPL_ASSERT_MSG((detail::is_range<Range>::value),
+                             PASSED_OBJECT_IS_NOT_A_RANGE,
+                             (Range));
 
-        return query_dispatch(predicates, out_it, boost::mpl::bool_<is_distance_predicate>());
+        this->raw_batch_insert(boost::const_begin(rng), boost::const_end(rng));
     }
 
     /*!
-    \brief Returns a query iterator pointing at the begin of the query range.
+    \brief Remove a range of values from the container at once.
 
-    This method returns an iterator which may be used to perform iterative queries.
-    For the information about predicates which may be passed to this method see query().
+    The tree is traversed once. Each node is visited once for all values which may be stored
+    in its subtree. The underflowed nodes are removed and their elements are reinserted after
+    all values are removed. Like remove(Iterator, Iterator) this method removes only one value
+    for each one passed in the range, not all equal values.
 
-    \par Example
-    \verbatim    
-    for ( Rtree::const_query_iterator it = tree.qbegin(bgi::nearest(pt, 10000)) ;
-          it != tree.qend() ; ++it )
-    {
-        // do something with value
-        if ( has_enough_nearest_values() )
-            break;
-    }
+    \param first    The beginning of the range of values.
+    \param last     The end of the range of values.
 
-    // C++11 (auto)
+    \return         The number of removed values.
+
+    \par Throws
+    \li If Value copy constructor or copy assignment throws.
+    \li If allocation throws or returns invalid value.
+
+    \warning
+    This operation only guarantees that there will be no memory leaks.
+    After an exception is thrown the R-tree may be left in an inconsistent state,
+    elements must not be inserted or removed. Other operations are allowed however
+    some of them may return invalid data.
+    */
+    template <typename Iterator>
+    inline size_type batch_remove(Iterator first, Iterator last)
+    {
+        return this->raw_batch_remove(first, last);
+    }
+
+    /*!
+    \brief Remove a range of values from the container at once.
+
+    It works like batch_remove(Iterator, Iterator).
+
+    \param rng      The range of values.
+
+    \return         The number of removed values.
+
+    \par Throws
+    \li If Value copy constructor or copy assignment throws.
+    \li If allocation throws or returns invalid value.
+
+    \warning
+    This operation only guarantees that there will be no memory leaks.
+    After an exception is thrown the R-tree may be left in an inconsistent state,
+    elements must not be inserted or removed. Other operations are allowed however
+    some of them may return invalid data.
+    */
+    template <typename Range>
+    inline size_type batch_remove(Range const& rng)
+    {
+        BOOST_MPL_ASSERT_MSG((detail::is_range<Range>::value),
+                             PASSED_OBJECT_IS_NOT_A_RANGE,
+                             (Range));
+
+        return this->raw_batch_remove(boost::const_begin(rng), boost::const_end(rng));
+    }
+
+    /*!
+    \brief Remove all values meeting the predicate.
+
+    The tree is traversed once and all nodes are visited. The values for which the predicate
+    returns true are removed from the leafs. After the children of a node are processed their
+    boxes are recalculated and the underflowed nodes are removed. Their elements are reinserted
+    after all values are removed. This is faster than removing the values one by one or
+    creating the tree again if a part of the values is removed.
+
+    \par Example
+    \verbatim
+    // remove the values older than the given time
+    std::size_t count = tree.remove_if(older_than(t));
+    \endverbatim
+
+    \param pred     The unary predicate called for each value.
+
+    \return         The number of removed values.
+
+    \par Throws
+    \li If Value copy constructor or copy assignment throws.
+    \li If the predicate throws.
+    \li If allocation throws or returns invalid value.
+
+    \warning
+    This operation only guarantees that there will be no memory leaks.
+    After an exception is thrown the R-tree may be left in an inconsistent state,
+    elements must not be inserted or removed. Other operations are allowed however
+    some of them may return invalid data.
+    */
+    template <typename UnaryPredicate>
+    inline size_type remove_if(UnaryPredicate const& pred)
+    {
+        return this->raw_remove_if(pred, 1);
+    }
+
+    /*!
+    \brief Remove all values meeting the predicate using multiple threads.
+
+    It works like remove_if(UnaryPredicate) but the subtrees of the children of the root
+    are divided into chunks and each chunk is processed in a separate thread. The result
+    is the same as the result of the sequential version.
+
+    \par Example
+    \verbatim
+    std::size_t count = tree.remove_if(older_than(t), bgi::parallel(4));
+    \endverbatim
+
+    \param pred     The unary predicate called for each value.
+    \param par      The parallel execution policy defining the maximum number of threads.
+
+    \return         The number of removed values.
+
+    \par Throws
+    \li If Value copy constructor or copy assignment throws.
+    \li If the predicate throws.
+    \li If allocation throws or returns invalid value.
+
+    \warning
+    This operation only guarantees that there will be no memory leaks.
+    After an exception is thrown the R-tree may be left in an inconsistent state,
+    elements must not be inserted or removed. Other operations are allowed however
+    some of them may return invalid data.
+    The predicate is called by many threads at the same time.
+    */
+    template <typename UnaryPredicate>
+    inline size_type remove_if(UnaryPredicate const& pred, index::parallel const& par)
+    {
+        return this->raw_remove_if(pred, par.threads());
+    }
+
+    /*!
+    \brief Rebuilds the R-tree with the packing algorithm.
+
+    After many insertions and removals the nodes of the R-tree may overlap more
+    and cover more dead space than the nodes of the R-tree created with the packing
+    algorithm which results in slower queries. This function moves the values out of
+    the R-tree and creates it again with the packing algorithm. The values are moved,
+    not copied, and each node is destroyed right after its values are moved out so
+    its memory may be reused by the allocator for the new nodes. The overlap of the
+    nodes may be checked with \c bgi::detail::rtree::utilities::overlap_ratio().
+
+    \par Example
+    \verbatim
+    if ( 0.2 < bgi::detail::rtree::utilities::overlap_ratio(tree) )
+        tree.repack();
+    \endverbatim
+
+    \param packing  The packing policy defining the algorithm and the maximum number of threads.
+
+    \par Throws
+    \li If Value move constructor throws.
+    \li If allocation throws or returns invalid value.
+
+    \warning
+    If an exception is thrown the R-tree is left empty.
+    If more than one thread is used the allocator is used by many threads at the same time.
+    */
+    inline void repack(index::packing const& packing = index::packing())
+    {
+        if ( !m_members.root )
+            return;
+
+        std::vector<value_type> values;
+        values.reserve(m_members.values_count);                                             // MAY THROW (A)
+
+        BOOST_TRY
+        {
+            detail::rtree::visitors::move_values
+                <
+                    value_type, options_type, translator_type, box_type, allocators_type,
+                    std::vector<value_type>
+                > move_v(m_members.root, values, m_members.allocators());
+            detail::rtree::apply_visitor(move_v, *m_members.root);                          // MAY THROW (V: move)
+        }
+        BOOST_CATCH(...)
+        {
+            this->raw_destroy(*this);
+            BOOST_RETHROW                                                                   // RETHROW
+        }
+        BOOST_CATCH_END
+
+        m_members.root = 0;
+        m_members.values_count = 0;
+        m_members.leafs_level = 0;
+
+        typedef detail::rtree::pack<value_type, options_type, translator_type, box_type, allocators_type> pack;
+        size_type vc = 0, ll = 0;
+        m_members.root = pack::apply(boost::make_move_iterator(values.begin()),
+                                     boost::make_move_iterator(values.end()), vc, ll,
+                                     m_members.parameters(), m_members.translator(), m_members.allocators(),
+                                     packing);                                              // MAY THROW (V: move, N: alloc)
+        m_members.values_count = vc;
+        m_members.leafs_level = ll;
+    }
+
+    /*!
+    \brief Finds values meeting passed predicates e.g. nearest to some Point and/or intersecting some Box.
+
+    This query function performs spatial and k-nearest neighbor searches. It allows to pass a set of predicates.
+    Values will be returned only if all predicates are met.
+
+    <b>Spatial predicates</b>
+    
+    Spatial predicates may be generated by one of the functions listed below:
+    \li \c boost::geometry::index::contains(),
+    \li \c boost::geometry::index::covered_by(),
+    \li \c boost::geometry::index::covers(),
+    \li \c boost::geometry::index::disjoint(),
+    \li \c boost::geometry::index::intersects(),
+    \li \c boost::geometry::index::overlaps(),
+    \li \c boost::geometry::index::within(),
+
+    It is possible to negate spatial predicates:
+    \li <tt>! boost::geometry::index::contains()</tt>,
+    \li <tt>! boost::geometry::index::covered_by()</tt>,
+    \li <tt>! boost::geometry::index::covers()</tt>,
+    \li <tt>! boost::geometry::index::disjoint()</tt>,
+    \li <tt>! boost::geometry::index::intersects()</tt>,
+    \li <tt>! boost::geometry::index::overlaps()</tt>,
+    \li <tt>! boost::geometry::index::within()</tt>
+
+    <b>Satisfies predicate</b>
+    
+    This is a special kind of predicate which allows to pass a user-defined function or function object which checks
+    if Value should be returned by the query. It's generated by:
+    \li \c boost::geometry::index::satisfies().
+
+    <b>Nearest predicate</b>
+
+    If the nearest predicate is passed a k-nearest neighbor search will be performed. This query will result
+    in returning k values to the output iterator. Only one nearest predicate may be passed to the query.
+    It may be generated by:
+    \li \c boost::geometry::index::nearest().
+        
+    <b>Connecting predicates</b>
+
+    Predicates may be passed together connected with \c operator&&().
+
+    \par Example
+    \verbatim
+    // return elements intersecting box
+    tree.query(bgi::intersects(box), std::back_inserter(result));
+    // return elements intersecting poly but not within box
+    tree.query(bgi::intersects(poly) && !bgi::within(box), std::back_inserter(result));
+    // return elements overlapping box and meeting my_fun unary predicate
+    tree.query(bgi::overlaps(box) && bgi::satisfies(my_fun), std::back_inserter(result));
+    // return 5 elements nearest to pt and elements are intersecting box
+    tree.query(bgi::nearest(pt, 5) && bgi::intersects(box), std::back_inserter(result));
+
+    // For each found value do_something (it is a type of function object)
+    tree.query(bgi::intersects(box),
+               boost::make_function_output_iterator(do_something()));
+
+    // For each value stored in the rtree do_something
+    // always_true is a type of function object always returning true
+    tree.query(bgi::satisfies(always_true()),
+               boost::make_function_output_iterator(do_something()));
+
+    // C++11 (lambda expression)
+    tree.query(bgi::intersects(box),
+               boost::make_function_output_iterator([](value_type const& val){
+                   // do something
+               }));
+
+    // C++14 (generic lambda expression)
+    tree.query(bgi::intersects(box),
+               boost::make_function_output_iterator([](auto const& val){
+                   // do something
+               }));
+    \endverbatim
+
+    \par Throws
+    If Value copy constructor or copy assignment throws.
+    If predicates copy throws.
+
+    \warning
+    Only one \c nearest() predicate may be passed to the query. Passing more of them results in compile-time error.
+
+    \param predicates   Predicates.
+    \param out_it       The output iterator, e.g. generated by std::back_inserter().
+
+    \return             The number of values found.
+    */
+    template <typename Predicates, typename OutIter>
+    size_type query(Predicates const& predicates, OutIter out_it) const
+    {
+        if ( !m_members.root )
+            return 0;
+
+        static const unsigned distance_predicates_count = detail::predicates_count_distance<Predicates>::value;
+        static const bool is_distance_predicate = 0 < distance_predicates_count;
+        BOOST_MPL_ASSERT_MSG((distance_predicates_count <= 1), PASS_ONLY_ONE_DISTANCE_PREDICATE, (Predicates));
+
+        return query_dispatch(predicates, out_it, boost::mpl::bool_<is_distance_predicate>());
+    }
+
+    /*!
+    \brief Finds values meeting passed predicates and passes them to the function object until it returns false.
+
+    This query function accepts the same predicates as query(). Instead of writing the values to
+    the output iterator it calls the function object for each value found and stops the query
+    as soon as the function object returns false. The values are passed in the same order
+    as they would be returned by query(). The function object is called with a const reference
+    to the value stored in the rtree, so nothing is copied. Spatial queries don't allocate memory.
+
+    This function may be used e.g. to check if any value meets predicates or to process only
+    the first N values found without storing them.
+
+    \par Example
+    \verbatim
+    // check if any value intersects box
+    struct found { bool operator()(Value const&) const { return false; } };
+    bool any = 0 < tree.query_each(bgi::intersects(box), found());
+    // C++11, process at most 100 values
+    std::size_t n = 0;
+    tree.query_each(bgi::intersects(box), [&](Value const& v){ process(v); return ++n < 100; });
+    \endverbatim
+
+    \par Throws
+    If predicates copy throws.
+    If the function object throws.
+    Distance queries: if Value copy constructor or copy assignment throws.
+
+    \param predicates   Predicates.
+    \param function     The function object taking Value const& and returning bool, false if the query should be stopped.
+
+    \return             The number of values passed to the function object.
+    */
+    template <typename Predicates, typename Function>
+    size_type query_each(Predicates const& predicates, Function function) const
+    {
+        if ( !m_members.root )
+            return 0;
+
+        static const unsigned distance_predicates_count = detail::predicates_count_distance<Predicates>::value;
+        static const bool is_distance_predicate = 0 < distance_predicates_count;
+        BOOST_MPL_ASSERT_MSG((distance_predicates_count <= 1), PASS_ONLY_ONE_DISTANCE_PREDICATE, (Predicates));
+
+        return query_each_dispatch(predicates, function, boost::mpl::bool_<is_distance_predicate>());
+    }
+
+    /*!
+    \brief Counts values meeting passed spatial predicates.
+
+    This query function accepts the same spatial predicates as query(), distance predicates are not
+    allowed. It returns the same number of values as query() but the values aren't copied.
+    If the rtree is created with index::augmented parameters the subtrees which bounds are covered
+    by the region defined by the predicates aren't traversed, the counts stored in nodes are used instead.
+    In this case the complexity depends on the boundary of the region rather than on the number of values
+    found. The subtrees are counted this way for predicates index::intersects(), index::covered_by()
+    and negated index::disjoint() if Geometry is a Box, and for index::disjoint() and negated
+    index::intersects() for any Geometry. If more predicates are passed all of them must be met.
+
+    \par Example
+    \verbatim
+    typedef bgi::rtree<Value, bgi::augmented< bgi::quadratic<16> > > rtree_t;
+    std::size_t n = tree.query_count(bgi::intersects(box));
+    \endverbatim
+
+    \par Throws
+    If predicates copy throws.
+
+    \param predicates   Spatial predicates.
+
+    \return             The number of values meeting predicates.
+    */
+    template <typename Predicates>
+    size_type query_count(Predicates const& predicates) const
+    {
+        BOOST_MPL_ASSERT_MSG((detail::predicates_count_distance<Predicates>::value == 0),
+                             DISTANCE_PREDICATES_NOT_SUPPORTED, (Predicates));
+
+        if ( !m_members.root )
+            return 0;
+
+        return static_cast<size_type>(query_aggregate_dispatch(predicates).aggregate_count);
+    }
+
+    /*!
+    \brief Calculates the aggregate of values meeting passed spatial predicates.
+
+    This query function is available only if the rtree is created with index::augmented parameters
+    with an Aggregator defined. It returns the aggregate of values found calculated with the Aggregator,
+    e.g. a sum of weights of values. The values are found the same way as in query_count(),
+    the aggregates stored in nodes are used for subtrees covered by the region defined by the predicates.
+    If no value is found Aggregator::identity() is returned.
+
+    \par Example
+    \verbatim
+    struct weight_sum
+    {
+        typedef double result_type;
+        double identity() const { return 0; }
+        double value(Value const& v) const { return v.second; }
+        double combine(double l, double r) const { return l + r; }
+    };
+    typedef bgi::rtree<Value, bgi::augmented<bgi::quadratic<16>, weight_sum> > rtree_t;
+    double w = tree.query_aggregate(bgi::intersects(box));
+    \endverbatim
+
+    \par Throws
+    If predicates copy throws.
+    If the Aggregator throws.
+
+    \param predicates   Spatial predicates.
+
+    \return             The aggregate of values meeting predicates.
+    */
+    template <typename Predicates>
+    typename detail::rtree::parameters_aggregator<parameters_type>::result_type
+    query_aggregate(Predicates const& predicates) const
+    {
+        typedef detail::rtree::parameters_aggregator<parameters_type> aggregator_traits;
+        BOOST_MPL_ASSERT_MSG((! boost::is_void<typename aggregator_traits::result_type>::value),
+                             AGGREGATOR_NOT_DEFINED_IN_PARAMETERS, (parameters_type));
+        BOOST_MPL_ASSERT_MSG((detail::predicates_count_distance<Predicates>::value == 0),
+                             DISTANCE_PREDICATES_NOT_SUPPORTED, (Predicates));
+
+        if ( !m_members.root )
+            return aggregator_traits::get(m_members.parameters()).identity();
+
+        return query_aggregate_dispatch(predicates).aggregate_value;
+    }
+
+    /*!
+    \brief Finds values meeting each of passed sets of predicates.
+
+    This function performs a number of queries, one for each element of the range of predicates,
+    in one call. All queries must use predicates of the same type. The results of all queries
+    are stored in one flat output range. The results of i-th query are the same and are stored
+    in the same order as if the query was performed by query(). For each query the offset of its
+    results in the output range is stored by the offsets output iterator. The last offset is
+    equal to the total number of values found, so for N queries N+1 offsets are stored and
+    the results of i-th query are in the range [offsets[i], offsets[i+1]).
+
+    Spatial queries are performed during one traversal of the tree, the node meeting the
+    predicates of many queries is visited once. k-nearest neighbor queries are performed
+    one by one.
+
+    \par Example
+    \verbatim
+    // predicates is a random access range of objects returned e.g. by bgi::intersects(box)
+    std::vector<Value> result;
+    std::vector<std::size_t> offsets;
+    tree.batch_query(predicates, std::back_inserter(result), std::back_inserter(offsets));
+    // values found by i-th query
+    for ( std::size_t j = offsets[i] ; j < offsets[i + 1] ; ++j )
+        do_something(result[j]);
+    \endverbatim
+
+    \par Throws
+    If Value copy constructor or copy assignment throws.
+    If predicates copy throws.
+    If allocation throws.
+
+    \warning
+    Only one \c nearest() predicate may be passed to each query. Passing more of them results in compile-time error.
+
+    \param predicates   The random access range of Predicates.
+    \param out_it       The output iterator of values, e.g. generated by std::back_inserter().
+    \param offsets_it   The output iterator of offsets, e.g. generated by std::back_inserter().
+
+    \return             The number of values found by all queries.
+    */
+    template <typename PredicatesRange, typename OutIter, typename OffsetsOutIter>
+    size_type batch_query(PredicatesRange const& predicates, OutIter out_it, OffsetsOutIter offsets_it) const
+    {
+        return batch_query_dispatch(predicates, out_it, offsets_it, 1);
+    }
+
+    /*!
+    \brief Finds values meeting each of passed sets of predicates using multiple threads.
+
+    This function works like batch_query() but the range of predicates is divided into chunks
+    and the queries from each chunk are performed in a separate thread. The results
+    are the same as the results of the sequential version.
+
+    \par Example
+    \verbatim
+    tree.batch_query(predicates, std::back_inserter(result), std::back_inserter(offsets), bgi::parallel(4));
+    \endverbatim
+
+    \par Throws
+    If Value copy constructor or copy assignment throws.
+    If predicates copy throws.
+    If allocation throws.
+
+    \warning
+    The rtree must not be modified during the query.
+
+    \param predicates   The random access range of Predicates.
+    \param out_it       The output iterator of values, e.g. generated by std::back_inserter().
+    \param offsets_it   The output iterator of offsets, e.g. generated by std::back_inserter().
+    \param par          The parallel execution policy.
+
+    \return             The number of values found by all queries.
+    */
+    template <typename PredicatesRange, typename OutIter, typename OffsetsOutIter>
+    size_type batch_query(PredicatesRange const& predicates, OutIter out_it, OffsetsOutIter offsets_it,
+                          index::parallel const& par) const
+    {
+        return batch_query_dispatch(predicates, out_it, offsets_it, par.threads());
+    }
+
+    /*!
+    \brief Returns a query iterator pointing at the begin of the query range.
+
+    This method returns an iterator which may be used to perform iterative queries.
+    For the information about predicates which may be passed to this method see query().
+
+    \par Example
+    \verbatim    
+    for ( Rtree::const_query_iterator it = tree.qbegin(bgi::nearest(pt, 10000)) ;
+          it != tree.qend() ; ++it )
+    {
+        // do something with value
+        if ( has_enough_nearest_values() )
+            break;
+    }
+
+    // C++11 (auto)
     for ( auto it = tree.qbegin(bgi::nearest(pt, 3)) ; it != tree.qend() ; ++it )
     {
         // do something with value
@@ -929,6 +1574,65 @@ public:
         return const_query_iterator();
     }
 
+    /*!
+    \brief Returns the range of Values meeting the predicates.
+
+    This method returns the range which may be used to perform iterative queries, the same
+    as the range defined by qbegin() and qend(). For the information about predicates which
+    may be passed to this method see query().
+
+    Contrary to const_query_iterator the iterators of the returned range are not type-erased
+    so neither virtual functions are called nor the iterators are allocated on the heap.
+    The memory needed by the traversal is reserved when the range is created, so the
+    iteration over the range doesn't allocate memory. In case of spatial queries the stack
+    of the traversed nodes is stored in the iterator and no memory is allocated for trees
+    storing less than 2^32 Values with compile-time parameters.
+
+    Both iterators of the range are of the same type so the range may be passed to algorithms
+    requiring it, e.g. std::copy() or Boost.Range algorithms. The type of the range is
+    query_range_type<Predicates>::type. Note that copying the iterators of k-nearest neighbours
+    queries copies the found neighbours, so the prefix increment should be used.
+
+    \par Example
+    \verbatim
+    // C++11 (range-based for loop)
+    for ( Value const& v : tree.qrange(bgi::intersects(box)) )
+    {
+        // do something with value
+    }
+
+    // C++11 (auto)
+    auto range = tree.qrange(bgi::nearest(pt, 10000));
+    for ( auto it = range.begin() ; it != range.end() ; ++it )
+    {
+        // do something with value
+        if ( has_enough_nearest_values() )
+            break;
+    }
+    \endverbatim
+
+    \par Iterator category
+    ForwardIterator
+
+    \par Throws
+    If predicates copy throws.
+    If allocation throws.
+
+    \warning
+    The modification of the rtree may invalidate the range and the iterators.
+
+    \param predicates   Predicates.
+
+    \return             The range of Values meeting the predicates.
+    */
+    template <typename Predicates>
+    typename query_range_type<Predicates>::type
+    qrange(Predicates const& predicates) const
+    {
+        typedef typename query_range_type<Predicates>::type range_type;
+        return range_type(qbegin_(predicates), qend_(predicates));
+    }
+
 #ifndef BOOST_GEOMETRY_INDEX_DETAIL_EXPERIMENTAL
 private:
 #endif
@@ -1011,7 +1715,9 @@ private:
         if ( !m_members.root )
             return iterator_type(m_members.translator(), predicates);
 
-        return iterator_type(m_members.root, m_members.translator(), predicates);
+        return iterator_type(m_members.root, m_members.leafs_level,
+                             m_members.parameters().get_max_elements(), m_members.values_count,
+                             m_members.translator(), predicates);
     }
 
     /*!
@@ -1454,6 +2160,10 @@ private:
 
         detail::rtree::apply_visitor(insert_v, *m_members.root);
 
+        // the nodes below the root are updated by the visitor
+        detail::rtree::update_aggregate<value_type, options_type, box_type, allocators_type>
+            ::apply(*m_members.root, m_members.parameters());
+
 // TODO
 // Think about this: If exception is thrown, may the root be removed?
 // Or it is just cleared?
@@ -1483,6 +2193,13 @@ private:
 
         detail::rtree::apply_visitor(remove_v, *m_members.root);
 
+        // the nodes below the root are updated by the visitor
+        if ( remove_v.is_value_removed() && m_members.root )
+        {
+            detail::rtree::update_aggregate<value_type, options_type, box_type, allocators_type>
+                ::apply(*m_members.root, m_members.parameters());
+        }
+
         // If exception is thrown, m_values_count may be invalid
 
         if ( remove_v.is_value_removed() )
@@ -1497,6 +2214,99 @@ private:
         return 0;
     }
 
+    /*!
+    \brief Insert a range of values to the index at once.
+
+    \par Exception-safety
+    basic
+    */
+    template <typename Iterator>
+    inline void raw_batch_insert(Iterator first, Iterator last)
+    {
+        // the empty tree is packed
+        if ( !m_members.root || 0 == m_members.values_count )
+        {
+            typedef detail::rtree::pack<value_type, options_type, translator_type, box_type, allocators_type> pack;
+            size_type vc = 0, ll = 0;
+            node_pointer new_root = pack::apply(first, last, vc, ll,
+                                                m_members.parameters(), m_members.translator(), m_members.allocators());
+            if ( !new_root )
+                return;
+
+            this->raw_destroy(*this);
+            m_members.root = new_root;
+            m_members.values_count = vc;
+            m_members.leafs_level = ll;
+            return;
+        }
+
+        detail::rtree::insert_batch<
+            value_type, options_type, translator_type, box_type, allocators_type
+        >::apply(m_members.root, m_members.leafs_level, first, last,
+                 m_members.parameters(), m_members.translator(), m_members.allocators());
+
+        // If exception is thrown, m_values_count may be invalid
+        m_members.values_count += static_cast<size_type>(std::distance(first, last));
+    }
+
+    /*!
+    \brief Remove a range of values from the container at once.
+
+    \par Exception-safety
+    basic
+    */
+    template <typename Iterator>
+    inline size_type raw_batch_remove(Iterator first, Iterator last)
+    {
+        if ( !m_members.root )
+            return 0;
+
+        // the values of the removed leafs
+        std::vector<value_type> orphaned_values;
+
+        size_type const result = detail::rtree::remove_batch<
+            value_type, options_type, translator_type, box_type, allocators_type
+        >::apply(m_members.root, m_members.leafs_level, first, last, orphaned_values,
+                 m_members.parameters(), m_members.translator(), m_members.allocators());
+
+        // If exception is thrown, m_values_count may be invalid
+        BOOST_GEOMETRY_INDEX_ASSERT(result + orphaned_values.size() <= m_members.values_count, "unexpected state");
+        m_members.values_count -= result + orphaned_values.size();
+
+        this->raw_batch_insert(orphaned_values.begin(), orphaned_values.end());
+
+        return result;
+    }
+
+    /*!
+    \brief Remove all values meeting the predicate.
+
+    \par Exception-safety
+    basic
+    */
+    template <typename UnaryPredicate>
+    inline size_type raw_remove_if(UnaryPredicate const& pred, std::size_t threads)
+    {
+        if ( !m_members.root )
+            return 0;
+
+        // the values of the removed leafs
+        std::vector<value_type> orphaned_values;
+
+        size_type const result = detail::rtree::remove_batch<
+            value_type, options_type, translator_type, box_type, allocators_type
+        >::apply_if(m_members.root, m_members.leafs_level, pred, threads, orphaned_values,
+                    m_members.parameters(), m_members.translator(), m_members.allocators());
+
+        // If exception is thrown, m_values_count may be invalid
+        BOOST_GEOMETRY_INDEX_ASSERT(result + orphaned_values.size() <= m_members.values_count, "unexpected state");
+        m_members.values_count -= result + orphaned_values.size();
+
+        this->raw_batch_insert(orphaned_values.begin(), orphaned_values.end());
+
+        return result;
+    }
+
     /*!
     \brief Create an empty R-tree i.e. new empty root node and clear other attributes.
 
@@ -1657,42 +2467,118 @@ private:
     template <typename Predicates, typename OutIter>
     size_type query_dispatch(Predicates const& predicates, OutIter out_it, boost::mpl::bool_<false> const& /*is_distance_predicate*/) const
     {
-        detail::rtree::visitors::spatial_query<value_type, options_type, translator_type, box_type, allocators_type, Predicates, OutIter>
-            find_v(m_members.translator(), predicates, out_it);
+        detail::rtree::visitors::spatial_query<value_type, options_type, translator_type, box_type, allocators_type, Predicates, OutIter>
+            find_v(m_members.translator(), predicates, out_it);
+
+        detail::rtree::apply_visitor(find_v, *m_members.root);
+
+        return find_v.found_count;
+    }
+
+    /*!
+    \brief Perform nearest neighbour search.
+
+    \par Exception-safety
+    strong
+    */
+    template <typename Predicates, typename OutIter>
+    size_type query_dispatch(Predicates const& predicates, OutIter out_it, boost::mpl::bool_<true> const& /*is_distance_predicate*/) const
+    {
+        BOOST_GEOMETRY_INDEX_ASSERT(m_members.root, "The root must exist");
+
+        static const unsigned distance_predicate_index = detail::predicates_find_distance<Predicates>::value;
+        typename detail::rtree::visitors::distance_query_visitor<
+            value_type,
+            options_type,
+            translator_type,
+            box_type,
+            allocators_type,
+            Predicates,
+            distance_predicate_index,
+            OutIter
+        >::type distance_v(m_members.parameters(), m_members.translator(), predicates, out_it);
+
+        detail::rtree::apply_visitor(distance_v, *m_members.root);
+
+        return distance_v.finish();
+    }
+
+    /*!
+    \brief Pass values meeting predicates to the function object.
+
+    \par Exception-safety
+    strong
+    */
+    template <typename Predicates, typename Function>
+    size_type query_each_dispatch(Predicates const& predicates, Function & function, boost::mpl::bool_<false> const& /*is_distance_predicate*/) const
+    {
+        detail::rtree::visitors::spatial_query_callback<value_type, options_type, translator_type, box_type, allocators_type, Predicates, Function>
+            find_v(m_members.translator(), predicates, function);
+
+        detail::rtree::apply_visitor(find_v, *m_members.root);
+
+        return find_v.found_count;
+    }
+
+    /*!
+    \brief Pass nearest values to the function object.
+
+    \par Exception-safety
+    strong
+    */
+    template <typename Predicates, typename Function>
+    size_type query_each_dispatch(Predicates const& predicates, Function & function, boost::mpl::bool_<true> const& is_distance_predicate) const
+    {
+        typedef detail::rtree::callback_output_iterator<Function> callback_iterator;
+        typename callback_iterator::state state(function);
+
+        query_dispatch(predicates, callback_iterator(state), is_distance_predicate);
+
+        return static_cast<size_type>(state.count);
+    }
+
+    /*!
+    \brief Count and aggregate values meeting predicates.
+
+    \par Exception-safety
+    strong
+    */
+    template <typename Predicates>
+    typename detail::rtree::visitors::spatial_query_aggregate
+        <
+            value_type, options_type, translator_type, box_type, allocators_type, Predicates
+        >::aggregate_type
+    query_aggregate_dispatch(Predicates const& predicates) const
+    {
+        detail::rtree::visitors::spatial_query_aggregate<value_type, options_type, translator_type, box_type, allocators_type, Predicates>
+            find_v(m_members.translator(), m_members.parameters(), predicates);
 
         detail::rtree::apply_visitor(find_v, *m_members.root);
 
-        return find_v.found_count;
+        return find_v.result;
     }
 
     /*!
-    \brief Perform nearest neighbour search.
+    \brief Return values meeting each of the sets of predicates.
 
     \par Exception-safety
     strong
     */
-    template <typename Predicates, typename OutIter>
-    size_type query_dispatch(Predicates const& predicates, OutIter out_it, boost::mpl::bool_<true> const& /*is_distance_predicate*/) const
+    template <typename PredicatesRange, typename OutIter, typename OffsetsOutIter>
+    size_type batch_query_dispatch(PredicatesRange const& predicates, OutIter out_it, OffsetsOutIter offsets_it,
+                                   std::size_t threads) const
     {
-        BOOST_GEOMETRY_INDEX_ASSERT(m_members.root, "The root must exist");
-
-        static const unsigned distance_predicate_index = detail::predicates_find_distance<Predicates>::value;
-        detail::rtree::visitors::distance_query<
-            value_type,
-            options_type,
-            translator_type,
-            box_type,
-            allocators_type,
-            Predicates,
-            distance_predicate_index,
-            OutIter
-        > distance_v(m_members.parameters(), m_members.translator(), predicates, out_it);
-
-        detail::rtree::apply_visitor(distance_v, *m_members.root);
+        typedef typename boost::range_const_iterator<PredicatesRange>::type predicates_iterator;
 
-        return distance_v.finish();
+        return detail::rtree::batch_query
+            <
+                value_type, options_type, translator_type, box_type, allocators_type, predicates_iterator
+            >::apply(m_members.root, m_members.parameters(), m_members.translator(),
+                     ::boost::const_begin(predicates),
+                     static_cast<size_type>(::boost::size(predicates)),
+                     out_it, offsets_it, threads);
     }
-    
+
     /*!
     \brief Count elements corresponding to value or indexable.
 
@@ -1986,6 +2872,404 @@ query(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> const& tree,
     return tree.query(predicates, out_it);
 }
 
+/*!
+\brief Finds values meeting each of passed sets of predicates.
+
+This function performs a number of queries, one for each element of the range of predicates,
+in one call. The results of all queries are stored in one flat output range and for each query
+the offset of its results is stored by the offsets output iterator. For N queries N+1 offsets
+are stored, the results of i-th query are in the range [offsets[i], offsets[i+1]).
+For more information see rtree::batch_query().
+
+\par Example
+\verbatim
+bgi::batch_query(tree, predicates, std::back_inserter(result), std::back_inserter(offsets));
+\endverbatim
+
+\par Throws
+If Value copy constructor or copy assignment throws.
+If allocation throws.
+
+\ingroup rtree_functions
+
+\param tree         The rtree.
+\param predicates   The random access range of Predicates.
+\param out_it       The output iterator of values, e.g. generated by std::back_inserter().
+\param offsets_it   The output iterator of offsets, e.g. generated by std::back_inserter().
+
+\return             The number of values found by all queries.
+*/
+template <typename Value, typename Parameters, typename IndexableGetter, typename EqualTo, typename Allocator,
+          typename PredicatesRange, typename OutIter, typename OffsetsOutIter> inline
+typename rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator>::size_type
+batch_query(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> const& tree,
+            PredicatesRange const& predicates,
+            OutIter out_it,
+            OffsetsOutIter offsets_it)
+{
+    return tree.batch_query(predicates, out_it, offsets_it);
+}
+
+/*!
+\brief Finds values meeting each of passed sets of predicates using multiple threads.
+
+For more information see rtree::batch_query().
+
+\par Example
+\verbatim
+bgi::batch_query(tree, predicates, std::back_inserter(result), std::back_inserter(offsets), bgi::parallel(4));
+\endverbatim
+
+\par Throws
+If Value copy constructor or copy assignment throws.
+If allocation throws.
+
+\ingroup rtree_functions
+
+\param tree         The rtree.
+\param predicates   The random access range of Predicates.
+\param out_it       The output iterator of values, e.g. generated by std::back_inserter().
+\param offsets_it   The output iterator of offsets, e.g. generated by std::back_inserter().
+\param par          The parallel execution policy.
+
+\return             The number of values found by all queries.
+*/
+template <typename Value, typename Parameters, typename IndexableGetter, typename EqualTo, typename Allocator,
+          typename PredicatesRange, typename OutIter, typename OffsetsOutIter> inline
+typename rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator>::size_type
+batch_query(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> const& tree,
+            PredicatesRange const& predicates,
+            OutIter out_it,
+            OffsetsOutIter offsets_it,
+            index::parallel const& par)
+{
+    return tree.batch_query(predicates, out_it, offsets_it, par);
+}
+
+/*!
+\brief Finds values meeting passed predicates and passes them to the function object until it returns false.
+
+For more information see rtree::query_each().
+
+\par Example
+\verbatim
+bool any = 0 < bgi::query_each(tree, bgi::intersects(box), found());
+\endverbatim
+
+\par Throws
+If predicates copy throws.
+If the function object throws.
+Distance queries: if Value copy constructor or copy assignment throws.
+
+\ingroup rtree_functions
+
+\param tree         The rtree.
+\param predicates   Predicates.
+\param function     The function object taking Value const& and returning bool, false if the query should be stopped.
+
+\return             The number of values passed to the function object.
+*/
+template <typename Value, typename Parameters, typename IndexableGetter, typename EqualTo, typename Allocator,
+          typename Predicates, typename Function> inline
+typename rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator>::size_type
+query_each(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> const& tree,
+           Predicates const& predicates,
+           Function function)
+{
+    return tree.query_each(predicates, function);
+}
+
+/*!
+\brief Counts values meeting passed spatial predicates.
+
+For more information see rtree::query_count().
+
+\par Example
+\verbatim
+std::size_t n = bgi::query_count(tree, bgi::intersects(box));
+\endverbatim
+
+\par Throws
+If predicates copy throws.
+
+\ingroup rtree_functions
+
+\param tree         The rtree.
+\param predicates   Spatial predicates.
+
+\return             The number of values meeting predicates.
+*/
+template <typename Value, typename Parameters, typename IndexableGetter, typename EqualTo, typename Allocator,
+          typename Predicates> inline
+typename rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator>::size_type
+query_count(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> const& tree,
+            Predicates const& predicates)
+{
+    return tree.query_count(predicates);
+}
+
+/*!
+\brief Finds all pairs of values of two rtrees for which the indexables intersect.
+
+Both rtrees are traversed simultaneously and the pairs of nodes whose boxes don't
+intersect are pruned. For each pair of values found <tt>std::pair<Value1, Value2></tt>
+is written to the output iterator. To process the pairs without storing them
+an output iterator calling a function object may be passed,
+e.g. <tt>boost::function_output_iterator</tt>. The rtrees may be of different types.
+
+\par Example
+\verbatim
+std::vector< std::pair<Parcel, Building> > result;
+bgi::spatial_join(parcels, buildings, std::back_inserter(result));
+\endverbatim
+
+\par Throws
+If Value copy constructor or copy assignment throws.
+
+\ingroup rtree_functions
+
+\param tree1        The first rtree.
+\param tree2        The second rtree.
+\param out_it       The output iterator of pairs of values, e.g. generated by std::back_inserter().
+
+\return             The number of pairs found.
+*/
+template <typename Value1, typename Parameters1, typename IndexableGetter1, typename EqualTo1, typename Allocator1,
+          typename Value2, typename Parameters2, typename IndexableGetter2, typename EqualTo2, typename Allocator2,
+          typename OutIter> inline
+std::size_t
+spatial_join(rtree<Value1, Parameters1, IndexableGetter1, EqualTo1, Allocator1> const& tree1,
+             rtree<Value2, Parameters2, IndexableGetter2, EqualTo2, Allocator2> const& tree2,
+             OutIter out_it)
+{
+    return detail::rtree::spatial_join
+        <
+            rtree<Value1, Parameters1, IndexableGetter1, EqualTo1, Allocator1>,
+            rtree<Value2, Parameters2, IndexableGetter2, EqualTo2, Allocator2>
+        >::apply(tree1, tree2, out_it, 1);
+}
+
+/*!
+\brief Finds all pairs of values of two rtrees for which the indexables intersect using multiple threads.
+
+The pairs of the children of the roots are divided between threads. The pairs found are
+stored and then written to the output iterator in the same order as in the sequential
+version. For more information see spatial_join().
+
+\par Example
+\verbatim
+std::vector< std::pair<Parcel, Building> > result;
+bgi::spatial_join(parcels, buildings, std::back_inserter(result), bgi::parallel(4));
+\endverbatim
+
+\par Throws
+If Value copy constructor or copy assignment throws.
+If allocation throws.
+
+\ingroup rtree_functions
+
+\param tree1        The first rtree.
+\param tree2        The second rtree.
+\param out_it       The output iterator of pairs of values, e.g. generated by std::back_inserter().
+\param par          The parallel execution policy.
+
+\return             The number of pairs found.
+*/
+template <typename Value1, typename Parameters1, typename IndexableGetter1, typename EqualTo1, typename Allocator1,
+          typename Value2, typename Parameters2, typename IndexableGetter2, typename EqualTo2, typename Allocator2,
+          typename OutIter> inline
+std::size_t
+spatial_join(rtree<Value1, Parameters1, IndexableGetter1, EqualTo1, Allocator1> const& tree1,
+             rtree<Value2, Parameters2, IndexableGetter2, EqualTo2, Allocator2> const& tree2,
+             OutIter out_it,
+             index::parallel const& par)
+{
+    return detail::rtree::spatial_join
+        <
+            rtree<Value1, Parameters1, IndexableGetter1, EqualTo1, Allocator1>,
+            rtree<Value2, Parameters2, IndexableGetter2, EqualTo2, Allocator2>
+        >::apply(tree1, tree2, out_it, par.threads());
+}
+
+/*!
+\brief Finds k nearest values for each Point of a range.
+
+The result is the same as the result of the k-NN query <tt>nearest(pt, k)</tt> performed
+for each Point. However the Points are sorted along the Hilbert curve and the queries of the
+groups of Points close to each other are performed during one traversal of the rtree, so the
+nodes shared by the queries are visited once. For each Point and each of its neighbors
+<tt>std::pair<Point, Value></tt> is written to the output iterator. The pairs are written in
+the order of Points and the neighbors of each Point in the same order as by the k-NN query.
+
+\par Example
+\verbatim
+std::vector< std::pair<Point, Value> > result;
+bgi::knn_join(tree, points, 5, std::back_inserter(result));
+\endverbatim
+
+\par Throws
+If Value copy constructor or copy assignment throws.
+If allocation throws.
+
+\ingroup rtree_functions
+
+\param tree         The rtree.
+\param points       The range of Points.
+\param k            The number of nearest values searched for each Point.
+\param out_it       The output iterator of pairs of Points and values, e.g. generated by std::back_inserter().
+
+\return             The number of pairs found.
+*/
+template <typename Value, typename Parameters, typename IndexableGetter, typename EqualTo, typename Allocator,
+          typename PointRange, typename OutIter> inline
+std::size_t
+knn_join(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> const& tree,
+         PointRange const& points, unsigned k, OutIter out_it)
+{
+    BOOST_MPL_ASSERT_MSG((detail::is_range<PointRange>::value),
+                         PASSED_OBJECT_IS_NOT_A_RANGE,
+                         (PointRange));
+
+    typedef typename boost::range_value<PointRange>::type point_type;
+    return detail::rtree::knn_join
+        <
+            rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator>, point_type, point_type
+        >::apply(tree, boost::begin(points), boost::end(points), k, out_it, 1);
+}
+
+/*!
+\brief Finds k nearest values for each Point of a range using multiple threads.
+
+The groups of Points are divided between threads. The pairs found are stored and then written
+to the output iterator in the same order as in the sequential version. For more information
+see knn_join().
+
+\par Example
+\verbatim
+std::vector< std::pair<Point, Value> > result;
+bgi::knn_join(tree, points, 5, std::back_inserter(result), bgi::parallel(4));
+\endverbatim
+
+\par Throws
+If Value copy constructor or copy assignment throws.
+If allocation throws.
+
+\ingroup rtree_functions
+
+\param tree         The rtree.
+\param points       The range of Points.
+\param k            The number of nearest values searched for each Point.
+\param out_it       The output iterator of pairs of Points and values, e.g. generated by std::back_inserter().
+\param par          The parallel execution policy.
+
+\return             The number of pairs found.
+*/
+template <typename Value, typename Parameters, typename IndexableGetter, typename EqualTo, typename Allocator,
+          typename PointRange, typename OutIter> inline
+std::size_t
+knn_join(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> const& tree,
+         PointRange const& points, unsigned k, OutIter out_it,
+         index::parallel const& par)
+{
+    BOOST_MPL_ASSERT_MSG((detail::is_range<PointRange>::value),
+                         PASSED_OBJECT_IS_NOT_A_RANGE,
+                         (PointRange));
+
+    typedef typename boost::range_value<PointRange>::type point_type;
+    return detail::rtree::knn_join
+        <
+            rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator>, point_type, point_type
+        >::apply(tree, boost::begin(points), boost::end(points), k, out_it, par.threads());
+}
+
+/*!
+\brief Finds k nearest values of the first rtree for each value of the second rtree.
+
+The indexables of the second rtree must be Points. The queries of the Points stored in one leaf
+of the second rtree are performed during one traversal of the first rtree. For each value of
+the second rtree and each of its neighbors <tt>std::pair<Value2, Value1></tt> is written to the
+output iterator. The pairs are written in the order of the leafs of the second rtree and the
+neighbors of each value in the same order as by the k-NN query. The rtrees may be of different
+types. If the same rtree is passed twice the k-nearest neighbors graph is created, each value
+is one of its own neighbors.
+
+\par Example
+\verbatim
+std::vector< std::pair<Vertex, Vertex> > graph;
+bgi::knn_join(vertices, vertices, 6, std::back_inserter(graph));
+\endverbatim
+
+\par Throws
+If Value copy constructor or copy assignment throws.
+If allocation throws.
+
+\ingroup rtree_functions
+
+\param tree1        The rtree searched for neighbors.
+\param tree2        The rtree of query Points.
+\param k            The number of nearest values searched for each value of the second rtree.
+\param out_it       The output iterator of pairs of values, e.g. generated by std::back_inserter().
+
+\return             The number of pairs found.
+*/
+template <typename Value1, typename Parameters1, typename IndexableGetter1, typename EqualTo1, typename Allocator1,
+          typename Value2, typename Parameters2, typename IndexableGetter2, typename EqualTo2, typename Allocator2,
+          typename OutIter> inline
+std::size_t
+knn_join(rtree<Value1, Parameters1, IndexableGetter1, EqualTo1, Allocator1> const& tree1,
+         rtree<Value2, Parameters2, IndexableGetter2, EqualTo2, Allocator2> const& tree2,
+         unsigned k, OutIter out_it)
+{
+    typedef typename rtree<Value2, Parameters2, IndexableGetter2, EqualTo2, Allocator2>::indexable_type point_type;
+    return detail::rtree::knn_join
+        <
+            rtree<Value1, Parameters1, IndexableGetter1, EqualTo1, Allocator1>, Value2, point_type
+        >::apply(tree1, tree2, k, out_it, 1);
+}
+
+/*!
+\brief Finds k nearest values of the first rtree for each value of the second rtree using multiple threads.
+
+The leafs of the second rtree are divided between threads. The pairs found are stored and then
+written to the output iterator in the same order as in the sequential version. For more
+information see knn_join().
+
+\par Example
+\verbatim
+std::vector< std::pair<Vertex, Vertex> > graph;
+bgi::knn_join(vertices, vertices, 6, std::back_inserter(graph), bgi::parallel(4));
+\endverbatim
+
+\par Throws
+If Value copy constructor or copy assignment throws.
+If allocation throws.
+
+\ingroup rtree_functions
+
+\param tree1        The rtree searched for neighbors.
+\param tree2        The rtree of query Points.
+\param k            The number of nearest values searched for each value of the second rtree.
+\param out_it       The output iterator of pairs of values, e.g. generated by std::back_inserter().
+\param par          The parallel execution policy.
+
+\return             The number of pairs found.
+*/
+template <typename Value1, typename Parameters1, typename IndexableGetter1, typename EqualTo1, typename Allocator1,
+          typename Value2, typename Parameters2, typename IndexableGetter2, typename EqualTo2, typename Allocator2,
+          typename OutIter> inline
+std::size_t
+knn_join(rtree<Value1, Parameters1, IndexableGetter1, EqualTo1, Allocator1> const& tree1,
+         rtree<Value2, Parameters2, IndexableGetter2, EqualTo2, Allocator2> const& tree2,
+         unsigned k, OutIter out_it,
+         index::parallel const& par)
+{
+    typedef typename rtree<Value2, Parameters2, IndexableGetter2, EqualTo2, Allocator2>::indexable_type point_type;
+    return detail::rtree::knn_join
+        <
+            rtree<Value1, Parameters1, IndexableGetter1, EqualTo1, Allocator1>, Value2, point_type
+        >::apply(tree1, tree2, k, out_it, par.threads());
+}
+
 /*!
 \brief Returns the query iterator pointing at the begin of the query range.
 
@@ -2053,6 +3337,44 @@ qend(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> const& tree)
     return tree.qend();
 }
 
+/*!
+\brief Returns the range of Values meeting the predicates.
+
+This method returns the range which may be used to perform iterative queries without
+type-erasure and memory allocations during the iteration. For the information
+about the predicates which may be passed to this method see query().
+
+\par Example
+\verbatim
+boost::for_each(bgi::qrange(tree, bgi::nearest(pt, 3)), do_something());
+\endverbatim
+
+\par Iterator category
+ForwardIterator
+
+\par Throws
+If predicates copy throws.
+If allocation throws.
+
+\warning
+The modification of the rtree may invalidate the range and the iterators.
+
+\ingroup rtree_functions
+
+\param tree         The rtree.
+\param predicates   Predicates.
+
+\return             The range of Values meeting the predicates.
+*/
+template <typename Value, typename Parameters, typename IndexableGetter, typename EqualTo, typename Allocator,
+          typename Predicates> inline
+typename rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator>::template query_range_type<Predicates>::type
+qrange(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> const& tree,
+       Predicates const& predicates)
+{
+    return tree.qrange(predicates);
+}
+
 /*!
 \brief Returns the iterator pointing at the begin of the rtree values range.
 
@@ -0,0 +1,487 @@
+// Boost.Geometry Index
+//
+// R-tree with copy-on-write snapshots
+//
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_SNAPSHOT_RTREE_HPP
+#define BOOST_GEOMETRY_INDEX_SNAPSHOT_RTREE_HPP
+
+#include <vector>
+
+#include <boost/core/noncopyable.hpp>
+#include <boost/core/ref.hpp>
+#include <boost/smart_ptr/make_shared.hpp>
+#include <boost/smart_ptr/shared_ptr.hpp>
+
+#include <boost/geometry/util/parallel.hpp>
+
+#include <boost/geometry/index/rtree.hpp>
+#include <boost/geometry/index/detail/rtree/copy_on_write.hpp>
+#include <boost/geometry/index/detail/rtree/private_view.hpp>
+
+#ifdef BOOST_GEOMETRY_DETAIL_PARALLEL_USE_THREADS
+#include <mutex>
+#endif
+
+namespace boost { namespace geometry { namespace index {
+
+namespace detail { namespace rtree {
+
+// One version of the tree published by snapshot_rtree.
+//
+// The nodes are shared with the other versions. When the next version is
+// published the nodes of this version which aren't used by the next one are
+// retired. They are destroyed when this version and all previous versions are
+// destroyed, so each version holds the next one. The last version owns all of
+// its nodes.
+template <typename Rtree>
+class snapshot_version
+    : boost::noncopyable
+{
+    typedef typename Rtree::value_type value_type;
+    typedef typename private_view<Rtree>::options_type options_type;
+    typedef typename private_view<Rtree>::translator_type translator_type;
+    typedef typename private_view<Rtree>::box_type box_type;
+    typedef typename private_view<Rtree>::allocators_type allocators_type;
+
+    typedef rtree::copy_on_write<value_type, options_type, translator_type, box_type, allocators_type> copy_on_write;
+
+public:
+    typedef typename copy_on_write::retired_nodes_type retired_nodes_type;
+
+    // The created version shares the nodes of the tree.
+    explicit snapshot_version(Rtree const& tree)
+        : m_tree(tree.parameters(), tree.indexable_get(), tree.value_eq(), tree.get_allocator())
+        , m_owns_nodes(true)
+    {
+        private_view<Rtree> dst(m_tree);
+        const_private_view<Rtree> src(tree);
+        dst.members().root = src.members().root;
+        dst.members().leafs_level = src.members().leafs_level;
+        dst.members().values_count = src.members().values_count;
+    }
+
+    ~snapshot_version()
+    {
+        private_view<Rtree> view(m_tree);
+
+        for ( typename retired_nodes_type::iterator it = m_retired_nodes.begin() ;
+              it != m_retired_nodes.end() ; ++it )
+        {
+            copy_on_write::destroy_node(*it, view.members().allocators());
+        }
+
+        // the nodes are destroyed by the rtree only if they're not used by the next version
+        if ( ! m_owns_nodes )
+            view.members().root = 0;
+
+        // release the next versions in a loop instead of the recursion
+        boost::shared_ptr<snapshot_version> next;
+        next.swap(m_next);
+        while ( next && next.unique() )
+        {
+            boost::shared_ptr<snapshot_version> after_next;
+            after_next.swap(next->m_next);
+            next = after_next;
+        }
+    }
+
+    Rtree const& tree() const
+    {
+        return m_tree;
+    }
+
+    // The retired nodes are the nodes of this version not used by the next version.
+    void set_next(boost::shared_ptr<snapshot_version> const& next, retired_nodes_type & retired_nodes)
+    {
+        m_next = next;
+        m_retired_nodes.swap(retired_nodes);
+        m_owns_nodes = false;
+    }
+
+private:
+    Rtree m_tree;
+    retired_nodes_type m_retired_nodes;
+    boost::shared_ptr<snapshot_version> m_next;
+    bool m_owns_nodes;
+};
+
+}} // namespace detail::rtree
+
+/*!
+\brief The R-tree supporting concurrent readers and one writer with copy-on-write snapshots.
+
+The writer modifies the tree without modifying the nodes visible to the readers.
+Before a node is modified for the first time after the tree was published it is
+copied together with all nodes on the path from the root. The modifications become
+visible after publish() is called which atomically replaces the current version
+of the tree. The readers obtain the current version with snapshot(). A snapshot is
+an immutable R-tree which may be queried without locks and it isn't affected by
+the subsequent modifications. The nodes which are no longer used are destroyed when
+all snapshots which may use them are destroyed.
+
+Only snapshot() may be called concurrently with the other member functions. Values
+are inserted without R*-tree forced reinsertions. The allocator must be safe to use
+by many threads because the nodes may be destroyed by the thread releasing the last
+snapshot.
+
+\tparam Value           The type of objects stored in the container.
+\tparam Parameters      Compile-time parameters.
+\tparam IndexableGetter The function object extracting Indexable from Value.
+\tparam EqualTo         The function object comparing objects of type Value.
+\tparam Allocator       The allocator used to allocate/deallocate memory,
+                        construct/destroy nodes and Values.
+*/
+template
+<
+    typename Value,
+    typename Parameters,
+    typename IndexableGetter = index::indexable<Value>,
+    typename EqualTo = index::equal_to<Value>,
+    typename Allocator = boost::container::new_allocator<Value>
+>
+class snapshot_rtree
+    : boost::noncopyable
+{
+public:
+    /*! \brief The type of the published R-trees. */
+    typedef index::rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> rtree_type;
+    /*! \brief The type of a snapshot, a shared pointer to an immutable R-tree. */
+    typedef boost::shared_ptr<rtree_type const> snapshot_type;
+
+    /*! \brief The type of Value stored in the container. */
+    typedef Value value_type;
+    /*! \brief R-tree parameters type. */
+    typedef Parameters parameters_type;
+    /*! \brief The function object extracting Indexable from Value. */
+    typedef IndexableGetter indexable_getter;
+    /*! \brief The function object comparing objects of type Value. */
+    typedef EqualTo value_equal;
+    /*! \brief The type of allocator used by the container. */
+    typedef Allocator allocator_type;
+    /*! \brief Unsigned integral type used by the container. */
+    typedef typename rtree_type::size_type size_type;
+
+private:
+    typedef detail::rtree::snapshot_version<rtree_type> version_type;
+    typedef detail::rtree::private_view<rtree_type> private_view;
+    typedef detail::rtree::const_private_view<rtree_type> const_private_view;
+
+    typedef detail::rtree::copy_on_write
+        <
+            value_type,
+            typename private_view::options_type,
+            typename private_view::translator_type,
+            typename private_view::box_type,
+            typename private_view::allocators_type
+        > copy_on_write;
+
+public:
+    /*!
+    \brief The constructor.
+
+    The empty tree is published.
+
+    \param parameters   The parameters object.
+    \param getter       The function object extracting Indexable from Value.
+    \param equal        The function object comparing Values.
+    \param allocator    The allocator object.
+
+    \par Throws
+    If allocation throws.
+    */
+    inline explicit snapshot_rtree(parameters_type const& parameters = parameters_type(),
+                                   indexable_getter const& getter = indexable_getter(),
+                                   value_equal const& equal = value_equal(),
+                                   allocator_type const& allocator = allocator_type())
+        : m_tree(parameters, getter, equal, allocator)
+    {
+        m_current = boost::make_shared<version_type>(boost::cref(m_tree));                     // MAY THROW (alloc)
+    }
+
+    /*!
+    \brief The constructor.
+
+    The tree is created using packing algorithm and published.
+
+    \param rng          The range of Values.
+    \param parameters   The parameters object.
+    \param getter       The function object extracting Indexable from Value.
+    \param equal        The function object comparing Values.
+    \param allocator    The allocator object.
+
+    \par Throws
+    \li If allocator copy constructor throws.
+    \li If Value copy constructor or copy assignment throws.
+    \li If allocation throws or returns invalid value.
+    */
+    template<typename Range>
+    inline explicit snapshot_rtree(Range const& rng,
+                                   parameters_type const& parameters = parameters_type(),
+                                   indexable_getter const& getter = indexable_getter(),
+                                   value_equal const& equal = value_equal(),
+                                   allocator_type const& allocator = allocator_type())
+        : m_tree(rng, parameters, getter, equal, allocator)
+    {
+        m_current = boost::make_shared<version_type>(boost::cref(m_tree));                     // MAY THROW (alloc)
+    }
+
+    /*!
+    \brief The destructor.
+
+    The modifications which weren't published are discarded. The published
+    nodes are destroyed when the last snapshot is destroyed.
+
+    \par Throws
+    Nothing.
+    */
+    inline ~snapshot_rtree()
+    {
+        destroy_private_nodes();
+
+        // the rest of the nodes is owned by the last version
+        private_view(m_tree).members().root = 0;
+    }
+
+    /*!
+    \brief Insert a value to the tree.
+
+    The value is visible in the snapshots after publish() is called.
+
+    \param value    The value which will be stored in the container.
+
+    \par Exception-safety
+    If an exception is thrown all modifications since the last call of publish() are discarded.
+    */
+    inline void insert(value_type const& value)
+    {
+        typename private_view::members_holder & members = private_view(m_tree).members();
+
+        copy_on_write cow(members.root, members.leafs_level, m_private_nodes, m_retired_nodes,
+                          members.parameters(), members.translator(), members.allocators());
+
+        BOOST_TRY
+        {
+            cow.insert(value);                                                                  // MAY THROW (V, E: alloc, copy, N: alloc)
+        }
+        BOOST_CATCH(...)
+        {
+            discard_changes();
+            BOOST_RETHROW                                                                       // RETHROW
+        }
+        BOOST_CATCH_END
+
+        ++members.values_count;
+    }
+
+    /*!
+    \brief Insert a range of values to the tree.
+
+    \param first    The beginning of the range of values.
+    \param last     The end of the range of values.
+
+    \par Exception-safety
+    If an exception is thrown all modifications since the last call of publish() are discarded.
+    */
+    template <typename Iterator>
+    inline void insert(Iterator first, Iterator last)
+    {
+        for ( ; first != last ; ++first )
+            this->insert(*first);                                                               // MAY THROW
+    }
+
+    /*!
+    \brief Remove a value from the tree.
+
+    In contrast to the \c std::set or <tt>std::map erase()</tt> method
+    this method removes only one value from the container.
+
+    \param value    The value which will be removed from the container.
+
+    \return         1 if the value was removed, 0 otherwise.
+
+    \par Exception-safety
+    If an exception is thrown all modifications since the last call of publish() are discarded.
+    */
+    inline size_type remove(value_type const& value)
+    {
+        typename private_view::members_holder & members = private_view(m_tree).members();
+
+        copy_on_write cow(members.root, members.leafs_level, m_private_nodes, m_retired_nodes,
+                          members.parameters(), members.translator(), members.allocators());
+
+        bool removed = false;
+        BOOST_TRY
+        {
+            removed = cow.remove(value);                                                        // MAY THROW (V, E: alloc, copy, N: alloc)
+        }
+        BOOST_CATCH(...)
+        {
+            discard_changes();
+            BOOST_RETHROW                                                                       // RETHROW
+        }
+        BOOST_CATCH_END
+
+        if ( ! removed )
+            return 0;
+
+        --members.values_count;
+        return 1;
+    }
+
+    /*!
+    \brief Remove a range of values from the tree.
+
+    \param first    The beginning of the range of values.
+    \param last     The end of the range of values.
+
+    \return         The number of removed values.
+
+    \par Exception-safety
+    If an exception is thrown all modifications since the last call of publish() are discarded.
+    */
+    template <typename Iterator>
+    inline size_type remove(Iterator first, Iterator last)
+    {
+        size_type result = 0;
+        for ( ; first != last ; ++first )
+            result += this->remove(*first);                                                     // MAY THROW
+        return result;
+    }
+
+    /*!
+    \brief Publish the modifications.
+
+    The current version of the tree is atomically replaced by the modified tree.
+    The snapshots taken before are not affected.
+
+    \par Exception-safety
+    strong
+    */
+    inline void publish()
+    {
+        if ( m_private_nodes.empty() && m_retired_nodes.empty() )
+            return;
+
+        boost::shared_ptr<version_type> next = boost::make_shared<version_type>(boost::cref(m_tree)); // MAY THROW (alloc)
+
+        m_current->set_next(next, m_retired_nodes);
+        m_private_nodes.clear();
+
+        {
+            lock_guard lock(m_mutex);
+            m_current.swap(next);
+        }
+
+        // the previous version may be destroyed here if there are no snapshots
+    }
+
+    /*!
+    \brief Returns the snapshot of the current version of the tree.
+
+    This function may be called concurrently with the other member functions.
+
+    \return     The immutable R-tree.
+
+    \par Throws
+    Nothing.
+    */
+    inline snapshot_type snapshot() const
+    {
+        boost::shared_ptr<version_type> current;
+        {
+            lock_guard lock(m_mutex);
+            current = m_current;
+        }
+
+        return snapshot_type(current, boost::addressof(current->tree()));
+    }
+
+    /*!
+    \brief Returns the number of stored values including the modifications which weren't published.
+
+    \return     The number of stored values.
+
+    \par Throws
+    Nothing.
+    */
+    inline size_type size() const
+    {
+        return m_tree.size();
+    }
+
+    /*!
+    \brief Query if the container is empty including the modifications which weren't published.
+
+    \return     true if the container is empty.
+
+    \par Throws
+    Nothing.
+    */
+    inline bool empty() const
+    {
+        return m_tree.empty();
+    }
+
+private:
+    void destroy_private_nodes()
+    {
+        typename private_view::members_holder & members = private_view(m_tree).members();
+
+        for ( typename private_nodes_type::iterator it = m_private_nodes.begin() ;
+              it != m_private_nodes.end() ; ++it )
+        {
+            copy_on_write::destroy_node(*it, members.allocators());
+        }
+
+        m_private_nodes.clear();
+    }
+
+    // Restores the published version of the tree.
+    void discard_changes()
+    {
+        destroy_private_nodes();
+        m_retired_nodes.clear();
+
+        typename private_view::members_holder & members = private_view(m_tree).members();
+        typename const_private_view::members_holder const& current
+            = const_private_view(m_current->tree()).members();
+
+        members.root = current.root;
+        members.leafs_level = current.leafs_level;
+        members.values_count = current.values_count;
+    }
+
+    typedef typename copy_on_write::private_nodes_type private_nodes_type;
+    typedef typename copy_on_write::retired_nodes_type retired_nodes_type;
+
+#ifdef BOOST_GEOMETRY_DETAIL_PARALLEL_USE_THREADS
+    typedef std::mutex mutex_type;
+    typedef std::lock_guard<std::mutex> lock_guard;
+#else
+    struct mutex_type {};
+    struct lock_guard
+    {
+        explicit lock_guard(mutex_type &) {}
+    };
+#endif
+
+    // The modified tree, its nodes are shared with the published versions
+    rtree_type m_tree;
+    // The nodes created since the last publication
+    private_nodes_type m_private_nodes;
+    // The nodes of the current version replaced since the last publication
+    retired_nodes_type m_retired_nodes;
+
+    boost::shared_ptr<version_type> m_current;
+    mutable mutex_type m_mutex;
+};
+
+}}} // namespace boost::geometry::index
+
+#endif // BOOST_GEOMETRY_INDEX_SNAPSHOT_RTREE_HPP
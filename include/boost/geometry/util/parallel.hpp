@@ -0,0 +1,233 @@
+// Boost.Geometry
+
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_UTIL_PARALLEL_HPP
+#define BOOST_GEOMETRY_UTIL_PARALLEL_HPP
+
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/config.hpp>
+#include <boost/core/ignore_unused.hpp>
+
+
+// Threads are used only if the standard library provides them and exceptions
+// are enabled so the exceptions thrown in worker threads can be propagated.
+// Otherwise all tasks are executed sequentially in the calling thread.
+// The use of threads can also be disabled explicitly by defining
+// BOOST_GEOMETRY_DISABLE_THREADS.
+#if !defined(BOOST_GEOMETRY_DISABLE_THREADS) \
+ && !defined(BOOST_NO_CXX11_HDR_THREAD) \
+ && !defined(BOOST_NO_CXX11_HDR_EXCEPTION) \
+ && !defined(BOOST_NO_EXCEPTIONS)
+#define BOOST_GEOMETRY_DETAIL_PARALLEL_USE_THREADS
+#endif
+
+#ifdef BOOST_GEOMETRY_DETAIL_PARALLEL_USE_THREADS
+#include <exception>
+#include <system_error>
+#include <thread>
+#endif
+
+
+namespace boost { namespace geometry
+{
+
+#ifndef DOXYGEN_NO_DETAIL
+namespace detail { namespace parallel
+{
+
+// Returns the number of threads which should be used if the number of
+// requested threads is equal to 0, i.e. the number of hardware threads.
+inline std::size_t hardware_threads()
+{
+#ifdef BOOST_GEOMETRY_DETAIL_PARALLEL_USE_THREADS
+    std::size_t const result = std::thread::hardware_concurrency();
+    return result > 0 ? result : 1;
+#else
+    return 1;
+#endif
+}
+
+// Translates the number of requested threads into the number of threads
+// which will actually be used.
+inline std::size_t threads_count(std::size_t requested)
+{
+#ifdef BOOST_GEOMETRY_DETAIL_PARALLEL_USE_THREADS
+    return requested > 0 ? requested : hardware_threads();
+#else
+    boost::ignore_unused(requested);
+    return 1;
+#endif
+}
+
+#ifdef BOOST_GEOMETRY_DETAIL_PARALLEL_USE_THREADS
+
+template <typename Function>
+struct guarded_call
+{
+    guarded_call(Function & f, std::exception_ptr & e)
+        : function(f), exception(e)
+    {}
+
+    void operator()()
+    {
+        try
+        {
+            function();
+        }
+        catch (...)
+        {
+            exception = std::current_exception();
+        }
+    }
+
+    Function & function;
+    std::exception_ptr & exception;
+};
+
+template <typename Function>
+struct guarded_chunk_call
+{
+    guarded_chunk_call(Function & f, std::exception_ptr & e,
+                       std::size_t fi, std::size_t la, std::size_t i)
+        : function(f), exception(e), first(fi), last(la), index(i)
+    {}
+
+    void operator()()
+    {
+        try
+        {
+            function(first, last, index);
+        }
+        catch (...)
+        {
+            exception = std::current_exception();
+        }
+    }
+
+    Function & function;
+    std::exception_ptr & exception;
+    std::size_t first, last, index;
+};
+
+#endif // BOOST_GEOMETRY_DETAIL_PARALLEL_USE_THREADS
+
+// Calls f1() and f2() and returns when both of them have finished.
+// If concurrently is true f1() is called in a separate thread.
+// If any of the functions throws, the exception is rethrown after
+// both calls have finished. If both of them throw the exception
+// thrown by f1() is propagated.
+template <typename Function1, typename Function2>
+inline void invoke(Function1 & f1, Function2 & f2, bool concurrently)
+{
+#ifdef BOOST_GEOMETRY_DETAIL_PARALLEL_USE_THREADS
+    if (concurrently)
+    {
+        std::exception_ptr e1, e2;
+        std::thread t;
+        try
+        {
+            t = std::thread(guarded_call<Function1>(f1, e1));
+        }
+        catch (std::system_error const&)
+        {
+            // no more threads available, f1() is called sequentially below
+        }
+
+        if (t.joinable())
+        {
+            guarded_call<Function2>(f2, e2)();
+            t.join();
+
+            if (e1)
+                std::rethrow_exception(e1);
+            if (e2)
+                std::rethrow_exception(e2);
+
+            return;
+        }
+    }
+#else
+    boost::ignore_unused(concurrently);
+#endif
+
+    f1();
+    f2();
+}
+
+// Splits the range of indexes [0, count) into at most threads contiguous
+// chunks of similar size and calls f(first, last, chunk_index) for each
+// chunk, each of them in a separate thread. Returns when all of the calls
+// have finished. The first exception thrown, WRT the chunks order,
+// is rethrown.
+template <typename Function>
+inline void for_each_chunk(std::size_t count, std::size_t threads, Function & f)
+{
+    if (count == 0)
+        return;
+
+    if (threads > count)
+        threads = count;
+
+#ifdef BOOST_GEOMETRY_DETAIL_PARALLEL_USE_THREADS
+    if (threads > 1)
+    {
+        std::vector<std::exception_ptr> exceptions(threads);
+        std::vector<std::thread> workers;
+        workers.reserve(threads - 1);
+
+        std::size_t first = 0;
+        for (std::size_t i = 0 ; i < threads ; ++i)
+        {
+            std::size_t const last = first + (count - first) / (threads - i);
+            guarded_chunk_call<Function> call(f, exceptions[i], first, last, i);
+            if (i + 1 < threads)
+            {
+                // If the thread creation fails the threads created so far
+                // have to be joined before the exception is propagated
+                try
+                {
+                    workers.push_back(std::thread(call));
+                }
+                catch (...)
+                {
+                    for (std::size_t j = 0 ; j < workers.size() ; ++j)
+                        workers[j].join();
+                    throw;
+                }
+            }
+            else
+            {
+                call();
+            }
+            first = last;
+        }
+
+        for (std::size_t i = 0 ; i < workers.size() ; ++i)
+            workers[i].join();
+
+        for (std::size_t i = 0 ; i < threads ; ++i)
+            if (exceptions[i])
+                std::rethrow_exception(exceptions[i]);
+
+        return;
+    }
+#endif
+
+    f(std::size_t(0), count, std::size_t(0));
+}
+
+}} // namespace detail::parallel
+#endif // DOXYGEN_NO_DETAIL
+
+}} // namespace boost::geometry
+
+
+#endif // BOOST_GEOMETRY_UTIL_PARALLEL_HPP
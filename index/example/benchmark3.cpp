@@ -95,5 +95,68 @@ int main()
         std::cout << '\n';
     }
 
+    // packed trees queries test
+    {
+        typedef bg::model::box<P> B;
+        typedef bgi::rtree<P, bgi::linear<16, 4> > RTP;
+
+        size_t const packed_count = stored_count * 20;
+        size_t const queries_count = 200000;
+        size_t const nearest_queries_count = 50000;
+        float const max_val = static_cast<float>(stored_count / 10);
+
+        boost::mt19937 rng;
+        boost::uniform_real<float> range(-max_val, max_val);
+        boost::variate_generator<boost::mt19937&, boost::uniform_real<float> > rnd(rng, range);
+
+        std::vector<P> values;
+        values.reserve(packed_count);
+        for ( size_t i = 0 ; i < packed_count ; ++i )
+            values.push_back(P(rnd(), rnd()));
+
+        std::vector<P> query_points;
+        query_points.reserve(queries_count);
+        for ( size_t i = 0 ; i < queries_count ; ++i )
+            query_points.push_back(P(rnd(), rnd()));
+
+        bgi::packing::node_order_type const orders[] = { bgi::packing::creation_order,
+                                                         bgi::packing::breadth_first,
+                                                         bgi::packing::van_emde_boas };
+        char const* const names[] = { "creation_order", "breadth_first", "van_emde_boas" };
+
+        for ( size_t o = 0 ; o < 3 ; ++o )
+        {
+            clock_t::time_point start = clock_t::now();
+            RTP rt(values, bgi::packing(bgi::packing::hilbert, bgi::parallel(1), orders[o]));
+            dur_t time = clock_t::now() - start;
+            std::cout << names[o] << ' ' << time.count() << ' ';
+
+            float const d = max_val / 1000;
+            size_t found = 0;
+            std::vector<P> result;
+            start = clock_t::now();
+            for ( size_t i = 0 ; i < queries_count ; ++i )
+            {
+                float x = bg::get<0>(query_points[i]);
+                float y = bg::get<1>(query_points[i]);
+                result.clear();
+                rt.query(bgi::intersects(B(P(x - d, y - d), P(x + d, y + d))), std::back_inserter(result));
+                found += result.size();
+            }
+            time = clock_t::now() - start;
+            std::cout << time.count() << ' ';
+
+            start = clock_t::now();
+            for ( size_t i = 0 ; i < nearest_queries_count ; ++i )
+            {
+                result.clear();
+                rt.query(bgi::nearest(query_points[i], 10), std::back_inserter(result));
+                found += result.size();
+            }
+            time = clock_t::now() - start;
+            std::cout << time.count() << ' ' << found << '\n';
+        }
+    }
+
     return 0;
 }
@@ -17,6 +17,7 @@
 
 #include <boost/geometry.hpp>
 #include <boost/geometry/index/rtree.hpp>
+#include <boost/geometry/index/node_pool_allocator.hpp>
 #include <boost/geometry/geometries/geometries.hpp>
 
 #include <boost/geometry/index/detail/rtree/utilities/are_boxes_ok.hpp>
@@ -78,13 +79,18 @@ void test_queries(RT const& t, std::vector< std::pair<float, float> > const& coo
 }
 
 //#define BOOST_GEOMETRY_INDEX_BENCHMARK_DEBUG
+//#define BOOST_GEOMETRY_INDEX_BENCHMARK_NODE_POOL
 
 int main()
 {
     //typedef bgi::rtree<V, bgi::linear<4, 2> > RT;
     //typedef bgi::rtree<V, bgi::linear<16, 4> > RT;
     //typedef bgi::rtree<V, bgi::quadratic<4, 2> > RT;
+#ifndef BOOST_GEOMETRY_INDEX_BENCHMARK_NODE_POOL
     typedef bgi::rtree<V, bgi::rstar<8, 2> > RT;
+#else
+    typedef bgi::rtree<V, bgi::rstar<8, 2>, bgi::indexable<V>, bgi::equal_to<V>, bgi::node_pool_allocator<V> > RT;
+#endif
 
     typedef boost::chrono::thread_clock clock_t;
     typedef boost::chrono::duration<float> dur_t;
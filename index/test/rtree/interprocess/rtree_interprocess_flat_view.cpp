@@ -0,0 +1,90 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <rtree/test_rtree.hpp>
+
+#include <cstdio>
+#include <fstream>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <boost/geometry/index/detail/rtree/flat/flat_view.hpp>
+
+namespace bgif = bgi::detail::rtree::flat;
+
+template <typename Value, typename Params>
+void test_mapped_file(Params const& params = Params())
+{
+    namespace bi = boost::interprocess;
+
+    typedef bgi::rtree<Value, Params> rtree_t;
+    typedef typename rtree_t::bounds_type box_t;
+    typedef typename bg::point_type<box_t>::type point_t;
+
+    std::vector<Value> input;
+    box_t qbox;
+    generate::input<2>::apply(input, qbox, 10);
+    rtree_t rt(input, params);
+
+    const char * filename = "rtree_interprocess_flat_view.bin";
+    {
+        std::ofstream ofs(filename, std::ios::binary);
+        bgif::write_flat(rt, ofs);
+    }
+
+    {
+        bi::file_mapping file(filename, bi::read_only);
+        bi::mapped_region region(file, bi::read_only);
+
+        bgif::flat_view<Value> view(region.get_address(), region.get_size());
+
+        BOOST_CHECK_EQUAL(rt.size(), view.size());
+        BOOST_CHECK(bg::equals(rt.bounds(), view.bounds()));
+
+        std::vector<Value> expected, result;
+        rt.query(bgi::intersects(qbox), std::back_inserter(expected));
+        view.query(bgi::intersects(qbox), std::back_inserter(result));
+        BOOST_CHECK(expected.size() == result.size()
+                 && std::equal(expected.begin(), expected.end(), result.begin(), bgi::equal_to<Value>()));
+
+        point_t pt;
+        bg::centroid(qbox, pt);
+        expected.clear();
+        result.clear();
+        rt.query(bgi::nearest(pt, 10), std::back_inserter(expected));
+        basictest::copy_alt(view.qbegin(bgi::nearest(pt, 10)), view.qend(), std::back_inserter(result));
+        BOOST_CHECK_EQUAL(expected.size(), result.size());
+        if ( expected.size() == result.size() )
+        {
+            // the same distances, the values returned by the view are sorted
+            std::vector<double> expected_d, result_d;
+            for ( size_t i = 0 ; i < result.size() ; ++i )
+            {
+                expected_d.push_back(bg::comparable_distance(pt, expected[i]));
+                result_d.push_back(bg::comparable_distance(pt, result[i]));
+            }
+            std::sort(expected_d.begin(), expected_d.end());
+            BOOST_CHECK(expected_d == result_d);
+        }
+    }
+
+    std::remove(filename);
+}
+
+int test_main(int, char* [])
+{
+    typedef bg::model::point<float, 2, bg::cs::cartesian> P2f;
+    typedef bg::model::box<P2f> B2f;
+
+    test_mapped_file< P2f, bgi::rstar<8, 3> >();
+    test_mapped_file< B2f, bgi::quadratic<16, 4> >();
+
+    return 0;
+}
@@ -0,0 +1,205 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <rtree/test_rtree.hpp>
+
+#include <boost/geometry/index/detail/rtree/utilities/are_boxes_ok.hpp>
+
+// the maximum isn't invertible so the aggregates must be recalculated after removal
+struct weight_max
+{
+    typedef int result_type;
+
+    int identity() const { return (std::numeric_limits<int>::min)(); }
+
+    template <typename Value>
+    int value(Value const& v) const { return v.second; }
+
+    int combine(int l, int r) const { return (std::max)(l, r); }
+};
+
+struct weight_sum
+{
+    typedef long result_type;
+
+    long identity() const { return 0; }
+
+    template <typename Value>
+    long value(Value const& v) const { return v.second; }
+
+    long combine(long l, long r) const { return l + r; }
+};
+
+template <typename Value>
+inline int weight_max_of(std::vector<Value> const& values)
+{
+    int result = weight_max().identity();
+    for ( std::size_t i = 0 ; i < values.size() ; ++i )
+        result = weight_max().combine(result, weight_max().value(values[i]));
+    return result;
+}
+
+template <typename Value>
+inline long weight_sum_of(std::vector<Value> const& values)
+{
+    long result = weight_sum().identity();
+    for ( std::size_t i = 0 ; i < values.size() ; ++i )
+        result = weight_sum().combine(result, weight_sum().value(values[i]));
+    return result;
+}
+
+template <typename Rtree, typename Predicates>
+inline std::vector<typename Rtree::value_type> query_values(Rtree const& rt, Predicates const& pred)
+{
+    std::vector<typename Rtree::value_type> result;
+    rt.query(pred, std::back_inserter(result));
+    return result;
+}
+
+template <typename Aggregator>
+struct check_aggregate
+{
+    template <typename Rtree, typename Predicates>
+    static void apply(Rtree const& , Predicates const& ) {}
+};
+
+template <>
+struct check_aggregate<weight_max>
+{
+    template <typename Rtree, typename Predicates>
+    static void apply(Rtree const& rt, Predicates const& pred)
+    {
+        BOOST_CHECK_EQUAL(rt.query_aggregate(pred), weight_max_of(query_values(rt, pred)));
+    }
+};
+
+template <>
+struct check_aggregate<weight_sum>
+{
+    template <typename Rtree, typename Predicates>
+    static void apply(Rtree const& rt, Predicates const& pred)
+    {
+        BOOST_CHECK_EQUAL(rt.query_aggregate(pred), weight_sum_of(query_values(rt, pred)));
+    }
+};
+
+template <typename Aggregator, typename Rtree, typename Predicates>
+void check_query(Rtree const& rt, Predicates const& pred)
+{
+    BOOST_CHECK_EQUAL(rt.query_count(pred), query_values(rt, pred).size());
+    check_aggregate<Aggregator>::apply(rt, pred);
+}
+
+template <typename Aggregator, typename Rtree>
+void check_queries(Rtree const& rt)
+{
+    typedef typename Rtree::bounds_type box_t;
+    typedef typename bg::point_type<box_t>::type point_t;
+    typedef bg::model::segment<point_t> segment_t;
+
+    if ( ! rt.empty() )
+        BOOST_CHECK(bgi::detail::rtree::utilities::are_boxes_ok(rt));
+
+    for ( int i = 0 ; i < 10 ; ++i )
+    {
+        double const x = (i * 13) % 100, y = (i * 37) % 100;
+        double const w = 5 + (i * 7) % 50, h = 5 + (i * 11) % 40;
+        box_t const b(point_t(x, y), point_t(x + w, y + h));
+        box_t const small(point_t(x + 1, y + 1), point_t(x + 4, y + 3));
+
+        check_query<Aggregator>(rt, bgi::intersects(b));
+        check_query<Aggregator>(rt, bgi::covered_by(b));
+        check_query<Aggregator>(rt, bgi::within(b));
+        check_query<Aggregator>(rt, !bgi::disjoint(b));
+        check_query<Aggregator>(rt, bgi::disjoint(b));
+        check_query<Aggregator>(rt, !bgi::intersects(b));
+        check_query<Aggregator>(rt, bgi::intersects(b) && !bgi::intersects(small));
+        check_query<Aggregator>(rt, bgi::intersects(segment_t(point_t(x, y), point_t(x + w, y + h))));
+    }
+
+    // all values
+    if ( ! rt.empty() )
+        check_query<Aggregator>(rt, bgi::intersects(rt.bounds()));
+}
+
+template <typename Value, typename Params>
+void test_rtree(Params const& params)
+{
+    typedef bgi::rtree<Value, Params> rtree_t;
+    typedef typename Params::aggregator_type aggregator_t;
+
+    std::vector<Value> input;
+    for ( int i = 0 ; i < 1000 ; ++i )
+        input.push_back(generate::value<Value>::apply(i * 7919 % 101, i * 104729 % 97));
+
+    // empty
+    rtree_t rt(params);
+    check_queries<aggregator_t>(rt);
+
+    // inserted
+    rt.insert(input);
+    BOOST_CHECK_EQUAL(bgi::query_count(rt, bgi::intersects(rt.bounds())), input.size());
+    check_queries<aggregator_t>(rt);
+
+    // removed
+    rt.remove(input.begin(), input.begin() + input.size() / 2);
+    check_queries<aggregator_t>(rt);
+
+    // copied
+    rtree_t copied(rt);
+    check_queries<aggregator_t>(copied);
+
+    // all removed
+    rt.remove(input.begin() + input.size() / 2, input.end());
+    BOOST_CHECK(rt.empty());
+    check_queries<aggregator_t>(rt);
+
+    // packed
+    rtree_t packed(input, params);
+    check_queries<aggregator_t>(packed);
+    packed.insert(input.begin(), input.begin() + 100);
+    check_queries<aggregator_t>(packed);
+}
+
+template <typename Value, typename Params>
+void test_rtree_not_augmented(Params const& params = Params())
+{
+    typedef bgi::rtree<Value, Params> rtree_t;
+
+    std::vector<Value> input;
+    for ( int i = 0 ; i < 300 ; ++i )
+        input.push_back(generate::value<Value>::apply(i * 7919 % 101, i * 104729 % 97));
+
+    rtree_t rt(input, params);
+    check_queries<void>(rt);
+}
+
+int test_main(int, char* [])
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+    typedef bg::model::box<point_t> box_t;
+    typedef std::pair<box_t, int> pair_t;
+    typedef std::pair<point_t, int> pair_point_t;
+
+    test_rtree<pair_t>(bgi::augmented<bgi::linear<4, 2>, weight_max>());
+    test_rtree<pair_t>(bgi::augmented<bgi::quadratic<8, 3>, weight_sum>());
+    test_rtree<pair_t>(bgi::augmented<bgi::rstar<4, 2>, weight_max>());
+    test_rtree<pair_point_t>(bgi::augmented<bgi::rstar<16, 4>, weight_sum>());
+    test_rtree<pair_t>(bgi::augmented<bgi::dynamic_rstar, weight_max>(bgi::dynamic_rstar(4, 2)));
+    test_rtree<pair_t>(bgi::augmented<bgi::dynamic_quadratic, weight_sum>(bgi::dynamic_quadratic(8, 3)));
+
+    // counts only
+    test_rtree<point_t>(bgi::augmented< bgi::quadratic<4, 2> >());
+    test_rtree<box_t>(bgi::augmented<bgi::dynamic_rstar>(bgi::dynamic_rstar(4, 2)));
+
+    test_rtree_not_augmented< box_t, bgi::rstar<4, 2> >();
+    test_rtree_not_augmented<pair_point_t>(bgi::dynamic_linear(8, 3));
+
+    return 0;
+}
@@ -0,0 +1,124 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <rtree/test_rtree.hpp>
+
+template <typename Rtree, typename Predicates>
+void check_batch_query(Rtree const& rt, std::vector<Predicates> const& predicates,
+                       std::vector<typename Rtree::value_type> const& result,
+                       std::vector<std::size_t> const& offsets,
+                       std::size_t found_count)
+{
+    typedef typename Rtree::value_type value_t;
+
+    BOOST_CHECK_EQUAL(offsets.size(), predicates.size() + 1);
+    if ( offsets.size() != predicates.size() + 1 )
+        return;
+
+    BOOST_CHECK_EQUAL(offsets.front(), 0u);
+    BOOST_CHECK_EQUAL(offsets.back(), found_count);
+    BOOST_CHECK_EQUAL(result.size(), found_count);
+
+    for ( std::size_t i = 0 ; i < predicates.size() ; ++i )
+    {
+        std::vector<value_t> expected;
+        rt.query(predicates[i], std::back_inserter(expected));
+
+        BOOST_CHECK_EQUAL(offsets[i + 1] - offsets[i], expected.size());
+        if ( offsets[i + 1] - offsets[i] == expected.size() )
+        {
+            // the same values in the same order
+            BOOST_CHECK(std::equal(expected.begin(), expected.end(), result.begin() + offsets[i],
+                                   bgi::equal_to<value_t>()));
+        }
+    }
+}
+
+template <typename Rtree, typename Predicates>
+void test_batch_query(Rtree const& rt, std::vector<Predicates> const& predicates)
+{
+    typedef typename Rtree::value_type value_t;
+
+    {
+        std::vector<value_t> result;
+        std::vector<std::size_t> offsets;
+        std::size_t n = rt.batch_query(predicates, std::back_inserter(result), std::back_inserter(offsets));
+        check_batch_query(rt, predicates, result, offsets, n);
+    }
+
+    std::size_t const threads[] = { 1, 2, 3, 8, 0 };
+    for ( std::size_t i = 0 ; i < sizeof(threads) / sizeof(std::size_t) ; ++i )
+    {
+        std::vector<value_t> result;
+        std::vector<std::size_t> offsets;
+        std::size_t n = bgi::batch_query(rt, predicates, std::back_inserter(result), std::back_inserter(offsets),
+                                         bgi::parallel(threads[i]));
+        check_batch_query(rt, predicates, result, offsets, n);
+    }
+}
+
+template <typename Value, typename Params>
+void test_rtree(std::size_t count, Params const& params = Params())
+{
+    typedef bgi::rtree<Value, Params> rtree_t;
+    typedef typename bg::point_type<Value>::type point_t;
+    typedef bg::model::box<point_t> box_t;
+
+    std::vector<Value> input;
+    for ( std::size_t i = 0 ; i < count ; ++i )
+    {
+        double const x = static_cast<double>((i * 7919) % 1000) / 10.0;
+        double const y = static_cast<double>((i * 104729) % 997) / 10.0;
+        input.push_back(Value(point_t(x, y), point_t(x + 0.5, y + 0.5)));
+    }
+
+    rtree_t rt(input, params);
+    rtree_t empty(params);
+
+    std::vector<bgi::detail::predicates::spatial_predicate<box_t, bgi::detail::predicates::intersects_tag, false> > spatial;
+    std::vector<bgi::detail::predicates::nearest<point_t> > nearest;
+    for ( std::size_t i = 0 ; i < 50 ; ++i )
+    {
+        double const x = static_cast<double>((i * 31) % 100);
+        double const y = static_cast<double>((i * 17) % 100);
+        spatial.push_back(bgi::intersects(box_t(point_t(x, y), point_t(x + i % 7, y + i % 5))));
+        nearest.push_back(bgi::nearest(point_t(x, y), i % 10 + 1));
+    }
+
+    test_batch_query(rt, spatial);
+    test_batch_query(rt, nearest);
+    test_batch_query(empty, spatial);
+    test_batch_query(empty, nearest);
+
+    // no queries
+    test_batch_query(rt, std::vector<bgi::detail::predicates::nearest<point_t> >());
+}
+
+template <typename Value>
+void test_rtree_all(std::size_t count)
+{
+    test_rtree< Value, bgi::linear<4, 2> >(count);
+    test_rtree< Value, bgi::quadratic<8, 3> >(count);
+    test_rtree< Value, bgi::rstar<16, 4> >(count);
+
+    test_rtree<Value>(count, bgi::dynamic_linear(4, 2));
+    test_rtree<Value>(count, bgi::dynamic_quadratic(8, 3));
+    test_rtree<Value>(count, bgi::dynamic_rstar(16, 4));
+}
+
+int test_main(int, char* [])
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+    typedef bg::model::box<point_t> box_t;
+
+    test_rtree_all<box_t>(1);
+    test_rtree_all<box_t>(1000);
+
+    return 0;
+}
@@ -0,0 +1,144 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <rtree/test_rtree.hpp>
+
+#include <boost/geometry/index/detail/rtree/utilities/are_boxes_ok.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/are_counts_ok.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/are_levels_ok.hpp>
+
+template <typename Rtree, typename Box>
+void check_tree(Rtree const& rt, std::vector<typename Rtree::value_type> const& expected_values, Box const& qbox)
+{
+    namespace bgiu = bgi::detail::rtree::utilities;
+    typedef typename Rtree::value_type value_t;
+
+    BOOST_CHECK(bgiu::are_levels_ok(rt));
+    BOOST_CHECK(bgiu::are_boxes_ok(rt));
+    BOOST_CHECK(bgiu::are_counts_ok(rt));
+    BOOST_CHECK_EQUAL(rt.size(), expected_values.size());
+
+    std::vector<value_t> expected;
+    for ( std::size_t i = 0 ; i < expected_values.size() ; ++i )
+        if ( bg::intersects(rt.indexable_get()(expected_values[i]), qbox) )
+            expected.push_back(expected_values[i]);
+
+    std::vector<value_t> output;
+    rt.query(bgi::intersects(qbox), std::back_inserter(output));
+    basictest::compare_outputs(rt, output, expected);
+
+    // all values are stored
+    std::vector<value_t> all(rt.begin(), rt.end());
+    basictest::compare_outputs(rt, all, expected_values);
+}
+
+template <typename Value, typename Params>
+void test_batch_update(Params const& params = Params())
+{
+    typedef bgi::rtree<Value, Params> rtree_t;
+    typedef typename rtree_t::bounds_type box_t;
+
+    std::vector<Value> input;
+    box_t qbox;
+    generate::input<2>::apply(input, qbox, 4);
+
+    std::size_t const half = input.size() / 2;
+    std::vector<Value> first_half(input.begin(), input.begin() + half);
+    std::vector<Value> second_half(input.begin() + half, input.end());
+
+    // insert into the empty tree
+    {
+        rtree_t rt(params);
+        rt.batch_insert(input);
+        check_tree(rt, input, qbox);
+    }
+
+    // insert into the packed tree and into the tree created by insertion
+    {
+        rtree_t packed(first_half, params);
+        packed.batch_insert(second_half.begin(), second_half.end());
+        check_tree(packed, input, qbox);
+
+        rtree_t inserted(params);
+        inserted.insert(first_half);
+        inserted.batch_insert(second_half);
+        check_tree(inserted, input, qbox);
+
+        // small batches
+        rtree_t small(params);
+        for ( std::size_t i = 0 ; i < input.size() ; i += 3 )
+            small.batch_insert(input.begin() + i, input.begin() + (std::min)(i + 3, input.size()));
+        check_tree(small, input, qbox);
+
+        // empty range
+        small.batch_insert(input.begin(), input.begin());
+        check_tree(small, input, qbox);
+    }
+
+    // remove
+    {
+        rtree_t rt(input, params);
+
+        // every other value
+        std::vector<Value> removed, kept;
+        for ( std::size_t i = 0 ; i < input.size() ; ++i )
+            (i % 2 == 0 ? removed : kept).push_back(input[i]);
+
+        BOOST_CHECK_EQUAL(rt.batch_remove(removed), removed.size());
+        check_tree(rt, kept, qbox);
+
+        // not stored
+        BOOST_CHECK_EQUAL(rt.batch_remove(removed.begin(), removed.end()), 0u);
+        check_tree(rt, kept, qbox);
+
+        // the rest, the tree is empty
+        BOOST_CHECK_EQUAL(rt.batch_remove(kept), kept.size());
+        BOOST_CHECK(rt.empty());
+        BOOST_CHECK(bgi::detail::rtree::utilities::are_levels_ok(rt));
+
+        // the tree may be used again
+        rt.batch_insert(input);
+        check_tree(rt, input, qbox);
+
+        // the same value is removed once for each value passed
+        std::vector<Value> duplicated(2, input[0]);
+        BOOST_CHECK_EQUAL(rt.batch_remove(duplicated), 1u);
+        BOOST_CHECK_EQUAL(rt.size(), input.size() - 1);
+    }
+
+    // mixed updates give the same values as the regular insert and remove
+    {
+        rtree_t rt(first_half, params);
+        rt.batch_insert(second_half);
+        BOOST_CHECK_EQUAL(rt.batch_remove(first_half), first_half.size());
+        check_tree(rt, second_half, qbox);
+        rt.batch_insert(first_half);
+        check_tree(rt, input, qbox);
+    }
+}
+
+int test_main(int, char* [])
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+    typedef bg::model::box<point_t> box_t;
+    typedef std::pair<box_t, int> pair_t;
+
+    test_batch_update< point_t, bgi::linear<4, 2> >();
+    test_batch_update< box_t, bgi::quadratic<4, 2> >();
+    test_batch_update< pair_t, bgi::rstar<4, 2> >();
+    test_batch_update< box_t, bgi::rstar<16, 4> >();
+    test_batch_update<point_t>(bgi::dynamic_linear(8, 3));
+    test_batch_update<pair_t>(bgi::dynamic_quadratic(16, 4));
+    test_batch_update<box_t>(bgi::dynamic_rstar(4, 2));
+
+    // the aggregates are updated
+    test_batch_update<pair_t>(bgi::augmented< bgi::rstar<8, 3> >());
+
+    return 0;
+}
@@ -0,0 +1,181 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <rtree/test_rtree.hpp>
+
+#include <sstream>
+
+#include <boost/geometry/index/binary.hpp>
+
+#include <boost/geometry/index/detail/rtree/utilities/are_boxes_ok.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/are_counts_ok.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/are_levels_ok.hpp>
+
+struct weight_sum
+{
+    typedef long result_type;
+
+    long identity() const { return 0; }
+
+    template <typename Value>
+    long value(Value const& v) const { return v.second; }
+
+    long combine(long l, long r) const { return l + r; }
+};
+
+template <typename Rtree>
+inline std::string save_to_string(Rtree const& rt)
+{
+    std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+    bgi::save_binary(rt, ss);
+    return ss.str();
+}
+
+template <typename Rtree>
+inline void load_from_string(Rtree & rt, std::string const& str)
+{
+    std::stringstream ss(str, std::ios::in | std::ios::out | std::ios::binary);
+    bgi::load_binary(rt, ss);
+}
+
+template <typename Rtree, typename SavedRtree>
+void check_loaded(Rtree const& loaded, SavedRtree const& rt)
+{
+    typedef typename Rtree::value_type value_t;
+    typedef typename Rtree::bounds_type box_t;
+
+    BOOST_CHECK_EQUAL(loaded.size(), rt.size());
+    BOOST_CHECK(bgi::detail::rtree::utilities::are_levels_ok(loaded));
+    BOOST_CHECK(bgi::detail::rtree::utilities::are_counts_ok(loaded));
+
+    if ( rt.empty() )
+        return;
+
+    BOOST_CHECK(bgi::detail::rtree::utilities::are_boxes_ok(loaded));
+
+    BOOST_CHECK(bg::equals(loaded.bounds(), rt.bounds()));
+
+    box_t const b = rt.bounds();
+    typedef typename bg::coordinate_type<box_t>::type coord_t;
+    typedef typename bg::point_type<box_t>::type point_t;
+    coord_t const x = bg::get<bg::min_corner, 0>(b), y = bg::get<bg::min_corner, 1>(b);
+    box_t const qbox(point_t(x + 2, y + 2), point_t(x + 9, y + 7));
+
+    std::vector<value_t> expected, output;
+    rt.query(bgi::intersects(qbox), std::back_inserter(expected));
+    loaded.query(bgi::intersects(qbox), std::back_inserter(output));
+    basictest::compare_outputs(loaded, output, expected);
+
+    expected.clear();
+    output.clear();
+    rt.query(bgi::nearest(qbox, 7), std::back_inserter(expected));
+    loaded.query(bgi::nearest(qbox, 7), std::back_inserter(output));
+    basictest::compare_outputs(loaded, output, expected);
+}
+
+template <typename Value, typename Params>
+void test_binary(Params const& params = Params())
+{
+    typedef bgi::rtree<Value, Params> rtree_t;
+    typedef typename rtree_t::bounds_type box_t;
+
+    std::vector<Value> input;
+    box_t qbox;
+    generate::input<2>::apply(input, qbox, 3);
+
+    rtree_t rt(params);
+    rt.insert(input.begin(), input.end());
+    rtree_t packed(input, params);
+    rtree_t empty(params);
+
+    rtree_t const* trees[] = { &rt, &packed, &empty };
+    for ( std::size_t i = 0 ; i < 3 ; ++i )
+    {
+        std::string const data = save_to_string(*trees[i]);
+
+        // the previous content is replaced
+        rtree_t loaded(input.begin(), input.begin() + 10, params);
+        load_from_string(loaded, data);
+        check_loaded(loaded, *trees[i]);
+
+        // the structure is restored exactly
+        BOOST_CHECK(save_to_string(loaded) == data);
+
+        // the loaded tree may be modified
+        loaded.insert(input.front());
+        BOOST_CHECK_EQUAL(loaded.size(), trees[i]->size() + 1);
+        BOOST_CHECK_EQUAL(loaded.remove(input.front()), 1u);
+        BOOST_CHECK(bgi::detail::rtree::utilities::are_boxes_ok(loaded));
+    }
+}
+
+void test_errors()
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+    typedef bg::model::box<point_t> box_t;
+    typedef bg::model::point<float, 2, bg::cs::cartesian> point_f_t;
+
+    std::vector<point_t> input;
+    box_t qbox;
+    generate::input<2>::apply(input, qbox, 2);
+
+    bgi::rtree<point_t, bgi::rstar<16, 4> > rt(input);
+    std::string const data = save_to_string(rt);
+
+    // the data may be loaded into the tree with compatible parameters
+    {
+        bgi::rtree<point_t, bgi::linear<32, 2> > loaded;
+        load_from_string(loaded, data);
+        check_loaded(loaded, rt);
+    }
+
+    bgi::rtree<point_t, bgi::quadratic<8, 3> > other(input.begin(), input.begin() + 10);
+    std::vector<point_t> other_values(other.begin(), other.end());
+
+    // incompatible parameters
+    BOOST_CHECK_THROW(load_from_string(other, data), std::runtime_error);
+    // truncated data
+    BOOST_CHECK_THROW(load_from_string(rt, data.substr(0, data.size() - 1)), std::runtime_error);
+    BOOST_CHECK_THROW(load_from_string(rt, data.substr(0, 10)), std::runtime_error);
+    // different Value type
+    {
+        bgi::rtree<point_f_t, bgi::rstar<16, 4> > rtf;
+        BOOST_CHECK_THROW(load_from_string(rtf, data), std::runtime_error);
+    }
+    // corrupted data
+    {
+        std::string corrupted = data;
+        corrupted[0] = 'X';
+        BOOST_CHECK_THROW(load_from_string(rt, corrupted), std::runtime_error);
+    }
+
+    // the content isn't modified if an exception is thrown
+    BOOST_CHECK_EQUAL(other.size(), 10u);
+    std::vector<point_t> output(other.begin(), other.end());
+    basictest::compare_outputs(other, output, other_values);
+    BOOST_CHECK_EQUAL(rt.size(), input.size());
+}
+
+int test_main(int, char* [])
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+    typedef bg::model::box<point_t> box_t;
+    typedef std::pair<box_t, int> pair_t;
+
+    test_binary< point_t, bgi::linear<4, 2> >();
+    test_binary< box_t, bgi::quadratic<8, 3> >();
+    test_binary< pair_t, bgi::rstar<8, 3> >();
+    test_binary<point_t>(bgi::dynamic_linear(4, 2));
+    test_binary<pair_t>(bgi::dynamic_rstar(8, 3));
+    test_binary<pair_t>(bgi::augmented<bgi::quadratic<8, 3>, weight_sum>());
+
+    test_errors();
+
+    return 0;
+}
@@ -0,0 +1,132 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <rtree/test_rtree.hpp>
+
+#include <boost/geometry/geometries/linestring.hpp>
+#include <boost/geometry/geometries/polygon.hpp>
+
+#include <boost/geometry/index/cached_envelope.hpp>
+
+#include <boost/geometry/index/detail/rtree/utilities/are_boxes_ok.hpp>
+
+typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+typedef bg::model::box<point_t> box_t;
+typedef bg::model::polygon<point_t> polygon_t;
+typedef bg::model::linestring<point_t> linestring_t;
+
+template <typename Geometry>
+struct make_geometry {};
+
+template <>
+struct make_geometry<polygon_t>
+{
+    static polygon_t apply(double x, double y)
+    {
+        polygon_t p;
+        bg::append(p, point_t(x, y));
+        bg::append(p, point_t(x + 0.5, y + 1));
+        bg::append(p, point_t(x + 1, y));
+        bg::append(p, point_t(x, y));
+        return p;
+    }
+};
+
+template <>
+struct make_geometry<linestring_t>
+{
+    static linestring_t apply(double x, double y)
+    {
+        linestring_t ls;
+        bg::append(ls, point_t(x, y));
+        bg::append(ls, point_t(x + 1, y + 0.5));
+        bg::append(ls, point_t(x + 0.5, y + 1.5));
+        return ls;
+    }
+};
+
+template <typename Geometry>
+inline bgi::cached_envelope<Geometry> make_value(int i, bgi::cached_envelope<Geometry> const*)
+{
+    return bgi::cached_envelope<Geometry>(make_geometry<Geometry>::apply(i % 17 * 2, i / 17 * 2));
+}
+
+template <typename Geometry>
+inline std::pair<bgi::cached_envelope<Geometry>, int> make_value(int i, std::pair<bgi::cached_envelope<Geometry>, int> const*)
+{
+    return std::make_pair(make_value(i, static_cast<bgi::cached_envelope<Geometry> const*>(0)), i);
+}
+
+template <typename Value, typename Params>
+void test_cached_envelope(Params const& params = Params())
+{
+    typedef bgi::rtree<Value, Params> rtree_t;
+
+    BOOST_MPL_ASSERT((boost::is_same<typename rtree_t::bounds_type, box_t>));
+
+    std::vector<Value> values;
+    for ( int i = 0 ; i < 300 ; ++i )
+        values.push_back(make_value(i, static_cast<Value const*>(0)));
+
+    bgi::indexable<Value> getter;
+
+    BOOST_CHECK(bg::equals(getter(values[0]), bg::return_envelope<box_t>(getter(values[0]))));
+
+    rtree_t rt(params);
+    rt.insert(values.begin(), values.end());
+    rtree_t packed(values, params);
+
+    box_t const qbox(point_t(5, 5), point_t(15, 10));
+    std::vector<Value> expected;
+    for ( std::size_t i = 0 ; i < values.size() ; ++i )
+        if ( bg::intersects(getter(values[i]), qbox) )
+            expected.push_back(values[i]);
+
+    BOOST_CHECK(bgi::detail::rtree::utilities::are_boxes_ok(rt));
+    BOOST_CHECK(bgi::detail::rtree::utilities::are_boxes_ok(packed));
+
+    std::vector<Value> output;
+    rt.query(bgi::intersects(qbox), std::back_inserter(output));
+    basictest::compare_outputs(rt, output, expected);
+
+    output.clear();
+    packed.query(bgi::intersects(qbox), std::back_inserter(output));
+    basictest::compare_outputs(packed, output, expected);
+
+    output.clear();
+    rt.query(bgi::nearest(point_t(0, 0), 1), std::back_inserter(output));
+    BOOST_CHECK_EQUAL(output.size(), 1u);
+    BOOST_CHECK(output.size() == 1 && rt.value_eq()(output[0], values[0]));
+
+    // the values are compared using the geometries
+    BOOST_CHECK_EQUAL(rt.remove(values.begin(), values.begin() + 100), 100u);
+    BOOST_CHECK_EQUAL(rt.remove(values[0]), 0u);
+    BOOST_CHECK_EQUAL(rt.size(), 200u);
+    BOOST_CHECK_EQUAL(rt.count(values[150]), 1u);
+    BOOST_CHECK(bgi::detail::rtree::utilities::are_boxes_ok(rt));
+}
+
+int test_main(int, char* [])
+{
+    typedef bgi::cached_envelope<polygon_t> poly_value;
+    typedef bgi::cached_envelope<linestring_t> ls_value;
+    typedef std::pair<poly_value, int> poly_pair;
+
+    test_cached_envelope< poly_value, bgi::linear<4, 2> >();
+    test_cached_envelope< ls_value, bgi::quadratic<8, 3> >();
+    test_cached_envelope< poly_pair, bgi::rstar<8, 3> >();
+    test_cached_envelope<ls_value>(bgi::dynamic_rstar(4, 2));
+
+    // the envelope is cached once per value
+    poly_value v(make_geometry<polygon_t>::apply(0, 0));
+    BOOST_CHECK(&bgi::indexable<poly_value>()(v) == &v.envelope());
+    BOOST_CHECK(bg::equals(v.envelope(), box_t(point_t(0, 0), point_t(1, 1))));
+
+    return 0;
+}
@@ -0,0 +1,259 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <rtree/test_rtree.hpp>
+
+#include <sstream>
+
+#include <boost/type_traits/aligned_storage.hpp>
+
+#include <boost/geometry/index/detail/rtree/flat/flat_view.hpp>
+
+namespace bgif = bgi::detail::rtree::flat;
+
+struct aligned_buffer
+{
+    typedef typename boost::aligned_storage<16, 16>::type chunk_type;
+
+    explicit aligned_buffer(std::string const& str)
+        : chunks(str.size() / sizeof(chunk_type) + 1)
+    {
+        std::memcpy(data(), str.data(), str.size());
+    }
+
+    void * data() { return &chunks[0]; }
+
+    std::vector<chunk_type> chunks;
+};
+
+template <typename Value, typename Point>
+double distance_to(Value const& v, Point const& pt)
+{
+    return bg::comparable_distance(pt, v);
+}
+
+template <typename Rtree, typename View, typename Box>
+void check_queries(Rtree const& rt, View const& view, Box const& qbox)
+{
+    typedef typename Rtree::value_type value_t;
+    typedef typename bg::point_type<Box>::type point_t;
+
+    BOOST_CHECK_EQUAL(rt.size(), view.size());
+    BOOST_CHECK_EQUAL(rt.empty(), view.empty());
+    BOOST_CHECK(bg::equals(rt.bounds(), view.bounds()));
+    BOOST_CHECK_EQUAL(bgi::detail::rtree::utilities::view<Rtree>(rt).depth(), view.depth());
+
+    // spatial query, the structure of the tree is preserved so the order is the same
+    {
+        std::vector<value_t> expected, result, result_it;
+        rt.query(bgi::intersects(qbox), std::back_inserter(expected));
+        size_t n = view.query(bgi::intersects(qbox), std::back_inserter(result));
+        basictest::copy_alt(view.qbegin(bgi::intersects(qbox)), view.qend(), std::back_inserter(result_it));
+
+        BOOST_CHECK_EQUAL(n, expected.size());
+        BOOST_CHECK(expected.size() == result.size()
+                 && std::equal(expected.begin(), expected.end(), result.begin(), bgi::equal_to<value_t>()));
+        BOOST_CHECK(expected.size() == result_it.size()
+                 && std::equal(expected.begin(), expected.end(), result_it.begin(), bgi::equal_to<value_t>()));
+    }
+
+    // other spatial predicates, the generic check of the children of a node
+    {
+        std::vector<value_t> expected, result;
+        rt.query(!bgi::disjoint(qbox) && bgi::intersects(qbox), std::back_inserter(expected));
+        view.query(!bgi::disjoint(qbox) && bgi::intersects(qbox), std::back_inserter(result));
+        BOOST_CHECK(expected.size() == result.size()
+                 && std::equal(expected.begin(), expected.end(), result.begin(), bgi::equal_to<value_t>()));
+    }
+
+    // knn query, compare distances
+    point_t pt;
+    bg::centroid(qbox, pt);
+    unsigned const ks[] = { 1, 3, 10, 1000 };
+    for ( size_t i = 0 ; i < sizeof(ks) / sizeof(unsigned) ; ++i )
+    {
+        std::vector<value_t> expected, result, result_it;
+        rt.query(bgi::nearest(pt, ks[i]), std::back_inserter(expected));
+        size_t n = view.query(bgi::nearest(pt, ks[i]), std::back_inserter(result));
+        basictest::copy_alt(view.qbegin(bgi::nearest(pt, ks[i])), view.qend(), std::back_inserter(result_it));
+
+        BOOST_CHECK_EQUAL(n, expected.size());
+        BOOST_CHECK_EQUAL(result.size(), expected.size());
+        BOOST_CHECK_EQUAL(result_it.size(), expected.size());
+        if ( result.size() != expected.size() || result_it.size() != expected.size() )
+            continue;
+
+        std::vector<double> expected_d, result_d;
+        for ( size_t j = 0 ; j < expected.size() ; ++j )
+        {
+            expected_d.push_back(distance_to(expected[j], pt));
+            result_d.push_back(distance_to(result_it[j], pt));
+            BOOST_CHECK(bg::equals(result[j], result_it[j]));
+        }
+        // the values are returned sorted
+        for ( size_t j = 1 ; j < result_d.size() ; ++j )
+            BOOST_CHECK(result_d[j - 1] <= result_d[j]);
+        std::sort(expected_d.begin(), expected_d.end());
+        BOOST_CHECK(expected_d == result_d);
+    }
+
+    // knn query with spatial predicate
+    {
+        std::vector<value_t> expected, result;
+        rt.query(bgi::nearest(pt, 5) && bgi::disjoint(qbox), std::back_inserter(expected));
+        view.query(bgi::nearest(pt, 5) && bgi::disjoint(qbox), std::back_inserter(result));
+        BOOST_CHECK_EQUAL(result.size(), expected.size());
+        for ( size_t j = 0 ; j < result.size() ; ++j )
+            BOOST_CHECK(bg::disjoint(result[j], qbox));
+    }
+}
+
+template <typename Value, typename Params>
+void test_flat_view(Params const& params = Params())
+{
+    typedef bgi::rtree<Value, Params> rtree_t;
+    typedef bgif::flat_view<Value> view_t;
+    typedef typename rtree_t::bounds_type box_t;
+
+    std::vector<Value> input;
+    box_t qbox;
+    generate::input<2>::apply(input, qbox, 10);
+
+    unsigned const bits[] = { 0, 8, 16 };
+    for ( size_t b = 0 ; b < sizeof(bits) / sizeof(unsigned) ; ++b )
+    {
+        std::size_t const counts[] = { 0, 1, input.size() };
+        for ( size_t i = 0 ; i < sizeof(counts) / sizeof(size_t) ; ++i )
+        {
+            rtree_t rt(input.begin(), input.begin() + counts[i], params);
+
+            std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+            bgif::write_flat(rt, ss, bits[b]);
+
+            aligned_buffer buffer(ss.str());
+            view_t view(buffer.data(), ss.str().size());
+            check_queries(rt, view, qbox);
+        }
+
+        // not packed
+        {
+            rtree_t rt(params);
+            rt.insert(input);
+
+            std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+            bgif::write_flat(rt, ss, bits[b]);
+
+            aligned_buffer buffer(ss.str());
+            view_t view(buffer.data(), ss.str().size());
+            check_queries(rt, view, qbox);
+        }
+    }
+}
+
+template <typename Box>
+void test_quantized_boxes()
+{
+    typedef typename bg::point_type<Box>::type point_t;
+    typedef bgi::rtree<Box, bgi::rstar<8> > rtree_t;
+    typedef bgif::flat_view<Box> view_t;
+
+    // small boxes far from the origin and degenerated boxes
+    std::vector<Box> input;
+    for ( int i = 0 ; i < 1000 ; ++i )
+    {
+        double const x = 1000000.0 + (i % 37) * 0.001;
+        double const y = -1000000.0 + (i / 37) * 0.001;
+        double const s = (i % 3) * 0.0001;
+        input.push_back(Box(point_t(x, y), point_t(x + s, y + s)));
+    }
+    rtree_t rt(input);
+
+    std::size_t sizes[3];
+    unsigned const bits[] = { 0, 8, 16 };
+    for ( size_t b = 0 ; b < sizeof(bits) / sizeof(unsigned) ; ++b )
+    {
+        std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+        bgif::write_flat(rt, ss, bits[b]);
+        sizes[b] = ss.str().size();
+
+        aligned_buffer buffer(ss.str());
+        view_t view(buffer.data(), ss.str().size());
+
+        // every value is found with a query of its own box
+        for ( size_t i = 0 ; i < input.size() ; ++i )
+        {
+            std::vector<Box> result;
+            view.query(bgi::intersects(input[i]), std::back_inserter(result));
+            std::vector<Box> expected;
+            rt.query(bgi::intersects(input[i]), std::back_inserter(expected));
+            BOOST_CHECK_EQUAL(result.size(), expected.size());
+        }
+
+        check_queries(rt, view, input[500]);
+    }
+
+    BOOST_CHECK_LT(sizes[1], sizes[2]);
+    BOOST_CHECK_LT(sizes[2], sizes[0]);
+}
+
+void test_invalid()
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+    typedef bg::model::box<point_t> box_t;
+
+    bgi::rtree<box_t, bgi::linear<4> > rt;
+    rt.insert(box_t(point_t(0, 0), point_t(1, 1)));
+
+    std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+    bgif::write_flat(rt, ss);
+    std::string const str = ss.str();
+
+    aligned_buffer buffer(str);
+
+    // too small
+    BOOST_CHECK_THROW(bgif::flat_view<box_t>(buffer.data(), 10), std::invalid_argument);
+    // different Value
+    BOOST_CHECK_THROW(bgif::flat_view<point_t>(buffer.data(), str.size()), std::invalid_argument);
+    // truncated
+    BOOST_CHECK_THROW(bgif::flat_view<box_t>(buffer.data(), str.size() - 1), std::invalid_argument);
+    // not aligned
+    BOOST_CHECK_THROW(bgif::flat_view<box_t>(static_cast<char*>(buffer.data()) + 1, str.size() - 1), std::invalid_argument);
+    // unsupported quantization
+    {
+        std::stringstream ss2(std::ios::in | std::ios::out | std::ios::binary);
+        BOOST_CHECK_THROW(bgif::write_flat(rt, ss2, 4), std::invalid_argument);
+
+        typedef bg::model::point<int, 2, bg::cs::cartesian> ipoint_t;
+        bgi::rtree<ipoint_t, bgi::linear<4> > irt;
+        BOOST_CHECK_THROW(bgif::write_flat(irt, ss2, 16), std::invalid_argument);
+    }
+    // not recognized
+    static_cast<char*>(buffer.data())[0] = 'X';
+    BOOST_CHECK_THROW(bgif::flat_view<box_t>(buffer.data(), str.size()), std::invalid_argument);
+}
+
+int test_main(int, char* [])
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+    typedef bg::model::box<point_t> box_t;
+
+    test_flat_view< point_t, bgi::linear<4, 2> >();
+    test_flat_view< box_t, bgi::quadratic<8, 3> >();
+    test_flat_view< box_t, bgi::rstar<16, 4> >();
+    test_flat_view<point_t>(bgi::dynamic_rstar(16, 4));
+    // the envelopes of values are not exact
+    test_flat_view< bg::model::segment<point_t>, bgi::quadratic<8, 3> >();
+
+    test_quantized_boxes<box_t>();
+    test_quantized_boxes< bg::model::box< bg::model::point<float, 2, bg::cs::cartesian> > >();
+
+    test_invalid();
+
+    return 0;
+}
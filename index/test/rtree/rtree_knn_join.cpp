@@ -0,0 +1,205 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <rtree/test_rtree.hpp>
+
+#include <algorithm>
+
+// The neighbors of a query are compared by distances because of ties
+template <typename Rtree, typename Point, typename Pairs>
+void check_neighbors(Rtree const& rt, Point const& pt, unsigned k,
+                     Pairs const& pairs, std::size_t first, std::size_t last)
+{
+    typedef typename Rtree::value_type value_t;
+
+    std::vector<value_t> expected;
+    rt.query(bgi::nearest(pt, k), std::back_inserter(expected));
+
+    BOOST_CHECK_EQUAL(last - first, expected.size());
+    if ( last - first != expected.size() )
+        return;
+
+    std::vector<double> expected_dist, dist;
+    for ( std::size_t i = 0 ; i < expected.size() ; ++i )
+    {
+        expected_dist.push_back(bg::comparable_distance(pt, rt.indexable_get()(expected[i])));
+        dist.push_back(bg::comparable_distance(pt, rt.indexable_get()(pairs[first + i].second)));
+    }
+    std::sort(expected_dist.begin(), expected_dist.end());
+    std::sort(dist.begin(), dist.end());
+    for ( std::size_t i = 0 ; i < dist.size() ; ++i )
+        BOOST_CHECK_CLOSE(dist[i], expected_dist[i], 0.0001);
+}
+
+template <typename Pairs>
+bool equal_pairs(Pairs const& p1, Pairs const& p2)
+{
+    if ( p1.size() != p2.size() )
+        return false;
+    for ( std::size_t i = 0 ; i < p1.size() ; ++i )
+    {
+        if ( ! bg::equals(p1[i].first, p2[i].first)
+          || ! bgi::equal_to<typename Pairs::value_type::second_type>()(p1[i].second, p2[i].second) )
+            return false;
+    }
+    return true;
+}
+
+template <typename Rtree, typename Points>
+void test_points(Rtree const& rt, Points const& points, unsigned k)
+{
+    typedef typename Rtree::value_type value_t;
+    typedef typename Points::value_type point_t;
+    typedef std::vector< std::pair<point_t, value_t> > pairs_t;
+
+    pairs_t result;
+    std::size_t const count = bgi::knn_join(rt, points, k, std::back_inserter(result));
+    BOOST_CHECK_EQUAL(count, result.size());
+    BOOST_CHECK_EQUAL(count, points.size() * (std::min)(std::size_t(k), rt.size()));
+
+    // the pairs are written in the order of points
+    std::size_t first = 0;
+    for ( std::size_t i = 0 ; i < points.size() ; ++i )
+    {
+        std::size_t last = first;
+        while ( last < result.size() && bg::equals(result[last].first, points[i]) && last - first < k )
+            ++last;
+        check_neighbors(rt, points[i], k, result, first, last);
+        first = last;
+    }
+
+    // the same result is returned by many threads
+    for ( std::size_t threads = 2 ; threads <= 4 ; threads += 2 )
+    {
+        pairs_t par_result;
+        BOOST_CHECK_EQUAL(bgi::knn_join(rt, points, k, std::back_inserter(par_result), bgi::parallel(threads)), count);
+        BOOST_CHECK(equal_pairs(par_result, result));
+    }
+}
+
+template <typename Rtree, typename QueryRtree>
+void test_rtrees(Rtree const& rt, QueryRtree const& query_rt, unsigned k)
+{
+    typedef typename Rtree::value_type value_t;
+    typedef typename QueryRtree::value_type query_value_t;
+    typedef std::vector< std::pair<query_value_t, value_t> > pairs_t;
+
+    pairs_t result;
+    std::size_t const count = bgi::knn_join(rt, query_rt, k, std::back_inserter(result));
+    BOOST_CHECK_EQUAL(count, result.size());
+    BOOST_CHECK_EQUAL(count, query_rt.size() * (std::min)(std::size_t(k), rt.size()));
+
+    // each value of the query tree is passed once
+    std::vector<query_value_t> queries;
+    for ( std::size_t i = 0 ; i < result.size() ; i += (std::min)(std::size_t(k), rt.size()) )
+    {
+        queries.push_back(result[i].first);
+        check_neighbors(rt, query_rt.indexable_get()(result[i].first), k, result,
+                        i, i + (std::min)(std::size_t(k), rt.size()));
+    }
+    std::vector<query_value_t> all(query_rt.begin(), query_rt.end());
+    basictest::compare_outputs(query_rt, queries, all);
+
+    pairs_t par_result;
+    BOOST_CHECK_EQUAL(bgi::knn_join(rt, query_rt, k, std::back_inserter(par_result), bgi::parallel(3)), count);
+    BOOST_CHECK_EQUAL(par_result.size(), result.size());
+    for ( std::size_t i = 0 ; i < result.size() && i < par_result.size() ; ++i )
+    {
+        BOOST_CHECK(query_rt.value_eq()(par_result[i].first, result[i].first));
+        BOOST_CHECK(rt.value_eq()(par_result[i].second, result[i].second));
+    }
+}
+
+template <typename Value, typename Params>
+void test_knn_join(Params const& params = Params())
+{
+    typedef bgi::rtree<Value, Params> rtree_t;
+    typedef typename rtree_t::bounds_type box_t;
+    typedef typename bg::point_type<box_t>::type point_t;
+    typedef std::pair<point_t, int> query_value_t;
+
+    std::vector<Value> input;
+    box_t qbox;
+    generate::input<2>::apply(input, qbox, 3);
+    rtree_t rt(input, params);
+
+    // the points inside and outside the tree
+    std::vector<point_t> points;
+    std::vector<query_value_t> query_values;
+    for ( int i = -5 ; i < 45 ; i += 2 )
+    {
+        for ( int j = -3 ; j < 80 ; j += 7 )
+        {
+            points.push_back(point_t(i + 0.5, j + 0.25));
+            query_values.push_back(query_value_t(points.back(), static_cast<int>(points.size())));
+        }
+    }
+
+    test_points(rt, points, 1);
+    test_points(rt, points, 5);
+    test_points(rt, points, static_cast<unsigned>(input.size() + 10));
+
+    bgi::rtree<query_value_t, bgi::quadratic<8, 3> > query_rt(query_values);
+    test_rtrees(rt, query_rt, 3);
+    test_rtrees(rt, query_rt, 20);
+
+    // the tree containing only the root
+    rtree_t small(input.begin(), input.begin() + 3, params);
+    test_points(small, points, 2);
+    test_rtrees(small, query_rt, 2);
+
+    // nothing is found
+    rtree_t empty(params);
+    std::vector< std::pair<point_t, Value> > result;
+    BOOST_CHECK_EQUAL(bgi::knn_join(empty, points, 3, std::back_inserter(result)), 0u);
+    BOOST_CHECK_EQUAL(bgi::knn_join(rt, points, 0, std::back_inserter(result)), 0u);
+    BOOST_CHECK_EQUAL(bgi::knn_join(rt, std::vector<point_t>(), 3, std::back_inserter(result), bgi::parallel(2)), 0u);
+    BOOST_CHECK(result.empty());
+}
+
+void test_self_join()
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+    typedef bgi::rtree<point_t, bgi::rstar<8, 3> > rtree_t;
+
+    std::vector<point_t> input;
+    bg::model::box<point_t> qbox;
+    generate::input<2>::apply(input, qbox, 4);
+    rtree_t rt(input);
+
+    // k-nearest neighbors graph, each point is one of its own neighbors
+    std::vector< std::pair<point_t, point_t> > graph;
+    BOOST_CHECK_EQUAL(bgi::knn_join(rt, rt, 4, std::back_inserter(graph), bgi::parallel(2)), input.size() * 4);
+    for ( std::size_t i = 0 ; i < graph.size() ; i += 4 )
+    {
+        bool found = false;
+        for ( std::size_t j = i ; j < i + 4 ; ++j )
+        {
+            BOOST_CHECK(bg::equals(graph[j].first, graph[i].first));
+            found = found || bg::equals(graph[j].first, graph[j].second);
+        }
+        BOOST_CHECK(found);
+    }
+}
+
+int test_main(int, char* [])
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+    typedef bg::model::box<point_t> box_t;
+    typedef std::pair<box_t, int> pair_t;
+
+    test_knn_join< point_t, bgi::linear<4, 2> >();
+    test_knn_join< box_t, bgi::quadratic<8, 3> >();
+    test_knn_join< pair_t, bgi::rstar<8, 3> >();
+    test_knn_join<point_t>(bgi::dynamic_rstar(16, 4));
+
+    test_self_join();
+
+    return 0;
+}
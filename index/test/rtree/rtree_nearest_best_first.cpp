@@ -0,0 +1,32 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_GEOMETRY_INDEX_RTREE_BEST_FIRST_DISTANCE_QUERY
+
+#include <rtree/test_rtree.hpp>
+
+int test_main(int, char* [])
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> P2d;
+    typedef bg::model::box<P2d> B2d;
+    typedef bg::model::point<double, 3, bg::cs::cartesian> P3d;
+
+    BOOST_CHECK((boost::is_same
+        <
+            bgi::detail::rtree::visitors::distance_query_default_tag,
+            bgi::detail::rtree::visitors::distance_query_best_first_tag
+        >::value));
+
+    testset::queries<P2d>(bgi::linear<5, 2>(), std::allocator<int>());
+    testset::queries<B2d>(bgi::quadratic<5, 2>(), std::allocator<int>());
+    testset::queries<P3d>(bgi::rstar<5, 2>(), std::allocator<int>());
+    testset::queries<B2d>(bgi::dynamic_rstar(5, 2), std::allocator<int>());
+
+    return 0;
+}
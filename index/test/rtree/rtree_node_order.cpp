@@ -0,0 +1,285 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <rtree/test_rtree.hpp>
+
+#include <map>
+
+#include <boost/geometry/index/node_pool_allocator.hpp>
+#include <boost/geometry/index/pack_external.hpp>
+
+#include <boost/geometry/index/detail/rtree/utilities/are_boxes_ok.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/are_counts_ok.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/are_levels_ok.hpp>
+
+// The sizes and sequence numbers of the allocated blocks
+typedef std::map<const char *, std::pair<std::size_t, std::size_t> > allocations_map;
+allocations_map allocations;
+std::size_t allocations_counter = 0;
+
+template <typename T>
+class recording_allocator
+    : public std::allocator<T>
+{
+public:
+    typedef std::size_t size_type;
+    typedef T * pointer;
+
+    template <typename U>
+    struct rebind
+    {
+        typedef recording_allocator<U> other;
+    };
+
+    recording_allocator() {}
+
+    template <typename U>
+    recording_allocator(recording_allocator<U> const&) {}
+
+    pointer allocate(size_type n, const void * = 0)
+    {
+        pointer p = std::allocator<T>::allocate(n);
+        allocations[reinterpret_cast<const char *>(p)] = std::make_pair(n * sizeof(T), allocations_counter++);
+        return p;
+    }
+
+    void deallocate(pointer p, size_type n)
+    {
+        allocations.erase(reinterpret_cast<const char *>(p));
+        std::allocator<T>::deallocate(p, n);
+    }
+};
+
+// The sequence number of the block containing the object
+inline std::size_t allocation_number(const void * ptr)
+{
+    const char * p = static_cast<const char *>(ptr);
+    allocations_map::const_iterator it = allocations.upper_bound(p);
+    BOOST_CHECK(it != allocations.begin());
+    --it;
+    BOOST_CHECK(p < it->first + it->second.first);
+    return it->second.second;
+}
+
+struct node_info
+{
+    std::size_t number;
+    std::size_t level;
+    std::size_t parent;     // the index of the parent in the depth-first order
+};
+
+// Gathers the nodes in depth-first order
+template <typename Value, typename Options, typename Box, typename Allocators>
+class gather_nodes
+    : public bgi::detail::rtree::visitor<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag, true>::type
+{
+    typedef typename bgi::detail::rtree::internal_node<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag>::type internal_node;
+    typedef typename bgi::detail::rtree::leaf<Value, typename Options::parameters_type, Box, Allocators, typename Options::node_tag>::type leaf;
+
+public:
+    gather_nodes() : m_level(0), m_parent(0) {}
+
+    void operator()(internal_node const& n)
+    {
+        std::size_t const index = add(&n);
+
+        std::size_t const parent = m_parent;
+        m_parent = index;
+        ++m_level;
+        for ( std::size_t i = 0 ; i < bgi::detail::rtree::elements(n).size() ; ++i )
+            bgi::detail::rtree::apply_visitor(*this, *bgi::detail::rtree::elements(n)[i].second);
+        --m_level;
+        m_parent = parent;
+    }
+
+    void operator()(leaf const& n)
+    {
+        add(&n);
+    }
+
+    std::vector<node_info> nodes;
+
+private:
+    std::size_t add(const void * ptr)
+    {
+        node_info info;
+        info.number = allocation_number(ptr);
+        info.level = m_level;
+        info.parent = m_parent;
+        nodes.push_back(info);
+        return nodes.size() - 1;
+    }
+
+    std::size_t m_level;
+    std::size_t m_parent;
+};
+
+struct level_less
+{
+    level_less(std::vector<node_info> const& n) : nodes(n) {}
+    bool operator()(std::size_t l, std::size_t r) const
+    {
+        return nodes[l].level < nodes[r].level || ( nodes[l].level == nodes[r].level && l < r );
+    }
+    std::vector<node_info> const& nodes;
+};
+
+template <typename Rtree>
+inline std::size_t depth(Rtree const& rt)
+{
+    return bgi::detail::rtree::utilities::view<Rtree>(rt).depth();
+}
+
+template <typename Rtree>
+void check_node_order(Rtree const& rt, bgi::packing::node_order_type order)
+{
+    typedef bgi::detail::rtree::utilities::view<Rtree> RTV;
+    RTV rtv(rt);
+
+    gather_nodes
+        <
+            typename RTV::value_type,
+            typename RTV::options_type,
+            typename RTV::box_type,
+            typename RTV::allocators_type
+        > gather_v;
+    rtv.apply_visitor(gather_v);
+    std::vector<node_info> const& nodes = gather_v.nodes;
+
+    // the parents are allocated before the children
+    for ( std::size_t i = 1 ; i < nodes.size() ; ++i )
+        BOOST_CHECK_LT(nodes[nodes[i].parent].number, nodes[i].number);
+
+    if ( order == bgi::packing::breadth_first )
+    {
+        // the nodes are allocated level by level
+        std::vector<std::size_t> indexes;
+        for ( std::size_t i = 0 ; i < nodes.size() ; ++i )
+            indexes.push_back(i);
+        std::sort(indexes.begin(), indexes.end(), level_less(nodes));
+        for ( std::size_t i = 1 ; i < indexes.size() ; ++i )
+            BOOST_CHECK_LT(nodes[indexes[i - 1]].number, nodes[indexes[i]].number);
+    }
+    else if ( order == bgi::packing::van_emde_boas )
+    {
+        // the leafs are allocated right after their parent, the subtrees are contiguous
+        std::size_t const leafs_level = rtv.depth();
+        for ( std::size_t i = 1 ; i < nodes.size() ; ++i )
+        {
+            if ( nodes[i].level == leafs_level )
+                BOOST_CHECK_EQUAL(nodes[i].number, nodes[i - 1].number + 1);
+        }
+    }
+}
+
+template <typename Value, typename Params, typename Allocator>
+void test_node_order(Params const& params = Params(), Allocator const& allocator = Allocator())
+{
+    typedef bgi::rtree<Value, Params, bgi::indexable<Value>, bgi::equal_to<Value>, Allocator> rtree_t;
+    typedef typename rtree_t::bounds_type box_t;
+
+    std::vector<Value> input;
+    box_t qbox;
+    generate::input<2>::apply(input, qbox, 6);
+
+    bgi::packing::node_order_type const orders[] = { bgi::packing::creation_order,
+                                                     bgi::packing::breadth_first,
+                                                     bgi::packing::van_emde_boas };
+    bgi::packing::algorithm_type const algorithms[] = { bgi::packing::top_down, bgi::packing::hilbert };
+
+    for ( std::size_t a = 0 ; a < 2 ; ++a )
+    {
+        rtree_t const expected(input, bgi::packing(algorithms[a]), params,
+                               bgi::indexable<Value>(), bgi::equal_to<Value>(), allocator);
+
+        std::vector<Value> expected_output;
+        expected.query(bgi::intersects(qbox), std::back_inserter(expected_output));
+
+        for ( std::size_t o = 0 ; o < 3 ; ++o )
+        {
+            bgi::packing const pack(algorithms[a], bgi::parallel(1), orders[o]);
+            rtree_t rt(input, pack, params, bgi::indexable<Value>(), bgi::equal_to<Value>(), allocator);
+
+            BOOST_CHECK_EQUAL(rt.size(), input.size());
+            BOOST_CHECK_EQUAL(depth(rt), depth(expected));
+            BOOST_CHECK(bg::equals(rt.bounds(), expected.bounds()));
+            BOOST_CHECK(bgi::detail::rtree::utilities::are_boxes_ok(rt));
+            BOOST_CHECK(bgi::detail::rtree::utilities::are_levels_ok(rt));
+            BOOST_CHECK(bgi::detail::rtree::utilities::are_counts_ok(rt));
+
+            std::vector<Value> output;
+            rt.query(bgi::intersects(qbox), std::back_inserter(output));
+            basictest::compare_outputs(rt, output, expected_output);
+
+            // the order is also used by repack()
+            rt.repack(pack);
+            BOOST_CHECK_EQUAL(rt.size(), input.size());
+            BOOST_CHECK(bgi::detail::rtree::utilities::are_boxes_ok(rt));
+
+            // the tree may be modified
+            rt.remove(input.begin(), input.begin() + input.size() / 2);
+            rt.insert(input.begin(), input.begin() + input.size() / 2);
+            BOOST_CHECK_EQUAL(rt.size(), input.size());
+            BOOST_CHECK(bgi::detail::rtree::utilities::are_boxes_ok(rt));
+        }
+    }
+}
+
+template <typename Value, typename Params>
+void test_recorded_node_order(Params const& params = Params())
+{
+    typedef recording_allocator<Value> allocator_t;
+    typedef bgi::rtree<Value, Params, bgi::indexable<Value>, bgi::equal_to<Value>, allocator_t> rtree_t;
+    typedef typename rtree_t::bounds_type box_t;
+
+    std::vector<Value> input;
+    box_t qbox;
+    generate::input<2>::apply(input, qbox, 6);
+
+    bgi::packing::node_order_type const orders[] = { bgi::packing::creation_order,
+                                                     bgi::packing::breadth_first,
+                                                     bgi::packing::van_emde_boas };
+    for ( std::size_t o = 0 ; o < 3 ; ++o )
+    {
+        rtree_t rt(input, bgi::packing(bgi::packing::hilbert, bgi::parallel(1), orders[o]), params);
+        BOOST_CHECK_GT(depth(rt), 2u);
+        check_node_order(rt, orders[o]);
+    }
+
+    // the nodes created from the temporary files are reordered as well
+    for ( std::size_t o = 1 ; o < 3 ; ++o )
+    {
+        rtree_t rt(params);
+        bgi::pack_external(rt, input.begin(), input.end(), input.size() / 3,
+                           bgi::packing(bgi::packing::hilbert, bgi::parallel(1), orders[o]));
+        BOOST_CHECK_EQUAL(rt.size(), input.size());
+        BOOST_CHECK(bgi::detail::rtree::utilities::are_boxes_ok(rt));
+        check_node_order(rt, orders[o]);
+    }
+}
+
+int test_main(int, char* [])
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+    typedef bg::model::box<point_t> box_t;
+    typedef std::pair<box_t, int> pair_t;
+
+    test_node_order< point_t, bgi::linear<4, 2>, std::allocator<point_t> >();
+    test_node_order< box_t, bgi::quadratic<8, 3>, std::allocator<box_t> >();
+    test_node_order< pair_t, bgi::rstar<8, 3>, std::allocator<pair_t> >();
+    test_node_order< point_t, bgi::dynamic_linear, std::allocator<point_t> >(bgi::dynamic_linear(4, 2));
+    test_node_order< pair_t, bgi::augmented<bgi::quadratic<6, 2> >, std::allocator<pair_t> >();
+    test_node_order< point_t, bgi::rstar<8, 3>, bgi::node_pool_allocator<point_t> >();
+
+    // the static nodes are allocated one by one
+    test_recorded_node_order< point_t, bgi::linear<4, 2> >();
+    test_recorded_node_order< pair_t, bgi::rstar<8, 3> >();
+
+    return 0;
+}
@@ -0,0 +1,106 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <rtree/test_rtree.hpp>
+
+#include <boost/geometry/index/node_pool_allocator.hpp>
+
+#include <boost/geometry/index/detail/rtree/utilities/are_boxes_ok.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/are_counts_ok.hpp>
+
+template <typename Value, typename Params>
+void test_pool(Params const& params = Params())
+{
+    typedef bgi::node_pool_allocator<Value> allocator_t;
+    typedef bgi::rtree<Value, Params, bgi::indexable<Value>, bgi::equal_to<Value>, allocator_t> rtree_t;
+    typedef typename rtree_t::bounds_type box_t;
+
+    std::vector<Value> input;
+    box_t qbox;
+    generate::input<2>::apply(input, qbox, 4);
+
+    allocator_t allocator;
+    rtree_t rt(params, bgi::indexable<Value>(), bgi::equal_to<Value>(), allocator);
+    BOOST_CHECK(rt.get_allocator() == allocator);
+    BOOST_CHECK_EQUAL(allocator.blocks_count(), 0u);
+
+    rt.insert(input);
+    BOOST_CHECK(bgi::detail::rtree::utilities::are_boxes_ok(rt));
+    BOOST_CHECK(bgi::detail::rtree::utilities::are_counts_ok(rt));
+    BOOST_CHECK_GT(allocator.blocks_count(), 0u);
+    BOOST_CHECK_GT(allocator.slabs_count(), 0u);
+
+    // the memory is still used
+    BOOST_CHECK(! allocator.release());
+
+    // the copy shares the pool
+    {
+        std::size_t const blocks_count = allocator.blocks_count();
+        rtree_t copied(rt);
+        BOOST_CHECK(copied.get_allocator() == allocator);
+        BOOST_CHECK_EQUAL(allocator.blocks_count(), 2 * blocks_count);
+        BOOST_CHECK_EQUAL(copied.size(), rt.size());
+
+        // the copy with a different allocator uses its own pool
+        allocator_t other;
+        rtree_t copied_other(rt, other);
+        BOOST_CHECK(copied_other.get_allocator() != allocator);
+        BOOST_CHECK_EQUAL(other.blocks_count(), blocks_count);
+    }
+
+    // the freed nodes are reused
+    std::size_t const slabs_count = allocator.slabs_count();
+    rt.remove(input.begin(), input.begin() + input.size() / 2);
+    rt.insert(input.begin(), input.begin() + input.size() / 2);
+    BOOST_CHECK(bgi::detail::rtree::utilities::are_boxes_ok(rt));
+    BOOST_CHECK_EQUAL(rt.size(), input.size());
+    BOOST_CHECK_LE(allocator.slabs_count(), slabs_count + 1);
+
+    // all nodes are deallocated
+    rt.clear();
+    BOOST_CHECK_EQUAL(allocator.blocks_count(), 0u);
+    BOOST_CHECK(allocator.release());
+    BOOST_CHECK_EQUAL(allocator.slabs_count(), 0u);
+
+    // the pool may be used again
+    rt.insert(input);
+    BOOST_CHECK(bgi::detail::rtree::utilities::are_boxes_ok(rt));
+
+    // packing, possibly using many threads
+    rtree_t packed(input, bgi::parallel(4), params, bgi::indexable<Value>(), bgi::equal_to<Value>(), allocator);
+    BOOST_CHECK(bgi::detail::rtree::utilities::are_boxes_ok(packed));
+    BOOST_CHECK(bgi::detail::rtree::utilities::are_counts_ok(packed));
+    BOOST_CHECK_EQUAL(packed.size(), input.size());
+}
+
+template <typename Point, typename Params>
+void test_rtree(Params const& params = Params())
+{
+    typedef bg::model::box<Point> box_t;
+    typedef std::pair<box_t, int> pair_t;
+
+    bgi::node_pool_allocator<int> allocator;
+    testset::modifiers<Point>(params, allocator);
+    testset::queries<box_t>(params, allocator);
+
+    test_pool<Point>(params);
+    test_pool<pair_t>(params);
+}
+
+int test_main(int, char* [])
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+
+    test_rtree< point_t, bgi::linear<4, 2> >();
+    test_rtree< point_t, bgi::rstar<8, 3> >();
+    test_rtree<point_t>(bgi::dynamic_quadratic(4, 2));
+    test_rtree<point_t>(bgi::dynamic_rstar(16, 4));
+
+    return 0;
+}
@@ -104,6 +104,81 @@ void test_ticket_12413()
     BOOST_CHECK_EQUAL(num_removed, 1);
 }
 
+template <typename Point>
+void test_distance_near_spherical()
+{
+    typedef bg::model::box<Point> box_t;
+
+    // in the band of longitudes of the box
+    BOOST_CHECK_CLOSE(bgi::detail::comparable_distance_near_spherical(Point(5, 50), box_t(Point(0, 0), Point(10, 10))),
+                      bg::math::hav(40 * bg::math::d2r<double>()), 0.0001);
+    BOOST_CHECK_EQUAL(bgi::detail::comparable_distance_near_spherical(Point(5, 5), box_t(Point(0, 0), Point(10, 10))), 0);
+    // the box crossing the antimeridian and the point not normalized
+    BOOST_CHECK_EQUAL(bgi::detail::comparable_distance_near_spherical(Point(-175, 5), box_t(Point(170, 0), Point(190, 10))), 0);
+    BOOST_CHECK_EQUAL(bgi::detail::comparable_distance_near_spherical(Point(365, 5), box_t(Point(0, 0), Point(10, 10))), 0);
+    // the closest point behind the pole
+    BOOST_CHECK_CLOSE(bgi::detail::comparable_distance_near_spherical(Point(180, 80), box_t(Point(-10, 70), Point(10, 85))),
+                      bg::comparable_distance(Point(180, 80), Point(10, 85)), 0.0001);
+    // the point closest to the interior of the meridian segment
+    BOOST_CHECK_CLOSE(bgi::detail::comparable_distance_near_spherical(Point(20, 0), box_t(Point(-10, -10), Point(10, 10))),
+                      bg::math::hav(10 * bg::math::d2r<double>()), 0.0001);
+
+    // the same as the distance calculated by the default strategy for the box rotated
+    // to not cross the antimeridian
+    for ( int i = 0 ; i < 1000 ; ++i )
+    {
+        double const lon = i * 37 % 360 - 180.0, lat = i * 13 % 180 - 90.0;
+        double const box_lon = i * 17 % 360 - 180.0, box_lat = i * 7 % 170 - 90.0;
+        double const width = i % 30;
+        box_t const b(Point(box_lon, box_lat), Point(box_lon + width, box_lat + i % 11));
+
+        double rotated_lon = lon - box_lon - width / 2;
+        if ( rotated_lon < -180 )
+            rotated_lon += 360;
+        else if ( rotated_lon > 180 )
+            rotated_lon -= 360;
+        box_t const rotated_b(Point(-width / 2, box_lat), Point(width / 2, box_lat + i % 11));
+
+        BOOST_CHECK_CLOSE(bgi::detail::comparable_distance_near_spherical(Point(lon, lat), b) + 1,
+                          bg::comparable_distance(Point(rotated_lon, lat), rotated_b) + 1, 0.000001);
+    }
+}
+
+template <typename Point>
+void test_nearest_global()
+{
+    typedef std::pair<Point, int> value_t;
+
+    std::vector<value_t> values;
+    for ( int i = 0 ; i < 2000 ; ++i )
+        values.push_back(std::make_pair(Point(i * 7919 % 3600 / 10.0 - 180, i * 104729 % 1800 / 10.0 - 90), i));
+
+    bgi::rtree<value_t, bgi::rstar<8> > rtree(values);
+
+    // the query points near the poles and the antimeridian
+    Point const query_points[] = { Point(179.9, 10), Point(-179.9, -40), Point(0, 89.9),
+                                   Point(120, -89.9), Point(-180, 90), Point(45, 30) };
+    for ( std::size_t q = 0 ; q < sizeof(query_points) / sizeof(query_points[0]) ; ++q )
+    {
+        Point const& pt = query_points[q];
+
+        std::vector<double> expected;
+        for ( std::size_t i = 0 ; i < values.size() ; ++i )
+            expected.push_back(bg::distance(pt, values[i].first));
+        std::sort(expected.begin(), expected.end());
+
+        std::vector<value_t> result;
+        rtree.query(bgi::nearest(pt, 10), std::back_inserter(result));
+        std::vector<double> dists;
+        for ( std::size_t i = 0 ; i < result.size() ; ++i )
+            dists.push_back(bg::distance(pt, result[i].first));
+        std::sort(dists.begin(), dists.end());
+
+        BOOST_CHECK_EQUAL(dists.size(), 10u);
+        BOOST_CHECK(dists.size() == 10u && std::equal(dists.begin(), dists.end(), expected.begin()));
+    }
+}
+
 template <typename Point>
 void test_cs()
 {
@@ -124,5 +199,9 @@ int test_main(int, char* [])
     test_cs<bg::model::point<double, 2, bg::cs::spherical_equatorial<bg::degree> > >();
     test_cs<bg::model::point<double, 2, bg::cs::geographic<bg::degree> > >();
 
+    test_distance_near_spherical<bg::model::point<double, 2, bg::cs::spherical_equatorial<bg::degree> > >();
+    test_nearest_global<bg::model::point<double, 2, bg::cs::spherical_equatorial<bg::degree> > >();
+    test_nearest_global<bg::model::point<double, 2, bg::cs::geographic<bg::degree> > >();
+
     return 0;
 }
@@ -0,0 +1,166 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <rtree/test_rtree.hpp>
+
+#include <boost/geometry/index/detail/rtree/utilities/are_boxes_ok.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/are_counts_ok.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/are_levels_ok.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/statistics.hpp>
+
+#include <boost/tuple/tuple_comparison.hpp>
+
+template <typename Box>
+std::vector<Box> generate_boxes(std::size_t count)
+{
+    typedef typename bg::point_type<Box>::type point_t;
+
+    std::vector<Box> result;
+    result.reserve(count);
+    for ( std::size_t i = 0 ; i < count ; ++i )
+    {
+        // clustered, not uniformly distributed data
+        double const x = static_cast<double>((i * 7919) % 1000) / ((i % 3) + 1);
+        double const y = static_cast<double>((i * 104729) % 997);
+        result.push_back(Box(point_t(x, y), point_t(x + 0.5, y + 0.5)));
+    }
+    return result;
+}
+
+template <typename Rtree>
+void check_tree(Rtree const& rt, std::vector<typename Rtree::value_type> const& input)
+{
+    namespace bgiu = bgi::detail::rtree::utilities;
+    typedef typename Rtree::value_type value_t;
+
+    BOOST_CHECK(bgiu::are_levels_ok(rt));
+    BOOST_CHECK(bgiu::are_boxes_ok(rt));
+    BOOST_CHECK(bgiu::are_counts_ok(rt));
+    BOOST_CHECK_EQUAL(rt.size(), input.size());
+
+    // the same values are returned by queries
+    value_t qbox(bg::return_centroid<typename bg::point_type<value_t>::type>(rt.bounds()),
+                 rt.bounds().max_corner());
+    std::vector<value_t> expected;
+    for ( std::size_t i = 0 ; i < input.size() ; ++i )
+        if ( bg::intersects(input[i], qbox) )
+            expected.push_back(input[i]);
+
+    std::vector<value_t> output;
+    rt.query(bgi::intersects(qbox), std::back_inserter(output));
+    basictest::compare_outputs(rt, output, expected);
+
+    typedef typename bgiu::view<Rtree>::box_type box_t;
+    typedef typename bgi::detail::default_content_result<box_t>::type content_t;
+    content_t content = 0, overlap = 0, dead_space = 0;
+    boost::tie(content, overlap, dead_space) = bgiu::quality_statistics(rt);
+    BOOST_CHECK(0 <= content && 0 <= overlap && 0 <= dead_space);
+}
+
+template <typename Rtree>
+void check_the_same(Rtree const& expected, Rtree const& rt)
+{
+    namespace bgiu = bgi::detail::rtree::utilities;
+
+    BOOST_CHECK(bgiu::statistics(expected) == bgiu::statistics(rt));
+    BOOST_CHECK(bgiu::quality_statistics(expected) == bgiu::quality_statistics(rt));
+
+    // the order of iteration reflects the structure of the tree
+    BOOST_CHECK(std::equal(expected.begin(), expected.end(), rt.begin(),
+                           bgi::equal_to<typename Rtree::value_type>()));
+}
+
+template <typename Box, typename Params>
+void test_rtree(std::size_t count, Params const& params = Params())
+{
+    namespace bgiu = bgi::detail::rtree::utilities;
+    typedef bgi::rtree<Box, Params> rtree_t;
+
+    std::vector<Box> input = generate_boxes<Box>(count);
+
+    rtree_t top_down(input, params);
+    rtree_t top_down_p(input, bgi::packing(bgi::packing::top_down), params);
+    check_the_same(top_down, top_down_p);
+
+    bgi::packing::algorithm_type const algorithms[] = { bgi::packing::hilbert, bgi::packing::morton };
+    for ( std::size_t a = 0 ; a < sizeof(algorithms) / sizeof(algorithms[0]) ; ++a )
+    {
+        rtree_t rt(input.begin(), input.end(), bgi::packing(algorithms[a]), params);
+        check_tree(rt, input);
+
+        // the same number of nodes on each level
+        BOOST_CHECK(bgiu::statistics(top_down) == bgiu::statistics(rt));
+
+        std::size_t const threads[] = { 2, 3, 8, 0 };
+        for ( std::size_t i = 0 ; i < sizeof(threads) / sizeof(std::size_t) ; ++i )
+        {
+            rtree_t rt_p(input, bgi::packing(algorithms[a], bgi::parallel(threads[i])), params);
+            check_the_same(rt, rt_p);
+        }
+
+        rtree_t empty(input.begin(), input.begin(), bgi::packing(algorithms[a]), params);
+        BOOST_CHECK(empty.empty());
+    }
+}
+
+template <typename Box>
+void test_rtree_all(std::size_t count)
+{
+    test_rtree< Box, bgi::linear<4, 2> >(count);
+    test_rtree< Box, bgi::quadratic<8, 3> >(count);
+    test_rtree< Box, bgi::rstar<16, 4> >(count);
+
+    test_rtree<Box>(count, bgi::dynamic_linear(4, 2));
+    test_rtree<Box>(count, bgi::dynamic_rstar(16, 4));
+}
+
+struct first_less
+{
+    template <typename Pair>
+    bool operator()(Pair const& l, Pair const& r) const
+    {
+        return l.first < r.first;
+    }
+};
+
+void test_radix_sort(std::size_t count, std::size_t threads)
+{
+    std::vector<std::pair<boost::uint64_t, std::size_t> > values, expected;
+    for ( std::size_t i = 0 ; i < count ; ++i )
+    {
+        boost::uint64_t const key = (boost::uint64_t(i * 7919 % 101) << 40) | (i * 104729 % 13);
+        values.push_back(std::make_pair(key, i));
+    }
+    expected = values;
+    // stable
+    std::stable_sort(expected.begin(), expected.end(), first_less());
+
+    bgi::detail::radix_sort(values, threads);
+    BOOST_CHECK(values == expected);
+}
+
+int test_main(int, char* [])
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+    typedef bg::model::box<point_t> box_t;
+    typedef bg::model::point<double, 3, bg::cs::cartesian> point3_t;
+    typedef bg::model::box<point3_t> box3_t;
+
+    test_radix_sort(0, 1);
+    test_radix_sort(1000, 1);
+    test_radix_sort(1000, 3);
+
+    test_rtree_all<box_t>(1);
+    test_rtree_all<box_t>(177);
+    test_rtree_all<box_t>(10000);
+
+    test_rtree< box3_t, bgi::quadratic<8, 3> >(1000);
+
+    return 0;
+}
@@ -0,0 +1,148 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <rtree/test_rtree.hpp>
+
+#include <boost/iterator/function_input_iterator.hpp>
+#include <boost/tuple/tuple_comparison.hpp>
+
+#include <boost/geometry/index/node_pool_allocator.hpp>
+#include <boost/geometry/index/pack_external.hpp>
+
+#include <boost/geometry/index/detail/rtree/utilities/are_boxes_ok.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/are_counts_ok.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/are_levels_ok.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/statistics.hpp>
+
+// Generates the values stored in a vector, used to create a single-pass input range.
+template <typename Value>
+struct values_generator
+{
+    typedef Value result_type;
+
+    explicit values_generator(std::vector<Value> const& v) : values(&v), index(0) {}
+
+    result_type operator()() { return (*values)[index++]; }
+
+    std::vector<Value> const* values;
+    std::size_t index;
+};
+
+template <typename Rtree>
+void check_same_trees(Rtree const& rt, Rtree const& expected)
+{
+    namespace bgiu = bgi::detail::rtree::utilities;
+
+    BOOST_CHECK(bgiu::are_levels_ok(rt));
+    BOOST_CHECK(bgiu::are_boxes_ok(rt));
+    BOOST_CHECK(bgiu::are_counts_ok(rt));
+    BOOST_CHECK_EQUAL(rt.size(), expected.size());
+    BOOST_CHECK(bgiu::statistics(rt) == bgiu::statistics(expected));
+
+    // the values are stored in the same order
+    BOOST_CHECK(std::equal(rt.begin(), rt.end(), expected.begin(), rt.value_eq()));
+}
+
+template <typename Value, typename Params>
+void test_pack_external(Params const& params = Params())
+{
+    namespace bgiu = bgi::detail::rtree::utilities;
+
+    typedef bgi::node_pool_allocator<Value> allocator_t;
+    typedef bgi::rtree<Value, Params, bgi::indexable<Value>, bgi::equal_to<Value>, allocator_t> rtree_t;
+    typedef typename rtree_t::bounds_type box_t;
+    typedef boost::function_input_iterator<values_generator<Value>, std::size_t> input_iterator;
+
+    std::vector<Value> input;
+    box_t qbox;
+    generate::input<2>::apply(input, qbox, 4);
+
+    // duplicated values have the same keys
+    input.insert(input.end(), input.begin(), input.begin() + input.size() / 3);
+
+    allocator_t allocator;
+
+    bgi::packing::algorithm_type const algorithms[] = { bgi::packing::hilbert, bgi::packing::morton };
+    std::size_t const memory_sizes[] = { 1, 7, 100, input.size() - 1, input.size() };
+
+    for ( std::size_t a = 0 ; a < sizeof(algorithms) / sizeof(algorithms[0]) ; ++a )
+    {
+        rtree_t expected(input, bgi::packing(algorithms[a]), params,
+                         bgi::indexable<Value>(), bgi::equal_to<Value>(), allocator);
+
+        for ( std::size_t m = 0 ; m < sizeof(memory_sizes) / sizeof(memory_sizes[0]) ; ++m )
+        {
+            // the previous content is replaced
+            rtree_t rt(input.begin(), input.begin() + 10, params,
+                       bgi::indexable<Value>(), bgi::equal_to<Value>(), allocator);
+
+            values_generator<Value> gen(input);
+            bgi::pack_external(rt, input_iterator(gen, 0), input_iterator(gen, input.size()),
+                               memory_sizes[m], bgi::packing(algorithms[a], bgi::parallel(2)));
+            check_same_trees(rt, expected);
+
+            // the passed bounds equal to the bounds of all values
+            rtree_t rt_bounds(params, bgi::indexable<Value>(), bgi::equal_to<Value>(), allocator);
+            bgi::pack_external(rt_bounds, input.begin(), input.end(), expected.bounds(),
+                               memory_sizes[m], bgi::packing(algorithms[a]));
+            check_same_trees(rt_bounds, expected);
+        }
+    }
+
+    // the top-down algorithm is replaced with the Hilbert curve
+    {
+        rtree_t expected(input, bgi::packing(bgi::packing::hilbert), params,
+                         bgi::indexable<Value>(), bgi::equal_to<Value>(), allocator);
+        rtree_t rt(params, bgi::indexable<Value>(), bgi::equal_to<Value>(), allocator);
+        bgi::pack_external(rt, input.begin(), input.end(), 50, bgi::packing(bgi::packing::top_down));
+        check_same_trees(rt, expected);
+    }
+
+    // bounds different than the bounds of values
+    {
+        box_t bounds = qbox;
+        bg::expand(bounds, rtree_t(input, params).bounds());
+        rtree_t rt(params, bgi::indexable<Value>(), bgi::equal_to<Value>(), allocator);
+        bgi::pack_external(rt, input.begin(), input.end(), bounds, 50);
+        BOOST_CHECK(bgiu::are_levels_ok(rt));
+        BOOST_CHECK(bgiu::are_boxes_ok(rt));
+        BOOST_CHECK(bgiu::are_counts_ok(rt));
+
+        std::vector<Value> output(rt.begin(), rt.end());
+        basictest::compare_outputs(rt, output, input);
+    }
+
+    // empty range
+    {
+        rtree_t rt(input, params, bgi::indexable<Value>(), bgi::equal_to<Value>(), allocator);
+        bgi::pack_external(rt, input.end(), input.end(), 50);
+        BOOST_CHECK(rt.empty());
+        bgi::pack_external(rt, input.end(), input.end(), qbox, 50);
+        BOOST_CHECK(rt.empty());
+    }
+
+    BOOST_CHECK_EQUAL(allocator.blocks_count(), 0u);
+}
+
+int test_main(int, char* [])
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+    typedef bg::model::box<point_t> box_t;
+    typedef std::pair<box_t, int> pair_t;
+
+    test_pack_external< point_t, bgi::linear<4, 2> >();
+    test_pack_external< box_t, bgi::quadratic<8, 3> >();
+    test_pack_external< pair_t, bgi::rstar<8, 3> >();
+    test_pack_external<point_t>(bgi::dynamic_linear(5, 2));
+
+    // the aggregates are calculated
+    test_pack_external<pair_t>(bgi::augmented< bgi::rstar<8, 3> >());
+
+    return 0;
+}
@@ -0,0 +1,99 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <rtree/test_rtree.hpp>
+
+#include <boost/geometry/index/detail/rtree/utilities/are_boxes_ok.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/are_counts_ok.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/are_levels_ok.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/statistics.hpp>
+
+#include <boost/tuple/tuple_comparison.hpp>
+
+template <typename Box>
+std::vector<Box> generate_boxes(std::size_t count)
+{
+    typedef typename bg::point_type<Box>::type point_t;
+
+    std::vector<Box> result;
+    result.reserve(count);
+    for ( std::size_t i = 0 ; i < count ; ++i )
+    {
+        // clustered, not uniformly distributed data
+        double const x = static_cast<double>((i * 7919) % 1000) / ((i % 3) + 1);
+        double const y = static_cast<double>((i * 104729) % 997);
+        result.push_back(Box(point_t(x, y), point_t(x + 0.5, y + 0.5)));
+    }
+    return result;
+}
+
+template <typename Rtree>
+void check_the_same(Rtree const& expected, Rtree const& rt)
+{
+    namespace bgiu = bgi::detail::rtree::utilities;
+
+    BOOST_CHECK(bgiu::are_levels_ok(rt));
+    BOOST_CHECK(bgiu::are_boxes_ok(rt));
+    BOOST_CHECK(bgiu::are_counts_ok(rt));
+
+    BOOST_CHECK_EQUAL(expected.size(), rt.size());
+    BOOST_CHECK(bg::equals(expected.bounds(), rt.bounds()));
+    BOOST_CHECK(bgiu::statistics(expected) == bgiu::statistics(rt));
+
+    // the order of iteration reflects the structure of the tree
+    BOOST_CHECK(std::equal(expected.begin(), expected.end(), rt.begin(),
+                           bgi::equal_to<typename Rtree::value_type>()));
+}
+
+template <typename Box, typename Params>
+void test_rtree(std::size_t count, Params const& params = Params())
+{
+    typedef bgi::rtree<Box, Params> rtree_t;
+
+    std::vector<Box> input = generate_boxes<Box>(count);
+
+    rtree_t expected(input, params);
+
+    std::size_t const threads[] = { 1, 2, 3, 4, 8, 0 };
+    for ( std::size_t i = 0 ; i < sizeof(threads) / sizeof(std::size_t) ; ++i )
+    {
+        rtree_t rt1(input.begin(), input.end(), bgi::parallel(threads[i]), params);
+        check_the_same(expected, rt1);
+
+        rtree_t rt2(input, bgi::parallel(threads[i]), params);
+        check_the_same(expected, rt2);
+    }
+
+    rtree_t empty(input.begin(), input.begin(), bgi::parallel(4), params);
+    BOOST_CHECK(empty.empty());
+}
+
+template <typename Box>
+void test_rtree_all(std::size_t count)
+{
+    test_rtree< Box, bgi::linear<4, 2> >(count);
+    test_rtree< Box, bgi::quadratic<8, 3> >(count);
+    test_rtree< Box, bgi::rstar<16, 4> >(count);
+
+    test_rtree<Box>(count, bgi::dynamic_linear(4, 2));
+    test_rtree<Box>(count, bgi::dynamic_quadratic(8, 3));
+    test_rtree<Box>(count, bgi::dynamic_rstar(16, 4));
+}
+
+int test_main(int, char* [])
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+    typedef bg::model::box<point_t> box_t;
+
+    test_rtree_all<box_t>(3);
+    test_rtree_all<box_t>(177);
+    test_rtree_all<box_t>(10000);
+
+    return 0;
+}
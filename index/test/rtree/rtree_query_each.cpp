@@ -0,0 +1,117 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <rtree/test_rtree.hpp>
+
+template <typename Value>
+struct collect_n
+{
+    collect_n(std::vector<Value> & r, std::size_t m) : result(&r), max_count(m) {}
+
+    bool operator()(Value const& v) const
+    {
+        result->push_back(v);
+        return result->size() < max_count;
+    }
+
+    std::vector<Value> * result;
+    std::size_t max_count;
+};
+
+struct any_found
+{
+    explicit any_found(bool & f) : found(&f) {}
+
+    template <typename Value>
+    bool operator()(Value const& ) const
+    {
+        *found = true;
+        return false;
+    }
+
+    bool * found;
+};
+
+template <typename Rtree, typename Predicates>
+void test_query_each(Rtree const& rt, Predicates const& pred)
+{
+    typedef typename Rtree::value_type value_t;
+
+    std::vector<value_t> expected;
+    rt.query(pred, std::back_inserter(expected));
+
+    // all values, the same order
+    {
+        std::vector<value_t> result;
+        std::size_t n = rt.query_each(pred, collect_n<value_t>(result, (std::numeric_limits<std::size_t>::max)()));
+        BOOST_CHECK_EQUAL(n, expected.size());
+        basictest::exactly_the_same_outputs(rt, result, expected);
+    }
+
+    // stop after some values
+    std::size_t const counts[] = { 1, 2, 5 };
+    for ( std::size_t i = 0 ; i < sizeof(counts) / sizeof(std::size_t) ; ++i )
+    {
+        std::vector<value_t> result;
+        std::size_t n = bgi::query_each(rt, pred, collect_n<value_t>(result, counts[i]));
+        std::size_t const expected_n = (std::min)(counts[i], expected.size());
+        BOOST_CHECK_EQUAL(n, expected_n);
+        std::vector<value_t> expected_prefix(expected.begin(), expected.begin() + expected_n);
+        basictest::exactly_the_same_outputs(rt, result, expected_prefix);
+    }
+
+    // existence check
+    {
+        bool found = false;
+        std::size_t n = rt.query_each(pred, any_found(found));
+        BOOST_CHECK_EQUAL(found, ! expected.empty());
+        BOOST_CHECK_EQUAL(n, expected.empty() ? 0u : 1u);
+    }
+}
+
+template <typename Value, typename Params>
+void test_rtree(Params const& params = Params())
+{
+    typedef bgi::rtree<Value, Params> rtree_t;
+    typedef typename rtree_t::bounds_type box_t;
+    typedef typename bg::point_type<box_t>::type point_t;
+
+    std::vector<Value> input;
+    box_t qbox;
+    generate::input<2>::apply(input, qbox, 2);
+
+    rtree_t rt(input, params);
+
+    test_query_each(rt, bgi::intersects(qbox));
+    test_query_each(rt, bgi::within(qbox) && !bgi::intersects(box_t(point_t(4, 4), point_t(5, 5))));
+    test_query_each(rt, bgi::nearest(point_t(5, 5), 10));
+    test_query_each(rt, bgi::nearest(point_t(5, 5), 10) && bgi::intersects(qbox));
+
+    // no values found
+    box_t const outside(point_t(-10, -10), point_t(-9, -9));
+    test_query_each(rt, bgi::intersects(outside));
+
+    // empty rtree
+    rtree_t empty(params);
+    test_query_each(empty, bgi::intersects(qbox));
+    test_query_each(empty, bgi::nearest(point_t(5, 5), 10));
+}
+
+int test_main(int, char* [])
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+    typedef bg::model::box<point_t> box_t;
+
+    test_rtree< point_t, bgi::linear<4, 2> >();
+    test_rtree< box_t, bgi::quadratic<8, 3> >();
+    test_rtree< std::pair<box_t, int>, bgi::rstar<4, 2> >();
+    test_rtree<box_t>(bgi::dynamic_rstar(4, 2));
+
+    return 0;
+}
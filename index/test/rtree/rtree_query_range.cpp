@@ -0,0 +1,145 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <rtree/test_rtree.hpp>
+
+#include <cstdlib>
+#include <new>
+
+#include <boost/range/algorithm/copy.hpp>
+
+// The number of allocations performed with the global operator new
+std::size_t allocations_count = 0;
+
+void * operator new(std::size_t size)
+{
+    ++allocations_count;
+    void * p = std::malloc(size == 0 ? 1 : size);
+    if ( !p )
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void * p) throw()
+{
+    std::free(p);
+}
+
+#ifndef BOOST_NO_CXX14_SIZED_DEALLOCATION
+void operator delete(void * p, std::size_t) throw()
+{
+    std::free(p);
+}
+#endif
+
+template <typename Rtree, typename Predicates>
+void test_query_range(Rtree const& rt, Predicates const& pred, std::size_t expected_size)
+{
+    typedef typename Rtree::value_type value_t;
+    typedef typename Rtree::template query_range_type<Predicates>::type range_t;
+
+    std::vector<value_t> expected;
+    rt.query(pred, std::back_inserter(expected));
+    BOOST_CHECK_EQUAL(expected.size(), expected_size);
+
+    std::vector<value_t> output;
+    output.reserve(expected.size());
+
+    range_t const range = rt.qrange(pred);
+    BOOST_CHECK_EQUAL(range.empty(), expected.empty());
+
+    // the iteration doesn't allocate memory, the k-NN iterator allocates
+    // the memory when it's created or copied
+    typename range_t::const_iterator it = range.begin();
+    std::size_t const allocations_before = allocations_count;
+    for ( ; it != range.end() ; ++it )
+        output.push_back(*it);
+    BOOST_CHECK_EQUAL(allocations_count, allocations_before);
+
+    basictest::compare_outputs(rt, output, expected);
+
+    // the range may be used with range algorithms
+    output.clear();
+    boost::copy(bgi::qrange(rt, pred), std::back_inserter(output));
+    basictest::compare_outputs(rt, output, expected);
+
+    // the same values as returned by the type-erased iterators
+    output.clear();
+    std::copy(rt.qbegin(pred), rt.qend(), std::back_inserter(output));
+    basictest::compare_outputs(rt, output, expected);
+}
+
+template <typename Rtree, typename Predicates>
+void count_without_allocations(Rtree const& rt, Predicates const& pred, std::size_t expected_size)
+{
+    typedef typename Rtree::template query_range_type<Predicates>::type range_t;
+
+    std::size_t const allocations_before = allocations_count;
+
+    range_t const range = rt.qrange(pred);
+    std::size_t count = 0;
+    for ( typename range_t::const_iterator it = range.begin() ; it != range.end() ; ++it )
+        ++count;
+
+    BOOST_CHECK_EQUAL(allocations_count, allocations_before);
+    BOOST_CHECK_EQUAL(count, expected_size);
+}
+
+template <typename Value, typename Params>
+void test_rtree_query_range(Params const& params = Params())
+{
+    typedef bgi::rtree<Value, Params> rtree_t;
+    typedef typename rtree_t::bounds_type box_t;
+    typedef typename bg::point_type<box_t>::type point_t;
+
+    std::vector<Value> input;
+    box_t qbox;
+    generate::input<2>::apply(input, qbox, 4);
+
+    rtree_t rt(input.begin(), input.end(), params);
+    rtree_t packed(input, params);
+
+    std::size_t expected_count = 0;
+    for ( std::size_t i = 0 ; i < input.size() ; ++i )
+        if ( bg::intersects(bgi::indexable<Value>()(input[i]), qbox) )
+            ++expected_count;
+
+    point_t const pt(1, 1);
+
+    // spatial queries, nothing is allocated, also when the range is created
+    count_without_allocations(rt, bgi::intersects(qbox), expected_count);
+    count_without_allocations(packed, bgi::intersects(qbox), expected_count);
+
+    test_query_range(rt, bgi::intersects(qbox), expected_count);
+    test_query_range(packed, bgi::intersects(qbox), expected_count);
+    test_query_range(rt, bgi::intersects(qbox) && bgi::disjoint(qbox), 0);
+    test_query_range(rt, bgi::nearest(pt, 10), 10);
+    test_query_range(packed, bgi::nearest(pt, 10) && bgi::intersects(qbox), (std::min)(expected_count, std::size_t(10)));
+    test_query_range(rt, bgi::nearest(pt, static_cast<unsigned>(input.size() + 10)), input.size());
+
+    // empty tree
+    rtree_t empty(params);
+    test_query_range(empty, bgi::intersects(qbox), 0);
+    test_query_range(empty, bgi::nearest(pt, 10), 0);
+}
+
+int test_main(int, char* [])
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+    typedef bg::model::box<point_t> box_t;
+    typedef std::pair<box_t, int> pair_t;
+
+    test_rtree_query_range< point_t, bgi::linear<4, 2> >();
+    test_rtree_query_range< box_t, bgi::quadratic<8, 3> >();
+    test_rtree_query_range< pair_t, bgi::rstar<8, 3> >();
+    test_rtree_query_range<point_t>(bgi::dynamic_linear(4, 2));
+    test_rtree_query_range<pair_t>(bgi::dynamic_rstar(8, 3));
+
+    return 0;
+}
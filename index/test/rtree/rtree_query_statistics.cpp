@@ -0,0 +1,132 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <rtree/test_rtree.hpp>
+
+#include <boost/geometry/index/detail/rtree/utilities/statistics.hpp>
+
+namespace bgiu = bgi::detail::rtree::utilities;
+
+inline std::size_t histogram_sum(std::vector<std::size_t> const& histogram)
+{
+    std::size_t result = 0;
+    for ( std::size_t i = 0 ; i < histogram.size() ; ++i )
+        result += histogram[i];
+    return result;
+}
+
+template <typename Rtree, typename Predicates>
+void test_query(Rtree const& rt, Predicates const& pred, bgiu::query_statistics & stats)
+{
+    typedef typename Rtree::value_type value_t;
+
+    std::vector<value_t> expected;
+    rt.query(pred, std::back_inserter(expected));
+
+    std::size_t const queries = stats.queries();
+    bgiu::query_counters const total = stats.total();
+
+    std::vector<value_t> result;
+    std::size_t n = bgiu::query(rt, pred, std::back_inserter(result), stats);
+    BOOST_CHECK_EQUAL(n, expected.size());
+    basictest::exactly_the_same_outputs(rt, result, expected);
+
+    bgiu::query_counters const& last = stats.last();
+    BOOST_CHECK_EQUAL(stats.queries(), queries + 1);
+    BOOST_CHECK_EQUAL(last.values, expected.size());
+    BOOST_CHECK_LE(last.leaves, last.nodes);
+    if ( rt.empty() )
+    {
+        BOOST_CHECK_EQUAL(last.nodes, 0u);
+        BOOST_CHECK_EQUAL(last.predicates, 0u);
+    }
+    else
+    {
+        // the root is always visited, other nodes only if their boxes were checked
+        BOOST_CHECK_GE(last.nodes, 1u);
+        BOOST_CHECK_GE(last.predicates + 1, last.nodes);
+    }
+    BOOST_CHECK_GE(last.predicates, last.values);
+
+    BOOST_CHECK_EQUAL(stats.total().nodes, total.nodes + last.nodes);
+    BOOST_CHECK_EQUAL(stats.total().leaves, total.leaves + last.leaves);
+    BOOST_CHECK_EQUAL(stats.total().predicates, total.predicates + last.predicates);
+    BOOST_CHECK_EQUAL(stats.total().values, total.values + last.values);
+
+    BOOST_CHECK_EQUAL(histogram_sum(stats.nodes_histogram()), stats.queries());
+    BOOST_CHECK_EQUAL(histogram_sum(stats.leaves_histogram()), stats.queries());
+    BOOST_CHECK_EQUAL(histogram_sum(stats.predicates_histogram()), stats.queries());
+    BOOST_CHECK_EQUAL(histogram_sum(stats.values_histogram()), stats.queries());
+}
+
+template <typename Value, typename Params>
+void test_rtree(Params const& params = Params())
+{
+    typedef bgi::rtree<Value, Params> rtree_t;
+    typedef typename rtree_t::bounds_type box_t;
+    typedef typename bg::point_type<box_t>::type point_t;
+
+    std::vector<Value> input;
+    box_t qbox;
+    generate::input<2>::apply(input, qbox, 2);
+
+    rtree_t rt(input, params);
+
+    bgiu::query_statistics stats;
+
+    test_query(rt, bgi::intersects(qbox), stats);
+    test_query(rt, bgi::within(qbox) && !bgi::intersects(box_t(point_t(4, 4), point_t(5, 5))), stats);
+    test_query(rt, bgi::nearest(point_t(5, 5), 1), stats);
+    test_query(rt, bgi::nearest(point_t(5, 5), 10), stats);
+    test_query(rt, bgi::nearest(point_t(5, 5), 10) && bgi::intersects(qbox), stats);
+
+    // the whole tree is traversed
+    {
+        test_query(rt, bgi::intersects(rt.bounds()), stats);
+        bgiu::query_counters const& last = stats.last();
+        BOOST_CHECK_EQUAL(last.values, rt.size());
+        std::size_t levels, nodes, leaves, values, values_min, values_max;
+        boost::tie(levels, nodes, leaves, values, values_min, values_max) = bgiu::statistics(rt);
+        BOOST_CHECK_EQUAL(last.leaves, leaves);
+        BOOST_CHECK_EQUAL(last.nodes, nodes + leaves);
+    }
+
+    // no values found, only the root is visited
+    {
+        box_t const outside(point_t(-10, -10), point_t(-9, -9));
+        test_query(rt, bgi::intersects(outside), stats);
+        BOOST_CHECK_EQUAL(stats.last().nodes, 1u);
+        BOOST_CHECK_EQUAL(stats.values_histogram()[0], 1u);
+    }
+
+    // empty rtree
+    rtree_t empty(params);
+    test_query(empty, bgi::intersects(qbox), stats);
+    test_query(empty, bgi::nearest(point_t(5, 5), 10), stats);
+
+    BOOST_CHECK_EQUAL(stats.queries(), 9u);
+
+    stats.clear();
+    BOOST_CHECK_EQUAL(stats.queries(), 0u);
+    BOOST_CHECK_EQUAL(stats.total().nodes, 0u);
+    BOOST_CHECK(stats.nodes_histogram().empty());
+}
+
+int test_main(int, char* [])
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+    typedef bg::model::box<point_t> box_t;
+
+    test_rtree< point_t, bgi::linear<4, 2> >();
+    test_rtree< box_t, bgi::quadratic<8, 3> >();
+    test_rtree< std::pair<box_t, int>, bgi::rstar<4, 2> >();
+    test_rtree<box_t>(bgi::dynamic_rstar(4, 2));
+
+    return 0;
+}
@@ -0,0 +1,155 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <rtree/test_rtree.hpp>
+
+#include <boost/geometry/index/detail/rtree/utilities/are_boxes_ok.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/are_counts_ok.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/are_levels_ok.hpp>
+
+// Removes the values which min x coordinates are in [min_x, max_x]
+// and which sums of the integral parts of min coordinates are divisible by modulo
+template <typename Value>
+struct in_stripes
+{
+    in_stripes(double mi, double ma, int mod) : min_x(mi), max_x(ma), modulo(mod) {}
+
+    bool operator()(Value const& v) const
+    {
+        typedef typename bgi::rtree<Value, bgi::linear<4> >::bounds_type box_t;
+        box_t b;
+        bgi::detail::bounds(bgi::indexable<Value>()(v), b);
+        double const x = bg::get<bg::min_corner, 0>(b);
+        double const y = bg::get<bg::min_corner, 1>(b);
+        return min_x <= x && x <= max_x
+            && (static_cast<int>(x) + static_cast<int>(y)) % modulo == 0;
+    }
+
+    double min_x, max_x;
+    int modulo;
+};
+
+template <typename Rtree>
+void check_tree(Rtree const& rt, std::vector<typename Rtree::value_type> const& expected_values)
+{
+    namespace bgiu = bgi::detail::rtree::utilities;
+    typedef typename Rtree::value_type value_t;
+
+    BOOST_CHECK(bgiu::are_levels_ok(rt));
+    BOOST_CHECK(bgiu::are_counts_ok(rt));
+    BOOST_CHECK_EQUAL(rt.size(), expected_values.size());
+
+    if ( expected_values.empty() )
+        return;
+
+    BOOST_CHECK(bgiu::are_boxes_ok(rt));
+
+    std::vector<value_t> all(rt.begin(), rt.end());
+    basictest::compare_outputs(rt, all, expected_values);
+
+    typename Rtree::bounds_type const qbox = rt.bounds();
+    std::vector<value_t> output;
+    rt.query(bgi::intersects(qbox), std::back_inserter(output));
+    basictest::compare_outputs(rt, output, expected_values);
+}
+
+template <typename Rtree, typename Predicate>
+void test_predicate(Rtree const& source, Predicate const& pred, std::size_t threads)
+{
+    typedef typename Rtree::value_type value_t;
+
+    std::vector<value_t> kept;
+    std::size_t removed = 0;
+    for ( typename Rtree::const_iterator it = source.begin() ; it != source.end() ; ++it )
+    {
+        if ( pred(*it) )
+            ++removed;
+        else
+            kept.push_back(*it);
+    }
+
+    Rtree rt = source;
+    std::size_t const count = threads == 1 ? rt.remove_if(pred)
+                                           : rt.remove_if(pred, bgi::parallel(threads));
+    BOOST_CHECK_EQUAL(count, removed);
+    check_tree(rt, kept);
+
+    // nothing more to remove
+    BOOST_CHECK_EQUAL(rt.remove_if(pred, bgi::parallel(threads)), 0u);
+    check_tree(rt, kept);
+
+    // the tree may be modified
+    std::vector<value_t> all(source.begin(), source.end());
+    if ( all.empty() )
+        return;
+
+    rt.clear();
+    rt.insert(all.begin(), all.end());
+    BOOST_CHECK_EQUAL(rt.remove_if(pred, bgi::parallel(threads)), removed);
+    rt.insert(all.front());
+    kept.push_back(all.front());
+    check_tree(rt, kept);
+}
+
+template <typename Value, typename Params>
+void test_remove_if(Params const& params = Params())
+{
+    typedef bgi::rtree<Value, Params> rtree_t;
+    typedef typename rtree_t::bounds_type box_t;
+
+    std::vector<Value> input;
+    box_t qbox;
+    generate::input<2>::apply(input, qbox, 4);
+
+    rtree_t packed(input, params);
+    rtree_t inserted(params);
+    inserted.insert(input);
+    rtree_t empty(params);
+
+    rtree_t const* trees[] = { &packed, &inserted, &empty };
+    std::size_t const threads[] = { 1, 2, 4 };
+
+    for ( std::size_t t = 0 ; t < 3 ; ++t )
+    {
+        for ( std::size_t i = 0 ; i < 3 ; ++i )
+        {
+            // nothing
+            test_predicate(*trees[t], in_stripes<Value>(1, 0, 1), threads[i]);
+            // everything
+            test_predicate(*trees[t], in_stripes<Value>(-1000, 1000, 1), threads[i]);
+            // a region of the space, many nodes are emptied
+            test_predicate(*trees[t], in_stripes<Value>(-1000, 20, 1), threads[i]);
+            // scattered values
+            test_predicate(*trees[t], in_stripes<Value>(-1000, 1000, 2), threads[i]);
+        }
+    }
+
+    // the tree containing only the root
+    rtree_t small(input.begin(), input.begin() + 3, params);
+    test_predicate(small, in_stripes<Value>(-1000, 1000, 2), 4);
+}
+
+int test_main(int, char* [])
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+    typedef bg::model::box<point_t> box_t;
+    typedef std::pair<box_t, int> pair_t;
+
+    test_remove_if< point_t, bgi::linear<4, 2> >();
+    test_remove_if< box_t, bgi::quadratic<4, 2> >();
+    test_remove_if< pair_t, bgi::rstar<4, 2> >();
+    test_remove_if< box_t, bgi::rstar<16, 4> >();
+    test_remove_if<point_t>(bgi::dynamic_linear(8, 3));
+    test_remove_if<pair_t>(bgi::dynamic_rstar(4, 2));
+
+    // the aggregates are updated
+    test_remove_if<pair_t>(bgi::augmented< bgi::rstar<8, 3> >());
+
+    return 0;
+}
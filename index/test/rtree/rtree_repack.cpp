@@ -0,0 +1,158 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <rtree/test_rtree.hpp>
+
+#include <boost/geometry/index/node_pool_allocator.hpp>
+
+#include <boost/geometry/index/detail/rtree/utilities/are_boxes_ok.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/are_counts_ok.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/are_levels_ok.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/statistics.hpp>
+
+template <typename Rtree, typename Box>
+void check_tree(Rtree const& rt, std::vector<typename Rtree::value_type> const& expected_values, Box const& qbox)
+{
+    namespace bgiu = bgi::detail::rtree::utilities;
+    typedef typename Rtree::value_type value_t;
+
+    BOOST_CHECK(bgiu::are_levels_ok(rt));
+    BOOST_CHECK(bgiu::are_boxes_ok(rt));
+    BOOST_CHECK(bgiu::are_counts_ok(rt));
+    BOOST_CHECK_EQUAL(rt.size(), expected_values.size());
+
+    std::vector<value_t> expected;
+    for ( std::size_t i = 0 ; i < expected_values.size() ; ++i )
+        if ( bg::intersects(rt.indexable_get()(expected_values[i]), qbox) )
+            expected.push_back(expected_values[i]);
+
+    std::vector<value_t> output;
+    rt.query(bgi::intersects(qbox), std::back_inserter(output));
+    basictest::compare_outputs(rt, output, expected);
+
+    std::vector<value_t> all(rt.begin(), rt.end());
+    basictest::compare_outputs(rt, all, expected_values);
+}
+
+template <typename Value, typename Params>
+void test_repack(Params const& params = Params())
+{
+    namespace bgiu = bgi::detail::rtree::utilities;
+
+    typedef bgi::node_pool_allocator<Value> allocator_t;
+    typedef bgi::rtree<Value, Params, bgi::indexable<Value>, bgi::equal_to<Value>, allocator_t> rtree_t;
+    typedef typename rtree_t::bounds_type box_t;
+
+    std::vector<Value> input;
+    box_t qbox;
+    generate::input<2>::apply(input, qbox, 4);
+
+    allocator_t allocator;
+
+    // empty tree
+    {
+        rtree_t rt(params, bgi::indexable<Value>(), bgi::equal_to<Value>(), allocator);
+        rt.repack();
+        BOOST_CHECK(rt.empty());
+        BOOST_CHECK_EQUAL(bgiu::overlap_ratio(rt), 0.0);
+    }
+
+    bgi::packing::algorithm_type const algorithms[] = {
+        bgi::packing::top_down, bgi::packing::hilbert, bgi::packing::morton
+    };
+
+    for ( std::size_t a = 0 ; a < sizeof(algorithms) / sizeof(algorithms[0]) ; ++a )
+    {
+        // insert the values, remove and insert again half of them
+        rtree_t rt(params, bgi::indexable<Value>(), bgi::equal_to<Value>(), allocator);
+        rt.insert(input);
+        rt.remove(input.begin(), input.begin() + input.size() / 2);
+        rt.insert(input.begin(), input.begin() + input.size() / 2);
+
+        BOOST_CHECK_GE(bgiu::overlap_ratio(rt), 0.0);
+
+        std::size_t const blocks_count = allocator.blocks_count();
+        std::size_t const slabs_count = allocator.slabs_count();
+
+        rt.repack(bgi::packing(algorithms[a], bgi::parallel(2)));
+        check_tree(rt, input, qbox);
+        BOOST_CHECK_GE(bgiu::overlap_ratio(rt), 0.0);
+
+        // the memory of the destroyed nodes is reused
+        BOOST_CHECK_LE(allocator.blocks_count(), blocks_count);
+        BOOST_CHECK_EQUAL(allocator.slabs_count(), slabs_count);
+
+        // the tree may be modified and repacked again
+        rt.remove(input.begin(), input.begin() + input.size() / 2);
+        rt.repack();
+        check_tree(rt, std::vector<Value>(input.begin() + input.size() / 2, input.end()), qbox);
+    }
+}
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+
+// The value counting the copies
+struct copied_value
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> point_type;
+
+    copied_value(point_type const& p) : point(p) {}
+    copied_value(copied_value const& other) : point(other.point) { ++copies(); }
+    copied_value(copied_value && other) : point(other.point) {}
+    copied_value & operator=(copied_value const& other) { point = other.point; ++copies(); return *this; }
+    copied_value & operator=(copied_value && other) { point = other.point; return *this; }
+
+    static std::size_t & copies() { static std::size_t c = 0; return c; }
+
+    point_type point;
+};
+
+struct copied_value_indexable
+{
+    typedef copied_value::point_type const& result_type;
+    result_type operator()(copied_value const& v) const { return v.point; }
+};
+
+void test_repack_moves()
+{
+    typedef bgi::rtree<copied_value, bgi::rstar<8, 3>, copied_value_indexable> rtree_t;
+
+    rtree_t rt;
+    for ( int i = 0 ; i < 1000 ; ++i )
+        rt.insert(copied_value(copied_value::point_type(i % 37, i / 37)));
+
+    copied_value::copies() = 0;
+    rt.repack();
+    BOOST_CHECK_EQUAL(copied_value::copies(), 0u);
+    BOOST_CHECK_EQUAL(rt.size(), 1000u);
+    BOOST_CHECK(bgi::detail::rtree::utilities::are_boxes_ok(rt));
+}
+
+#endif
+
+int test_main(int, char* [])
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+    typedef bg::model::box<point_t> box_t;
+    typedef std::pair<box_t, int> pair_t;
+
+    test_repack< point_t, bgi::linear<4, 2> >();
+    test_repack< box_t, bgi::quadratic<8, 3> >();
+    test_repack< pair_t, bgi::rstar<8, 3> >();
+    test_repack<box_t>(bgi::dynamic_rstar(16, 4));
+
+    // the aggregates are calculated
+    test_repack<pair_t>(bgi::augmented< bgi::rstar<8, 3> >());
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    test_repack_moves();
+#endif
+
+    return 0;
+}
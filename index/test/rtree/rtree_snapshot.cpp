@@ -0,0 +1,244 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <rtree/test_rtree.hpp>
+
+#include <boost/geometry/index/node_pool_allocator.hpp>
+#include <boost/geometry/index/snapshot_rtree.hpp>
+
+#include <boost/geometry/index/detail/rtree/utilities/are_boxes_ok.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/are_counts_ok.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/are_levels_ok.hpp>
+
+#ifdef BOOST_GEOMETRY_DETAIL_PARALLEL_USE_THREADS
+#include <thread>
+#endif
+
+template <typename Rtree, typename Box>
+void check_snapshot(Rtree const& rt, std::vector<typename Rtree::value_type> const& expected_values, Box const& qbox)
+{
+    namespace bgiu = bgi::detail::rtree::utilities;
+    typedef typename Rtree::value_type value_t;
+
+    BOOST_CHECK(bgiu::are_levels_ok(rt));
+    BOOST_CHECK(bgiu::are_boxes_ok(rt));
+    BOOST_CHECK(bgiu::are_counts_ok(rt));
+    BOOST_CHECK_EQUAL(rt.size(), expected_values.size());
+
+    std::vector<value_t> expected;
+    for ( std::size_t i = 0 ; i < expected_values.size() ; ++i )
+        if ( bg::intersects(rt.indexable_get()(expected_values[i]), qbox) )
+            expected.push_back(expected_values[i]);
+
+    std::vector<value_t> output;
+    rt.query(bgi::intersects(qbox), std::back_inserter(output));
+    basictest::compare_outputs(rt, output, expected);
+
+    std::vector<value_t> all(rt.begin(), rt.end());
+    basictest::compare_outputs(rt, all, expected_values);
+}
+
+template <typename Value, typename Params>
+void test_snapshots(Params const& params = Params())
+{
+    typedef bgi::node_pool_allocator<Value> allocator_t;
+    typedef bgi::snapshot_rtree<Value, Params, bgi::indexable<Value>, bgi::equal_to<Value>, allocator_t> tree_t;
+    typedef typename tree_t::snapshot_type snapshot_t;
+    typedef typename tree_t::rtree_type::bounds_type box_t;
+
+    std::vector<Value> input;
+    box_t qbox;
+    generate::input<2>::apply(input, qbox, 4);
+
+    std::size_t const half = input.size() / 2;
+    std::vector<Value> first_half(input.begin(), input.begin() + half);
+    std::vector<Value> removed, kept(input.begin() + half, input.end());
+    for ( std::size_t i = 0 ; i < half ; ++i )
+        (i % 2 == 0 ? removed : kept).push_back(input[i]);
+
+    allocator_t allocator;
+    snapshot_t last;
+
+    {
+        tree_t tree(params, bgi::indexable<Value>(), bgi::equal_to<Value>(), allocator);
+
+        snapshot_t s0 = tree.snapshot();
+        BOOST_CHECK(s0->empty());
+
+        // the modifications are not visible before publish()
+        tree.insert(first_half.begin(), first_half.end());
+        BOOST_CHECK_EQUAL(tree.size(), first_half.size());
+        BOOST_CHECK(tree.snapshot()->empty());
+
+        tree.publish();
+        snapshot_t s1 = tree.snapshot();
+        check_snapshot(*s1, first_half, qbox);
+
+        // the snapshot is not affected by the subsequent modifications
+        tree.insert(input.begin() + half, input.end());
+        BOOST_CHECK_EQUAL(tree.remove(removed.begin(), removed.end()), removed.size());
+        BOOST_CHECK_EQUAL(tree.remove(removed[0]), 0u);
+        BOOST_CHECK_EQUAL(tree.size(), kept.size());
+        check_snapshot(*s1, first_half, qbox);
+
+        tree.publish();
+        snapshot_t s2 = tree.snapshot();
+        check_snapshot(*s2, kept, qbox);
+        check_snapshot(*s1, first_half, qbox);
+        BOOST_CHECK(s0->empty());
+
+        // nothing to publish
+        tree.publish();
+        BOOST_CHECK(tree.snapshot() == s2);
+
+        // the snapshots may be released in any order
+        s1.reset();
+        check_snapshot(*s2, kept, qbox);
+
+        BOOST_CHECK_EQUAL(tree.remove(kept.begin(), kept.end()), kept.size());
+        BOOST_CHECK(tree.empty());
+        tree.publish();
+        BOOST_CHECK(tree.snapshot()->empty());
+        check_snapshot(*s2, kept, qbox);
+
+        s2.reset();
+        s0.reset();
+
+        // many modifications published one by one
+        for ( std::size_t i = 0 ; i < input.size() ; ++i )
+        {
+            tree.insert(input[i]);
+            tree.publish();
+        }
+        check_snapshot(*tree.snapshot(), input, qbox);
+
+        // the snapshot outlives the tree
+        last = tree.snapshot();
+        tree.remove(input.begin(), input.begin() + half);
+    }
+
+    check_snapshot(*last, input, qbox);
+
+    // all nodes are destroyed
+    last.reset();
+    BOOST_CHECK_EQUAL(allocator.blocks_count(), 0u);
+
+    // the packed tree
+    {
+        tree_t tree(input, params, bgi::indexable<Value>(), bgi::equal_to<Value>(), allocator);
+        snapshot_t s = tree.snapshot();
+        check_snapshot(*s, input, qbox);
+
+        tree.remove(removed.begin(), removed.end());
+        tree.publish();
+        check_snapshot(*s, input, qbox);
+
+        check_snapshot(*tree.snapshot(), kept, qbox);
+
+        // unpublished modifications are discarded
+        tree.insert(removed.begin(), removed.end());
+    }
+
+    BOOST_CHECK_EQUAL(allocator.blocks_count(), 0u);
+}
+
+#ifdef BOOST_GEOMETRY_DETAIL_PARALLEL_USE_THREADS
+
+template <typename Tree>
+void read_snapshots(Tree const& tree, std::size_t count, std::size_t values_step, bool & failed)
+{
+    namespace bgiu = bgi::detail::rtree::utilities;
+
+    for ( std::size_t i = 0 ; i < count ; ++i )
+    {
+        typename Tree::snapshot_type s = tree.snapshot();
+
+        // the writer publishes multiples of values_step values
+        std::size_t const size = static_cast<std::size_t>(std::distance(s->begin(), s->end()));
+        if ( size != s->size() || 0 != size % values_step || ( 0 < size && ! bgiu::are_boxes_ok(*s) ) )
+            failed = true;
+    }
+}
+
+template <typename Value, typename Params>
+void test_concurrent_readers(Params const& params = Params())
+{
+    typedef bgi::node_pool_allocator<Value> allocator_t;
+    typedef bgi::snapshot_rtree<Value, Params, bgi::indexable<Value>, bgi::equal_to<Value>, allocator_t> tree_t;
+    typedef typename tree_t::rtree_type::bounds_type box_t;
+
+    std::vector<Value> input;
+    box_t qbox;
+    generate::input<2>::apply(input, qbox, 4);
+
+    std::size_t const values_step = 10;
+    allocator_t allocator;
+
+    {
+        tree_t tree(params, bgi::indexable<Value>(), bgi::equal_to<Value>(), allocator);
+
+        bool failed[4] = { false, false, false, false };
+        std::vector<std::thread> readers;
+        for ( std::size_t i = 0 ; i < 4 ; ++i )
+            readers.push_back(std::thread(read_snapshots<tree_t>, boost::cref(tree), 200, values_step, boost::ref(failed[i])));
+
+        // insert and remove the values in groups
+        for ( std::size_t r = 0 ; r < 3 ; ++r )
+        {
+            for ( std::size_t i = 0 ; i + values_step <= input.size() ; i += values_step )
+            {
+                tree.insert(input.begin() + i, input.begin() + i + values_step);
+                tree.publish();
+            }
+            for ( std::size_t i = 0 ; i + values_step <= input.size() ; i += values_step )
+            {
+                tree.remove(input.begin() + i, input.begin() + i + values_step);
+                tree.publish();
+            }
+        }
+
+        for ( std::size_t i = 0 ; i < readers.size() ; ++i )
+            readers[i].join();
+
+        for ( std::size_t i = 0 ; i < 4 ; ++i )
+            BOOST_CHECK(! failed[i]);
+    }
+
+    BOOST_CHECK_EQUAL(allocator.blocks_count(), 0u);
+}
+
+#endif
+
+template <typename Value, typename Params>
+void test_snapshot_rtree(Params const& params = Params())
+{
+    test_snapshots<Value>(params);
+
+#ifdef BOOST_GEOMETRY_DETAIL_PARALLEL_USE_THREADS
+    test_concurrent_readers<Value>(params);
+#endif
+}
+
+int test_main(int, char* [])
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+    typedef bg::model::box<point_t> box_t;
+    typedef std::pair<box_t, int> pair_t;
+
+    test_snapshot_rtree< point_t, bgi::linear<4, 2> >();
+    test_snapshot_rtree< box_t, bgi::quadratic<4, 2> >();
+    test_snapshot_rtree< pair_t, bgi::rstar<8, 3> >();
+    test_snapshot_rtree<point_t>(bgi::dynamic_linear(8, 3));
+    test_snapshot_rtree<pair_t>(bgi::dynamic_rstar(4, 2));
+
+    // the aggregates are updated
+    test_snapshot_rtree<pair_t>(bgi::augmented< bgi::rstar<8, 3> >());
+
+    return 0;
+}
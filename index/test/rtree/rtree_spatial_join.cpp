@@ -0,0 +1,137 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <rtree/test_rtree.hpp>
+
+#include <boost/function_output_iterator.hpp>
+
+template <typename Pair>
+struct pair_equal
+{
+    bool operator()(Pair const& l, Pair const& r) const
+    {
+        return bgi::equal_to<typename Pair::first_type>()(l.first, r.first)
+            && bgi::equal_to<typename Pair::second_type>()(l.second, r.second);
+    }
+};
+
+struct counter
+{
+    explicit counter(std::size_t & c) : count(c) {}
+    template <typename Pair>
+    void operator()(Pair const& ) { ++count; }
+    std::size_t & count;
+};
+
+template <typename Rtree1, typename Rtree2>
+void test_join(Rtree1 const& rt1, Rtree2 const& rt2,
+               std::vector<typename Rtree1::value_type> const& input1,
+               std::vector<typename Rtree2::value_type> const& input2)
+{
+    typedef typename Rtree1::value_type value1_t;
+    typedef typename Rtree2::value_type value2_t;
+    typedef std::pair<value1_t, value2_t> pair_t;
+
+    // brute force
+    std::size_t expected_count = 0;
+    for ( std::size_t i = 0 ; i < input1.size() ; ++i )
+        for ( std::size_t j = 0 ; j < input2.size() ; ++j )
+            if ( bg::intersects(rt1.indexable_get()(input1[i]), rt2.indexable_get()(input2[j])) )
+                ++expected_count;
+
+    std::vector<pair_t> result;
+    std::size_t n = bgi::spatial_join(rt1, rt2, std::back_inserter(result));
+    BOOST_CHECK_EQUAL(n, expected_count);
+    BOOST_CHECK_EQUAL(result.size(), expected_count);
+
+    for ( std::size_t i = 0 ; i < result.size() ; ++i )
+        BOOST_CHECK(bg::intersects(rt1.indexable_get()(result[i].first), rt2.indexable_get()(result[i].second)));
+
+    // each pair only once
+    std::size_t unique_count = 0;
+    for ( std::size_t i = 0 ; i < result.size() ; ++i )
+    {
+        std::size_t j = 0;
+        for ( ; j < i ; ++j )
+            if ( pair_equal<pair_t>()(result[i], result[j]) )
+                break;
+        if ( j == i )
+            ++unique_count;
+    }
+    BOOST_CHECK_EQUAL(unique_count, result.size());
+
+    // callback
+    std::size_t callback_count = 0;
+    bgi::spatial_join(rt1, rt2, boost::make_function_output_iterator(counter(callback_count)));
+    BOOST_CHECK_EQUAL(callback_count, expected_count);
+
+    // the same results in the same order
+    std::size_t const threads[] = { 1, 2, 3, 8, 0 };
+    for ( std::size_t t = 0 ; t < sizeof(threads) / sizeof(std::size_t) ; ++t )
+    {
+        std::vector<pair_t> result_p;
+        std::size_t n_p = bgi::spatial_join(rt1, rt2, std::back_inserter(result_p), bgi::parallel(threads[t]));
+        BOOST_CHECK_EQUAL(n_p, expected_count);
+        BOOST_CHECK(result.size() == result_p.size()
+                 && std::equal(result.begin(), result.end(), result_p.begin(), pair_equal<pair_t>()));
+    }
+}
+
+template <typename Value1, typename Params1, typename Value2, typename Params2>
+void test_rtrees(std::size_t count1, std::size_t count2,
+                 Params1 const& params1 = Params1(), Params2 const& params2 = Params2())
+{
+    typedef bgi::rtree<Value1, Params1> rtree1_t;
+    typedef bgi::rtree<Value2, Params2> rtree2_t;
+
+    std::vector<Value1> input1;
+    for ( std::size_t i = 0 ; i < count1 ; ++i )
+        input1.push_back(generate::value<Value1>::apply(int(i * 7919 % 101), int(i * 104729 % 97)));
+    std::vector<Value2> input2;
+    for ( std::size_t i = 0 ; i < count2 ; ++i )
+        input2.push_back(generate::value<Value2>::apply(int(i * 7907 % 103), int(i * 104723 % 89)));
+
+    // packed
+    {
+        rtree1_t rt1(input1, params1);
+        rtree2_t rt2(input2, params2);
+        test_join(rt1, rt2, input1, input2);
+        test_join(rt2, rt1, input2, input1);
+    }
+
+    // not packed
+    {
+        rtree1_t rt1(params1);
+        rt1.insert(input1);
+        rtree2_t rt2(params2);
+        rt2.insert(input2);
+        test_join(rt1, rt2, input1, input2);
+    }
+}
+
+int test_main(int, char* [])
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+    typedef bg::model::box<point_t> box_t;
+    typedef bg::model::segment<point_t> segment_t;
+    typedef std::pair<box_t, int> pair_t;
+
+    test_rtrees< box_t, bgi::linear<4, 2>, box_t, bgi::quadratic<8, 3> >(1000, 1000);
+    test_rtrees< box_t, bgi::rstar<4, 2>, point_t, bgi::rstar<16, 4> >(1000, 300);
+    test_rtrees< pair_t, bgi::quadratic<4, 2>, segment_t, bgi::linear<4, 2> >(200, 1000);
+    test_rtrees<box_t, bgi::dynamic_rstar, box_t, bgi::dynamic_linear>(
+        100, 1000, bgi::dynamic_rstar(4, 2), bgi::dynamic_linear(16, 4));
+
+    // different heights, empty and one element trees
+    test_rtrees< box_t, bgi::linear<4, 2>, box_t, bgi::linear<4, 2> >(1, 1000);
+    test_rtrees< box_t, bgi::linear<4, 2>, box_t, bgi::linear<4, 2> >(0, 1000);
+    test_rtrees< box_t, bgi::linear<4, 2>, box_t, bgi::linear<4, 2> >(5, 5);
+
+    return 0;
+}
@@ -0,0 +1,153 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Copyright (c) 2018 Adam Wulkiewicz, Lodz, Poland.
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <rtree/test_rtree.hpp>
+
+#include <boost/geometry/geometries/segment.hpp>
+
+#include <boost/geometry/index/detail/rtree/utilities/are_boxes_ok.hpp>
+
+typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+typedef bg::model::box<point_t> box_t;
+typedef bg::model::segment<point_t> segment_t;
+typedef bg::model::point<double, 2, bg::cs::spherical_equatorial<bg::degree> > sph_point_t;
+
+// pseudo-random coordinates, the same in each run
+inline double next_coord(unsigned& seed, double range)
+{
+    seed = seed * 1103515245u + 12345u;
+    return double((seed >> 8) % 100000) / 100000.0 * range;
+}
+
+inline point_t make_value(unsigned& seed, point_t const*)
+{
+    return point_t(next_coord(seed, 100), next_coord(seed, 100));
+}
+
+inline box_t make_value(unsigned& seed, box_t const*)
+{
+    double const x = next_coord(seed, 100), y = next_coord(seed, 100);
+    return box_t(point_t(x, y), point_t(x + next_coord(seed, 3), y + next_coord(seed, 3)));
+}
+
+inline segment_t make_value(unsigned& seed, segment_t const*)
+{
+    double const x = next_coord(seed, 100), y = next_coord(seed, 100);
+    return segment_t(point_t(x, y), point_t(x + next_coord(seed, 3) - 1.5, y + next_coord(seed, 3) - 1.5));
+}
+
+inline sph_point_t make_value(unsigned& seed, sph_point_t const*)
+{
+    return sph_point_t(next_coord(seed, 60) - 30, next_coord(seed, 60) - 30);
+}
+
+struct is_in_box
+{
+    explicit is_in_box(box_t const& b) : box(b) {}
+
+    template <typename Value>
+    bool operator()(Value const& v) const { return bg::within(bg::return_centroid<point_t>(v), box); }
+
+    bool operator()(sph_point_t const& v) const { return bg::get<0>(v) < 0; }
+
+    box_t box;
+};
+
+template <typename Rtree, typename Point>
+void check_within_distance(Rtree const& rt, std::vector<typename Rtree::value_type> const& values,
+                           Point const& pt, double distance)
+{
+    typedef typename Rtree::value_type value_t;
+
+    std::vector<value_t> expected;
+    for ( std::size_t i = 0 ; i < values.size() ; ++i )
+        if ( bg::distance(pt, values[i]) <= distance )
+            expected.push_back(values[i]);
+
+    std::vector<value_t> output;
+    BOOST_CHECK_EQUAL(rt.query(bgi::within_distance(pt, distance), std::back_inserter(output)), expected.size());
+    basictest::compare_outputs(rt, output, expected);
+
+    // combined with other predicates
+    box_t const qbox(point_t(0, 0), point_t(50, 50));
+    output.clear();
+    rt.query(bgi::within_distance(pt, distance) && bgi::satisfies(is_in_box(qbox)), std::back_inserter(output));
+    BOOST_CHECK_EQUAL(std::size_t(std::count_if(expected.begin(), expected.end(), is_in_box(qbox))), output.size());
+
+    // the radius of the k-NN search is limited
+    std::vector<double> expected_dists;
+    for ( std::size_t i = 0 ; i < expected.size() ; ++i )
+        expected_dists.push_back(bg::distance(pt, expected[i]));
+    std::sort(expected_dists.begin(), expected_dists.end());
+
+    unsigned const counts[] = { 1, 5, static_cast<unsigned>(expected.size() + 10) };
+    for ( std::size_t c = 0 ; c < sizeof(counts) / sizeof(counts[0]) ; ++c )
+    {
+        output.clear();
+        rt.query(bgi::nearest(pt, counts[c]) && bgi::within_distance(pt, distance), std::back_inserter(output));
+
+        std::vector<double> dists;
+        for ( std::size_t i = 0 ; i < output.size() ; ++i )
+            dists.push_back(bg::distance(pt, output[i]));
+        std::sort(dists.begin(), dists.end());
+
+        std::size_t const expected_count = (std::min)(std::size_t(counts[c]), expected_dists.size());
+        BOOST_CHECK_EQUAL(dists.size(), expected_count);
+        BOOST_CHECK(dists.size() == expected_count
+                 && std::equal(dists.begin(), dists.end(), expected_dists.begin()));
+    }
+}
+
+template <typename Value, typename Point, typename Params>
+void test_within_distance(Point const& pt, double const* distances, std::size_t distances_count,
+                          Params const& params = Params())
+{
+    typedef bgi::rtree<Value, Params> rtree_t;
+
+    unsigned seed = 1;
+    std::vector<Value> values;
+    for ( int i = 0 ; i < 1000 ; ++i )
+        values.push_back(make_value(seed, static_cast<Value const*>(0)));
+
+    rtree_t rt(params);
+    rt.insert(values.begin(), values.end());
+    rtree_t packed(values, params);
+
+    BOOST_CHECK(bgi::detail::rtree::utilities::are_boxes_ok(rt));
+
+    for ( std::size_t d = 0 ; d < distances_count ; ++d )
+    {
+        check_within_distance(rt, values, pt, distances[d]);
+        check_within_distance(packed, values, pt, distances[d]);
+    }
+
+    // empty tree
+    rtree_t empty(params);
+    std::vector<Value> output;
+    BOOST_CHECK_EQUAL(empty.query(bgi::within_distance(pt, distances[0]), std::back_inserter(output)), 0u);
+}
+
+int test_main(int, char* [])
+{
+    double const distances[] = { 0.0, 1.0, 7.5, 30.0, 200.0 };
+    std::size_t const distances_count = sizeof(distances) / sizeof(distances[0]);
+
+    point_t const pt(40, 55);
+    test_within_distance< point_t, point_t, bgi::linear<4, 2> >(pt, distances, distances_count);
+    test_within_distance< box_t, point_t, bgi::quadratic<8, 3> >(pt, distances, distances_count);
+    test_within_distance< segment_t, point_t, bgi::rstar<8, 3> >(pt, distances, distances_count);
+    test_within_distance<point_t>(pt, distances, distances_count, bgi::dynamic_rstar(16, 4));
+
+    // the distances on the unit sphere
+    double const sph_distances[] = { 0.0, 0.01, 0.1, 0.3, 4.0 };
+    test_within_distance< sph_point_t, sph_point_t, bgi::rstar<8, 3> >(
+        sph_point_t(5, 10), sph_distances, sizeof(sph_distances) / sizeof(sph_distances[0]));
+
+    return 0;
+}
@@ -95,6 +95,37 @@ struct box_visitor
     }
 };
 
+template <typename Box>
+struct box_pairs_visitor
+{
+    typedef std::vector<std::pair<int, int> > buffer_type;
+
+    explicit box_pairs_visitor(buffer_type& pairs)
+        : m_pairs(pairs)
+    {}
+
+    box_pairs_visitor(box_pairs_visitor const& , buffer_type& pairs)
+        : m_pairs(pairs)
+    {}
+
+    template <typename Item>
+    inline bool apply(Item const& item1, Item const& item2)
+    {
+        if (bg::intersects(item1.box, item2.box))
+        {
+            m_pairs.push_back(std::make_pair(item1.id, item2.id));
+        }
+        return true;
+    }
+
+    void join(buffer_type& pairs)
+    {
+        m_pairs.insert(m_pairs.end(), pairs.begin(), pairs.end());
+    }
+
+    buffer_type& m_pairs;
+};
+
 struct point_in_box_visitor
 {
     int count;
@@ -568,6 +599,54 @@ void test_two_collections(int seed1, int seed2, int size, int count)
 }
 
 
+void test_parallel(int seed1, int seed2, int size, int count, std::size_t threads)
+{
+    typedef bg::model::box<point_item> box_type;
+    typedef box_pairs_visitor<box_type> visitor_type;
+    typedef bg::detail::partition::visit_no_policy partition_box_visitor_type;
+    typedef bg::partition
+        <
+            box_type,
+            bg::detail::partition::include_all_policy,
+            bg::detail::partition::include_all_policy
+        > partition_type;
+
+    std::vector<box_item<box_type> > boxes1, boxes2;
+
+    fill_boxes(boxes1, seed1, size, count);
+    fill_boxes(boxes2, seed2, size, count);
+
+    // The same pairs in the same order are expected from both versions
+    {
+        visitor_type::buffer_type expected, pairs;
+        visitor_type expected_visitor(expected), visitor(pairs);
+
+        partition_type::apply(boxes1, expected_visitor, get_box(), ovelaps_box(),
+                              2, partition_box_visitor_type());
+        partition_type::apply(boxes1, visitor, get_box(), ovelaps_box(),
+                              2, partition_box_visitor_type(), threads);
+
+        BOOST_CHECK(! expected.empty());
+        BOOST_CHECK(pairs == expected);
+    }
+
+    {
+        visitor_type::buffer_type expected, pairs;
+        visitor_type expected_visitor(expected), visitor(pairs);
+
+        partition_type::apply(boxes1, boxes2, expected_visitor,
+                              get_box(), ovelaps_box(), get_box(), ovelaps_box(),
+                              2, partition_box_visitor_type());
+        partition_type::apply(boxes1, boxes2, visitor,
+                              get_box(), ovelaps_box(), get_box(), ovelaps_box(),
+                              2, partition_box_visitor_type(), threads);
+
+        BOOST_CHECK(! expected.empty());
+        BOOST_CHECK(pairs == expected);
+    }
+}
+
+
 void test_heterogenuous_collections(int seed1, int seed2, int size, int count)
 {
     typedef bg::model::box<point_item> box_type;
@@ -666,5 +745,9 @@ int test_main( int , char* [] )
 
     test_heterogenuous_collections(67890, 98765, 20, 60);
 
+    test_parallel(12345, 54321, 20, 40, 2);
+    test_parallel(67890, 98765, 100, 400, 3);
+    test_parallel(13579, 97531, 100, 400, 0);
+
     return 0;
 }
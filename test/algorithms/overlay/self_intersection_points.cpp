@@ -101,6 +101,24 @@ static void test_self_intersection_points(std::string const& case_id,
 
     BOOST_CHECK_EQUAL(expected_count, n);
 
+    // The same turns in the same order are expected from the parallel version
+    {
+        std::vector<turn_info> parallel_turns;
+        bg::self_turns
+            <
+                bg::detail::overlay::assign_null_policy
+            >(geometry, strategy, rescale_policy, parallel_turns, policy,
+              0, false, 3);
+
+        BOOST_CHECK_EQUAL(boost::size(parallel_turns), n);
+        for (std::size_t i = 0; i < n && i < parallel_turns.size(); i++)
+        {
+            BOOST_CHECK_MESSAGE(bg::get<0>(parallel_turns[i].point) == bg::get<0>(turns[i].point)
+                             && bg::get<1>(parallel_turns[i].point) == bg::get<1>(turns[i].point),
+                                "Case " << case_id << " turn " << i << " differs");
+        }
+    }
+
     if (expected_count > 0)
     {
         BOOST_CHECK_EQUAL(bg::intersects(geometry), true);